@@ -14,7 +14,9 @@
 //
 #include "koladata/adoption_utils.h"
 
+#include <cstdint>
 #include <optional>
+#include <utility>
 #include <vector>
 
 #include "absl/base/nullability.h"
@@ -23,6 +25,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "koladata/data_bag.h"
 #include "koladata/data_slice.h"
 #include "koladata/extract_utils.h"
@@ -31,19 +34,26 @@
 #include "arolla/util/status_macros_backport.h"
 
 namespace koladata {
+namespace {
 
-absl::Status AdoptionQueue::AdoptInto(DataBag& db) const {
+// Merges `bags` and the triples reachable from `slices` into `db`. If
+// `allow_conflicts` is true, the value merged first is kept on conflicts,
+// otherwise conflicts are reported as errors.
+absl::Status AdoptIntoImpl(absl::Span<const DataBagPtr> bags,
+                           absl::Span<const DataSlice> slices, DataBag& db,
+                           bool allow_conflicts = false) {
   absl::flat_hash_set<const DataBag*> visited_bags{&db};
-  for (const DataBagPtr& other_db : bags_to_merge_) {
+  for (const DataBagPtr& other_db : bags) {
     if (visited_bags.contains(other_db.get())) {
       continue;
     }
     visited_bags.insert(other_db.get());
-    RETURN_IF_ERROR(db.MergeInplace(other_db, /*overwrite=*/false,
-                                    /*allow_data_conflicts=*/false,
-                                    /*allow_schema_conflicts=*/false));
+    RETURN_IF_ERROR(
+        db.MergeInplace(other_db, /*overwrite=*/false,
+                        /*allow_data_conflicts=*/allow_conflicts,
+                        /*allow_schema_conflicts=*/allow_conflicts));
   }
-  for (const DataSlice& slice : slices_to_merge_) {
+  for (const DataSlice& slice : slices) {
     if (visited_bags.contains(slice.GetBag().get())) {
       continue;
     }
@@ -53,15 +63,22 @@ absl::Status AdoptionQueue::AdoptInto(DataBag& db) const {
     if (extracted_db == nullptr) {
       continue;
     }
-    RETURN_IF_ERROR(db.MergeInplace(extracted_db, /*overwrite=*/false,
-                                    /*allow_data_conflicts=*/false,
-                                    /*allow_schema_conflicts=*/false));
+    RETURN_IF_ERROR(
+        db.MergeInplace(extracted_db, /*overwrite=*/false,
+                        /*allow_data_conflicts=*/allow_conflicts,
+                        /*allow_schema_conflicts=*/allow_conflicts));
   }
   return absl::OkStatus();
 }
 
-absl::StatusOr<absl::Nullable<DataBagPtr>> AdoptionQueue::GetCommonOrMergedDb()
-    const {
+}  // namespace
+
+absl::Status AdoptionQueue::AdoptInto(DataBag& db) const {
+  return AdoptIntoImpl(bags_to_merge_, slices_to_merge_, db);
+}
+
+absl::StatusOr<absl::Nullable<DataBagPtr>> AdoptionQueue::GetCommonOrMergedDb(
+    const LazyAdoptionOptions& lazy_options) const {
   // Check whether all bags (and slices' bags) are the same bag. If so, we
   // return that bag instead of merging.
   bool has_multiple_bags = false;
@@ -92,6 +109,9 @@ absl::StatusOr<absl::Nullable<DataBagPtr>> AdoptionQueue::GetCommonOrMergedDb()
     return nullptr;
   } else if (!has_multiple_bags) {
     return *single_bag;
+  } else if (auto lazy_db = GetLazilyMergedDb(lazy_options);
+             lazy_db != nullptr) {
+    return lazy_db;
   } else {
     DataBagPtr res = DataBag::Empty();
     RETURN_IF_ERROR(AdoptInto(*res));
@@ -100,17 +120,16 @@ absl::StatusOr<absl::Nullable<DataBagPtr>> AdoptionQueue::GetCommonOrMergedDb()
   }
 }
 
-absl::Nonnull<DataBagPtr> AdoptionQueue::GetBagWithFallbacks() const {
-  // Collect unique DataBags from all Add calls.
+std::vector<DataBagPtr> AdoptionQueue::GetUniqueBags() const {
   absl::flat_hash_set<const DataBag*> visited_bags;
-  std::vector<DataBagPtr> fallbacks;
-  fallbacks.reserve(slices_to_merge_.size() + bags_to_merge_.size());
+  std::vector<DataBagPtr> bags;
+  bags.reserve(slices_to_merge_.size() + bags_to_merge_.size());
   for (const DataBagPtr& bag : bags_to_merge_) {
     if (visited_bags.contains(bag.get())) {
       continue;
     }
     visited_bags.insert(bag.get());
-    fallbacks.push_back(bag);
+    bags.push_back(bag);
   }
   for (const DataSlice& slice : slices_to_merge_) {
     const DataBagPtr& bag = slice.GetBag();
@@ -118,10 +137,47 @@ absl::Nonnull<DataBagPtr> AdoptionQueue::GetBagWithFallbacks() const {
       continue;
     }
     visited_bags.insert(bag.get());
-    fallbacks.push_back(bag);
+    bags.push_back(bag);
   }
+  return bags;
+}
 
-  return DataBag::ImmutableEmptyWithFallbacks(fallbacks);
+absl::Nullable<DataBagPtr> AdoptionQueue::GetLazilyMergedDb(
+    const LazyAdoptionOptions& lazy_options) const {
+  if (!lazy_options.enabled) {
+    return nullptr;
+  }
+  std::vector<DataBagPtr> bags = GetUniqueBags();
+  for (const DataBagPtr& bag : bags) {
+    // Mutable DataBags can be modified after the adoption, which must not
+    // affect the result.
+    if (bag->IsMutable() || bag->HasMutableFallbacks()) {
+      return nullptr;
+    }
+  }
+  // Only the triples reachable from the tracked slices are merged, as in the
+  // eager merge. Conflicts are resolved in the same order as by lookups in
+  // `bags`, so the result does not change on compaction.
+  auto merge_fn = [bags_to_merge = bags_to_merge_,
+                   slices_to_merge =
+                       slices_to_merge_]() -> absl::StatusOr<DataBagPtr> {
+    DataBagPtr merged_db = DataBag::Empty();
+    RETURN_IF_ERROR(AdoptIntoImpl(bags_to_merge, slices_to_merge, *merged_db,
+                                  /*allow_conflicts=*/true));
+    return merged_db;
+  };
+  auto res =
+      DataBag::ImmutableEmptyWithDeferredMerge(bags, std::move(merge_fn));
+  int64_t fallback_depth =
+      FlattenFallbackFinder(*res).GetFlattenFallbacks().size();
+  if (fallback_depth > lazy_options.max_fallback_depth) {
+    return nullptr;
+  }
+  return res;
+}
+
+absl::Nonnull<DataBagPtr> AdoptionQueue::GetBagWithFallbacks() const {
+  return DataBag::ImmutableEmptyWithFallbacks(GetUniqueBags());
 }
 
 absl::Status AdoptStub(const DataBagPtr& db, const DataSlice& x) {
@@ -26,6 +26,16 @@
 
 namespace koladata {
 
+// Configuration of lazy adoption, see AdoptionQueue::GetCommonOrMergedDb.
+struct LazyAdoptionOptions {
+  // If true, DataBags are not merged eagerly when combined, but are used as
+  // fallbacks of a DataBag with deferred merge.
+  bool enabled = false;
+  // The maximal number of (flattened) fallbacks of a lazily combined DataBag.
+  // If it would be exceeded, the DataBags are merged eagerly instead.
+  int max_fallback_depth = 16;
+};
+
 // Used to track information about source data bags when we perform an operation
 // on a data bag using data from other data bags.
 class AdoptionQueue {
@@ -63,7 +73,17 @@ class AdoptionQueue {
   // 2. If all tracked triples are from the same DataBag, returns that DataBag.
   // 3. Else, returns a new immutable DataBag containing all tracked triples, or
   //    an error if this causes a merge conflict.
-  absl::StatusOr<absl::Nullable<DataBagPtr>> GetCommonOrMergedDb() const;
+  //
+  // If lazy adoption is enabled in `lazy_options` and all the tracked DataBags
+  // are immutable, in case 3 a DataBag with deferred merge (see
+  // DataBag::ImmutableEmptyWithDeferredMerge) with the tracked DataBags as
+  // fallbacks is returned instead. The merge happens once, on the first
+  // compaction of that DataBag. Conflicts are not reported then, but resolved
+  // in the fallback order both by lookups and by the merge, so the data does
+  // not change on compaction: the DataBags added directly come first, then the
+  // DataBags of the added slices, each in the order they were added.
+  absl::StatusOr<absl::Nullable<DataBagPtr>> GetCommonOrMergedDb(
+      const LazyAdoptionOptions& lazy_options = {}) const;
 
   // Returns a new empty immutable DataBag with all tracked DataBags and tracked
   // slices' DataBags as fallbacks. The fallback order is unspecified but
@@ -73,6 +93,14 @@ class AdoptionQueue {
   absl::Nonnull<DataBagPtr> GetBagWithFallbacks() const;
 
  private:
+  // Returns all tracked DataBags without duplicates.
+  std::vector<DataBagPtr> GetUniqueBags() const;
+
+  // Returns a DataBag with deferred merge of the tracked DataBags, or nullptr
+  // if lazy adoption is disabled in `lazy_options` or not applicable.
+  absl::Nullable<DataBagPtr> GetLazilyMergedDb(
+      const LazyAdoptionOptions& lazy_options) const;
+
   std::vector<DataSlice> slices_to_merge_;
   std::vector<DataBagPtr> bags_to_merge_;
 };
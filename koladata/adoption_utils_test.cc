@@ -27,11 +27,14 @@
 #include "koladata/internal/testing/matchers.h"
 #include "koladata/object_factories.h"
 #include "koladata/test_utils.h"
+#include "koladata/testing/matchers.h"
 
 namespace koladata {
 namespace {
 
 using ::absl_testing::IsOkAndHolds;
+using ::koladata::testing::IsEquivalentTo;
+using ::testing::ElementsAre;
 using ::testing::UnorderedElementsAre;
 
 TEST(AdoptionQueueTest, Empty) {
@@ -129,6 +132,104 @@ TEST(AdoptionQueueTest, GetCommonOrMergedDb) {
               IsOkAndHolds(internal::DataItem(2)));
 }
 
+TEST(AdoptionQueueTest, LazyAdoption) {
+  auto schema_db = DataBag::Empty();
+  ASSERT_OK_AND_ASSIGN(DataSlice schema,
+                       CreateEntitySchema(schema_db, {"a", "b"},
+                                          {test::Schema(schema::kInt32),
+                                           test::Schema(schema::kInt32)}));
+
+  internal::DataItem obj(internal::AllocateSingleObject());
+  auto db1 = DataBag::Empty();
+  auto db2 = DataBag::Empty();
+  ASSERT_OK(
+      db1->GetMutableImpl()->get().SetAttr(obj, "a", internal::DataItem(1)));
+  ASSERT_OK(
+      db2->GetMutableImpl()->get().SetAttr(obj, "b", internal::DataItem(2)));
+  // Not reachable from the slices, as it is not in the schema.
+  ASSERT_OK(
+      db2->GetMutableImpl()->get().SetAttr(obj, "c", internal::DataItem(3)));
+  ASSERT_OK_AND_ASSIGN(
+      DataSlice slice1,
+      DataSlice::Create(obj, internal::DataItem(schema::kAny), db1));
+  ASSERT_OK_AND_ASSIGN(slice1, slice1.SetSchema(schema));
+  ASSERT_OK_AND_ASSIGN(
+      DataSlice slice2,
+      DataSlice::Create(obj, internal::DataItem(schema::kAny), db2));
+  ASSERT_OK_AND_ASSIGN(slice2, slice2.SetSchema(schema));
+
+  LazyAdoptionOptions lazy_options = {.enabled = true,
+                                      .max_fallback_depth = 2};
+  {
+    // Mutable DataBags are merged eagerly.
+    AdoptionQueue q;
+    q.Add(slice1);
+    q.Add(slice2);
+    ASSERT_OK_AND_ASSIGN(DataBagPtr db3, q.GetCommonOrMergedDb(lazy_options));
+    EXPECT_FALSE(db3->HasDeferredMerge());
+    EXPECT_TRUE(db3->GetFallbacks().empty());
+  }
+  db1->UnsafeMakeImmutable();
+  db2->UnsafeMakeImmutable();
+  {
+    AdoptionQueue q;
+    q.Add(slice1);
+    q.Add(slice2);
+    ASSERT_OK_AND_ASSIGN(DataBagPtr db3, q.GetCommonOrMergedDb(lazy_options));
+    EXPECT_TRUE(db3->HasDeferredMerge());
+    EXPECT_FALSE(db3->IsMutable());
+    EXPECT_THAT(db3->GetFallbacks(), ElementsAre(db1, db2));
+    ASSERT_OK_AND_ASSIGN(DataBagPtr merged_db, db3->Fork(/*immutable=*/true));
+    EXPECT_FALSE(merged_db->IsMutable());
+    EXPECT_TRUE(merged_db->GetFallbacks().empty());
+    EXPECT_THAT(merged_db->GetImpl().GetAttr(obj, "a"),
+                IsOkAndHolds(internal::DataItem(1)));
+    EXPECT_THAT(merged_db->GetImpl().GetAttr(obj, "b"),
+                IsOkAndHolds(internal::DataItem(2)));
+    // Only the reachable triples are merged.
+    EXPECT_THAT(merged_db->GetImpl().GetAttr(obj, "c"),
+                IsOkAndHolds(std::nullopt));
+    // The merge is done once.
+    ASSERT_OK_AND_ASSIGN(DataBagPtr merge_result,
+                         db3->GetDeferredMergeResult());
+    EXPECT_FALSE(merge_result->IsMutable());
+    EXPECT_THAT(db3->GetDeferredMergeResult(), IsOkAndHolds(merge_result));
+  }
+  {
+    // Conflicts are resolved in the fallback order, before and after the
+    // merge, while the eager merge reports them.
+    auto db4 = DataBag::Empty();
+    ASSERT_OK(
+        db4->GetMutableImpl()->get().SetAttr(obj, "a", internal::DataItem(3)));
+    db4->UnsafeMakeImmutable();
+    AdoptionQueue q;
+    q.Add(slice1);
+    q.Add(db4);
+    EXPECT_FALSE(q.GetCommonOrMergedDb().ok());
+    ASSERT_OK_AND_ASSIGN(DataBagPtr db3, q.GetCommonOrMergedDb(lazy_options));
+    EXPECT_TRUE(db3->HasDeferredMerge());
+    EXPECT_THAT(db3->GetFallbacks(), ElementsAre(db4, db1));
+    EXPECT_THAT(slice1.WithBag(db3).GetAttr("a"),
+                IsOkAndHolds(IsEquivalentTo(test::DataItem(3, db3))));
+    ASSERT_OK_AND_ASSIGN(DataBagPtr merged_db, db3->MergeFallbacks());
+    EXPECT_THAT(slice1.WithBag(merged_db).GetAttr("a"),
+                IsOkAndHolds(IsEquivalentTo(test::DataItem(3, merged_db))));
+    EXPECT_THAT(slice1.WithBag(db3).GetAttr("a"),
+                IsOkAndHolds(IsEquivalentTo(test::DataItem(3, db3))));
+  }
+  {
+    // Too many fallbacks.
+    auto db5 = DataBag::Empty();
+    db5->UnsafeMakeImmutable();
+    AdoptionQueue q;
+    q.Add(slice1);
+    q.Add(slice2);
+    q.Add(DataBag::ImmutableEmptyWithFallbacks({db5}));
+    ASSERT_OK_AND_ASSIGN(DataBagPtr db3, q.GetCommonOrMergedDb(lazy_options));
+    EXPECT_FALSE(db3->HasDeferredMerge());
+  }
+}
+
 TEST(AdoptionQueueTest, WithFallbacks) {
   auto schema_db = DataBag::Empty();
   ASSERT_OK_AND_ASSIGN(DataSlice schema,
@@ -23,7 +23,9 @@
 #include "benchmark/benchmark.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "koladata/adoption_utils.h"
 #include "koladata/casting.h"
 #include "koladata/data_bag.h"
 #include "koladata/data_bag_repr.h"
@@ -365,7 +367,9 @@ void BM_ExplodeLists(benchmark::State& state) {
 BENCHMARK(BM_ExplodeLists)
     ->ArgPair(5, 5)
     ->ArgPair(100, 100)
-    ->ArgPair(10, 10000);
+    ->ArgPair(10, 10000)
+    ->ArgPair(1000, 1000)
+    ->ArgPair(1000000, 5);
 
 void BM_GetFromList(benchmark::State& state) {
   bool should_broadcast_index = state.range(0);
@@ -405,7 +409,125 @@ BENCHMARK(BM_GetFromList)
     ->Args({0, 10, 10000})
     ->Args({1, 1, 1})
     ->Args({1, 100, 100})
-    ->Args({1, 10, 10000});
+    ->Args({1, 10, 10000})
+    ->Args({1, 1000000, 5});
+
+// Returns an immutable DataBag with `num_fallbacks` fallbacks: the data is
+// defined in the last (lowest priority) of them, while the others contain
+// unrelated attributes and lists.
+DataBagPtr CreateDeepFallbackStack(const DataBagPtr& data_db,
+                                   int64_t num_fallbacks, int64_t size) {
+  std::vector<DataBagPtr> fallbacks;
+  fallbacks.reserve(num_fallbacks);
+  for (int64_t i = 0; i + 1 < num_fallbacks; ++i) {
+    auto db = DataBag::Empty();
+    auto o = *EntityCreator::Shaped(
+        db, DataSlice::JaggedShape::FlatFromSize(size),
+        {absl::StrCat("other_", i)},
+        {*DataSlice::Create(internal::DataItem(int{0}),
+                            internal::DataItem(schema::kInt32))});
+    auto lists = *CreateListsFromLastDimension(
+        db, *o.Reshape(*DataSlice::JaggedShape::FlatFromSize(1).AddDims(
+                {GetEdge(1, size)})),
+        test::Schema(schema::kAny));
+    benchmark::DoNotOptimize(lists);
+    db->UnsafeMakeImmutable();
+    fallbacks.push_back(std::move(db));
+  }
+  data_db->UnsafeMakeImmutable();
+  fallbacks.push_back(data_db);
+  return DataBag::ImmutableEmptyWithFallbacks(fallbacks);
+}
+
+void BM_GetAttrDeepFallbacks(benchmark::State& state) {
+  int64_t num_fallbacks = state.range(0);
+  int64_t size = state.range(1);
+  auto data_db = DataBag::Empty();
+  auto o = *EntityCreator::Shaped(
+      data_db, DataSlice::JaggedShape::FlatFromSize(size), {"x"},
+      {*DataSlice::Create(internal::DataItem(int{1}),
+                          internal::DataItem(schema::kInt32))});
+  o = o.WithBag(CreateDeepFallbackStack(data_db, num_fallbacks, size));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(o);
+    auto res = o.GetAttr("x");
+    benchmark::DoNotOptimize(res);
+  }
+}
+
+BENCHMARK(BM_GetAttrDeepFallbacks)
+    // num_fallbacks, size
+    ->ArgPair(1, 1)
+    ->ArgPair(5, 1)
+    ->ArgPair(20, 1)
+    ->ArgPair(1, 10000)
+    ->ArgPair(5, 10000)
+    ->ArgPair(20, 10000);
+
+void BM_ExplodeListsDeepFallbacks(benchmark::State& state) {
+  int64_t num_fallbacks = state.range(0);
+  int64_t size = state.range(1);
+  auto data_db = DataBag::Empty();
+  auto o = *EntityCreator::Shaped(
+      data_db,
+      *DataSlice::JaggedShape::FlatFromSize(1).AddDims({GetEdge(1, size)}),
+      {}, {});
+  auto list = *CreateListsFromLastDimension(data_db, o,
+                                            test::Schema(schema::kAny));
+  list = list.WithBag(CreateDeepFallbackStack(data_db, num_fallbacks, size));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(list);
+    auto items_or = list.ExplodeList(0, std::nullopt);
+    benchmark::DoNotOptimize(items_or);
+  }
+}
+
+BENCHMARK(BM_ExplodeListsDeepFallbacks)
+    // num_fallbacks, size
+    ->ArgPair(1, 10)
+    ->ArgPair(5, 10)
+    ->ArgPair(20, 10)
+    ->ArgPair(1, 10000)
+    ->ArgPair(5, 10000)
+    ->ArgPair(20, 10000);
+
+// Combines entities from two immutable DataBags (as done e.g. by kd.stack) and
+// reads an attribute of the result, with eager or lazy adoption.
+void BM_CombineBags(benchmark::State& state) {
+  bool lazy = state.range(0);
+  int64_t size = state.range(1);
+  auto create_entities = [&](absl::string_view attr_name) {
+    auto db = DataBag::Empty();
+    auto ds = *EntityCreator::Shaped(
+        db, DataSlice::JaggedShape::FlatFromSize(size), {attr_name},
+        {*DataSlice::Create(internal::DataItem(int{1}),
+                            internal::DataItem(schema::kInt32))});
+    db->UnsafeMakeImmutable();
+    return ds;
+  };
+  auto x = create_entities("a");
+  auto y = create_entities("b");
+  LazyAdoptionOptions lazy_options = {.enabled = lazy};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(x);
+    benchmark::DoNotOptimize(y);
+    AdoptionQueue adoption_queue;
+    adoption_queue.Add(x);
+    adoption_queue.Add(y);
+    auto db = *adoption_queue.GetCommonOrMergedDb(lazy_options);
+    auto res = x.WithBag(db).GetAttr("a");
+    benchmark::DoNotOptimize(res);
+  }
+}
+
+BENCHMARK(BM_CombineBags)
+    // lazy, size
+    ->ArgPair(0, 10)
+    ->ArgPair(1, 10)
+    ->ArgPair(0, 10000)
+    ->ArgPair(1, 10000)
+    ->ArgPair(0, 1000000)
+    ->ArgPair(1, 1000000);
 
 void BM_SetMultipleAttrs(benchmark::State& state) {
   int64_t size = state.range(0);
@@ -588,6 +710,60 @@ void BM_CreateEntityWithSchemaAndCasting(benchmark::State& state) {
 
 BENCHMARK(BM_CreateEntityWithSchemaAndCasting)->Arg(1)->Arg(10)->Arg(10000);
 
+// Ingestion of a record batch with an INT64 column, a FLOAT32 column with
+// missing values and a column of lists of 4 INT32 items. If `cast`, the INT64
+// column is provided as INT32 and has to be casted.
+void BM_CreateEntityFromColumns(benchmark::State& state) {
+  int64_t rows = state.range(0);
+  bool cast = state.range(1);
+  auto db = DataBag::Empty();
+  auto a = cast ? DataSliceImpl::Create(
+                      arolla::CreateFullDenseArray(std::vector<int>(rows, 12)))
+                : DataSliceImpl::Create(arolla::CreateFullDenseArray(
+                      std::vector<int64_t>(rows, 1l << 43)));
+  arolla::DenseArrayBuilder<float> b_bldr(rows);
+  for (int64_t i = 0; i < rows; i += 2) {
+    b_bldr.Set(i, 3.14);
+  }
+  auto b = DataSliceImpl::Create(std::move(b_bldr).Build());
+  auto c = DataSliceImpl::Create(
+      arolla::CreateFullDenseArray(std::vector<int>(rows * 4, 57)));
+  std::vector<int64_t> c_offsets(rows + 1);
+  for (int64_t i = 0; i <= rows; ++i) {
+    c_offsets[i] = i * 4;
+  }
+
+  auto schema_db = DataBag::Empty();
+  auto list_schema = *CreateListSchema(schema_db, test::Schema(schema::kInt32));
+  auto schema = *CreateEntitySchema(
+      schema_db, {"a", "b", "c"},
+      {test::Schema(schema::kInt64), test::Schema(schema::kFloat32),
+       list_schema});
+
+  std::vector<EntityColumn> columns{
+      {.attr_name = "a", .values = a},
+      {.attr_name = "b", .values = b},
+      {.attr_name = "c",
+       .values = c,
+       .list_offsets = arolla::CreateFullDenseArray(std::move(c_offsets))}};
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(db);
+    benchmark::DoNotOptimize(columns);
+    auto entity_or = EntityCreator::FromColumns(db, schema, rows, columns);
+    CHECK_OK(entity_or);
+    benchmark::DoNotOptimize(entity_or);
+  }
+  state.SetItemsProcessed(state.iterations() * rows);
+}
+
+BENCHMARK(BM_CreateEntityFromColumns)
+    ->ArgPair(10, false)
+    ->ArgPair(10000, false)
+    ->ArgPair(1000000, false)
+    ->ArgPair(10000, true)
+    ->ArgPair(1000000, true);
+
 
 void BM_ToInt32_Int32Data_AnySchema(benchmark::State& state) {
   int64_t size = state.range(0);
@@ -14,20 +14,27 @@
 //
 #include "koladata/data_bag.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 
+#include "absl/base/call_once.h"
 #include "absl/base/no_destructor.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "koladata/data_bag_repr.h"
 #include "koladata/internal/data_bag.h"
+#include "koladata/internal/object_id.h"
+#include "koladata/internal/stable_fingerprint.h"
 #include "arolla/qtype/qtype.h"
 #include "arolla/qtype/simple_qtype.h"
 #include "arolla/qtype/typed_value.h"
@@ -54,7 +61,33 @@ DataBagPtr DataBag::ImmutableEmptyWithFallbacks(
   return res;
 }
 
+DataBagPtr DataBag::ImmutableEmptyWithDeferredMerge(
+    absl::Span<const DataBagPtr> fallbacks, DeferredMergeFn merge_fn) {
+  auto res = ImmutableEmptyWithFallbacks(fallbacks);
+  res->deferred_merge_ = std::make_unique<DeferredMerge>();
+  res->deferred_merge_->merge_fn = std::move(merge_fn);
+  return res;
+}
+
+absl::StatusOr<DataBagPtr> DataBag::GetDeferredMergeResult() const {
+  DCHECK(HasDeferredMerge());
+  DeferredMerge& deferred_merge = *deferred_merge_;
+  absl::call_once(deferred_merge.once, [&deferred_merge] {
+    deferred_merge.result = deferred_merge.merge_fn();
+    if (deferred_merge.result.ok()) {
+      (*deferred_merge.result)->UnsafeMakeImmutable();
+    }
+    // Release the inputs of the merge.
+    deferred_merge.merge_fn = nullptr;
+  });
+  return deferred_merge.result;
+}
+
 absl::StatusOr<DataBagPtr> DataBag::Fork(bool immutable) {
+  if (HasDeferredMerge()) {
+    ASSIGN_OR_RETURN(auto merged_db, GetDeferredMergeResult());
+    return merged_db->Fork(immutable);
+  }
   // TODO: Re-think forking in the context of DataBag with
   // mutable fallbacks.
   if (!fallbacks_.empty()) {
@@ -69,7 +102,7 @@ absl::StatusOr<DataBagPtr> DataBag::Fork(bool immutable) {
   } else {
     new_db = DataBagPtr::Make();
   }
-  new_db->impl_ = impl_->PartiallyPersistentFork();
+  new_db->impl_ = GetImpl().PartiallyPersistentFork();
   new_db->impl_->AssignToDataBag();
 
   // If the original DataBag is mutable, we need to assign a new implementation
@@ -127,6 +160,10 @@ constexpr absl::string_view kNullDataBagQValueSpecializationKey =
 
 absl::StatusOr<internal::DataBagImplPtr> MergeFallbacksToForkedImpl(
     const DataBag& db) {
+  if (db.HasDeferredMerge()) {
+    ASSIGN_OR_RETURN(auto merged_db, db.GetDeferredMergeResult());
+    return merged_db->GetImpl().PartiallyPersistentFork();
+  }
   auto forked_impl = db.GetImpl().PartiallyPersistentFork();
   FlattenFallbackFinder fallback_finder(db);
   auto keep_original = internal::MergeOptions{
@@ -143,7 +180,7 @@ absl::StatusOr<internal::DataBagImplPtr> MergeFallbacksToForkedImpl(
 absl::StatusOr<DataBagPtr> DataBag::MergeFallbacks() {
   ASSIGN_OR_RETURN(auto impl_fork, MergeFallbacksToForkedImpl(*this));
   // Make sure that modifications to the new DataBag don't affect the original.
-  this->impl_ = this->impl_->PartiallyPersistentFork();
+  this->impl_ = GetImpl().PartiallyPersistentFork();
   return FromImpl(std::move(impl_fork));
 }
 
@@ -167,37 +204,196 @@ absl::Status DataBag::MergeInplace(const DataBagPtr& other_db, bool overwrite,
   return db_impl.MergeInplace(*other_db_impl, merge_options);
 }
 
-void FlattenFallbackFinder::CollectFlattenFallbacks(
-    const DataBag& bag, const std::vector<DataBagPtr>& fallbacks) {
-  absl::flat_hash_set<const DataBag*> seen_db;
-  seen_db.reserve(fallbacks.size() + 1);
-  seen_db.insert(&bag);
+absl::StatusOr<arolla::Fingerprint> DataBag::ContentFingerprint() const {
+  ASSIGN_OR_RETURN(auto impl_fingerprint, GetImpl().ContentFingerprint());
+  if (fallbacks_.empty()) {
+    return impl_fingerprint;
+  }
+  internal::StableFingerprintHasher hasher("data_bag_with_fallbacks");
+  hasher.Combine(impl_fingerprint);
+  FlattenFallbackFinder fallback_finder(*this);
+  for (const auto* fallback : fallback_finder.GetFlattenFallbacks()) {
+    ASSIGN_OR_RETURN(auto fallback_fingerprint, fallback->ContentFingerprint());
+    hasher.Combine(fallback_fingerprint);
+  }
+  return std::move(hasher).Finish();
+}
 
-  auto add_fallback = [&](const DataBag* fallback) {
-    if (seen_db.insert(fallback).second) {
-      flattened_fallbacks_.push_back(&fallback->GetImpl());
-      return true;
+bool DataBag::IsContentFingerprintTracked() const {
+  if (!GetImpl().IsContentFingerprintTracked()) {
+    return false;
+  }
+  FlattenFallbackFinder fallback_finder(*this);
+  for (const auto* fallback : fallback_finder.GetFlattenFallbacks()) {
+    if (!fallback->IsContentFingerprintTracked()) {
+      return false;
     }
+  }
+  return true;
+}
+
+absl::Span<const DataBag* const> DataBag::GetFlattenFallbackBags() const {
+  absl::call_once(flatten_fallbacks_once_, [this] {
+    if (fallbacks_.empty()) {
+      return;
+    }
+    absl::flat_hash_set<const DataBag*> seen_db;
+    seen_db.reserve(fallbacks_.size() + 1);
+    seen_db.insert(this);
+
+    // Collect fallbacks in pre order using Depth First Search.
+    std::vector<const DataBag*> stack;
+    stack.reserve(fallbacks_.size());
+    for (auto it = fallbacks_.rbegin(); it != fallbacks_.rend(); ++it) {
+      stack.push_back(it->get());
+    }
+    while (!stack.empty()) {
+      const DataBag* fallback = stack.back();
+      DCHECK(fallback != nullptr);
+      stack.pop_back();
+      if (seen_db.insert(fallback).second) {
+        flatten_fallbacks_.push_back(fallback);
+        const auto& cur_fallbacks = fallback->GetFallbacks();
+        for (auto it = cur_fallbacks.rbegin(); it != cur_fallbacks.rend();
+             ++it) {
+          stack.push_back(it->get());
+        }
+      }
+    }
+  });
+  return flatten_fallbacks_;
+}
+
+const DataBag::ContentSummary* DataBag::GetContentSummary() const {
+  if (is_mutable_) {
+    return nullptr;
+  }
+  absl::call_once(content_summary_once_, [this] {
+    internal::DataBagIndex index = GetImpl().CreateIndex();
+    auto summary = std::make_unique<ContentSummary>();
+    summary->attrs.reserve(index.attrs.size());
+    for (const auto& [attr_name, _] : index.attrs) {
+      summary->attrs.insert(attr_name);
+    }
+    for (internal::AllocationId alloc_id : index.lists) {
+      summary->has_small_alloc_lists |= alloc_id.IsSmall();
+      summary->lists.insert(alloc_id);
+    }
+    for (internal::AllocationId alloc_id : index.dicts) {
+      summary->has_small_alloc_dicts |= alloc_id.IsSmall();
+      summary->dicts.insert(alloc_id);
+    }
+    content_summary_ = std::move(summary);
+  });
+  return content_summary_.get();
+}
+
+DataBag::DeepUuidMemo* DataBag::GetDeepUuidMemo() const {
+  if (is_mutable_ || has_mutable_fallbacks_) {
+    return nullptr;
+  }
+  absl::call_once(deep_uuid_memo_once_, [this] {
+    deep_uuid_memo_ = std::make_unique<DeepUuidMemo>();
+  });
+  return deep_uuid_memo_.get();
+}
+
+namespace {
+
+// Returns true if `allocs` may contain objects from `alloc_ids`.
+bool MayContainAllocations(
+    const absl::flat_hash_set<internal::AllocationId>& allocs,
+    bool has_small_allocs, const internal::AllocationIdSet& alloc_ids) {
+  if (allocs.empty()) {
     return false;
-  };
+  }
+  if (alloc_ids.contains_small_allocation_id() && has_small_allocs) {
+    return true;
+  }
+  for (internal::AllocationId alloc_id : alloc_ids) {
+    if (allocs.contains(alloc_id)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
 
-  std::vector<const DataBag*> stack;
-  stack.reserve(fallbacks.size());
-  for (auto it = fallbacks.rbegin(); it != fallbacks.rend(); ++it) {
-    stack.push_back(it->get());
+template <typename Fn>
+internal::DataBagImpl::FallbackSpan FlattenFallbackFinder::FilterFallbacks(
+    Fn may_contain) {
+  filtered_fallbacks_.clear();
+  for (size_t i = 0; i < fallback_bags_.size(); ++i) {
+    const DataBag::ContentSummary* summary =
+        fallback_bags_[i]->GetContentSummary();
+    if (summary == nullptr || may_contain(*summary)) {
+      filtered_fallbacks_.push_back(flattened_fallbacks_[i]);
+    }
   }
+  return filtered_fallbacks_;
+}
 
-  while (!stack.empty()) {
-    const DataBag* fallback = stack.back();
-    DCHECK(fallback != nullptr);
-    stack.pop_back();
-    if (add_fallback(fallback)) {
-      const auto cur_fallbacks = fallback->GetFallbacks();
-      for (auto it = cur_fallbacks.rbegin(); it != cur_fallbacks.rend(); ++it) {
-        stack.push_back(it->get());
-      }
+internal::DataBagImpl::FallbackSpan
+FlattenFallbackFinder::GetFlattenFallbacksWithAttr(absl::string_view attr) {
+  return FilterFallbacks([&](const DataBag::ContentSummary& summary) {
+    return summary.attrs.contains(attr);
+  });
+}
+
+internal::DataBagImpl::FallbackSpan
+FlattenFallbackFinder::GetFlattenFallbacksWithLists(
+    const internal::AllocationIdSet& alloc_ids) {
+  return FilterFallbacks([&](const DataBag::ContentSummary& summary) {
+    return MayContainAllocations(summary.lists, summary.has_small_alloc_lists,
+                                 alloc_ids);
+  });
+}
+
+internal::DataBagImpl::FallbackSpan
+FlattenFallbackFinder::GetFlattenFallbacksWithDicts(
+    const internal::AllocationIdSet& alloc_ids) {
+  return FilterFallbacks([&](const DataBag::ContentSummary& summary) {
+    return MayContainAllocations(summary.dicts, summary.has_small_alloc_dicts,
+                                 alloc_ids);
+  });
+}
+
+ShardedDataBagWriter::ShardedDataBagWriter(DataBagPtr db,
+                                           int64_t shard_count)
+    : db_(std::move(db)) {
+  shards_.reserve(shard_count);
+  for (int64_t i = 0; i < shard_count; ++i) {
+    shards_.push_back(DataBag::Empty());
+  }
+}
+
+absl::Status ShardedDataBagWriter::Commit() && {
+  std::vector<internal::DataBagImpl*> shard_impls;
+  shard_impls.reserve(shards_.size());
+  for (const DataBagPtr& shard : shards_) {
+    if (shard->impl_ == nullptr) {
+      return absl::FailedPreconditionError(
+          "ShardedDataBagWriter is already committed");
     }
+    ASSIGN_OR_RETURN(internal::DataBagImpl & shard_impl,
+                     shard->GetMutableImpl());
+    shard_impls.push_back(&shard_impl);
   }
+  ASSIGN_OR_RETURN(internal::DataBagImpl & db_impl, db_->GetMutableImpl());
+  RETURN_IF_ERROR(db_impl.SpliceInplace(shard_impls));
+  // The content of the shards is moved away, so they are detached from it to
+  // make any further use fail instead of observing partial data.
+  for (const DataBagPtr& shard : shards_) {
+    shard->UnsafeMakeImmutable();
+    shard->impl_ = nullptr;
+  }
+  return absl::OkStatus();
+}
+
+void DataBag::DieUsedAfterCommit() {
+  LOG(FATAL) << "DataBag was committed by ShardedDataBagWriter and must not "
+                "be used anymore";
 }
 
 std::string GetBagIdRepr(const DataBagPtr& db) {
@@ -16,15 +16,25 @@
 #define KOLADATA_DATA_BAG_H_
 
 #include <atomic>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/base/call_once.h"
+#include "absl/base/optimization.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "koladata/internal/data_bag.h"
+#include "koladata/internal/object_id.h"
+#include "koladata/internal/op_utils/deep_uuid.h"
 #include "arolla/qtype/simple_qtype.h"
 #include "arolla/util/fingerprint.h"
 #include "arolla/util/refcount_ptr.h"
@@ -61,7 +71,12 @@ class DataBag : public arolla::RefcountedBase {
 
   bool IsMutable() const { return is_mutable_; }
 
-  const internal::DataBagImpl& GetImpl() const { return *impl_; }
+  const internal::DataBagImpl& GetImpl() const {
+    if (ABSL_PREDICT_FALSE(impl_ == nullptr)) {
+      DieUsedAfterCommit();
+    }
+    return *impl_;
+  }
   absl::StatusOr<std::reference_wrapper<internal::DataBagImpl>>
   GetMutableImpl() {
     if (!is_mutable_) {
@@ -101,6 +116,25 @@ class DataBag : public arolla::RefcountedBase {
   static DataBagPtr ImmutableEmptyWithFallbacks(
       absl::Span<const DataBagPtr> fallbacks);
 
+  // Computes the immutable DataBag a DataBag with deferred merge stands for.
+  using DeferredMergeFn = std::function<absl::StatusOr<DataBagPtr>()>;
+
+  // Returns a newly created immutable DataBag with fallbacks that stands for
+  // the result of `merge_fn`, with the merge itself deferred. The fallbacks
+  // must contain all the data of that result. Lookups behave as for
+  // ImmutableEmptyWithFallbacks, while MergeFallbacks (and so Fork, freezing
+  // and serialization) use the result of `merge_fn`, which is computed once on
+  // the first use.
+  static DataBagPtr ImmutableEmptyWithDeferredMerge(
+      absl::Span<const DataBagPtr> fallbacks, DeferredMergeFn merge_fn);
+
+  // Returns true if the DataBag was created by ImmutableEmptyWithDeferredMerge.
+  bool HasDeferredMerge() const { return deferred_merge_ != nullptr; }
+
+  // Returns the immutable result of the deferred merge, computing it on the
+  // first call. Must be called only if HasDeferredMerge().
+  absl::StatusOr<DataBagPtr> GetDeferredMergeResult() const;
+
   // Returns a DataBag that contains all the data its input contain.
   // * If they are all the same or only 1 DataBag is non-nullptr, that DataBag
   //   is returned.
@@ -109,7 +143,8 @@ class DataBag : public arolla::RefcountedBase {
   // * In case of no DataBags, nullptr is returned.
   static DataBagPtr CommonDataBag(absl::Span<const DataBagPtr> databags);
 
-  // Returns a new DataBag with all the fallbacks merged.
+  // Returns a new DataBag with all the fallbacks merged. For DataBags with
+  // deferred merge, returns a fork of the result of the merge, or its error.
   absl::StatusOr<DataBagPtr> MergeFallbacks();
 
   // Merge additional attributes and objects from `other_db`.
@@ -126,7 +161,56 @@ class DataBag : public arolla::RefcountedBase {
   // Fingerprint of the DataBag (randomized).
   arolla::Fingerprint fingerprint() const { return fingerprint_; }
 
+  // Returns a stable fingerprint of the DataBag content, combined with the
+  // content fingerprints of the fallbacks in priority order. Unlike
+  // fingerprint(), it is equal for DataBags with the same content and can be
+  // used for deduplication and caching of derived data. Only the parts
+  // modified since the previous call are rehashed, see
+  // DataBagImpl::ContentFingerprint.
+  absl::StatusOr<arolla::Fingerprint> ContentFingerprint() const;
+
+  // Returns true if content fingerprints of the DataBag and all its fallbacks
+  // are already tracked, so ContentFingerprint() doesn't rehash everything.
+  bool IsContentFingerprintTracked() const;
+
+  // Summary of the attributes, lists and dicts stored in the DataBag itself
+  // (excluding fallbacks). Used to skip DataBags that cannot contain the
+  // requested data during fallback lookups.
+  struct ContentSummary {
+    absl::flat_hash_set<std::string> attrs;
+    absl::flat_hash_set<internal::AllocationId> lists;
+    absl::flat_hash_set<internal::AllocationId> dicts;
+    // True if `lists` (resp. `dicts`) contain a small AllocationId.
+    bool has_small_alloc_lists = false;
+    bool has_small_alloc_dicts = false;
+  };
+
+  // Returns the content summary of an immutable DataBag. It is computed on the
+  // first call and cached. Returns nullptr for mutable DataBags, as their
+  // content can change at any time.
+  const ContentSummary* GetContentSummary() const;
+
+  // Deep uuids memoized by kd.deep_uuid for the data of this DataBag.
+  struct DeepUuidMemo {
+    absl::Mutex mutex;
+    internal::DeepUuidCache cache ABSL_GUARDED_BY(mutex){
+        /*max_size=*/int64_t{1} << 20, /*track_modifications=*/false};
+  };
+
+  // Returns the deep uuid memo of an immutable DataBag without mutable
+  // fallbacks. It is created on the first call and lives as long as the
+  // DataBag. Returns nullptr for other DataBags, as their content can change
+  // at any time.
+  DeepUuidMemo* GetDeepUuidMemo() const;
+
  private:
+  friend class FlattenFallbackFinder;
+  friend class ShardedDataBagWriter;
+
+  // Crashes the process. Called on access to a shard of a committed
+  // ShardedDataBagWriter.
+  [[noreturn]] static void DieUsedAfterCommit();
+
   explicit DataBag(bool is_mutable)
       : impl_(internal::DataBagImpl::CreateEmptyDatabag()),
         is_mutable_(is_mutable),
@@ -146,6 +230,28 @@ class DataBag : public arolla::RefcountedBase {
 
   // Used to implement lazy forking for immutable DataBags.
   std::atomic<bool> forked_ = false;
+
+  // Returns all the fallbacks (recursively) in the decreasing priority order
+  // without duplicates. The list is computed on the first call and cached,
+  // which is safe because fallbacks_ never change after construction.
+  absl::Span<const DataBag* const> GetFlattenFallbackBags() const;
+
+  mutable absl::once_flag flatten_fallbacks_once_;
+  mutable std::vector<const DataBag*> flatten_fallbacks_;
+
+  mutable absl::once_flag content_summary_once_;
+  mutable std::unique_ptr<const ContentSummary> content_summary_;
+
+  mutable absl::once_flag deep_uuid_memo_once_;
+  mutable std::unique_ptr<DeepUuidMemo> deep_uuid_memo_;
+
+  struct DeferredMerge {
+    // Reset once the result is computed.
+    DeferredMergeFn merge_fn;
+    absl::once_flag once;
+    absl::StatusOr<DataBagPtr> result;
+  };
+  std::unique_ptr<DeferredMerge> deferred_merge_;
 };
 
 class FlattenFallbackFinder {
@@ -153,13 +259,14 @@ class FlattenFallbackFinder {
   // Constructs empty fallback list.
   FlattenFallbackFinder() = default;
 
-  // Constructs fallback list from the provided databag.
-  explicit FlattenFallbackFinder(const DataBag& bag) {
-    const auto& fallbacks = bag.GetFallbacks();
-    if (fallbacks.empty()) {
-      return;
+  // Constructs fallback list from the provided databag. The flattened
+  // fallbacks are cached in `bag`, so `bag` must outlive the finder.
+  explicit FlattenFallbackFinder(const DataBag& bag)
+      : fallback_bags_(bag.GetFlattenFallbackBags()) {
+    flattened_fallbacks_.reserve(fallback_bags_.size());
+    for (const DataBag* fallback : fallback_bags_) {
+      flattened_fallbacks_.push_back(&fallback->GetImpl());
     }
-    CollectFlattenFallbacks(bag, fallbacks);
   }
 
   // Returns DatBagImpl fallbacks in the decreasing priority order.
@@ -169,12 +276,60 @@ class FlattenFallbackFinder {
     return flattened_fallbacks_;
   }
 
+  // Same as GetFlattenFallbacks, but skips immutable fallbacks that have no
+  // attribute `attr`. Should only be used to look up attributes of objects,
+  // not of schemas. The returned span is valid until the next call of a
+  // GetFlattenFallbacksWith* method.
+  internal::DataBagImpl::FallbackSpan GetFlattenFallbacksWithAttr(
+      absl::string_view attr);
+
+  // Same as GetFlattenFallbacks, but skips immutable fallbacks that have no
+  // lists (resp. dicts) from `alloc_ids`. The returned span is valid until the
+  // next call of a GetFlattenFallbacksWith* method.
+  internal::DataBagImpl::FallbackSpan GetFlattenFallbacksWithLists(
+      const internal::AllocationIdSet& alloc_ids);
+  internal::DataBagImpl::FallbackSpan GetFlattenFallbacksWithDicts(
+      const internal::AllocationIdSet& alloc_ids);
+
  private:
-  // Collect fallbacks in pre order using Depth First Search.
-  void CollectFlattenFallbacks(const DataBag& bag,
-                               const std::vector<DataBagPtr>& fallbacks);
+  template <typename Fn>
+  internal::DataBagImpl::FallbackSpan FilterFallbacks(Fn may_contain);
 
+  absl::Span<const DataBag* const> fallback_bags_;
   absl::InlinedVector<const internal::DataBagImpl*, 2> flattened_fallbacks_;
+  absl::InlinedVector<const internal::DataBagImpl*, 2> filtered_fallbacks_;
+};
+
+// Writes into one mutable DataBag from several threads. Each writer gets its
+// own shard, a separate mutable DataBag that can be modified concurrently with
+// the other shards, and Commit() moves the content of all the shards into the
+// DataBag. The attributes of allocations, lists and dicts that are not present
+// in the DataBag (e.g. of the objects created by the writers) are moved without
+// copying, and the rest is merged as in DataBag::MergeInplace, raising on
+// conflicts.
+//
+// The DataBag must not be modified until Commit() is called. Commit() either
+// moves the content of all the shards or, on conflicts, nothing. After a
+// successful Commit() the shards must not be used, any access to their content
+// crashes.
+class ShardedDataBagWriter {
+ public:
+  ShardedDataBagWriter(DataBagPtr db, int64_t shard_count);
+
+  int64_t shard_count() const { return shards_.size(); }
+
+  // Returns the DataBag to write to from the `i`-th writer.
+  const DataBagPtr& shard(int64_t i) const { return shards_[i]; }
+
+  // Moves the content of all the shards into the DataBag. On conflicts returns
+  // an error and modifies neither the DataBag nor the shards. After a
+  // successful commit the shards must not be used: accessing their content
+  // crashes.
+  absl::Status Commit() &&;
+
+ private:
+  DataBagPtr db_;
+  std::vector<DataBagPtr> shards_;
 };
 
 // Returns the string representation of the DataBag.
@@ -15,18 +15,34 @@
 #ifndef KOLADATA_DATA_BAG_COMPARISON_H_
 #define KOLADATA_DATA_BAG_COMPARISON_H_
 
+#include "absl/status/statusor.h"
 #include "koladata/data_bag.h"
 #include "koladata/internal/triples.h"
-
+#include "arolla/util/fingerprint.h"
+#include "arolla/util/status_macros_backport.h"
 
 namespace koladata {
 
 class DataBagComparison {
  public:
-  static bool ExactlyEqual(const DataBagPtr a, const DataBagPtr b) {
+  static absl::StatusOr<bool> ExactlyEqual(const DataBagPtr a,
+                                           const DataBagPtr b) {
     using Triples = internal::debug::Triples;
-    if (Triples(a->GetImpl().ExtractContent().value()) !=
-        Triples(b->GetImpl().ExtractContent().value())) {
+    // Content fingerprints are maintained incrementally, so comparing them is
+    // cheap if they are already tracked. The comparison doesn't start the
+    // tracking, as it would slow down all further modifications of the bags.
+    if (a->IsContentFingerprintTracked() && b->IsContentFingerprintTracked()) {
+      ASSIGN_OR_RETURN(arolla::Fingerprint a_fingerprint,
+                       a->ContentFingerprint());
+      ASSIGN_OR_RETURN(arolla::Fingerprint b_fingerprint,
+                       b->ContentFingerprint());
+      if (a_fingerprint != b_fingerprint) {
+        return false;
+      }
+    }
+    ASSIGN_OR_RETURN(auto a_content, a->GetImpl().ExtractContent());
+    ASSIGN_OR_RETURN(auto b_content, b->GetImpl().ExtractContent());
+    if (Triples(a_content) != Triples(b_content)) {
       return false;
     }
     FlattenFallbackFinder a_fb_finder(*a);
@@ -37,8 +53,11 @@ class DataBagComparison {
       return false;
     }
     for (int i = 0; i < a_fallbacks.size(); ++i) {
-      if (Triples(a_fallbacks[i]->ExtractContent().value()) !=
-          Triples(b_fallbacks[i]->ExtractContent().value())) {
+      ASSIGN_OR_RETURN(auto a_fallback_content,
+                       a_fallbacks[i]->ExtractContent());
+      ASSIGN_OR_RETURN(auto b_fallback_content,
+                       b_fallbacks[i]->ExtractContent());
+      if (Triples(a_fallback_content) != Triples(b_fallback_content)) {
         return false;
       }
     }
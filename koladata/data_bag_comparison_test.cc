@@ -16,6 +16,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/status_matchers.h"
 #include "koladata/data_bag.h"
 #include "koladata/internal/data_slice.h"
 #include "koladata/internal/data_bag.h"
@@ -23,6 +24,8 @@
 namespace koladata {
 namespace {
 
+using ::absl_testing::IsOkAndHolds;
+
 TEST(DataBagComparisonTest, ExactlyEqual_NoFallbacks) {
   auto ds1 = internal::DataSliceImpl::AllocateEmptyObjects(3);
   auto ds2 = internal::DataSliceImpl::AllocateEmptyObjects(3);
@@ -36,8 +39,8 @@ TEST(DataBagComparisonTest, ExactlyEqual_NoFallbacks) {
   ASSERT_OK_AND_ASSIGN(internal::DataBagImpl& db3_impl, db3->GetMutableImpl());
   ASSERT_OK(db3_impl.SetAttr(ds2, "self", ds2));
 
-  EXPECT_TRUE(DataBagComparison::ExactlyEqual(db1, db2));
-  EXPECT_FALSE(DataBagComparison::ExactlyEqual(db1, db3));
+  EXPECT_THAT(DataBagComparison::ExactlyEqual(db1, db2), IsOkAndHolds(true));
+  EXPECT_THAT(DataBagComparison::ExactlyEqual(db1, db3), IsOkAndHolds(false));
 }
 
 TEST(DataBagComparisonTest, ExactlyEqual_Fallbacks) {
@@ -59,14 +62,44 @@ TEST(DataBagComparisonTest, ExactlyEqual_Fallbacks) {
   auto db_ff122 = DataBag::ImmutableEmptyWithFallbacks({db_f12, db2});
   auto db_ff212 = DataBag::ImmutableEmptyWithFallbacks({db_f21, db2});
 
-  EXPECT_TRUE(DataBagComparison::ExactlyEqual(db_f12, db_f12_copy));
-  EXPECT_FALSE(DataBagComparison::ExactlyEqual(db_f12, db_f21));
-  EXPECT_FALSE(DataBagComparison::ExactlyEqual(db_f1, db_f12));
-  EXPECT_FALSE(DataBagComparison::ExactlyEqual(db_f1, db_f21));
-  EXPECT_TRUE(DataBagComparison::ExactlyEqual(db_ff12, db_ff122));
-  EXPECT_FALSE(DataBagComparison::ExactlyEqual(db_ff212, db_ff122));
+  EXPECT_THAT(DataBagComparison::ExactlyEqual(db_f12, db_f12_copy),
+              IsOkAndHolds(true));
+  EXPECT_THAT(DataBagComparison::ExactlyEqual(db_f12, db_f21),
+              IsOkAndHolds(false));
+  EXPECT_THAT(DataBagComparison::ExactlyEqual(db_f1, db_f12),
+              IsOkAndHolds(false));
+  EXPECT_THAT(DataBagComparison::ExactlyEqual(db_f1, db_f21),
+              IsOkAndHolds(false));
+  EXPECT_THAT(DataBagComparison::ExactlyEqual(db_ff12, db_ff122),
+              IsOkAndHolds(true));
+  EXPECT_THAT(DataBagComparison::ExactlyEqual(db_ff212, db_ff122),
+              IsOkAndHolds(false));
 }
 
+TEST(DataBagComparisonTest, ExactlyEqual_ContentFingerprint) {
+  auto ds1 = internal::DataSliceImpl::AllocateEmptyObjects(3);
+  auto ds2 = internal::DataSliceImpl::AllocateEmptyObjects(3);
+  auto db1 = DataBag::Empty();
+  ASSERT_OK_AND_ASSIGN(internal::DataBagImpl& db1_impl, db1->GetMutableImpl());
+  ASSERT_OK(db1_impl.SetAttr(ds1, "self", ds1));
+  auto db2 = DataBag::Empty();
+  ASSERT_OK_AND_ASSIGN(internal::DataBagImpl& db2_impl, db2->GetMutableImpl());
+  ASSERT_OK(db2_impl.SetAttr(ds1, "self", ds1));
+
+  // Comparison doesn't start tracking of the content fingerprints.
+  EXPECT_THAT(DataBagComparison::ExactlyEqual(db1, db2), IsOkAndHolds(true));
+  EXPECT_FALSE(db1->IsContentFingerprintTracked());
+  EXPECT_FALSE(db2->IsContentFingerprintTracked());
+
+  // Already tracked fingerprints are used.
+  ASSERT_OK(db1->ContentFingerprint());
+  ASSERT_OK(db2->ContentFingerprint());
+  EXPECT_TRUE(db1->IsContentFingerprintTracked());
+  EXPECT_TRUE(db2->IsContentFingerprintTracked());
+  EXPECT_THAT(DataBagComparison::ExactlyEqual(db1, db2), IsOkAndHolds(true));
+  ASSERT_OK(db2_impl.SetAttr(ds2, "self", ds2));
+  EXPECT_THAT(DataBagComparison::ExactlyEqual(db1, db2), IsOkAndHolds(false));
+}
 
 }  // namespace
 }  // namespace koladata
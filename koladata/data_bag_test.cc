@@ -16,14 +16,19 @@
 
 #include <optional>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
+#include "koladata/data_slice.h"
 #include "koladata/internal/data_bag.h"
+#include "koladata/internal/data_item.h"
+#include "koladata/internal/object_id.h"
 #include "koladata/object_factories.h"
 #include "koladata/test_utils.h"
 #include "koladata/testing/matchers.h"
@@ -152,6 +157,68 @@ TEST(DataBagTest, CollectFlattenFallbacks) {
   }
 }
 
+TEST(DataBagTest, FlattenFallbackFinderSkipsFallbacksWithoutData) {
+  auto obj = internal::AllocateSingleObject();
+  auto lists = internal::AllocateLists(10);
+  auto dicts = internal::AllocateDicts(10);
+  auto other_lists = internal::AllocateLists(10);
+
+  auto db_attr = DataBag::Empty();
+  ASSERT_OK(db_attr->GetMutableImpl()->get().SetAttr(
+      internal::DataItem(obj), "a", internal::DataItem(1)));
+  auto db_list = DataBag::Empty();
+  ASSERT_OK(db_list->GetMutableImpl()->get().AppendToList(
+      internal::DataItem(lists.ObjectByOffset(0)), internal::DataItem(1)));
+  auto db_dict = DataBag::Empty();
+  ASSERT_OK(db_dict->GetMutableImpl()->get().SetInDict(
+      internal::DataItem(dicts.ObjectByOffset(0)), internal::DataItem(1),
+      internal::DataItem(2)));
+  auto db_mutable = DataBag::Empty();
+
+  // Mutable DataBags have no summary, so they are never skipped.
+  EXPECT_EQ(db_attr->GetContentSummary(), nullptr);
+  db_attr->UnsafeMakeImmutable();
+  db_list->UnsafeMakeImmutable();
+  db_dict->UnsafeMakeImmutable();
+  ASSERT_NE(db_attr->GetContentSummary(), nullptr);
+  EXPECT_TRUE(db_attr->GetContentSummary()->attrs.contains("a"));
+  EXPECT_TRUE(db_list->GetContentSummary()->lists.contains(lists));
+  EXPECT_TRUE(db_dict->GetContentSummary()->dicts.contains(dicts));
+
+  auto db = DataBag::ImmutableEmptyWithFallbacks(
+      {db_attr, db_list, db_dict, db_mutable});
+  FlattenFallbackFinder fbf(*db);
+  EXPECT_THAT(fbf.GetFlattenFallbacks(),
+              ElementsAre(&db_attr->GetImpl(), &db_list->GetImpl(),
+                          &db_dict->GetImpl(), &db_mutable->GetImpl()));
+  EXPECT_THAT(fbf.GetFlattenFallbacksWithAttr("a"),
+              ElementsAre(&db_attr->GetImpl(), &db_mutable->GetImpl()));
+  EXPECT_THAT(fbf.GetFlattenFallbacksWithAttr("b"),
+              ElementsAre(&db_mutable->GetImpl()));
+  EXPECT_THAT(
+      fbf.GetFlattenFallbacksWithLists(internal::AllocationIdSet(lists)),
+      ElementsAre(&db_list->GetImpl(), &db_mutable->GetImpl()));
+  EXPECT_THAT(
+      fbf.GetFlattenFallbacksWithLists(internal::AllocationIdSet(other_lists)),
+      ElementsAre(&db_mutable->GetImpl()));
+  EXPECT_THAT(
+      fbf.GetFlattenFallbacksWithDicts(internal::AllocationIdSet(dicts)),
+      ElementsAre(&db_dict->GetImpl(), &db_mutable->GetImpl()));
+  // Small allocations are not tracked by AllocationIdSet, so any fallback
+  // with small allocation lists may contain them.
+  auto small_list = internal::AllocateSingleList();
+  auto db_small_list = DataBag::Empty();
+  ASSERT_OK(db_small_list->GetMutableImpl()->get().AppendToList(
+      internal::DataItem(small_list), internal::DataItem(1)));
+  db_small_list->UnsafeMakeImmutable();
+  auto db_2 = DataBag::ImmutableEmptyWithFallbacks({db_list, db_small_list});
+  FlattenFallbackFinder fbf_2(*db_2);
+  internal::AllocationIdSet small_alloc_ids(
+      (internal::AllocationId(small_list)));
+  EXPECT_THAT(fbf_2.GetFlattenFallbacksWithLists(small_alloc_ids),
+              ElementsAre(&db_small_list->GetImpl()));
+}
+
 // Regression test for separate span storage in FlattenFallbackFinder.
 TEST(DataBagTest, FlattenFallbackFinderCopiableAndMovable) {
   for (int size = 1; size < 10; ++size) {
@@ -396,6 +463,42 @@ TEST(DataBagTest, MergeFallbacks) {
               IsOkAndHolds(IsEquivalentTo(test::DataItem(43, db_merged))));
 }
 
+TEST(DataBagTest, ContentFingerprint) {
+  auto db1 = DataBag::Empty();
+  auto db2 = DataBag::Empty();
+  EXPECT_NE(db1->fingerprint(), db2->fingerprint());
+  ASSERT_OK_AND_ASSIGN(auto empty_fp, db1->ContentFingerprint());
+  EXPECT_THAT(db2->ContentFingerprint(), IsOkAndHolds(empty_fp));
+
+  ASSERT_OK(EntityCreator::FromAttrs(db1, {std::string("a")},
+                                     {test::DataItem(42, db1)})
+                .status());
+  ASSERT_OK_AND_ASSIGN(auto fp1, db1->ContentFingerprint());
+  EXPECT_NE(fp1, empty_fp);
+  ASSERT_OK(db2->MergeInplace(db1, /*overwrite=*/false,
+                              /*allow_data_conflicts=*/false,
+                              /*allow_schema_conflicts=*/false));
+  EXPECT_THAT(db2->ContentFingerprint(), IsOkAndHolds(fp1));
+
+  auto db3 = DataBag::Empty();
+  ASSERT_OK(EntityCreator::FromAttrs(db3, {std::string("b")},
+                                     {test::DataItem(1, db3)})
+                .status());
+  ASSERT_OK_AND_ASSIGN(auto fp3, db3->ContentFingerprint());
+  // Fallbacks are combined in priority order.
+  ASSERT_OK_AND_ASSIGN(
+      auto fp13,
+      DataBag::ImmutableEmptyWithFallbacks({db1, db3})->ContentFingerprint());
+  EXPECT_THAT(
+      DataBag::ImmutableEmptyWithFallbacks({db2, db3})->ContentFingerprint(),
+      IsOkAndHolds(fp13));
+  EXPECT_THAT(
+      DataBag::ImmutableEmptyWithFallbacks({db3, db1})->ContentFingerprint(),
+      IsOkAndHolds(::testing::Ne(fp13)));
+  EXPECT_NE(fp13, fp1);
+  EXPECT_NE(fp13, fp3);
+}
+
 TEST(DataBagTest, Fork_Mutability) {
   {
     auto db1 = DataBag::Empty();
@@ -419,6 +522,84 @@ TEST(DataBagTest, Fork_Mutability) {
   }
 }
 
+TEST(DataBagTest, ShardedDataBagWriter) {
+  constexpr int kShardCount = 4;
+  auto db = DataBag::Empty();
+  ASSERT_OK_AND_ASSIGN(
+      auto shared,
+      EntityCreator::FromAttrs(db, {std::string("a")},
+                               {test::DataItem(-1, db)}));
+
+  ShardedDataBagWriter writer(db, kShardCount);
+  ASSERT_EQ(writer.shard_count(), kShardCount);
+  std::vector<std::optional<DataSlice>> entities(kShardCount);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kShardCount; ++i) {
+    threads.emplace_back([&, i] {
+      const DataBagPtr& shard = writer.shard(i);
+      auto entity = EntityCreator::FromAttrs(shard, {std::string("a")},
+                                             {test::DataItem(i, shard)});
+      CHECK_OK(entity);
+      entities[i] = *std::move(entity);
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  // Attributes of existing objects are merged.
+  DataBagPtr shard = writer.shard(0);
+  ASSERT_OK(shared.WithBag(shard).SetAttr("b", test::DataItem(5),
+                                          /*update_schema=*/true));
+  ASSERT_OK(std::move(writer).Commit());
+  EXPECT_FALSE(shard->IsMutable());
+
+  for (int i = 0; i < kShardCount; ++i) {
+    EXPECT_THAT(entities[i]->WithBag(db).GetAttr("a"),
+                IsOkAndHolds(IsEquivalentTo(test::DataItem(i, db))));
+  }
+  EXPECT_THAT(shared.GetAttr("a"),
+              IsOkAndHolds(IsEquivalentTo(test::DataItem(-1, db))));
+  EXPECT_THAT(shared.GetAttr("b"),
+              IsOkAndHolds(IsEquivalentTo(test::DataItem(5, db))));
+}
+
+TEST(DataBagTest, ShardedDataBagWriterConflict) {
+  auto db = DataBag::Empty();
+  ASSERT_OK_AND_ASSIGN(
+      auto shared,
+      EntityCreator::FromAttrs(db, {std::string("a")},
+                               {test::DataItem(-1, db)}));
+
+  ShardedDataBagWriter writer(db, 2);
+  DataBagPtr shard = writer.shard(0);
+  ASSERT_OK_AND_ASSIGN(auto entity,
+                       EntityCreator::FromAttrs(shard, {std::string("a")},
+                                                {test::DataItem(1, shard)}));
+  ASSERT_OK(shared.WithBag(writer.shard(1))
+                .SetAttr("a", test::DataItem(2), /*update_schema=*/true));
+  EXPECT_THAT(std::move(writer).Commit(),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+
+  // Nothing is moved on conflicts.
+  EXPECT_TRUE(shard->IsMutable());
+  EXPECT_THAT(entity.GetAttr("a"),
+              IsOkAndHolds(IsEquivalentTo(test::DataItem(1, shard))));
+  EXPECT_THAT(shared.GetAttr("a"),
+              IsOkAndHolds(IsEquivalentTo(test::DataItem(-1, db))));
+}
+
+TEST(DataBagDeathTest, ShardedDataBagWriterShardUsedAfterCommit) {
+  auto db = DataBag::Empty();
+  ShardedDataBagWriter writer(db, 1);
+  DataBagPtr shard = writer.shard(0);
+  ASSERT_OK_AND_ASSIGN(auto entity,
+                       EntityCreator::FromAttrs(shard, {std::string("a")},
+                                                {test::DataItem(1, shard)}));
+  ASSERT_OK(std::move(writer).Commit());
+  EXPECT_DEATH(entity.GetAttr("a").IgnoreError(),
+               "committed by ShardedDataBagWriter");
+}
+
 TEST(DataBagTest, UnsafeMakeImmutable) {
   DataBag db1;
   EXPECT_TRUE(db1.IsMutable());
@@ -22,6 +22,7 @@
 #include <type_traits>
 #include <utility>
 #include <variant>
+#include <vector>
 
 #include "absl/base/nullability.h"
 #include "absl/functional/overload.h"
@@ -394,7 +395,21 @@ absl::StatusOr<ImplT> GetAttrImpl(const DataBagPtr& db, const ImplT& impl,
         res_schema, GetResultSchema(db_impl, impl, schema, attr_name, fallbacks,
                                     allow_missing_schema));
   }
-  return db_impl.GetAttr(impl, attr_name, fallbacks);
+  return db_impl.GetAttr(impl, attr_name,
+                        fb_finder.GetFlattenFallbacksWithAttr(attr_name));
+}
+
+// Returns the allocation ids of the objects in `impl`.
+const internal::AllocationIdSet& GetAllocationIds(
+    const internal::DataSliceImpl& impl) {
+  return impl.allocation_ids();
+}
+internal::AllocationIdSet GetAllocationIds(const internal::DataItem& item) {
+  if (item.holds_value<internal::ObjectId>()) {
+    return internal::AllocationIdSet(
+        internal::AllocationId(item.value<internal::ObjectId>()));
+  }
+  return internal::AllocationIdSet();
 }
 
 // Function for `this.GetAttr(attr_name) | (default_value & has(this))`.
@@ -1047,6 +1062,11 @@ absl::StatusOr<DataSlice> DataSlice::Freeze() const {
   if (db == nullptr) {
     return *this;
   }
+  if (db->HasDeferredMerge()) {
+    ASSIGN_OR_RETURN(auto frozen_db, db->GetDeferredMergeResult());
+    return DataSlice(internal_->impl, GetShape(), GetSchemaImpl(),
+                     std::move(frozen_db), IsWhole());
+  }
   // TODO: Re-think forking in the context of DataBag with
   // mutable fallbacks.
   if (!db->GetFallbacks().empty()) {
@@ -1100,6 +1120,29 @@ absl::StatusOr<DataSlice::AttrNamesSet> DataSlice::GetAttrNames(
       }));
 }
 
+template <typename ImplT>
+absl::StatusOr<DataSlice> DataSlice::MakeAttrSlice(ImplT values,
+                                                   internal::DataItem schema,
+                                                   bool allow_missing) const {
+  if (!allow_missing) {
+    // TODO: Use DataSlice::Create instead of verifying manually.
+    RETURN_IF_ERROR(AssertIsSliceSchema(schema));
+    return DataSlice(std::move(values), GetShape(), std::move(schema),
+                     GetBag());
+  }
+  if (!schema.has_value()) {
+    schema = internal::DataItem(schema::kAny);
+    if (values.present_count() == 0 && GetSchemaImpl() != schema::kAny) {
+      schema = internal::DataItem(schema::kNone);
+    } else if (values.dtype() != arolla::GetNothingQType()) {
+      ASSIGN_OR_RETURN(auto dtype, schema::DType::FromQType(values.dtype()));
+      schema = internal::DataItem(dtype);
+    }
+  }
+  return DataSlice::Create(std::move(values), GetShape(), std::move(schema),
+                           GetBag());
+}
+
 absl::StatusOr<DataSlice> DataSlice::GetAttr(
     absl::string_view attr_name) const {
   return VisitImpl([&]<class T>(const T& impl) -> absl::StatusOr<DataSlice> {
@@ -1109,10 +1152,8 @@ absl::StatusOr<DataSlice> DataSlice::GetAttr(
         GetAttrImpl(GetBag(), impl, GetSchemaImpl(), attr_name, res_schema,
                     /*allow_missing_schema=*/false),
         AssembleErrorMessage(_, {.ds = *this}));
-    // TODO: Use DataSlice::Create instead of verifying manually.
-    RETURN_IF_ERROR(AssertIsSliceSchema(res_schema));
-    return DataSlice(std::move(res), GetShape(), std::move(res_schema),
-                     GetBag());
+    return MakeAttrSlice(std::move(res), std::move(res_schema),
+                         /*allow_missing=*/false);
   });
 }
 
@@ -1125,20 +1166,55 @@ absl::StatusOr<DataSlice> DataSlice::GetAttrOrMissing(
         GetAttrImpl(GetBag(), impl, GetSchemaImpl(), attr_name, res_schema,
                     /*allow_missing_schema=*/true),
         AssembleErrorMessage(_, {.ds = *this}));
-    if (!res_schema.has_value()) {
-      res_schema = internal::DataItem(schema::kAny);
-      if (res.present_count() == 0 && GetSchemaImpl() != schema::kAny) {
-        res_schema = internal::DataItem(schema::kNone);
-      } else if (res.dtype() != arolla::GetNothingQType()) {
-        ASSIGN_OR_RETURN(auto dtype, schema::DType::FromQType(res.dtype()));
-        res_schema = internal::DataItem(dtype);
-      }
-    }
-    return DataSlice::Create(std::move(res), GetShape(), std::move(res_schema),
-                             GetBag());
+    return MakeAttrSlice(std::move(res), std::move(res_schema),
+                         /*allow_missing=*/true);
   });
 }
 
+absl::StatusOr<std::vector<DataSlice>> DataSlice::GetAttrs(
+    absl::Span<const absl::string_view> attr_names, bool allow_missing) const {
+  std::vector<DataSlice> result;
+  result.reserve(attr_names.size());
+  const DataBagPtr& db = GetBag();
+  const internal::DataItem& schema = GetSchemaImpl();
+  // Items, schemas and errors are handled attribute by attribute.
+  if (is_item() || attr_names.size() < 2 || db == nullptr ||
+      schema == schema::kSchema || schema.is_primitive_schema()) {
+    for (absl::string_view attr_name : attr_names) {
+      ASSIGN_OR_RETURN(auto attr, allow_missing ? GetAttrOrMissing(attr_name)
+                                                : GetAttr(attr_name));
+      result.push_back(std::move(attr));
+    }
+    return result;
+  }
+
+  const internal::DataSliceImpl& impl = slice();
+  const auto& db_impl = db->GetImpl();
+  FlattenFallbackFinder fb_finder(*db);
+  auto fallbacks = fb_finder.GetFlattenFallbacks();
+  std::vector<internal::DataItem> res_schemas;
+  res_schemas.reserve(attr_names.size());
+  for (absl::string_view attr_name : attr_names) {
+    internal::DataItem res_schema(schema::kSchema);
+    if (attr_name != schema::kSchemaAttr) {
+      ASSIGN_OR_RETURN(res_schema,
+                       GetResultSchema(db_impl, impl, schema, attr_name,
+                                       fallbacks, allow_missing),
+                       AssembleErrorMessage(_, {.ds = *this}));
+    }
+    res_schemas.push_back(std::move(res_schema));
+  }
+  ASSIGN_OR_RETURN(auto values, db_impl.GetAttrs(impl, attr_names, fallbacks),
+                   AssembleErrorMessage(_, {.ds = *this}));
+  for (size_t i = 0; i < attr_names.size(); ++i) {
+    ASSIGN_OR_RETURN(auto attr,
+                     MakeAttrSlice(std::move(values[i]),
+                                   std::move(res_schemas[i]), allow_missing));
+    result.push_back(std::move(attr));
+  }
+  return result;
+}
+
 absl::StatusOr<DataSlice> DataSlice::GetAttrWithDefault(
     absl::string_view attr_name, const DataSlice& default_value) const {
   ASSIGN_OR_RETURN(auto expanded_default,
@@ -1370,10 +1446,12 @@ absl::StatusOr<DataSlice> DataSlice::GetFromDict(const DataSlice& keys) const {
   RETURN_IF_ERROR(AssertIsSliceSchema(res_schema));
   return expanded_this.VisitImpl(
       [&]<class T>(const T& impl) -> absl::StatusOr<DataSlice> {
+        auto fallbacks =
+            fb_finder.GetFlattenFallbacksWithDicts(GetAllocationIds(impl));
         ASSIGN_OR_RETURN(auto res_impl,
                          GetBag()->GetImpl().GetFromDict(
                              impl, keys_handler.GetValues().impl<T>(),
-                             fb_finder.GetFlattenFallbacks()));
+                             fallbacks));
         return DataSlice(std::move(res_impl), shape, std::move(res_schema),
                          GetBag());
       });
@@ -1386,9 +1464,13 @@ absl::Status DataSlice::SetInDict(const DataSlice& keys,
         "cannot set dict values without a DataBag");
   }
   const JaggedShape& shape = MaxRankShape(GetShape(), keys.GetShape());
-  // Note: expanding `this` has an overhead. In future we can try to optimize
-  // it.
-  ASSIGN_OR_RETURN(auto expanded_this, BroadcastToShape(*this, shape));
+  // Note: `this` is not expanded. Keys of higher rank are grouped by dicts
+  // instead (see DataBagImpl::SetInDicts).
+  if (!GetShape().IsBroadcastableTo(shape)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "DataSlice with shape=%s cannot be expanded to shape=%s",
+        arolla::Repr(GetShape()), arolla::Repr(shape)));
+  }
   ASSIGN_OR_RETURN(auto expanded_keys, BroadcastToShape(keys, shape));
   ASSIGN_OR_RETURN(auto expanded_values, BroadcastToShape(values, shape),
                    _.With([&](auto status) {
@@ -1413,7 +1495,22 @@ absl::Status DataSlice::SetInDict(const DataSlice& keys,
   adoption_queue.Add(keys);
   adoption_queue.Add(values);
   RETURN_IF_ERROR(adoption_queue.AdoptInto(*GetBag()));
-  return expanded_this.VisitImpl([&]<class T>(const T& impl) -> absl::Status {
+  if (GetShape().rank() < shape.rank()) {
+    auto edge = GetShape().GetBroadcastEdge(shape);
+    return VisitImpl([&]<class T>(const T& impl) -> absl::Status {
+      if constexpr (std::is_same_v<T, internal::DataItem>) {
+        return db_mutable_impl.SetInDicts(
+            internal::DataSliceImpl::Create(/*size=*/1, impl), edge,
+            keys_handler.GetValues().slice(),
+            values_handler.GetValues().slice());
+      } else {
+        return db_mutable_impl.SetInDicts(impl, edge,
+                                          keys_handler.GetValues().slice(),
+                                          values_handler.GetValues().slice());
+      }
+    });
+  }
+  return VisitImpl([&]<class T>(const T& impl) -> absl::Status {
     return db_mutable_impl.SetInDict(impl, keys_handler.GetValues().impl<T>(),
                                      values_handler.GetValues().impl<T>());
   });
@@ -1434,7 +1531,9 @@ absl::StatusOr<DataSlice> DataSlice::GetDictKeys() const {
                      AssembleErrorMessage(_, {.ds = *this}));
     ASSIGN_OR_RETURN(
         (auto [slice, edge]),
-        GetBag()->GetImpl().GetDictKeys(impl, fb_finder.GetFlattenFallbacks()));
+        GetBag()->GetImpl().GetDictKeys(
+            impl,
+            fb_finder.GetFlattenFallbacksWithDicts(GetAllocationIds(impl))));
     ASSIGN_OR_RETURN(auto shape, GetShape().AddDims({std::move(edge)}));
     return DataSlice::Create(std::move(slice), std::move(shape),
                              std::move(res_schema), GetBag());
@@ -1454,9 +1553,11 @@ absl::StatusOr<DataSlice> DataSlice::GetDictValues() const {
                                      fb_finder.GetFlattenFallbacks(),
                                      /*allow_missing=*/false),
                      AssembleErrorMessage(_, {.ds = *this}));
-    ASSIGN_OR_RETURN((auto [slice, edge]),
-                     GetBag()->GetImpl().GetDictValues(
-                         impl, fb_finder.GetFlattenFallbacks()));
+    ASSIGN_OR_RETURN(
+        (auto [slice, edge]),
+        GetBag()->GetImpl().GetDictValues(
+            impl,
+            fb_finder.GetFlattenFallbacksWithDicts(GetAllocationIds(impl))));
     ASSIGN_OR_RETURN(auto shape, GetShape().AddDims({std::move(edge)}));
     return DataSlice::Create(std::move(slice), std::move(shape),
                              std::move(res_schema), GetBag());
@@ -1494,9 +1595,11 @@ absl::StatusOr<DataSlice> DataSlice::GetFromList(
   if (std::holds_alternative<internal::DataItem>(
           expanded_this.internal_->impl)) {
     int64_t index = expanded_indices.item().value<int64_t>();
-    ASSIGN_OR_RETURN(auto res_impl, GetBag()->GetImpl().GetFromList(
-                                        expanded_this.item(), index,
-                                        fb_finder.GetFlattenFallbacks()));
+    ASSIGN_OR_RETURN(auto res_impl,
+                     GetBag()->GetImpl().GetFromList(
+                         expanded_this.item(), index,
+                         fb_finder.GetFlattenFallbacksWithLists(
+                             GetAllocationIds(expanded_this.item()))));
     return DataSlice(std::move(res_impl), shape, std::move(res_schema),
                      GetBag());
   } else {
@@ -1504,7 +1607,8 @@ absl::StatusOr<DataSlice> DataSlice::GetFromList(
         auto res_impl,
         GetBag()->GetImpl().GetFromLists(
             expanded_this.slice(), expanded_indices.slice().values<int64_t>(),
-            fb_finder.GetFlattenFallbacks()));
+            fb_finder.GetFlattenFallbacksWithLists(
+                expanded_this.slice().allocation_ids())));
     return DataSlice(std::move(res_impl), shape, std::move(res_schema),
                      GetBag());
   }
@@ -1530,7 +1634,8 @@ absl::StatusOr<DataSlice> DataSlice::ExplodeList(
       ASSIGN_OR_RETURN(auto values,
                        GetBag()->GetImpl().ExplodeList(
                            impl, internal::DataBagImpl::ListRange(start, stop),
-                           fb_finder.GetFlattenFallbacks()));
+                           fb_finder.GetFlattenFallbacksWithLists(
+                               GetAllocationIds(impl))));
       auto shape = JaggedShape::FlatFromSize(values.size());
       return DataSlice::Create(std::move(values), std::move(shape),
                                std::move(schema), GetBag());
@@ -1538,7 +1643,8 @@ absl::StatusOr<DataSlice> DataSlice::ExplodeList(
       ASSIGN_OR_RETURN((auto [values, edge]),
                        GetBag()->GetImpl().ExplodeLists(
                            impl, internal::DataBagImpl::ListRange(start, stop),
-                           fb_finder.GetFlattenFallbacks()));
+                           fb_finder.GetFlattenFallbacksWithLists(
+                               impl.allocation_ids())));
       ASSIGN_OR_RETURN(auto shape, GetShape().AddDims({edge}));
       return DataSlice::Create(std::move(values), std::move(shape),
                                std::move(schema), GetBag());
@@ -23,6 +23,7 @@
 #include <type_traits>
 #include <utility>
 #include <variant>
+#include <vector>
 
 #include "absl/base/nullability.h"
 #include "absl/base/optimization.h"
@@ -266,6 +267,13 @@ class DataSlice {
   // value is missing. This allows fetching an attribute that does not exist.
   absl::StatusOr<DataSlice> GetAttrOrMissing(absl::string_view attr_name) const;
 
+  // Returns the values of the attributes `attr_names`, same as GetAttr (or
+  // GetAttrOrMissing if `allow_missing` is true) for each of them, but reads
+  // all the attributes of a DataSlice from the DataBag in one batch.
+  absl::StatusOr<std::vector<DataSlice>> GetAttrs(
+      absl::Span<const absl::string_view> attr_names,
+      bool allow_missing = false) const;
+
   // Returns a new DataSlice containing the values of the attribute `attr_name`
   // on the objects in this DataSlice. The result uses the common DataBag of
   // this DataSlice and `default_value`. If the attribute is not defined in the
@@ -501,6 +509,13 @@ class DataSlice {
                                               arolla::QTypePtr dtype,
                                               bool empty_and_unknown);
 
+  // Returns the result of GetAttr (GetAttrOrMissing if `allow_missing` is
+  // true) given the attribute `values` and their `schema`.
+  template <typename ImplT>
+  absl::StatusOr<DataSlice> MakeAttrSlice(ImplT values,
+                                          internal::DataItem schema,
+                                          bool allow_missing) const;
+
   // Helper method for setting an attribute as if this DataSlice is a Schema
   // slice (schemas are stored in a dict and not in normal attribute storage).
   absl::Status SetSchemaAttr(absl::string_view attr_name,
@@ -0,0 +1,127 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "koladata/data_slice_chunks.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "koladata/data_slice.h"
+#include "koladata/internal/data_slice.h"
+#include "koladata/internal/slice_builder.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/memory/buffer.h"
+#include "arolla/util/status_macros_backport.h"
+
+namespace koladata {
+namespace {
+
+using ::koladata::internal::DataSliceImpl;
+
+// Returns the items [begin, end) of `impl`. Values of single-type slices are
+// not copied.
+DataSliceImpl SliceImplRange(const DataSliceImpl& impl, int64_t begin,
+                             int64_t end) {
+  int64_t size = end - begin;
+  if (impl.is_empty_and_unknown()) {
+    return DataSliceImpl::CreateEmptyAndUnknownType(size);
+  }
+  if (impl.is_single_dtype()) {
+    DataSliceImpl res;
+    impl.VisitValues([&]<class T>(const arolla::DenseArray<T>& values) {
+      res = DataSliceImpl::CreateWithAllocIds(
+          impl.allocation_ids(),
+          values.Slice(begin, size).ForceNoBitmapBitOffset());
+    });
+    return res;
+  }
+  internal::SliceBuilder bldr(size, impl.allocation_ids());
+  for (int64_t i = 0; i < size; ++i) {
+    bldr.InsertIfNotSet(i, impl[begin + i]);
+  }
+  return std::move(bldr).Build();
+}
+
+}  // namespace
+
+absl::StatusOr<DataSlice> GetRows(const DataSlice& ds, int64_t begin,
+                                  int64_t end) {
+  const DataSlice::JaggedShape& shape = ds.GetShape();
+  if (shape.rank() == 0) {
+    return absl::InvalidArgumentError(
+        "expected a DataSlice with at least one dimension");
+  }
+  int64_t row_count = shape.edges()[0].child_size();
+  if (begin < 0 || begin > end || end > row_count) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "rows [%d, %d) are out of bounds for a DataSlice with %d rows", begin,
+        end, row_count));
+  }
+  DataSlice::JaggedShape::EdgeVec edges;
+  edges.reserve(shape.rank());
+  ASSIGN_OR_RETURN(edges.emplace_back(),
+                   DataSlice::JaggedShape::Edge::FromUniformGroups(
+                       /*parent_size=*/1, /*group_size=*/end - begin));
+  // Range of the items of the current dimension.
+  int64_t items_begin = begin;
+  int64_t items_end = end;
+  for (const auto& edge : shape.edges().subspan(1)) {
+    absl::Span<const int64_t> split_points = edge.edge_values().values.span();
+    int64_t offset = split_points[items_begin];
+    arolla::Buffer<int64_t>::Builder bldr(items_end - items_begin + 1);
+    std::transform(split_points.begin() + items_begin,
+                   split_points.begin() + items_end + 1,
+                   bldr.GetMutableSpan().begin(),
+                   [offset](int64_t split_point) {
+                     return split_point - offset;
+                   });
+    items_begin = split_points[items_begin];
+    items_end = split_points[items_end];
+    ASSIGN_OR_RETURN(edges.emplace_back(),
+                     DataSlice::JaggedShape::Edge::FromSplitPoints(
+                         arolla::DenseArray<int64_t>{std::move(bldr).Build()}));
+  }
+  ASSIGN_OR_RETURN(auto rows_shape,
+                   DataSlice::JaggedShape::FromEdges(std::move(edges)));
+  return DataSlice::Create(SliceImplRange(ds.slice(), items_begin, items_end),
+                           std::move(rows_shape), ds.GetSchemaImpl(),
+                           ds.GetBag());
+}
+
+absl::StatusOr<DataSliceChunkIterator> DataSliceChunkIterator::Create(
+    DataSlice ds, int64_t chunk_size) {
+  if (ds.GetShape().rank() == 0) {
+    return absl::InvalidArgumentError(
+        "expected a DataSlice with at least one dimension");
+  }
+  if (chunk_size <= 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "chunk_size must be positive, got %d", chunk_size));
+  }
+  int64_t row_count = ds.GetShape().edges()[0].child_size();
+  return DataSliceChunkIterator(std::move(ds), chunk_size, row_count);
+}
+
+absl::StatusOr<DataSlice> DataSliceChunkIterator::Next() {
+  int64_t begin = next_row_;
+  next_row_ = std::min(row_count_, begin + chunk_size_);
+  return GetRows(ds_, begin, next_row_);
+}
+
+}  // namespace koladata
@@ -0,0 +1,72 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef KOLADATA_DATA_SLICE_CHUNKS_H_
+#define KOLADATA_DATA_SLICE_CHUNKS_H_
+
+#include <cstdint>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "koladata/data_slice.h"
+
+namespace koladata {
+
+// Returns the items [begin, end) of the first dimension of `ds` together with
+// all their nested items, as a DataSlice with the same rank, schema and
+// DataBag. The values are not copied.
+//
+// Returns an error if `ds` is a DataItem or the range is out of bounds.
+absl::StatusOr<DataSlice> GetRows(const DataSlice& ds, int64_t begin,
+                                  int64_t end);
+
+// Iterates over a DataSlice in chunks of at most `chunk_size` items of its
+// first dimension, so that huge slices can be processed (e.g. converted to
+// Python or used to fetch attributes through their DataBag) with memory
+// bounded by the chunk size. Chunks are created lazily by Next().
+//
+// Example:
+//   ASSIGN_OR_RETURN(auto it, DataSliceChunkIterator::Create(ds, 1000));
+//   while (it.HasNext()) {
+//     ASSIGN_OR_RETURN(DataSlice chunk, it.Next());
+//     ASSIGN_OR_RETURN(DataSlice a, chunk.GetAttr("a"));
+//     ...
+//   }
+class DataSliceChunkIterator {
+ public:
+  // Returns an error if `ds` is a DataItem or `chunk_size` is not positive.
+  static absl::StatusOr<DataSliceChunkIterator> Create(DataSlice ds,
+                                                       int64_t chunk_size);
+
+  // Returns the number of items in the first dimension of the slice.
+  int64_t row_count() const { return row_count_; }
+
+  bool HasNext() const { return next_row_ < row_count_; }
+
+  // Returns the next chunk, see GetRows. Must be called only if HasNext().
+  absl::StatusOr<DataSlice> Next();
+
+ private:
+  DataSliceChunkIterator(DataSlice ds, int64_t chunk_size, int64_t row_count)
+      : ds_(std::move(ds)), chunk_size_(chunk_size), row_count_(row_count) {}
+
+  DataSlice ds_;
+  int64_t chunk_size_;
+  int64_t row_count_;
+  int64_t next_row_ = 0;
+};
+
+}  // namespace koladata
+
+#endif  // KOLADATA_DATA_SLICE_CHUNKS_H_
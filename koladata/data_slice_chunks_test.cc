@@ -0,0 +1,115 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "koladata/data_slice_chunks.h"
+
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "koladata/data_bag.h"
+#include "koladata/data_slice.h"
+#include "koladata/internal/dtype.h"
+#include "koladata/object_factories.h"
+#include "koladata/test_utils.h"
+#include "koladata/testing/matchers.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/util/text.h"
+
+namespace koladata {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::arolla::CreateFullDenseArray;
+using ::koladata::testing::IsEquivalentTo;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+DataSlice::JaggedShape::Edge CreateEdge(
+    std::initializer_list<int64_t> split_points) {
+  return *DataSlice::JaggedShape::Edge::FromSplitPoints(
+      CreateFullDenseArray(std::vector<int64_t>(split_points)));
+}
+
+TEST(DataSliceChunksTest, GetRows) {
+  // [[1, 2], [], [3], [4, 5, 6]]
+  ASSERT_OK_AND_ASSIGN(auto shape, DataSlice::JaggedShape::FromEdges(
+                                       {CreateEdge({0, 4}),
+                                        CreateEdge({0, 2, 2, 3, 6})}));
+  auto db = DataBag::Empty();
+  auto ds = test::DataSlice<int>({1, 2, 3, 4, 5, 6}, shape, db);
+
+  ASSERT_OK_AND_ASSIGN(auto rows, GetRows(ds, 1, 4));
+  ASSERT_OK_AND_ASSIGN(
+      auto expected_shape,
+      DataSlice::JaggedShape::FromEdges(
+          {CreateEdge({0, 3}), CreateEdge({0, 0, 1, 4})}));
+  EXPECT_THAT(rows, IsEquivalentTo(test::DataSlice<int>({3, 4, 5, 6},
+                                                       expected_shape, db)));
+  EXPECT_EQ(rows.GetBag(), db);
+
+  ASSERT_OK_AND_ASSIGN(rows, GetRows(ds, 2, 2));
+  EXPECT_EQ(rows.size(), 0);
+  EXPECT_EQ(rows.GetShape().rank(), 2);
+
+  EXPECT_THAT(GetRows(ds, 3, 5),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("rows [3, 5) are out of bounds")));
+  EXPECT_THAT(GetRows(test::DataItem(1), 0, 1),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("at least one dimension")));
+}
+
+TEST(DataSliceChunksTest, GetRowsMixed) {
+  auto ds = test::MixedDataSlice<int, arolla::Text>(
+      {1, std::nullopt, std::nullopt, 4},
+      {std::nullopt, "b", std::nullopt, std::nullopt});
+  ASSERT_OK_AND_ASSIGN(auto rows, GetRows(ds, 1, 3));
+  EXPECT_THAT(rows.slice(), ElementsAre(arolla::Text("b"), std::nullopt));
+  EXPECT_EQ(rows.GetSchemaImpl(), schema::kObject);
+}
+
+TEST(DataSliceChunksTest, Iterator) {
+  auto db = DataBag::Empty();
+  auto values = test::DataSlice<int>({1, 2, 3, 4, 5});
+  ASSERT_OK_AND_ASSIGN(auto ds,
+                       EntityCreator::FromAttrs(db, {"a"}, {values}));
+
+  ASSERT_OK_AND_ASSIGN(auto it, DataSliceChunkIterator::Create(ds, 2));
+  EXPECT_EQ(it.row_count(), 5);
+  std::vector<DataSlice> chunks;
+  while (it.HasNext()) {
+    ASSERT_OK_AND_ASSIGN(chunks.emplace_back(), it.Next());
+  }
+  ASSERT_EQ(chunks.size(), 3);
+  EXPECT_EQ(chunks[0].size(), 2);
+  EXPECT_EQ(chunks[2].size(), 1);
+  ASSERT_OK_AND_ASSIGN(auto a, chunks[1].GetAttr("a"));
+  EXPECT_THAT(a.slice(), ElementsAre(3, 4));
+
+  EXPECT_THAT(DataSliceChunkIterator::Create(ds, 0),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("chunk_size must be positive, got 0")));
+  EXPECT_THAT(DataSliceChunkIterator::Create(test::DataItem(1), 1),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("at least one dimension")));
+}
+
+}  // namespace
+}  // namespace koladata
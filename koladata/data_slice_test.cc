@@ -1206,6 +1206,36 @@ TEST(DataSliceTest, GetAttrErrors) {
   }
 }
 
+TEST(DataSliceTest, GetAttrs) {
+  auto db = DataBag::Empty();
+  auto shape = DataSlice::JaggedShape::FlatFromSize(3);
+  ASSERT_OK_AND_ASSIGN(auto ds, EntityCreator::Shaped(db, shape, {}, {}));
+  ASSERT_OK(ds.SetAttr("a", test::DataSlice<int>({1, std::nullopt, 3})));
+  ASSERT_OK(ds.SetAttr("b", test::DataSlice<float>({std::nullopt, 2.f, 3.f})));
+
+  ASSERT_OK_AND_ASSIGN(auto res, ds.GetAttrs({"b", "a", "__schema__"}));
+  ASSERT_EQ(res.size(), 3);
+  EXPECT_THAT(res[0], IsEquivalentTo(*ds.GetAttr("b")));
+  EXPECT_THAT(res[1], IsEquivalentTo(*ds.GetAttr("a")));
+  EXPECT_THAT(res[2], IsEquivalentTo(*ds.GetAttr("__schema__")));
+  EXPECT_THAT(res[1].slice(), ElementsAre(1, std::nullopt, 3));
+  EXPECT_EQ(res[0].GetSchemaImpl(), schema::kFloat32);
+
+  EXPECT_THAT(ds.GetAttrs({"a", "c"}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("attribute 'c' is missing")));
+  ASSERT_OK_AND_ASSIGN(res, ds.GetAttrs({"a", "c"}, /*allow_missing=*/true));
+  ASSERT_EQ(res.size(), 2);
+  EXPECT_THAT(res[0], IsEquivalentTo(*ds.GetAttr("a")));
+  EXPECT_THAT(res[1], IsEquivalentTo(*ds.GetAttrOrMissing("c")));
+
+  auto x = test::DataSlice<int>({std::nullopt}, schema::kInt32, db);
+  EXPECT_THAT(
+      x.GetAttrs({"a", "b"}),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               "getting attributes from primitive values is not supported"));
+}
+
 TEST(DataSliceTest, GetAttrNames_SchemaItem) {
   auto db = DataBag::Empty();
   auto a = test::DataSlice<int>({1});
@@ -4314,6 +4344,58 @@ TEST(DataSliceTest, SetInDict_GetFromDict_ObjectSchema) {
                HasSubstr("DataBag is immutable")));
 }
 
+TEST(DataSliceTest, SetInDict_GetFromDict_KeysOfHigherRank) {
+  auto dicts_shape = DataSlice::JaggedShape::FlatFromSize(3);
+  ASSERT_OK_AND_ASSIGN(auto keys_shape,
+                       dicts_shape.AddDims({CreateEdge({0, 2, 2, 5})}));
+  auto db = DataBag::Empty();
+  ASSERT_OK_AND_ASSIGN(
+      auto dicts,
+      CreateDictShaped(db, dicts_shape, /*keys=*/std::nullopt,
+                       /*values=*/std::nullopt, /*schema=*/std::nullopt,
+                       test::Schema(schema::kInt32),
+                       test::Schema(schema::kInt64)));
+  auto keys = test::DataSlice<int>({1, 2, 1, 2, 3}, keys_shape);
+
+  ASSERT_OK(dicts.SetInDict(
+      keys, test::DataSlice<int64_t>({10, 20, 30, 40, 50}, keys_shape)));
+  ASSERT_OK_AND_ASSIGN(auto values, dicts.GetFromDict(keys));
+  EXPECT_THAT(values.slice(), ElementsAre(int64_t{10}, int64_t{20},
+                                          int64_t{30}, int64_t{40},
+                                          int64_t{50}));
+  EXPECT_THAT(values.GetShape(), IsEquivalentTo(keys_shape));
+  EXPECT_THAT(dicts.GetDictKeys(),
+              IsOkAndHolds(Property(&DataSlice::size, Eq(5))));
+
+  // Values of lower rank are broadcasted to the keys.
+  ASSERT_OK(dicts.SetInDict(keys,
+                            test::DataSlice<int64_t>({7, 8, 9}, dicts_shape)));
+  ASSERT_OK_AND_ASSIGN(values, dicts.GetFromDict(keys));
+  EXPECT_THAT(values.slice(),
+              ElementsAre(int64_t{7}, int64_t{7}, int64_t{9}, int64_t{9},
+                          int64_t{9}));
+
+  // A single dict with keys of rank 1.
+  ASSERT_OK_AND_ASSIGN(
+      auto dict,
+      CreateDictShaped(db, DataSlice::JaggedShape::Empty(),
+                       /*keys=*/std::nullopt, /*values=*/std::nullopt,
+                       /*schema=*/std::nullopt, test::Schema(schema::kInt32),
+                       test::Schema(schema::kInt64)));
+  ASSERT_OK(dict.SetInDict(test::DataSlice<int>({1, 2}),
+                           test::DataSlice<int64_t>({3, 4})));
+  EXPECT_THAT(dict.GetFromDict(test::DataSlice<int>({2, 1, 5})),
+              IsOkAndHolds(Property(
+                  &DataSlice::slice,
+                  ElementsAre(int64_t{4}, int64_t{3}, std::nullopt))));
+
+  auto other_shape = DataSlice::JaggedShape::FlatFromSize(2);
+  EXPECT_THAT(dicts.SetInDict(test::DataSlice<int>({1, 2}, other_shape),
+                              test::DataSlice<int64_t>({1, 2}, other_shape)),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("cannot be expanded to shape")));
+}
+
 TEST(DataSliceTest, SetInDict_GetFromDict_Int64Schema) {
   auto edge_1 = CreateEdge({0, 2});
   auto edge_2 = CreateEdge({0, 2, 3});
@@ -60,6 +60,10 @@ namespace {
 // since in most cases we have 1:1 correspondence between them.
 constexpr int64_t kCacheSize = 4096;
 
+// Maximum number of compiled expressions cached in a PreparedExpr. Further
+// input QType combinations use only the global compilation cache.
+constexpr size_t kMaxPreparedExprCompilations = 16;
+
 // Information about an expression for fetching inputs for evaluation.
 struct ExprInfo {
   std::vector<std::string> leaf_keys;
@@ -337,6 +341,113 @@ absl::StatusOr<arolla::TypedValue> EvalExprWithCompilationCache(
   return compiled_expr(input_qvalues);
 }
 
+absl::StatusOr<std::shared_ptr<const PreparedExpr>> PreparedExpr::Create(
+    const arolla::expr::ExprNodePtr& expr,
+    absl::Span<const std::string> input_names,
+    absl::Span<const std::string> variable_names) {
+  ASSIGN_OR_RETURN(auto transformed_expr, TransformExprForEval(expr));
+  const auto& expr_info = transformed_expr->info;
+  // NOTE: The constructor is private, so we cannot use std::make_shared.
+  std::shared_ptr<PreparedExpr> res(new PreparedExpr());
+  res->expr_ = transformed_expr->expr;
+  res->leaf_keys_ = expr_info.leaf_keys;
+  res->input_count_ = input_names.size();
+  res->variable_count_ = variable_names.size();
+  std::vector<std::optional<LeafSource>> leaf_sources(
+      expr_info.leaf_keys.size());
+  if (expr_info.non_deterministic_index) {
+    leaf_sources[*expr_info.non_deterministic_index] =
+        LeafSource{LeafSource::kNonDeterministicToken, 0};
+  }
+  auto assign_sources = [&](absl::Span<const std::string> names,
+                            const absl::flat_hash_map<std::string, size_t>&
+                                leaf_index,
+                            LeafSource::Kind kind,
+                            absl::string_view kind_name) -> absl::Status {
+    for (size_t i = 0; i < names.size(); ++i) {
+      auto it = leaf_index.find(names[i]);
+      if (it == leaf_index.end()) {
+        continue;
+      }
+      if (leaf_sources[it->second].has_value()) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "%s [%s] passed twice to kd.eval()", kind_name, names[i]));
+      }
+      leaf_sources[it->second] = LeafSource{kind, i};
+    }
+    return absl::OkStatus();
+  };
+  RETURN_IF_ERROR(assign_sources(input_names, expr_info.input_leaf_index,
+                                 LeafSource::kInput, "input"));
+  RETURN_IF_ERROR(assign_sources(variable_names,
+                                 expr_info.variable_leaf_index,
+                                 LeafSource::kVariable, "variable"));
+  std::vector<absl::string_view> missing_leaf_keys;
+  res->leaf_sources_.reserve(leaf_sources.size());
+  for (size_t i = 0; i < leaf_sources.size(); ++i) {
+    if (!leaf_sources[i].has_value()) {
+      missing_leaf_keys.push_back(expr_info.leaf_keys[i]);
+    } else {
+      res->leaf_sources_.push_back(*leaf_sources[i]);
+    }
+  }
+  if (!missing_leaf_keys.empty()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("kd.eval() has missing inputs for: [%s]",
+                        absl::StrJoin(missing_leaf_keys, ", ")));
+  }
+  return res;
+}
+
+absl::StatusOr<PreparedExpr::CompiledExpr> PreparedExpr::GetCompiledExpr(
+    absl::Span<const arolla::TypedRef> leaf_values) const {
+  std::vector<arolla::QTypePtr> leaf_types(leaf_values.size());
+  for (size_t i = 0; i < leaf_values.size(); ++i) {
+    leaf_types[i] = leaf_values[i].GetType();
+  }
+  {
+    absl::ReaderMutexLock lock(&mutex_);
+    if (auto it = compiled_exprs_.find(leaf_types);
+        it != compiled_exprs_.end()) {
+      return it->second;
+    }
+  }
+  ASSIGN_OR_RETURN(CompiledExpr fn, Compile(expr_, leaf_keys_, leaf_values));
+  absl::MutexLock lock(&mutex_);
+  if (compiled_exprs_.size() < kMaxPreparedExprCompilations) {
+    compiled_exprs_.emplace(std::move(leaf_types), fn);
+  }
+  return fn;
+}
+
+absl::StatusOr<arolla::TypedValue> PreparedExpr::Eval(
+    absl::Span<const arolla::TypedRef> inputs,
+    absl::Span<const arolla::TypedRef> variables) const {
+  if (inputs.size() != input_count_ || variables.size() != variable_count_) {
+    return absl::InternalError(absl::StrFormat(
+        "internal kd.eval error: expected %d inputs and %d variables, got %d "
+        "and %d",
+        input_count_, variable_count_, inputs.size(), variables.size()));
+  }
+  std::vector<arolla::TypedRef> leaf_values;
+  leaf_values.reserve(leaf_sources_.size());
+  for (const auto& source : leaf_sources_) {
+    switch (source.kind) {
+      case LeafSource::kInput:
+        leaf_values.push_back(inputs[source.index]);
+        break;
+      case LeafSource::kVariable:
+        leaf_values.push_back(variables[source.index]);
+        break;
+      case LeafSource::kNonDeterministicToken:
+        leaf_values.push_back(internal::NonDeterministicTokenValue().AsRef());
+        break;
+    }
+  }
+  ASSIGN_OR_RETURN(auto compiled_expr, GetCompiledExpr(leaf_values));
+  return compiled_expr(leaf_values);
+}
+
 absl::StatusOr<std::vector<std::string>> GetExprVariables(
     const arolla::expr::ExprNodePtr& expr) {
   ASSIGN_OR_RETURN(auto transformed_expr, TransformExprForEval(expr));
@@ -15,14 +15,21 @@
 #ifndef KOLADATA_EXPR_EXPR_EVAL_H_
 #define KOLADATA_EXPR_EXPR_EVAL_H_
 
+#include <cstddef>
+#include <functional>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "arolla/expr/expr_node.h"
+#include "arolla/qtype/qtype.h"
 #include "arolla/qtype/typed_ref.h"
 #include "arolla/qtype/typed_value.h"
 
@@ -42,6 +49,55 @@ absl::StatusOr<arolla::TypedValue> EvalExprWithCompilationCache(
     absl::Span<const std::pair<std::string, arolla::TypedRef>> inputs,
     absl::Span<const std::pair<std::string, arolla::TypedRef>> variables);
 
+// A Koda expression prepared for repeated evaluation. Compared to
+// EvalExprWithCompilationCache, the expression transformation and the matching
+// of inputs and variables by name happen once in Create, and the compiled
+// expressions are additionally cached inside the object by input QTypes.
+//
+// This class is thread-safe.
+class PreparedExpr {
+ public:
+  // Prepares `expr` for evaluation. `input_names` and `variable_names` define
+  // the order of the values passed to Eval. The expression may use only a
+  // subset of them, but all the inputs and variables it uses must be listed.
+  static absl::StatusOr<std::shared_ptr<const PreparedExpr>> Create(
+      const arolla::expr::ExprNodePtr& expr,
+      absl::Span<const std::string> input_names,
+      absl::Span<const std::string> variable_names);
+
+  // Evaluates the expression. `inputs` and `variables` must correspond to
+  // `input_names` and `variable_names` passed to Create.
+  absl::StatusOr<arolla::TypedValue> Eval(
+      absl::Span<const arolla::TypedRef> inputs,
+      absl::Span<const arolla::TypedRef> variables) const;
+
+ private:
+  using CompiledExpr = std::function<absl::StatusOr<arolla::TypedValue>(
+      absl::Span<const arolla::TypedRef>)>;
+
+  // Where the value of a leaf comes from.
+  struct LeafSource {
+    enum Kind { kInput, kVariable, kNonDeterministicToken };
+    Kind kind;
+    size_t index;
+  };
+
+  PreparedExpr() = default;
+
+  absl::StatusOr<CompiledExpr> GetCompiledExpr(
+      absl::Span<const arolla::TypedRef> leaf_values) const;
+
+  arolla::expr::ExprNodePtr expr_;
+  std::vector<std::string> leaf_keys_;
+  std::vector<LeafSource> leaf_sources_;
+  size_t input_count_ = 0;
+  size_t variable_count_ = 0;
+
+  mutable absl::Mutex mutex_;
+  mutable absl::flat_hash_map<std::vector<arolla::QTypePtr>, CompiledExpr>
+      compiled_exprs_ ABSL_GUARDED_BY(mutex_);
+};
+
 // Retrieves the list of variables used in the given expression.
 // This reuses the same cache as EvalExprWithCompilationCache, so it is cheap
 // to call this method before/after evaluating the expression.
@@ -131,6 +131,57 @@ TEST(ExprEvalTest, UnknownContainer) {
                "unknown input container: [Z]"));
 }
 
+TEST(PreparedExprTest, Basic) {
+  ASSERT_OK_AND_ASSIGN(
+      auto expr,
+      arolla::expr::CallOp(
+          "math.subtract",
+          {arolla::expr::CallOp("koda_internal.input",
+                                {arolla::expr::Literal(arolla::Text("I")),
+                                 arolla::expr::Literal(arolla::Text("foo"))}),
+           arolla::expr::CallOp(
+               "koda_internal.input",
+               {arolla::expr::Literal(arolla::Text("V")),
+                arolla::expr::Literal(arolla::Text("foo"))})}));
+  ASSERT_OK_AND_ASSIGN(
+      auto prepared_expr,
+      PreparedExpr::Create(expr, {"unused", "foo"}, {"foo"}));
+  auto unused_value = arolla::TypedValue::FromValue(arolla::Text("unused"));
+  for (int i = 0; i < 3; ++i) {
+    auto i_foo_value = arolla::TypedValue::FromValue(i);
+    auto v_foo_value = arolla::TypedValue::FromValue(2);
+    ASSERT_OK_AND_ASSIGN(
+        auto result,
+        prepared_expr->Eval({unused_value.AsRef(), i_foo_value.AsRef()},
+                            {v_foo_value.AsRef()}));
+    EXPECT_THAT(result.As<int32_t>(), IsOkAndHolds(i - 2));
+  }
+  // Different input types.
+  auto i_foo_value = arolla::TypedValue::FromValue(1.5f);
+  auto v_foo_value = arolla::TypedValue::FromValue(0.5f);
+  ASSERT_OK_AND_ASSIGN(
+      auto result,
+      prepared_expr->Eval({unused_value.AsRef(), i_foo_value.AsRef()},
+                          {v_foo_value.AsRef()}));
+  EXPECT_THAT(result.As<float>(), IsOkAndHolds(1.f));
+  EXPECT_THAT(prepared_expr->Eval({i_foo_value.AsRef()}, {}),
+              StatusIs(absl::StatusCode::kInternal));
+}
+
+TEST(PreparedExprTest, Errors) {
+  ASSERT_OK_AND_ASSIGN(
+      auto expr,
+      arolla::expr::CallOp("koda_internal.input",
+                           {arolla::expr::Literal(arolla::Text("V")),
+                            arolla::expr::Literal(arolla::Text("foo"))}));
+  EXPECT_THAT(PreparedExpr::Create(expr, {"foo"}, {}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       "kd.eval() has missing inputs for: [V.foo]"));
+  EXPECT_THAT(PreparedExpr::Create(expr, {}, {"foo", "foo"}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       "variable [foo] passed twice to kd.eval()"));
+}
+
 TEST(GetExprVariablesTest, Basic) {
   ASSERT_OK_AND_ASSIGN(
       auto expr,
@@ -14,17 +14,25 @@
 //
 #include "koladata/functor/call.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <queue>
 #include <stack>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "koladata/data_slice.h"
 #include "koladata/data_slice_qtype.h"
@@ -33,6 +41,8 @@
 #include "koladata/functor/signature.h"
 #include "koladata/functor/signature_storage.h"
 #include "koladata/internal/data_item.h"
+#include "koladata/internal/op_utils/parallel.h"
+#include "arolla/expr/expr_node.h"
 #include "arolla/expr/quote.h"
 #include "arolla/qtype/typed_ref.h"
 #include "arolla/qtype/typed_value.h"
@@ -46,6 +56,9 @@ struct VariableProcessingFrame {
   std::string variable_name;
   std::vector<std::string> dependencies;
   int64_t next_dependency_index = 0;
+  // Exactly one of `expr` and `value` is set.
+  arolla::expr::ExprNodePtr expr;
+  std::optional<arolla::TypedValue> value;
 };
 
 enum class VariableState {
@@ -53,14 +66,26 @@ enum class VariableState {
   kVisited,
 };
 
-// Returns the order in which the variables should be
-// evaluated through topological sorting.
-// We can add caching for this later if needed.
-absl::StatusOr<std::vector<std::string>> GetVariableEvaluationOrder(
-    const DataSlice& functor) {
+// A functor variable prepared for the evaluation.
+struct PreparedVariable {
+  std::string name;
+  // Null if the variable is not an expression. In this case `value` is set.
+  std::shared_ptr<const expr::PreparedExpr> expr;
+  std::optional<arolla::TypedValue> value;
+  // Indices of the direct dependencies in the evaluation order.
+  std::vector<int64_t> dependencies;
+};
+
+// Returns the variables in the order in which they should be evaluated
+// through topological sorting, together with their dependencies. The last
+// variable is always `returns`.
+absl::StatusOr<std::vector<PreparedVariable>> PrepareVariables(
+    const DataSlice& functor, absl::Span<const std::string> input_names) {
   // We implement depth-first search using our own stack to avoid recursion.
   std::stack<VariableProcessingFrame> stack;
   absl::flat_hash_map<std::string, VariableState> variable_state;
+  absl::flat_hash_map<std::string, int64_t> variable_index;
+  std::vector<PreparedVariable> res;
 
   auto reach_variable = [&stack, &functor, &variable_state](
                             absl::string_view variable_name) -> absl::Status {
@@ -79,21 +104,34 @@ absl::StatusOr<std::vector<std::string>> GetVariableEvaluationOrder(
                        variable.item().value<arolla::expr::ExprQuote>().expr());
       ASSIGN_OR_RETURN(auto dependencies, expr::GetExprVariables(expr));
       stack.push({.variable_name = std::string(variable_name),
-                  .dependencies = std::move(dependencies)});
+                  .dependencies = std::move(dependencies),
+                  .expr = std::move(expr)});
     } else {
-      stack.push(
-          {.variable_name = std::string(variable_name), .dependencies = {}});
+      stack.push({.variable_name = std::string(variable_name),
+                  .dependencies = {},
+                  .value = arolla::TypedValue::FromValue(std::move(variable))});
     }
     return absl::OkStatus();
   };
 
   RETURN_IF_ERROR(reach_variable(kReturnsAttrName));
-  std::vector<std::string> res;
   while (!stack.empty()) {
     auto& state = stack.top();
     if (state.next_dependency_index >= state.dependencies.size()) {
       variable_state[state.variable_name] = VariableState::kVisited;
-      res.push_back(state.variable_name);
+      PreparedVariable variable{.name = state.variable_name,
+                                .value = std::move(state.value)};
+      if (state.expr != nullptr) {
+        ASSIGN_OR_RETURN(variable.expr,
+                         expr::PreparedExpr::Create(state.expr, input_names,
+                                                    state.dependencies));
+      }
+      variable.dependencies.reserve(state.dependencies.size());
+      for (const auto& dependency : state.dependencies) {
+        variable.dependencies.push_back(variable_index.at(dependency));
+      }
+      variable_index.emplace(variable.name, res.size());
+      res.push_back(std::move(variable));
       stack.pop();
       continue;
     }
@@ -103,11 +141,129 @@ absl::StatusOr<std::vector<std::string>> GetVariableEvaluationOrder(
   return res;
 }
 
+// Evaluates `variables[index]` and stores the result in `values[index]`. All
+// its dependencies must be already computed.
+absl::Status EvalVariable(
+    absl::Span<const PreparedVariable> variables, int64_t index,
+    absl::Span<const arolla::TypedRef> inputs,
+    absl::Span<std::optional<arolla::TypedValue>> values) {
+  const PreparedVariable& variable = variables[index];
+  absl::InlinedVector<arolla::TypedRef, 8> dependencies;
+  dependencies.reserve(variable.dependencies.size());
+  for (int64_t dependency : variable.dependencies) {
+    dependencies.push_back(values[dependency]->AsRef());
+  }
+  ASSIGN_OR_RETURN(values[index], variable.expr->Eval(inputs, dependencies));
+  return absl::OkStatus();
+}
+
+// Evaluates the variables on up to `max_parallelism` threads: the calling one
+// and the shared thread pool (see internal::ParallelFor). A variable is
+// scheduled once all its dependencies are computed; among the ready variables
+// the one earliest in the evaluation order goes first.
+//
+// A thread that finishes a variable goes on with the variables it made ready,
+// so no thread has to wait for them. Only the calling thread waits, to help
+// with the variables becoming ready later. Pool threads leave as soon as there
+// is no ready variable, so nested parallel calls never park pool threads and
+// can't exhaust the pool.
+//
+// After a failure no variables later in the evaluation order are scheduled,
+// while the earlier ones still are. So the returned error is always the one of
+// the earliest failing variable, i.e. the same as in sequential evaluation.
+absl::Status EvalVariablesInParallel(
+    absl::Span<const PreparedVariable> variables,
+    absl::Span<const arolla::TypedRef> inputs,
+    absl::Span<std::optional<arolla::TypedValue>> values,
+    int64_t max_parallelism) {
+  const int64_t size = variables.size();
+  std::vector<int64_t> pending_dependencies(size, 0);
+  std::vector<std::vector<int64_t>> dependents(size);
+  std::priority_queue<int64_t, std::vector<int64_t>, std::greater<>> ready;
+  int64_t expr_variable_count = 0;
+  for (int64_t i = 0; i < size; ++i) {
+    if (variables[i].expr == nullptr) {
+      continue;
+    }
+    ++expr_variable_count;
+    for (int64_t dependency : variables[i].dependencies) {
+      if (variables[dependency].expr != nullptr) {
+        ++pending_dependencies[i];
+        dependents[dependency].push_back(i);
+      }
+    }
+    if (pending_dependencies[i] == 0) {
+      ready.push(i);
+    }
+  }
+
+  absl::Mutex mutex;
+  absl::CondVar cond_var;
+  int64_t running = 0;
+  int64_t error_index = size;
+  absl::Status error;
+  const std::thread::id calling_thread = std::this_thread::get_id();
+  auto worker = [&]() {
+    const bool is_calling_thread =
+        std::this_thread::get_id() == calling_thread;
+    absl::MutexLock lock(&mutex);
+    while (true) {
+      while (is_calling_thread && ready.empty() && running > 0) {
+        cond_var.Wait(&mutex);
+      }
+      if (ready.empty()) {
+        return;
+      }
+      int64_t index = ready.top();
+      ready.pop();
+      if (index > error_index) {
+        continue;  // Cancelled.
+      }
+      ++running;
+      mutex.Unlock();
+      absl::Status status = EvalVariable(variables, index, inputs, values);
+      mutex.Lock();
+      --running;
+      if (!status.ok()) {
+        if (index < error_index) {
+          error_index = index;
+          error = std::move(status);
+        }
+      } else {
+        for (int64_t dependent : dependents[index]) {
+          if (--pending_dependencies[dependent] == 0) {
+            ready.push(dependent);
+          }
+        }
+      }
+      cond_var.SignalAll();
+    }
+  };
+
+  // The workers run on the shared thread pool, so the number of threads is
+  // bounded across all the concurrent calls.
+  const int64_t worker_count = std::min(
+      {max_parallelism, expr_variable_count, internal::MaxParallelism()});
+  internal::ParallelFor(std::max<int64_t>(worker_count, 1),
+                        [&](int64_t) { worker(); });
+  return error;
+}
+
 }  // namespace
 
-absl::StatusOr<arolla::TypedValue> CallFunctorWithCompilationCache(
-    const DataSlice& functor, absl::Span<const arolla::TypedRef> args,
-    absl::Span<const std::pair<std::string, arolla::TypedRef>> kwargs) {
+struct PreparedFunctor::State {
+  Signature signature;
+  std::vector<PreparedVariable> variables;
+  // Whether to use EvalVariablesInParallel.
+  bool parallel = false;
+  int64_t max_parallelism = 1;
+};
+
+PreparedFunctor::PreparedFunctor(std::shared_ptr<const State> state)
+    : state_(std::move(state)) {}
+
+absl::StatusOr<PreparedFunctor> PrepareFunctor(
+    const DataSlice& functor, const CallFunctorOptions& options) {
   ASSIGN_OR_RETURN(bool is_functor, IsFunctor(functor));
   if (!is_functor) {
     return absl::InvalidArgumentError(
@@ -115,44 +271,73 @@ absl::StatusOr<arolla::TypedValue> CallFunctorWithCompilationCache(
   }
   ASSIGN_OR_RETURN(auto signature_item, functor.GetAttr(kSignatureAttrName));
   ASSIGN_OR_RETURN(auto signature, KodaSignatureToCppSignature(signature_item));
-  ASSIGN_OR_RETURN(auto bound_arguments,
-                   BindArguments(signature, args, kwargs));
-  ASSIGN_OR_RETURN(auto variable_evaluation_order,
-                   GetVariableEvaluationOrder(functor));
-  if (variable_evaluation_order.empty() ||
-      variable_evaluation_order.back() != kReturnsAttrName) {
+  std::vector<std::string> input_names;
+  input_names.reserve(signature.parameters().size());
+  for (const auto& parameter : signature.parameters()) {
+    input_names.push_back(parameter.name);
+  }
+  ASSIGN_OR_RETURN(auto variables, PrepareVariables(functor, input_names));
+  if (variables.empty() || variables.back().name != kReturnsAttrName) {
     return absl::InternalError(
         "variable evaluation order does not end with returns");
   }
-  std::vector<arolla::TypedValue> computed_variable_holder;
-  std::vector<std::pair<std::string, arolla::TypedRef>> inputs;
-  std::vector<std::pair<std::string, arolla::TypedRef>> variables;
-  const auto& parameters = signature.parameters();
-  inputs.reserve(parameters.size());
-  for (int64_t i = 0; i < parameters.size(); ++i) {
-    inputs.emplace_back(parameters[i].name, bound_arguments[i].AsRef());
+  int64_t expr_variable_count = 0;
+  for (const auto& variable : variables) {
+    expr_variable_count += (variable.expr != nullptr);
   }
-  computed_variable_holder.reserve(variable_evaluation_order.size());
-  variables.reserve(variable_evaluation_order.size());
-  for (const auto& variable_name : variable_evaluation_order) {
-    ASSIGN_OR_RETURN(auto variable, functor.GetAttr(variable_name));
-    if (variable.item().holds_value<arolla::expr::ExprQuote>()) {
-      ASSIGN_OR_RETURN(auto expr,
-                       variable.item().value<arolla::expr::ExprQuote>().expr());
-      // This passes all variables computed so far, even those not used, and
-      // EvalExprWithCompilationCache will traverse all provided variables,
-      // so this is O(num_variables**2). We can optimize this later if needed.
-      ASSIGN_OR_RETURN(auto variable_value, expr::EvalExprWithCompilationCache(
-                                                expr, inputs, variables));
-      computed_variable_holder.push_back(std::move(variable_value));
-    } else {
-      computed_variable_holder.push_back(
-          arolla::TypedValue::FromValue(std::move(variable)));
+  // With fewer expression variables there is nothing to evaluate concurrently
+  // with `returns` and its single dependency.
+  bool parallel = options.max_parallelism > 1 && expr_variable_count > 2;
+  return PreparedFunctor(std::make_shared<const State>(
+      State{.signature = std::move(signature),
+            .variables = std::move(variables),
+            .parallel = parallel,
+            .max_parallelism = options.max_parallelism}));
+}
+
+absl::StatusOr<arolla::TypedValue> PreparedFunctor::operator()(
+    absl::Span<const arolla::TypedRef> args,
+    absl::Span<const std::pair<std::string, arolla::TypedRef>> kwargs) const {
+  ASSIGN_OR_RETURN(auto bound_arguments,
+                   BindArguments(state_->signature, args, kwargs));
+  absl::InlinedVector<arolla::TypedRef, 8> inputs;
+  inputs.reserve(bound_arguments.size());
+  for (const auto& argument : bound_arguments) {
+    inputs.push_back(argument.AsRef());
+  }
+  const auto& variables = state_->variables;
+  std::vector<std::optional<arolla::TypedValue>> values(variables.size());
+  for (int64_t i = 0; i < variables.size(); ++i) {
+    values[i] = variables[i].value;
+  }
+  if (state_->parallel) {
+    RETURN_IF_ERROR(EvalVariablesInParallel(variables, inputs,
+                                            absl::MakeSpan(values),
+                                            state_->max_parallelism));
+  } else {
+    for (int64_t i = 0; i < variables.size(); ++i) {
+      if (variables[i].expr != nullptr) {
+        RETURN_IF_ERROR(
+            EvalVariable(variables, i, inputs, absl::MakeSpan(values)));
+      }
     }
-    variables.emplace_back(variable_name,
-                           computed_variable_holder.back().AsRef());
   }
-  return computed_variable_holder.back();
+  return *std::move(values.back());
+}
+
+absl::StatusOr<arolla::TypedValue> CallFunctorWithCompilationCache(
+    const DataSlice& functor, absl::Span<const arolla::TypedRef> args,
+    absl::Span<const std::pair<std::string, arolla::TypedRef>> kwargs) {
+  return CallFunctorWithCompilationCache(functor, args, kwargs,
+                                         CallFunctorOptions());
+}
+
+absl::StatusOr<arolla::TypedValue> CallFunctorWithCompilationCache(
+    const DataSlice& functor, absl::Span<const arolla::TypedRef> args,
+    absl::Span<const std::pair<std::string, arolla::TypedRef>> kwargs,
+    const CallFunctorOptions& options) {
+  ASSIGN_OR_RETURN(auto prepared_functor, PrepareFunctor(functor, options));
+  return prepared_functor(args, kwargs);
 }
 
 }  // namespace koladata::functor
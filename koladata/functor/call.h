@@ -15,6 +15,8 @@
 #ifndef KOLADATA_FUNCTOR_CALL_H_
 #define KOLADATA_FUNCTOR_CALL_H_
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
 
@@ -34,11 +36,62 @@ namespace koladata::functor {
 // in the variable expressions. The expressions can also refer to the variables
 // via V.foo, in which case the variable expression will be evaluated before
 // evaluating the expression that refers to it. In case of a cycle in variables,
-// an error will be returned.
+// an error will be returned. The functor is prepared anew on every call, so for
+// repeated calls of the same functor use PrepareFunctor and keep the result.
 absl::StatusOr<arolla::TypedValue> CallFunctorWithCompilationCache(
     const DataSlice& functor, absl::Span<const arolla::TypedRef> args,
     absl::Span<const std::pair<std::string, arolla::TypedRef>> kwargs);
 
+struct CallFunctorOptions {
+  // The maximum number of threads (including the calling one) used to
+  // evaluate independent variables concurrently. With 1, the variables are
+  // evaluated sequentially in the calling thread. Other threads are taken from
+  // a process-wide pool, so the effective parallelism is also limited by the
+  // number of CPUs.
+  //
+  // The result and the returned error don't depend on this setting, but the
+  // operators used in the functor must be safe to evaluate concurrently.
+  int64_t max_parallelism = 1;
+};
+
+// Same as above, but with the given options.
+absl::StatusOr<arolla::TypedValue> CallFunctorWithCompilationCache(
+    const DataSlice& functor, absl::Span<const arolla::TypedRef> args,
+    absl::Span<const std::pair<std::string, arolla::TypedRef>> kwargs,
+    const CallFunctorOptions& options);
+
+// A functor with its signature, variables and their evaluation order resolved
+// once, so that a call only binds the arguments and evaluates the variables.
+// Changes to the functor's DataBag made after the preparation are not
+// reflected.
+//
+// This class is thread-safe and cheap to copy.
+class PreparedFunctor {
+ public:
+  // Calls the functor, see CallFunctorWithCompilationCache.
+  absl::StatusOr<arolla::TypedValue> operator()(
+      absl::Span<const arolla::TypedRef> args,
+      absl::Span<const std::pair<std::string, arolla::TypedRef>> kwargs) const;
+
+ private:
+  struct State;
+
+  explicit PreparedFunctor(std::shared_ptr<const State> state);
+
+  friend absl::StatusOr<PreparedFunctor> PrepareFunctor(
+      const DataSlice& functor, const CallFunctorOptions& options);
+
+  std::shared_ptr<const State> state_;
+};
+
+// Prepares the given functor for repeated calls. Calling the result is
+// equivalent to CallFunctorWithCompilationCache(functor, ..., options), but
+// avoids the per-call overhead of reading the functor attributes and
+// resolving the variables.
+absl::StatusOr<PreparedFunctor> PrepareFunctor(
+    const DataSlice& functor,
+    const CallFunctorOptions& options = CallFunctorOptions());
+
 }  // namespace koladata::functor
 
 #endif  // KOLADATA_FUNCTOR_CALL_H_
@@ -0,0 +1,144 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "koladata/data_slice.h"
+#include "koladata/functor/call.h"
+#include "koladata/functor/functor.h"
+#include "koladata/functor/signature.h"
+#include "koladata/functor/signature_storage.h"
+#include "koladata/internal/data_item.h"
+#include "koladata/internal/dtype.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/expr/expr.h"
+#include "arolla/expr/expr_node.h"
+#include "arolla/expr/quote.h"
+#include "arolla/qtype/typed_value.h"
+#include "arolla/util/init_arolla.h"
+#include "arolla/util/text.h"
+
+namespace koladata::functor {
+namespace {
+
+arolla::expr::ExprNodePtr CreateInput(absl::string_view name) {
+  return *arolla::expr::CallOp("koda_internal.input",
+                               {arolla::expr::Literal(arolla::Text("I")),
+                                arolla::expr::Literal(arolla::Text(name))});
+}
+
+arolla::expr::ExprNodePtr CreateVariable(absl::string_view name) {
+  return *arolla::expr::CallOp("koda_internal.input",
+                               {arolla::expr::Literal(arolla::Text("V")),
+                                arolla::expr::Literal(arolla::Text(name))});
+}
+
+DataSlice WrapExpr(arolla::expr::ExprNodePtr expr) {
+  return *DataSlice::Create(
+      internal::DataItem(arolla::expr::ExprQuote(std::move(expr))),
+      internal::DataItem(schema::kExpr));
+}
+
+// Creates a functor of a single argument `a` with `variable_count`
+// independent variables `x_i = a * i` summed up in `returns`.
+DataSlice CreateFunctorWithIndependentVariables(int64_t variable_count) {
+  auto signature = Signature::Create(
+      {{.name = "a",
+        .kind = Signature::Parameter::Kind::kPositionalOrKeyword}});
+  CHECK_OK(signature);
+  auto koda_signature = CppSignatureToKodaSignature(*signature);
+  CHECK_OK(koda_signature);
+  std::vector<std::pair<std::string, DataSlice>> variables;
+  arolla::expr::ExprNodePtr returns = CreateInput("a");
+  for (int64_t i = 0; i < variable_count; ++i) {
+    std::string name = absl::StrCat("x", i);
+    variables.emplace_back(
+        name, WrapExpr(*arolla::expr::CallOp(
+                  "math.multiply",
+                  {CreateInput("a"),
+                   arolla::expr::Literal(static_cast<float>(i))})));
+    returns =
+        *arolla::expr::CallOp("math.add", {returns, CreateVariable(name)});
+  }
+  auto fn = CreateFunctor(WrapExpr(returns), *koda_signature, variables);
+  CHECK_OK(fn);
+  return *std::move(fn);
+}
+
+void BM_CallFunctor(benchmark::State& state) {
+  arolla::InitArolla();
+  int64_t variable_count = state.range(0);
+  int64_t input_size = state.range(1);
+  int64_t max_parallelism = state.range(2);
+  DataSlice fn = CreateFunctorWithIndependentVariables(variable_count);
+  auto input = arolla::TypedValue::FromValue(
+      arolla::CreateConstDenseArray<float>(input_size, 1.f));
+  CallFunctorOptions options{.max_parallelism = max_parallelism};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fn);
+    auto result =
+        CallFunctorWithCompilationCache(fn, {input.AsRef()}, {}, options);
+    CHECK_OK(result);
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+// Same as BM_CallFunctor, but the functor is prepared once outside the loop.
+void BM_CallPreparedFunctor(benchmark::State& state) {
+  arolla::InitArolla();
+  int64_t variable_count = state.range(0);
+  int64_t input_size = state.range(1);
+  int64_t max_parallelism = state.range(2);
+  DataSlice fn = CreateFunctorWithIndependentVariables(variable_count);
+  auto input = arolla::TypedValue::FromValue(
+      arolla::CreateConstDenseArray<float>(input_size, 1.f));
+  auto prepared_fn =
+      PrepareFunctor(fn, {.max_parallelism = max_parallelism});
+  CHECK_OK(prepared_fn);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(input);
+    auto result = (*prepared_fn)({input.AsRef()}, {});
+    CHECK_OK(result);
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+BENCHMARK(BM_CallFunctor)
+    // Tiny functors, the scheduling overhead dominates.
+    ->Args({0, 1, 1})
+    ->Args({0, 1, 8})
+    ->Args({1, 1, 1})
+    ->Args({1, 1, 8})
+    ->Args({16, 1, 1})
+    ->Args({16, 1, 8})
+    // Heavy independent variables.
+    ->Args({16, 1000000, 1})
+    ->Args({16, 1000000, 8});
+
+BENCHMARK(BM_CallPreparedFunctor)
+    ->Args({0, 1, 1})
+    ->Args({1, 1, 1})
+    ->Args({16, 1, 1})
+    ->Args({16, 1, 8})
+    ->Args({16, 1000000, 8});
+
+}  // namespace
+}  // namespace koladata::functor
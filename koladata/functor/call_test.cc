@@ -17,6 +17,7 @@
 #include "koladata/functor/call.h"
 
 #include <cstdint>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -25,6 +26,7 @@
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "koladata/data_slice.h"
 #include "koladata/functor/functor.h"
@@ -32,6 +34,7 @@
 #include "koladata/functor/signature_storage.h"
 #include "koladata/internal/data_item.h"
 #include "koladata/internal/dtype.h"
+#include "koladata/internal/op_utils/parallel.h"
 #include "koladata/testing/matchers.h"
 #include "arolla/expr/expr.h"
 #include "arolla/expr/expr_node.h"
@@ -48,6 +51,7 @@ namespace {
 using ::absl_testing::IsOkAndHolds;
 using ::absl_testing::StatusIs;
 using ::koladata::testing::IsEquivalentTo;
+using ::testing::HasSubstr;
 
 absl::StatusOr<arolla::expr::ExprNodePtr> CreateInput(absl::string_view name) {
   return arolla::expr::CallOp("koda_internal.input",
@@ -236,6 +240,135 @@ TEST(CallTest, EvalError) {
                "expression"));
 }
 
+TEST(CallTest, PrepareFunctor) {
+  Signature::Parameter p1 = {
+      .name = "a",
+      .kind = Signature::Parameter::Kind::kPositionalOrKeyword,
+  };
+  ASSERT_OK_AND_ASSIGN(auto signature, Signature::Create({p1}));
+  ASSERT_OK_AND_ASSIGN(auto koda_signature,
+                       CppSignatureToKodaSignature(signature));
+  ASSERT_OK_AND_ASSIGN(
+      auto returns_expr,
+      WrapExpr(arolla::expr::CallOp("math.add",
+                                    {CreateVariable("x"), CreateInput("a")})));
+  ASSERT_OK_AND_ASSIGN(
+      auto x_expr,
+      WrapExpr(arolla::expr::CallOp(
+          "math.multiply", {CreateInput("a"), arolla::expr::Literal(2)})));
+  ASSERT_OK_AND_ASSIGN(
+      auto fn, CreateFunctor(returns_expr, koda_signature, {{"x", x_expr}}));
+  ASSERT_OK_AND_ASSIGN(auto prepared_fn, PrepareFunctor(fn));
+  for (int i = 0; i < 3; ++i) {
+    auto input = arolla::TypedValue::FromValue(i);
+    ASSERT_OK_AND_ASSIGN(auto result, prepared_fn({input.AsRef()}, {}));
+    EXPECT_THAT(result.As<int32_t>(), IsOkAndHolds(3 * i));
+    ASSERT_OK_AND_ASSIGN(result, prepared_fn({}, {{"a", input.AsRef()}}));
+    EXPECT_THAT(result.As<int32_t>(), IsOkAndHolds(3 * i));
+  }
+  // Different input type.
+  auto float_input = arolla::TypedValue::FromValue(1.5f);
+  ASSERT_OK_AND_ASSIGN(auto result, prepared_fn({float_input.AsRef()}, {}));
+  EXPECT_THAT(result.As<float>(), IsOkAndHolds(4.5f));
+
+  EXPECT_THAT(prepared_fn({}, {}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("no value provided for")));
+  EXPECT_THAT(PrepareFunctor(fn.WithBag(nullptr)),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       "the first argument of kd.call must be a functor"));
+}
+
+TEST(CallTest, ParallelVariables) {
+  Signature::Parameter p1 = {
+      .name = "a",
+      .kind = Signature::Parameter::Kind::kPositionalOrKeyword,
+  };
+  ASSERT_OK_AND_ASSIGN(auto signature, Signature::Create({p1}));
+  ASSERT_OK_AND_ASSIGN(auto koda_signature,
+                       CppSignatureToKodaSignature(signature));
+  // returns = (V.x0 + V.x1) + ... + V.x7, x_i = I.a * i.
+  constexpr int kVariableCount = 8;
+  std::vector<std::pair<std::string, DataSlice>> variables;
+  absl::StatusOr<arolla::expr::ExprNodePtr> returns = arolla::expr::Literal(0);
+  for (int i = 0; i < kVariableCount; ++i) {
+    std::string name = absl::StrCat("x", i);
+    ASSERT_OK_AND_ASSIGN(
+        auto var_expr,
+        WrapExpr(arolla::expr::CallOp(
+            "math.multiply", {CreateInput("a"), arolla::expr::Literal(i)})));
+    variables.emplace_back(name, var_expr);
+    returns = arolla::expr::CallOp("math.add", {returns, CreateVariable(name)});
+  }
+  ASSERT_OK_AND_ASSIGN(auto returns_expr, WrapExpr(returns));
+  ASSERT_OK_AND_ASSIGN(auto fn,
+                       CreateFunctor(returns_expr, koda_signature, variables));
+  auto input = arolla::TypedValue::FromValue(3);
+  for (int64_t max_parallelism : {1, 2, 4, 16}) {
+    ASSERT_OK_AND_ASSIGN(
+        auto result,
+        CallFunctorWithCompilationCache(
+            fn, {input.AsRef()}, {},
+            CallFunctorOptions{.max_parallelism = max_parallelism}));
+    EXPECT_THAT(result.As<int32_t>(), IsOkAndHolds(3 * 28));
+  }
+
+  // Parallel calls nested into the tasks of the shared thread pool must not
+  // exhaust it.
+  constexpr int kCallCount = 64;
+  std::vector<absl::StatusOr<arolla::TypedValue>> results(
+      kCallCount, absl::UnknownError("not called"));
+  internal::ParallelFor(kCallCount, [&](int64_t call_id) {
+    results[call_id] = CallFunctorWithCompilationCache(
+        fn, {input.AsRef()}, {}, CallFunctorOptions{.max_parallelism = 4});
+  });
+  for (const auto& result : results) {
+    ASSERT_OK(result);
+    EXPECT_THAT(result->As<int32_t>(), IsOkAndHolds(3 * 28));
+  }
+}
+
+TEST(CallTest, ParallelVariablesError) {
+  Signature::Parameter p1 = {
+      .name = "a",
+      .kind = Signature::Parameter::Kind::kPositionalOrKeyword,
+  };
+  ASSERT_OK_AND_ASSIGN(auto signature, Signature::Create({p1}));
+  ASSERT_OK_AND_ASSIGN(auto koda_signature,
+                       CppSignatureToKodaSignature(signature));
+  ASSERT_OK_AND_ASSIGN(
+      auto returns_expr,
+      WrapExpr(arolla::expr::CallOp(
+          "math.add",
+          {arolla::expr::CallOp("math.add",
+                                {CreateVariable("x"), CreateVariable("y")}),
+           CreateVariable("z")})));
+  ASSERT_OK_AND_ASSIGN(auto x_expr, WrapExpr(CreateInput("a")));
+  ASSERT_OK_AND_ASSIGN(
+      auto y_expr,
+      WrapExpr(arolla::expr::CallOp(
+          "math.floordiv", {CreateInput("a"), arolla::expr::Literal(0)})));
+  ASSERT_OK_AND_ASSIGN(
+      auto z_expr,
+      WrapExpr(arolla::expr::CallOp(
+          "math.multiply", {CreateInput("a"), arolla::expr::Literal(2)})));
+  ASSERT_OK_AND_ASSIGN(
+      auto fn, CreateFunctor(returns_expr, koda_signature,
+                             {{"x", x_expr}, {"y", y_expr}, {"z", z_expr}}));
+  auto input = arolla::TypedValue::FromValue(3);
+  absl::Status sequential_status =
+      CallFunctorWithCompilationCache(fn, {input.AsRef()}, {}).status();
+  EXPECT_THAT(sequential_status, StatusIs(absl::StatusCode::kInvalidArgument,
+                                          HasSubstr("division by zero")));
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(CallFunctorWithCompilationCache(
+                  fn, {input.AsRef()}, {},
+                  CallFunctorOptions{.max_parallelism = 4})
+                  .status(),
+              sequential_status);
+  }
+}
+
 }  // namespace
 
 }  // namespace koladata::functor
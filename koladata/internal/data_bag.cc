@@ -35,11 +35,13 @@
 #include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/numeric/int128.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "koladata/internal/data_item.h"
 #include "koladata/internal/data_list.h"
@@ -51,11 +53,14 @@
 #include "koladata/internal/error.pb.h"
 #include "koladata/internal/error_utils.h"
 #include "koladata/internal/object_id.h"
+#include "koladata/internal/op_utils/parallel.h"
 #include "koladata/internal/op_utils/presence_or.h"
 #include "koladata/internal/schema_utils.h"
 #include "koladata/internal/slice_builder.h"
 #include "koladata/internal/sparse_source.h"
+#include "koladata/internal/stable_fingerprint.h"
 #include "koladata/internal/uuid_object.h"
+#include "arolla/dense_array/bitmap.h"
 #include "arolla/dense_array/dense_array.h"
 #include "arolla/dense_array/edge.h"
 #include "arolla/dense_array/ops/dense_ops.h"
@@ -63,6 +68,8 @@
 #include "arolla/memory/optional_value.h"
 #include "arolla/qtype/qtype.h"
 #include "arolla/qtype/qtype_traits.h"
+#include "arolla/util/fingerprint.h"
+#include "arolla/util/meta.h"
 #include "arolla/util/refcount_ptr.h"
 #include "arolla/util/text.h"
 #include "arolla/util/unit.h"
@@ -302,6 +309,191 @@ MergeOptions::ConflictHandlingOption ReverseConflictHandlingOption(
   return MergeOptions::kRaiseOnConflict;
 }
 
+// Minimal number of values copied by one thread in batch list operations.
+constexpr int64_t kMinListValuesPerThread = int64_t{1} << 18;
+
+// Value types that batch list operations copy directly into preallocated
+// buffers, bypassing SliceBuilder.
+using TriviallyCopiedListValueTypes =
+    arolla::meta::type_list<ObjectId, int32_t, int64_t, float, double, bool>;
+
+// Returns the type of the values of all `lists` if they are stored in the same
+// typed representation, or nullptr otherwise. Null lists and lists without
+// values are compatible with any type.
+const arolla::QType* CommonListsDType(absl::Span<const DataList* const> lists) {
+  const arolla::QType* res = arolla::GetNothingQType();
+  for (const DataList* list : lists) {
+    if (list == nullptr) {
+      continue;
+    }
+    const arolla::QType* dtype = list->dtype();
+    if (dtype == arolla::GetNothingQType()) {
+      continue;
+    }
+    if (dtype == nullptr ||
+        (res != arolla::GetNothingQType() && res != dtype)) {
+      return nullptr;
+    }
+    res = dtype;
+  }
+  return res;
+}
+
+// Creates DataSliceImpl from values copied by `ForEachBitmapAlignedRange`.
+template <typename T>
+DataSliceImpl CreateFromCopiedListValues(
+    typename arolla::Buffer<T>::Builder values_bldr,
+    arolla::bitmap::Bitmap::Builder presence_bldr,
+    absl::Span<const AllocationIdSet> thread_alloc_ids) {
+  arolla::DenseArray<T> values{std::move(values_bldr).Build(),
+                               std::move(presence_bldr).Build()};
+  if constexpr (std::is_same_v<T, ObjectId>) {
+    AllocationIdSet alloc_ids;
+    for (const AllocationIdSet& ids : thread_alloc_ids) {
+      alloc_ids.Insert(ids);
+    }
+    return DataSliceImpl::CreateObjectsDataSlice(std::move(values),
+                                                 std::move(alloc_ids));
+  } else {
+    return DataSliceImpl::Create(std::move(values));
+  }
+}
+
+// Copies `lists[i][range]` to positions [split_points[i], split_points[i+1])
+// of the result. All non-null lists must store values of type `T` or have no
+// values.
+template <typename T>
+DataSliceImpl ExplodeTypedLists(absl::Span<const DataList* const> lists,
+                                absl::Span<const int64_t> split_points,
+                                DataBagImpl::ListRange range) {
+  int64_t size = split_points.back();
+  typename arolla::Buffer<T>::Builder values_bldr(size);
+  arolla::bitmap::Bitmap::Builder presence_bldr(
+      arolla::bitmap::BitmapSize(size));
+  absl::Span<T> values = values_bldr.GetMutableSpan();
+  absl::Span<arolla::bitmap::Word> presence = presence_bldr.GetMutableSpan();
+  int64_t num_threads = ParallelTaskCount(size, kMinListValuesPerThread);
+  std::vector<AllocationIdSet> thread_alloc_ids(num_threads);
+
+  ForEachBitmapAlignedRange(size, num_threads, [&](int64_t thread_id,
+                                                   int64_t begin, int64_t end) {
+    std::fill(presence.begin() + begin / arolla::bitmap::kWordBitCount,
+              presence.begin() + arolla::bitmap::BitmapSize(end), 0);
+    DataBagImpl::ListRange thread_range = range;
+    AllocationIdSet& alloc_ids = thread_alloc_ids[thread_id];
+    // The only non-empty list that contains position `begin`.
+    int64_t list_idx = std::upper_bound(split_points.begin(),
+                                        split_points.end(), begin) -
+                       split_points.begin() - 1;
+    for (int64_t offset = begin; offset < end; ++list_idx) {
+      int64_t list_end = std::min(split_points[list_idx + 1], end);
+      if (offset >= list_end) {
+        continue;
+      }
+      const DataList& list = *lists[list_idx];
+      absl::Span<const std::optional<T>> list_values = list.typed_values<T>();
+      if (list_values.empty()) {
+        std::fill(values.begin() + offset, values.begin() + list_end, T());
+        offset = list_end;
+        continue;
+      }
+      int64_t from = thread_range.CalculateFrom(list.size()) + offset -
+                     split_points[list_idx];
+      for (; offset < list_end; ++offset, ++from) {
+        const std::optional<T>& value = list_values[from];
+        values[offset] = value.value_or(T());
+        if (value.has_value()) {
+          arolla::bitmap::SetBit(presence.data(), offset);
+          if constexpr (std::is_same_v<T, ObjectId>) {
+            alloc_ids.Insert(AllocationId(*value));
+          }
+        }
+      }
+    }
+  });
+  return CreateFromCopiedListValues<T>(std::move(values_bldr),
+                                       std::move(presence_bldr),
+                                       thread_alloc_ids);
+}
+
+// Returns `lists[i][positions[i]]` for each `i`. All non-null lists must store
+// values of type `T` or have no values, `positions` of non-null lists must be
+// valid.
+template <typename T>
+DataSliceImpl GetFromTypedLists(absl::Span<const DataList* const> lists,
+                                absl::Span<const int64_t> positions) {
+  int64_t size = lists.size();
+  typename arolla::Buffer<T>::Builder values_bldr(size);
+  arolla::bitmap::Bitmap::Builder presence_bldr(
+      arolla::bitmap::BitmapSize(size));
+  absl::Span<T> values = values_bldr.GetMutableSpan();
+  absl::Span<arolla::bitmap::Word> presence = presence_bldr.GetMutableSpan();
+  int64_t num_threads = ParallelTaskCount(size, kMinListValuesPerThread);
+  std::vector<AllocationIdSet> thread_alloc_ids(num_threads);
+
+  ForEachBitmapAlignedRange(size, num_threads, [&](int64_t thread_id,
+                                                   int64_t begin, int64_t end) {
+    std::fill(presence.begin() + begin / arolla::bitmap::kWordBitCount,
+              presence.begin() + arolla::bitmap::BitmapSize(end), 0);
+    AllocationIdSet& alloc_ids = thread_alloc_ids[thread_id];
+    for (int64_t offset = begin; offset < end; ++offset) {
+      values[offset] = T();
+      if (lists[offset] == nullptr) {
+        continue;
+      }
+      absl::Span<const std::optional<T>> list_values =
+          lists[offset]->typed_values<T>();
+      if (list_values.empty()) {
+        continue;
+      }
+      if (const std::optional<T>& value = list_values[positions[offset]];
+          value.has_value()) {
+        values[offset] = *value;
+        arolla::bitmap::SetBit(presence.data(), offset);
+        if constexpr (std::is_same_v<T, ObjectId>) {
+          alloc_ids.Insert(AllocationId(*value));
+        }
+      }
+    }
+  });
+  return CreateFromCopiedListValues<T>(std::move(values_bldr),
+                                       std::move(presence_bldr),
+                                       thread_alloc_ids);
+}
+
+// Minimal number of keys inserted by one thread in bulk dict operations.
+constexpr int64_t kMinDictKeysPerThread = int64_t{1} << 16;
+
+absl::Status VerifyDictKeyTypes(const DataSliceImpl& keys) {
+  const arolla::QType* unsupported_key_type = nullptr;
+  keys.VisitValues([&]<typename T>(const arolla::DenseArray<T>&) {
+    if (Dict::IsUnsupportedKeyType<T>()) {
+      unsupported_key_type = arolla::GetQType<T>();
+    }
+  });
+  if (unsupported_key_type) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("invalid key type: ", unsupported_key_type->name()));
+  }
+  return absl::OkStatus();
+}
+
+// Calls `fn(arolla::meta::type<T>())` if `dtype` is one of
+// TriviallyCopiedListValueTypes and returns its result, otherwise returns
+// nullopt.
+template <typename Fn>
+std::optional<DataSliceImpl> VisitTriviallyCopiedListValueType(
+    const arolla::QType* dtype, Fn fn) {
+  std::optional<DataSliceImpl> res;
+  arolla::meta::foreach_type(TriviallyCopiedListValueTypes(), [&](auto tpe) {
+    using T = typename decltype(tpe)::type;
+    if (dtype == arolla::GetQType<T>()) {
+      res = fn(tpe);
+    }
+  });
+  return res;
+}
+
 }  // namespace
 
 MergeOptions ReverseMergeOptions(const MergeOptions& options) {
@@ -323,6 +515,16 @@ DataBagImplPtr DataBagImpl::PartiallyPersistentFork() const {
   auto res_db = DataBagImpl::CreateEmptyDatabag();
   res_db->parent_data_bag_ =
       IsPristine() ? parent_data_bag_ : DataBagImplConstPtr::NewRef(this);
+  if (modification_tracked_.load(std::memory_order_relaxed)) {
+    absl::MutexLock lock(&modification_tracking_mutex_);
+    if (modification_tracking_ != nullptr) {
+      for (const auto& weak_tracker : modification_tracking_->trackers) {
+        if (ModificationTrackerPtr tracker = weak_tracker.lock()) {
+          res_db->GetModificationSnapshot(tracker);
+        }
+      }
+    }
+  }
   return res_db;
 }
 
@@ -368,42 +570,29 @@ DataItem DataBagImpl::LookupAttrInDataSourcesMap(ObjectId object_id,
 }
 
 SparseSource& DataBagImpl::GetMutableSmallAllocSource(absl::string_view attr) {
+  OnContentPartModified(ContentPart::kSmallAllocAttr, AllocationId(), attr);
   return small_alloc_sources_[attr];
 }
 
-absl::StatusOr<DataSliceImpl> DataBagImpl::GetAttr(
-    const DataSliceImpl& objects, absl::string_view attr,
-    FallbackSpan fallbacks) const {
-  if (objects.is_empty_and_unknown()) {
-    return DataSliceImpl::CreateEmptyAndUnknownType(objects.size());
-  }
-  if (objects.dtype() != arolla::GetQType<ObjectId>()) {
-    return absl::FailedPreconditionError(
-        "getting attributes of primitives is not allowed");
-  }
+namespace {
+
+// Gathers attribute values of `objects` (holding ObjectIds) from the data
+// sources of `databag_count` DataBagImpls; earlier DataBagImpls have priority.
+// `get_sources(i, dense_sources, sparse_sources)` appends the data sources of
+// the i-th DataBagImpl. `objects_mask` is computed if not provided.
+template <typename GetSourcesFn>
+DataSliceImpl GetAttrFromSources(
+    const DataSliceImpl& objects, size_t databag_count,
+    GetSourcesFn get_sources,
+    const arolla::DenseArray<arolla::Unit>* objects_mask = nullptr) {
   const arolla::DenseArray<ObjectId>& objs = objects.values<ObjectId>();
   absl::Span<const ObjectId> objs_span = objs.values.span();
 
-  auto next_fallback = [&fallbacks]() -> const DataBagImpl* {
-    if (fallbacks.empty()) {
-      return nullptr;
-    }
-    auto res = fallbacks.front();
-    fallbacks = fallbacks.subspan(1);
-    return res;
-  };
-
   std::optional<SliceBuilder> bldr;
-  for (const DataBagImpl* db = this; db != nullptr; db = next_fallback()) {
-    ConstDenseSourceArray dense_sources;
-    ConstSparseSourceArray sparse_sources;
-    if (objects.allocation_ids().contains_small_allocation_id()) {
-      db->GetSmallAllocDataSources(attr, sparse_sources);
-    }
-    for (AllocationId alloc_id : objects.allocation_ids()) {
-      db->GetAttributeDataSources(alloc_id, attr, dense_sources,
-                                  sparse_sources);
-    }
+  for (size_t db_index = 0; db_index < databag_count; ++db_index) {
+    DataBagImpl::ConstDenseSourceArray dense_sources;
+    DataBagImpl::ConstSparseSourceArray sparse_sources;
+    get_sources(db_index, dense_sources, sparse_sources);
     if (dense_sources.empty() && sparse_sources.empty()) {
       continue;
     }
@@ -411,7 +600,7 @@ absl::StatusOr<DataSliceImpl> DataBagImpl::GetAttr(
     if (!bldr.has_value()) {
       // Performance optimization: get data from a single dense source without
       // creating a builder.
-      if (fallbacks.empty() && sparse_sources.empty() &&
+      if (db_index + 1 == databag_count && sparse_sources.empty() &&
           dense_sources.size() == 1) {
         bool check_alloc_id =
           objects.allocation_ids().contains_small_allocation_id() ||
@@ -420,7 +609,8 @@ absl::StatusOr<DataSliceImpl> DataBagImpl::GetAttr(
       }
 
       bldr.emplace(objs.size());
-      bldr->ApplyMask(objs.ToMask());
+      bldr->ApplyMask(objects_mask != nullptr ? *objects_mask
+                                              : objs.ToMask());
     }
 
     // Sparse sources have priority over dense sources.
@@ -449,6 +639,105 @@ absl::StatusOr<DataSliceImpl> DataBagImpl::GetAttr(
   }
 }
 
+// Minimal number of attribute values gathered by one thread in GetAttrs.
+constexpr int64_t kMinAttrValuesPerThread = int64_t{1} << 18;
+
+}  // namespace
+
+absl::StatusOr<DataSliceImpl> DataBagImpl::GetAttr(
+    const DataSliceImpl& objects, absl::string_view attr,
+    FallbackSpan fallbacks) const {
+  if (objects.is_empty_and_unknown()) {
+    return DataSliceImpl::CreateEmptyAndUnknownType(objects.size());
+  }
+  if (objects.dtype() != arolla::GetQType<ObjectId>()) {
+    return absl::FailedPreconditionError(
+        "getting attributes of primitives is not allowed");
+  }
+  return GetAttrFromSources(
+      objects, fallbacks.size() + 1,
+      [&](size_t db_index, ConstDenseSourceArray& dense_sources,
+          ConstSparseSourceArray& sparse_sources) {
+        const DataBagImpl* db =
+            db_index == 0 ? this : fallbacks[db_index - 1];
+        if (objects.allocation_ids().contains_small_allocation_id()) {
+          db->GetSmallAllocDataSources(attr, sparse_sources);
+        }
+        for (AllocationId alloc_id : objects.allocation_ids()) {
+          db->GetAttributeDataSources(alloc_id, attr, dense_sources,
+                                      sparse_sources);
+        }
+      });
+}
+
+absl::StatusOr<std::vector<DataSliceImpl>> DataBagImpl::GetAttrs(
+    const DataSliceImpl& objects, absl::Span<const absl::string_view> attrs,
+    FallbackSpan fallbacks) const {
+  std::vector<DataSliceImpl> result(attrs.size());
+  if (objects.is_empty_and_unknown()) {
+    for (DataSliceImpl& values : result) {
+      values = DataSliceImpl::CreateEmptyAndUnknownType(objects.size());
+    }
+    return result;
+  }
+  if (objects.dtype() != arolla::GetQType<ObjectId>()) {
+    return absl::FailedPreconditionError(
+        "getting attributes of primitives is not allowed");
+  }
+
+  // Data sources of the i-th attribute in the j-th DataBagImpl are stored at
+  // i * databag_count + j.
+  struct DataSources {
+    ConstDenseSourceArray dense;
+    ConstSparseSourceArray sparse;
+  };
+  size_t databag_count = fallbacks.size() + 1;
+  std::vector<DataSources> sources(attrs.size() * databag_count);
+  const AllocationIdSet& alloc_ids = objects.allocation_ids();
+  for (size_t db_index = 0; db_index < databag_count; ++db_index) {
+    const DataBagImpl* db = db_index == 0 ? this : fallbacks[db_index - 1];
+    if (alloc_ids.contains_small_allocation_id()) {
+      for (size_t i = 0; i < attrs.size(); ++i) {
+        db->GetSmallAllocDataSources(
+            attrs[i], sources[i * databag_count + db_index].sparse);
+      }
+    }
+    for (AllocationId alloc_id : alloc_ids) {
+      for (size_t i = 0; i < attrs.size(); ++i) {
+        DataSources& attr_sources = sources[i * databag_count + db_index];
+        db->GetAttributeDataSources(alloc_id, attrs[i], attr_sources.dense,
+                                    attr_sources.sparse);
+      }
+    }
+  }
+
+  arolla::DenseArray<arolla::Unit> objects_mask =
+      objects.values<ObjectId>().ToMask();
+  auto get_attr = [&](size_t attr_index) {
+    result[attr_index] = GetAttrFromSources(
+        objects, databag_count,
+        [&](size_t db_index, ConstDenseSourceArray& dense_sources,
+            ConstSparseSourceArray& sparse_sources) {
+          const DataSources& attr_sources =
+              sources[attr_index * databag_count + db_index];
+          dense_sources = attr_sources.dense;
+          sparse_sources = attr_sources.sparse;
+        },
+        &objects_mask);
+  };
+
+  int64_t num_threads = std::min<int64_t>(
+      ParallelTaskCount(objects.size() * static_cast<int64_t>(attrs.size()),
+                        kMinAttrValuesPerThread),
+      attrs.size());
+  ParallelFor(num_threads, [&](int64_t thread_id) {
+    for (size_t i = thread_id; i < attrs.size(); i += num_threads) {
+      get_attr(i);
+    }
+  });
+  return result;
+}
+
 absl::StatusOr<DataItem> DataBagImpl::GetAttr(const DataItem& object,
                                               absl::string_view attr,
                                               FallbackSpan fallbacks) const {
@@ -607,6 +896,21 @@ absl::Status DataBagImpl::GetOrCreateMutableSourceInCollection(
   return absl::OkStatus();
 }
 
+absl::Status DataBagImpl::ReserveAttrForAllocation(
+    AllocationId alloc_id, absl::string_view attr,
+    const arolla::QType* main_type) {
+  if (alloc_id.IsSmall()) {
+    return absl::InvalidArgumentError(
+        "dense storage can not be reserved for small allocations");
+  }
+  SourceCollection& collection = GetOrCreateSourceCollection(alloc_id, attr);
+  if (collection.mutable_dense_source) {
+    return absl::OkStatus();
+  }
+  return CreateMutableDenseSource(collection, alloc_id, attr, main_type,
+                                  alloc_id.Capacity());
+}
+
 absl::StatusOr<DataSliceImpl>
 DataBagImpl::InternalSetUnitAttrAndReturnMissingObjects(
     const DataSliceImpl& objects, absl::string_view attr) {
@@ -699,6 +1003,7 @@ absl::StatusOr<DataSliceImpl> DataBagImpl::CreateObjectsFromFields(
       ASSIGN_OR_RETURN(
           source, DenseSource::CreateReadonly(alloc_id, slices[i]));
     }
+    OnContentPartModified(ContentPart::kAttr, alloc_id, attr_names[i]);
     sources_.emplace(SourceKey{alloc_id, std::string(attr_names[i])},
                      SourceCollection{.const_dense_source = std::move(source),
                                       .lookup_parent = false});
@@ -786,6 +1091,7 @@ absl::Status DataBagImpl::CreateMutableDenseSource(
 
 DataBagImpl::SourceCollection& DataBagImpl::GetOrCreateSourceCollection(
     AllocationId alloc_id, absl::string_view attr) {
+  OnContentPartModified(ContentPart::kAttr, alloc_id, attr);
   auto [it, _] = sources_.emplace(
       SourceKeyView{alloc_id, attr},
       SourceCollection{.lookup_parent = parent_data_bag_ != nullptr});
@@ -986,6 +1292,7 @@ const DataList& DataBagImpl::GetFirstPresentList(
 
 DataListVector& DataBagImpl::GetOrCreateMutableLists(AllocationId alloc_id) {
   DCHECK(alloc_id.IsListsAlloc());
+  OnContentPartModified(ContentPart::kLists, alloc_id);
   auto [it, inserted] = lists_.try_emplace(alloc_id);
   if (inserted) {
     const std::shared_ptr<DataListVector>* parent_lists = nullptr;
@@ -1047,14 +1354,17 @@ absl::StatusOr<DataSliceImpl> DataBagImpl::GetFromLists(
   }
 
   ReadOnlyListGetter list_getter(this);
-  SliceBuilder bldr(lists.size());
+  // The first pass resolves the lists, the second one copies the values.
+  std::vector<const DataList*> list_ptrs(lists.size(), nullptr);
+  std::vector<int64_t> positions(lists.size());
 
   auto set_from_list = [&](int64_t offset, const DataList& list, int64_t pos) {
     if (pos < 0) {
       pos += list.size();
     }
     if (pos >= 0 && pos < list.size()) {
-      bldr.InsertIfNotSetAndUpdateAllocIds(offset, list.Get(pos));
+      list_ptrs[offset] = &list;
+      positions[offset] = pos;
     }
     // Note: we don't return an error if `pos` is out of range.
   };
@@ -1079,6 +1389,20 @@ absl::StatusOr<DataSliceImpl> DataBagImpl::GetFromLists(
   }
 
   RETURN_IF_ERROR(list_getter.status());
+  std::optional<DataSliceImpl> res = VisitTriviallyCopiedListValueType(
+      CommonListsDType(list_ptrs), [&](auto tpe) {
+        using T = typename decltype(tpe)::type;
+        return GetFromTypedLists<T>(list_ptrs, positions);
+      });
+  if (res.has_value()) {
+    return *std::move(res);
+  }
+  SliceBuilder bldr(lists.size());
+  for (int64_t i = 0; i < lists.size(); ++i) {
+    if (const DataList* list = list_ptrs[i]; list != nullptr) {
+      bldr.InsertIfNotSetAndUpdateAllocIds(i, list->Get(positions[i]));
+    }
+  }
   return std::move(bldr).Build();
 }
 
@@ -1166,19 +1490,27 @@ DataBagImpl::ExplodeLists(const DataSliceImpl& lists, ListRange range,
   RETURN_IF_ERROR(list_getter.status());
 
   arolla::Buffer<int64_t> split_points = std::move(split_points_bldr).Build();
-  SliceBuilder slice_bldr(cum_size);
-  for (int64_t i = 0; i < lists.size(); ++i) {
-    if (const DataList* list = list_ptrs[i]; list != nullptr) {
-      auto [from, to] = range.Calculate(list->size());
-      if (from < to) {
-        list->AddToDataSlice(slice_bldr, split_points[i], from, to);
+  std::optional<DataSliceImpl> values = VisitTriviallyCopiedListValueType(
+      CommonListsDType(list_ptrs), [&](auto tpe) {
+        using T = typename decltype(tpe)::type;
+        return ExplodeTypedLists<T>(list_ptrs, split_points.span(), range);
+      });
+  if (!values.has_value()) {
+    SliceBuilder slice_bldr(cum_size);
+    for (int64_t i = 0; i < lists.size(); ++i) {
+      if (const DataList* list = list_ptrs[i]; list != nullptr) {
+        auto [from, to] = range.Calculate(list->size());
+        if (from < to) {
+          list->AddToDataSlice(slice_bldr, split_points[i], from, to);
+        }
       }
     }
+    values = std::move(slice_bldr).Build();
   }
 
   ASSIGN_OR_RETURN(auto edge, arolla::DenseArrayEdge::FromSplitPoints(
                                   {std::move(split_points)}));
-  return std::make_pair(std::move(slice_bldr).Build(), std::move(edge));
+  return std::make_pair(*std::move(values), std::move(edge));
 }
 
 absl::Status DataBagImpl::ExtendLists(
@@ -1646,6 +1978,7 @@ const std::shared_ptr<DictVector>* DataBagImpl::GetConstDictsOrNull(
 
 DictVector& DataBagImpl::GetOrCreateMutableDicts(AllocationId alloc_id) {
   DCHECK(alloc_id.IsDictsAlloc() || alloc_id.IsSchemasAlloc());
+  OnContentPartModified(ContentPart::kDicts, alloc_id);
   auto [it, inserted] = dicts_.try_emplace(alloc_id);
   if (inserted) {
     const std::shared_ptr<DictVector>* parent_dicts = nullptr;
@@ -1979,16 +2312,7 @@ absl::Status DataBagImpl::SetInDict(const DataSliceImpl& dicts,
   if (dicts.dtype() != arolla::GetQType<ObjectId>()) {
     return absl::FailedPreconditionError("dicts expected");
   }
-  const arolla::QType* unsupported_key_type = nullptr;
-  keys.VisitValues([&]<typename T>(const arolla::DenseArray<T>&) {
-    if (Dict::IsUnsupportedKeyType<T>()) {
-      unsupported_key_type = arolla::GetQType<T>();
-    }
-  });
-  if (unsupported_key_type) {
-    return absl::InvalidArgumentError(
-        absl::StrCat("invalid key type: ", unsupported_key_type->name()));
-  }
+  RETURN_IF_ERROR(VerifyDictKeyTypes(keys));
 
   MutableDictGetter<DictsAllocCheckFn> dict_getter(this);
 
@@ -2043,6 +2367,102 @@ absl::Status DataBagImpl::SetInDict(const DataSliceImpl& dicts,
   return dict_getter.status();
 }
 
+absl::Status DataBagImpl::SetInDicts(
+    const DataSliceImpl& dicts, const arolla::DenseArrayEdge& keys_to_dicts,
+    const DataSliceImpl& keys, const DataSliceImpl& values) {
+  if (dicts.size() != keys_to_dicts.parent_size() ||
+      keys.size() != keys_to_dicts.child_size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "dicts and keys sizes don't match the edge: %d and %d vs %d -> %d",
+        dicts.size(), keys.size(), keys_to_dicts.parent_size(),
+        keys_to_dicts.child_size()));
+  }
+  if (dicts.is_empty_and_unknown()) {
+    return absl::OkStatus();
+  }
+  if (dicts.dtype() != arolla::GetQType<ObjectId>()) {
+    return absl::FailedPreconditionError("dicts expected");
+  }
+  RETURN_IF_ERROR(VerifyDictKeyTypes(keys));
+  ASSIGN_OR_RETURN(auto splits_edge, keys_to_dicts.ToSplitPointsEdge());
+  absl::Span<const int64_t> split_points =
+      splits_edge.edge_values().values.span();
+
+  // The first pass resolves the dicts and reserves space for the new keys.
+  MutableDictGetter<DictsAllocCheckFn> dict_getter(this);
+  std::vector<Dict*> dict_ptrs(dicts.size(), nullptr);
+  // Strictly increasing ids guarantee that the dicts are unique.
+  bool unique_dicts = true;
+  std::optional<ObjectId> prev_dict_id;
+  dicts.values<ObjectId>().ForEachPresent(
+      [&](int64_t offset, ObjectId dict_id) {
+        Dict* dict = dict_getter(dict_id);
+        if (ABSL_PREDICT_FALSE(dict == nullptr)) {
+          return;
+        }
+        dict->Reserve(split_points[offset + 1] - split_points[offset]);
+        dict_ptrs[offset] = dict;
+        unique_dicts &= !prev_dict_id.has_value() || *prev_dict_id < dict_id;
+        prev_dict_id = dict_id;
+      });
+  RETURN_IF_ERROR(dict_getter.status());
+
+  // The second pass inserts the keys, `set_fn(dict, i)` sets the i-th key.
+  auto for_each_key = [&](auto set_fn) {
+    auto process_dicts = [&](int64_t begin, int64_t end) {
+      for (int64_t offset = begin; offset < end; ++offset) {
+        if (Dict* dict = dict_ptrs[offset]; dict != nullptr) {
+          for (int64_t i = split_points[offset]; i < split_points[offset + 1];
+               ++i) {
+            set_fn(*dict, i);
+          }
+        }
+      }
+    };
+    int64_t num_threads =
+        unique_dicts ? ParallelTaskCount(keys.size(), kMinDictKeysPerThread)
+                     : 1;
+    if (num_threads > 1) {
+      ForEachGroupRangeInParallel(split_points, num_threads, process_dicts);
+    } else {
+      process_dicts(0, dicts.size());
+    }
+  };
+
+  if (keys.is_mixed_dtype()) {
+    for_each_key([&](Dict& dict, int64_t i) {
+      if (DataItem key = keys[i]; key.has_value()) {
+        dict.Set(key, values[i]);
+      }
+    });
+  } else if (!values.is_single_dtype()) {
+    keys.VisitValues([&](const auto& keys_vec) {
+      using KeyT = typename std::decay_t<decltype(keys_vec)>::base_type;
+      for_each_key([&](Dict& dict, int64_t i) {
+        if (auto key = keys_vec[i]; key.present) {
+          dict.Set(DataItem::View<KeyT>{key.value}, values[i]);
+        }
+      });
+    });
+  } else {
+    values.VisitValues([&](const auto& values_vec) {
+      using ValueT = typename std::decay_t<decltype(values_vec)>::base_type;
+      keys.VisitValues([&](const auto& keys_vec) {
+        using KeyT = typename std::decay_t<decltype(keys_vec)>::base_type;
+        for_each_key([&](Dict& dict, int64_t i) {
+          if (auto key = keys_vec[i]; key.present) {
+            auto value = values_vec[i];
+            dict.Set(DataItem::View<KeyT>{key.value},
+                     value.present ? DataItem(ValueT(value.value))
+                                   : DataItem());
+          }
+        });
+      });
+    });
+  }
+  return absl::OkStatus();
+}
+
 absl::Status DataBagImpl::ClearDict(const DataSliceImpl& dicts) {
   if (dicts.is_empty_and_unknown()) {
     return absl::OkStatus();
@@ -2608,6 +3028,7 @@ absl::Status DataBagImpl::OverwriteSchemaFieldsForEntireAllocation(
   for (int i = 0; i < attr_names.size(); ++i) {
     common_dict->Set(DataItem::View<arolla::Text>(attr_names[i]), items[i]);
   }
+  OnContentPartModified(ContentPart::kDicts, schema_alloc_id);
   dicts_.emplace(schema_alloc_id,
                  std::make_shared<DictVector>(size, std::move(common_dict)));
   return absl::OkStatus();
@@ -2656,6 +3077,8 @@ absl::Status DataBagImpl::MergeSmallAllocInplace(const DataBagImpl& other,
 
       if (this_sources.empty() && other_sources.size() == 1) {
         // Copy entire source
+        OnContentPartModified(ContentPart::kSmallAllocAttr, AllocationId(),
+                              attr_name);
         small_alloc_sources_.emplace(attr_name, other_source_top);
         continue;
       }
@@ -2902,6 +3325,139 @@ absl::Status DataBagImpl::MergeInplace(const DataBagImpl& other,
   return absl::OkStatus();
 }
 
+absl::Status DataBagImpl::SpliceInplace(DataBagImpl& other,
+                                        MergeOptions options) {
+  if (this == &other) {
+    return absl::OkStatus();
+  }
+  DataBagImpl* others[] = {&other};
+  return SpliceInplace(others, options);
+}
+
+absl::Status DataBagImpl::SpliceInplace(absl::Span<DataBagImpl* const> others,
+                                        MergeOptions options) {
+  // Content moved out of one of `others`.
+  struct MovedContent {
+    DataBagImpl* from;
+    std::vector<std::pair<SourceKey, SourceCollection>> sources;
+    std::vector<std::pair<AllocationId, std::shared_ptr<DataListVector>>>
+        lists;
+    std::vector<std::pair<AllocationId, std::shared_ptr<DictVector>>> dicts;
+  };
+  // Sources of a fork may depend on its parent, so forks are merged.
+  auto can_move_from = [&](const DataBagImpl* other) {
+    return other != this && other->parent_data_bag_ == nullptr;
+  };
+
+  // Only the content present in exactly one of `others` and missing in this
+  // DataBagImpl is moved, so it cannot conflict with anything.
+  absl::flat_hash_map<SourceKey, int64_t, SourceKeyHashAndEq,
+                      SourceKeyHashAndEq>
+      source_counts;
+  absl::flat_hash_map<AllocationId, int64_t> list_counts;
+  absl::flat_hash_map<AllocationId, int64_t> dict_counts;
+  for (const DataBagImpl* other : others) {
+    for (const auto& [key, _] : other->sources_) {
+      ++source_counts[key];
+    }
+    for (const auto& [alloc, _] : other->lists_) {
+      ++list_counts[alloc];
+    }
+    for (const auto& [alloc, _] : other->dicts_) {
+      ++dict_counts[alloc];
+    }
+  }
+  std::vector<MovedContent> moved;
+  moved.reserve(others.size());
+  for (DataBagImpl* other : others) {
+    if (!can_move_from(other)) {
+      continue;
+    }
+    MovedContent& content = moved.emplace_back(MovedContent{.from = other});
+    for (auto it = other->sources_.begin(); it != other->sources_.end();) {
+      const auto& [alloc, attr_name] = it->first;
+      ConstDenseSourceArray dense_sources;
+      ConstSparseSourceArray sparse_sources;
+      GetAttributeDataSources(alloc, attr_name, dense_sources, sparse_sources);
+      if (source_counts[it->first] > 1 || !dense_sources.empty() ||
+          !sparse_sources.empty()) {
+        ++it;
+        continue;
+      }
+      content.sources.emplace_back(it->first, std::move(it->second));
+      other->sources_.erase(it++);
+    }
+    for (auto it = other->lists_.begin(); it != other->lists_.end();) {
+      if (list_counts[it->first] > 1 ||
+          GetConstListsOrNull(it->first) != nullptr) {
+        ++it;
+        continue;
+      }
+      content.lists.emplace_back(it->first, std::move(it->second));
+      other->lists_.erase(it++);
+    }
+    for (auto it = other->dicts_.begin(); it != other->dicts_.end();) {
+      if (dict_counts[it->first] > 1 ||
+          GetConstDictsOrNull(it->first) != nullptr) {
+        ++it;
+        continue;
+      }
+      content.dicts.emplace_back(it->first, std::move(it->second));
+      other->dicts_.erase(it++);
+    }
+  }
+
+  // The rest is merged. With kRaiseOnConflict it is first merged into a
+  // throwaway fork, so that on a conflict neither this DataBagImpl nor
+  // `others` are modified.
+  if (options.data_conflict_policy == MergeOptions::kRaiseOnConflict ||
+      options.schema_conflict_policy == MergeOptions::kRaiseOnConflict) {
+    absl::Status status = [&]() -> absl::Status {
+      DataBagImplPtr check = PartiallyPersistentFork();
+      for (const DataBagImpl* other : others) {
+        RETURN_IF_ERROR(check->MergeInplace(*other, options));
+      }
+      return absl::OkStatus();
+    }();
+    if (!status.ok()) {
+      for (MovedContent& content : moved) {
+        for (auto& [key, collection] : content.sources) {
+          content.from->sources_.emplace(std::move(key), std::move(collection));
+        }
+        for (auto& [alloc, lists] : content.lists) {
+          content.from->lists_.emplace(alloc, std::move(lists));
+        }
+        for (auto& [alloc, dicts] : content.dicts) {
+          content.from->dicts_.emplace(alloc, std::move(dicts));
+        }
+      }
+      return status;
+    }
+  }
+  for (const DataBagImpl* other : others) {
+    if (other != this) {
+      RETURN_IF_ERROR(MergeInplace(*other, options));
+    }
+  }
+  for (MovedContent& content : moved) {
+    for (auto& [key, moved_collection] : content.sources) {
+      SourceCollection& collection =
+          GetOrCreateSourceCollection(key.alloc, key.attr);
+      collection = std::move(moved_collection);
+      collection.lookup_parent = false;
+    }
+    for (auto& [alloc, lists] : content.lists) {
+      OnContentPartModified(ContentPart::kLists, alloc);
+      lists_[alloc] = std::move(lists);
+    }
+    for (auto& [alloc, dicts] : content.dicts) {
+      OnContentPartModified(ContentPart::kDicts, alloc);
+      dicts_[alloc] = std::move(dicts);
+    }
+  }
+  return absl::OkStatus();
+}
+
 // TODO: Consider removing this destructor once databag
 // automatically squashes long chains.
 DataBagImpl::~DataBagImpl() noexcept {
@@ -3189,6 +3745,280 @@ absl::StatusOr<DataBagContent> DataBagImpl::ExtractContent(
   return content;
 }
 
+namespace {
+
+// Hash of a single attribute value. Big and small allocations use the same
+// hash, so the result doesn't depend on where the value is stored.
+absl::uint128 AttrEntryHash(const arolla::Fingerprint& attr_fingerprint,
+                            ObjectId obj, const DataItem& value) {
+  return StableFingerprintHasher(attr_fingerprint)
+      .Combine(obj, value.StableFingerprint())
+      .Finish()
+      .value;
+}
+
+}  // namespace
+
+absl::StatusOr<absl::uint128> DataBagImpl::ComputeContentPartHash(
+    const ContentPart& part) const {
+  absl::uint128 res = 0;
+  switch (part.kind) {
+    case ContentPart::kAttr: {
+      ConstDenseSourceArray dense_sources;
+      ConstSparseSourceArray sparse_sources;
+      int64_t size = GetAttributeDataSources(part.alloc, part.attr,
+                                             dense_sources, sparse_sources);
+      if (size == 0) {
+        return res;
+      }
+      auto objects = DataSliceImpl::ObjectsFromAllocation(part.alloc, size);
+      ASSIGN_OR_RETURN(
+          auto values,
+          GetAttributeFromSources(objects, dense_sources, sparse_sources));
+      auto attr_fingerprint =
+          StableFingerprintHasher("attr").Combine(part.attr).Finish();
+      for (int64_t i = 0; i < size; ++i) {
+        if (DataItem value = values[i]; value.has_value()) {
+          res += AttrEntryHash(attr_fingerprint,
+                               part.alloc.ObjectByOffset(i), value);
+        }
+      }
+      return res;
+    }
+    case ContentPart::kSmallAllocAttr: {
+      auto attr_fingerprint =
+          StableFingerprintHasher("attr").Combine(part.attr).Finish();
+      for (const auto& [obj, value] :
+           ExtractSmallAllocAttrContent(part.attr)) {
+        res += AttrEntryHash(attr_fingerprint, obj, value);
+      }
+      return res;
+    }
+    case ContentPart::kLists: {
+      const std::shared_ptr<DataListVector>* lists =
+          GetConstListsOrNull(part.alloc);
+      if (lists == nullptr) {
+        return res;
+      }
+      for (size_t i = 0; i < (*lists)->size(); ++i) {
+        const DataList& list = (*lists)->Get(i);
+        if (list.empty()) {
+          continue;
+        }
+        StableFingerprintHasher hasher("list");
+        hasher.Combine(part.alloc.ObjectByOffset(i), list.size());
+        for (size_t j = 0; j < list.size(); ++j) {
+          hasher.Combine(list.Get(j).StableFingerprint());
+        }
+        res += std::move(hasher).Finish().value;
+      }
+      return res;
+    }
+    case ContentPart::kDicts: {
+      const std::shared_ptr<DictVector>* dicts =
+          GetConstDictsOrNull(part.alloc);
+      if (dicts == nullptr) {
+        return res;
+      }
+      for (size_t i = 0; i < (*dicts)->size(); ++i) {
+        const Dict& dict = (**dicts)[i];
+        std::vector<DataItem> keys = dict.GetKeys();
+        std::vector<DataItem> values = dict.GetValues();
+        DCHECK_EQ(keys.size(), values.size());
+        ObjectId dict_id = part.alloc.ObjectByOffset(i);
+        for (size_t j = 0; j < keys.size(); ++j) {
+          if (!values[j].has_value()) {
+            continue;
+          }
+          res += StableFingerprintHasher("dict")
+                     .Combine(dict_id, keys[j].StableFingerprint(),
+                              values[j].StableFingerprint())
+                     .Finish()
+                     .value;
+        }
+      }
+      return res;
+    }
+  }
+  return absl::InternalError("unexpected content part kind");
+}
+
+absl::uint128 DataBagImpl::GetParentContentPartHash(
+    const ContentPart& part) const {
+  for (const DataBagImpl* db = parent_data_bag_.get(); db != nullptr;
+       db = db->parent_data_bag_.get()) {
+    absl::MutexLock lock(&db->content_fingerprint_mutex_);
+    DCHECK(db->content_fingerprint_ != nullptr);
+    if (auto it = db->content_fingerprint_->part_hashes.find(part);
+        it != db->content_fingerprint_->part_hashes.end()) {
+      return it->second;
+    }
+  }
+  return 0;
+}
+
+void DataBagImpl::OnContentPartModifiedSlow(ContentPart::Kind kind,
+                                            AllocationId alloc,
+                                            absl::string_view attr) {
+  if (content_fingerprint_tracked_.load(std::memory_order_relaxed)) {
+    absl::MutexLock lock(&content_fingerprint_mutex_);
+    content_fingerprint_->modified_parts.insert(
+        ContentPart{kind, alloc, std::string(attr)});
+  }
+  if (modification_tracked_.load(std::memory_order_relaxed)) {
+    absl::MutexLock lock(&modification_tracking_mutex_);
+    if (modification_tracking_ == nullptr) {
+      return;
+    }
+    ModificationTrackingState& state = *modification_tracking_;
+    if (!state.HasLiveTrackers()) {
+      modification_tracking_ = nullptr;
+      modification_tracked_.store(false, std::memory_order_relaxed);
+      return;
+    }
+    int64_t count = ++state.modification_count;
+    if (kind == ContentPart::kSmallAllocAttr) {
+      state.small_alloc_modification = count;
+    } else {
+      state.alloc_modifications[alloc] = count;
+    }
+  }
+}
+
+bool DataBagImpl::ModificationTrackingState::HasLiveTrackers() {
+  trackers.erase(std::remove_if(trackers.begin(), trackers.end(),
+                                [](const auto& tracker) {
+                                  return tracker.expired();
+                                }),
+                 trackers.end());
+  return !trackers.empty();
+}
+
+DataBagImpl::ModificationSnapshot DataBagImpl::GetModificationSnapshot(
+    const ModificationTrackerPtr& tracker) const {
+  DCHECK(tracker != nullptr);
+  static absl::NoDestructor<std::atomic<uint64_t>> next_databag_id(1);
+  absl::MutexLock lock(&modification_tracking_mutex_);
+  if (modification_tracking_ != nullptr &&
+      !modification_tracking_->HasLiveTrackers()) {
+    // Release the state kept for the destroyed trackers.
+    modification_tracking_ = nullptr;
+  }
+  if (modification_tracking_ == nullptr) {
+    modification_tracking_ = std::make_unique<ModificationTrackingState>();
+    modification_tracking_->databag_id = next_databag_id->fetch_add(1);
+    if (!IsPristine()) {
+      // Modifications made before the tracking can affect any allocation.
+      modification_tracking_->modification_count = 1;
+      modification_tracking_->untracked_count = 1;
+    }
+    modification_tracked_.store(true, std::memory_order_relaxed);
+  }
+  std::vector<std::weak_ptr<const ModificationTracker>>& trackers =
+      modification_tracking_->trackers;
+  if (std::none_of(trackers.begin(), trackers.end(),
+                   [&](const auto& weak_tracker) {
+                     return weak_tracker.lock() == tracker;
+                   })) {
+    trackers.push_back(tracker);
+  }
+  return {.databag_id = modification_tracking_->databag_id,
+          .modification_count = modification_tracking_->modification_count};
+}
+
+bool DataBagImpl::IsAllocationModifiedAfter(AllocationId alloc,
+                                            int64_t count) const {
+  absl::MutexLock lock(&modification_tracking_mutex_);
+  if (modification_tracking_ == nullptr) {
+    return true;
+  }
+  const ModificationTrackingState& state = *modification_tracking_;
+  if (count < state.untracked_count) {
+    return true;
+  }
+  int64_t last_modification = 0;
+  if (auto it = state.alloc_modifications.find(alloc);
+      it != state.alloc_modifications.end()) {
+    last_modification = it->second;
+  }
+  if (alloc.IsSmall()) {
+    last_modification =
+        std::max(last_modification, state.small_alloc_modification);
+  }
+  return last_modification > count;
+}
+
+bool DataBagImpl::IsAllocationModifiedSince(
+    AllocationId alloc, const ModificationSnapshot& snapshot) const {
+  for (const DataBagImpl* db = this; db != nullptr;
+       db = db->parent_data_bag_.get()) {
+    bool is_snapshot_databag;
+    {
+      absl::MutexLock lock(&db->modification_tracking_mutex_);
+      is_snapshot_databag =
+          db->modification_tracking_ != nullptr &&
+          db->modification_tracking_->databag_id == snapshot.databag_id;
+    }
+    if (is_snapshot_databag) {
+      return db->IsAllocationModifiedAfter(alloc, snapshot.modification_count);
+    }
+    // All modifications of the forks are made after the snapshot.
+    if (db->IsAllocationModifiedAfter(alloc, 0)) {
+      return true;
+    }
+  }
+  return true;
+}
+
+absl::StatusOr<absl::uint128> DataBagImpl::UpdateContentFingerprint() const {
+  absl::MutexLock lock(&content_fingerprint_mutex_);
+  if (content_fingerprint_ == nullptr) {
+    auto state = std::make_unique<ContentFingerprintState>();
+    // Parents are not modified while they have forks, so their state (once
+    // computed) stays valid for the whole lifetime of this DataBagImpl.
+    if (parent_data_bag_ != nullptr) {
+      ASSIGN_OR_RETURN(state->total,
+                       parent_data_bag_->UpdateContentFingerprint());
+    }
+    for (const auto& [key, _] : sources_) {
+      state->modified_parts.insert(
+          ContentPart{ContentPart::kAttr, key.alloc, key.attr});
+    }
+    for (const auto& [attr, _] : small_alloc_sources_) {
+      state->modified_parts.insert(
+          ContentPart{ContentPart::kSmallAllocAttr, AllocationId(), attr});
+    }
+    for (const auto& [alloc, _] : lists_) {
+      state->modified_parts.insert(ContentPart{ContentPart::kLists, alloc, ""});
+    }
+    for (const auto& [alloc, _] : dicts_) {
+      state->modified_parts.insert(ContentPart{ContentPart::kDicts, alloc, ""});
+    }
+    content_fingerprint_ = std::move(state);
+    content_fingerprint_tracked_.store(true, std::memory_order_relaxed);
+  }
+  ContentFingerprintState& state = *content_fingerprint_;
+  for (const ContentPart& part : state.modified_parts) {
+    auto it = state.part_hashes.find(part);
+    absl::uint128 old_hash = it != state.part_hashes.end()
+                                 ? it->second
+                                 : GetParentContentPartHash(part);
+    ASSIGN_OR_RETURN(absl::uint128 new_hash, ComputeContentPartHash(part));
+    // Wraps around on overflow, which keeps the sum order-independent.
+    state.total += new_hash - old_hash;
+    state.part_hashes[part] = new_hash;
+  }
+  state.modified_parts.clear();
+  return state.total;
+}
+
+absl::StatusOr<arolla::Fingerprint> DataBagImpl::ContentFingerprint() const {
+  ASSIGN_OR_RETURN(absl::uint128 total, UpdateContentFingerprint());
+  return StableFingerprintHasher("data_bag_content")
+      .Combine(arolla::Fingerprint{total})
+      .Finish();
+}
+
 int64_t DataBagImpl::GetApproxTotalSize() const {
   int64_t size = 0;
 
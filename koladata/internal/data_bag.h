@@ -16,6 +16,7 @@
 #define KOLADATA_INTERNAL_DATA_BAG_H_
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
@@ -30,12 +31,15 @@
 #include "absl/base/optimization.h"
 #include "absl/container/btree_map.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/hash/hash.h"
 #include "absl/log/log.h"
+#include "absl/numeric/int128.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "koladata/internal/data_item.h"
 #include "koladata/internal/data_list.h"
@@ -47,6 +51,7 @@
 #include "arolla/dense_array/dense_array.h"
 #include "arolla/dense_array/edge.h"
 #include "arolla/qtype/qtype.h"
+#include "arolla/util/fingerprint.h"
 #include "arolla/util/refcount_ptr.h"
 
 namespace koladata::internal {
@@ -170,6 +175,14 @@ class DataBagImpl : public arolla::RefcountedBase {
       absl::string_view attr,
       FallbackSpan fallbacks = {}) const;
 
+  // Same as calling GetAttr for each of `attrs`, but faster for many
+  // attributes: the data sources of all the attributes are looked up in one
+  // pass over the allocations, and the columns of large slices are gathered
+  // by several threads.
+  absl::StatusOr<std::vector<DataSliceImpl>> GetAttrs(
+      const DataSliceImpl& objects, absl::Span<const absl::string_view> attrs,
+      FallbackSpan fallbacks = {}) const;
+
   // Gets __schema__ attribute for objects and returns an Error if DataSlice has
   // primitives or objects do not have __schema__ attribute.
   absl::StatusOr<DataItem> GetObjSchemaAttr(const DataItem& item,
@@ -221,6 +234,59 @@ class DataBagImpl : public arolla::RefcountedBase {
   // - The upper bound of the number of entities/objects.
   absl::StatusOr<DataBagStatistics> GetStatistics() const;
 
+  // Returns a stable fingerprint of the content of the DataBag including data
+  // from parents (fallbacks are not included). DataBags with the same
+  // attributes, lists and dicts have the same content fingerprint regardless
+  // of the order of modifications or how the data is split between forks.
+  //
+  // The fingerprint is a sum of independent per-part hashes, where a part is
+  // an (allocation, attribute) source, all small allocations of an attribute,
+  // or a list or dict allocation. The first call is O(size); after that only
+  // the parts modified since the previous call are rehashed, and a fork reuses
+  // hashes of the parts it inherits unmodified from its parent. Modifications
+  // have no extra cost until the fingerprint is requested for the first time.
+  absl::StatusOr<arolla::Fingerprint> ContentFingerprint() const;
+
+  // Returns true if ContentFingerprint() was called for this DataBagImpl (or
+  // its parent before forking), so modifications are tracked and the next
+  // call is cheap.
+  bool IsContentFingerprintTracked() const {
+    return content_fingerprint_tracked_.load(std::memory_order_relaxed);
+  }
+
+  // State of a DataBagImpl at some moment, used to check which allocations
+  // were modified since then (e.g. to invalidate caches of derived data).
+  struct ModificationSnapshot {
+    // Identifies the DataBagImpl; zero if it is not known.
+    uint64_t databag_id = 0;
+    int64_t modification_count = 0;
+
+    friend bool operator==(const ModificationSnapshot&,
+                           const ModificationSnapshot&) = default;
+  };
+
+  // Owner of modification tracking, see GetModificationSnapshot().
+  struct ModificationTracker {};
+  using ModificationTrackerPtr = std::shared_ptr<const ModificationTracker>;
+
+  // Returns the current modification snapshot and starts tracking which
+  // allocations are modified, if not tracked yet. Forks created after that
+  // are tracked from the start. The tracking stays enabled while `tracker`
+  // (or any other tracker passed here) is alive. Once all of them are
+  // destroyed, the tracking state is released on the next modification, and
+  // modifications have no extra cost again.
+  ModificationSnapshot GetModificationSnapshot(
+      const ModificationTrackerPtr& tracker) const;
+
+  // Returns true if attributes, list items or dict content of the objects from
+  // `alloc`, as seen by this DataBagImpl, could have been modified since
+  // `snapshot` was taken. It is the case if `alloc` was modified in the
+  // snapshot DataBagImpl afterwards, or in any of the forks between it and
+  // this DataBagImpl. If the snapshot DataBagImpl is neither this DataBagImpl
+  // nor one of its parents, always returns true.
+  bool IsAllocationModifiedSince(AllocationId alloc,
+                                 const ModificationSnapshot& snapshot) const;
+
   // *******  Mutable interface
 
   // Allocates new objects with provided attributes and store them in
@@ -247,6 +313,16 @@ class DataBagImpl : public arolla::RefcountedBase {
   absl::Status SetAttr(const DataItem& object, absl::string_view attr,
                        DataItem value);
 
+  // Creates (if not yet present) a mutable dense storage for attribute `attr`
+  // of the objects in `alloc_id`, so that following SetAttr calls for small
+  // parts of the allocation write into it instead of into a sparse source.
+  // Useful when a big allocation is populated chunk by chunk (e.g. during
+  // streaming deserialization). `main_type` has the same meaning as in
+  // DenseSource::CreateMutable.
+  absl::Status ReserveAttrForAllocation(
+      AllocationId alloc_id, absl::string_view attr,
+      const arolla::QType* main_type = nullptr);
+
   // Updates DataBagImpl by setting attribute to present for specified objects.
   // Returns a slice of unique ObjectIds that had an attribute missing before.
   absl::StatusOr<DataSliceImpl>
@@ -444,6 +520,17 @@ class DataBagImpl : public arolla::RefcountedBase {
   absl::Status SetInDict(const DataSliceImpl& dicts, const DataSliceImpl& keys,
                          const DataSliceImpl& values);
 
+  // Bulk version of SetInDict for keys grouped by dicts, e.g. when building
+  // dicts from columns. Sets `values[i]` for `keys[i]` in the dict
+  // `dicts[j]`, where `j` is the parent of `i` in `keys_to_dicts`. Equivalent
+  // to SetInDict with `dicts` expanded by `keys_to_dicts`, but every dict is
+  // resized only once. If `dicts` are unique (e.g. a fresh allocation), big
+  // inputs are processed by several threads across ranges of dicts.
+  absl::Status SetInDicts(const DataSliceImpl& dicts,
+                          const arolla::DenseArrayEdge& keys_to_dicts,
+                          const DataSliceImpl& keys,
+                          const DataSliceImpl& values);
+
   // Clear given dicts.
   absl::Status ClearDict(const DataSliceImpl& dicts);
 
@@ -613,6 +700,21 @@ class DataBagImpl : public arolla::RefcountedBase {
   absl::Status MergeInplace(const DataBagImpl& other,
                             MergeOptions options = MergeOptions());
 
+  // Same as MergeInplace, but moves the content of `other`, leaving it in an
+  // unspecified state. Attributes of big allocations, lists and dicts that are
+  // not present in this DataBagImpl (e.g. of the objects created in `other`)
+  // are moved without copying or merging. The rest is merged.
+  //
+  // On conflicts returns an error without modifying this DataBagImpl or
+  // `other`.
+  absl::Status SpliceInplace(DataBagImpl& other,
+                             MergeOptions options = MergeOptions());
+
+  // Same as above, but splices all `others` in order. Either all of them are
+  // spliced, or, on conflicts, none is and nothing is modified.
+  absl::Status SpliceInplace(absl::Span<DataBagImpl* const> others,
+                             MergeOptions options = MergeOptions());
+
   // Assigns this DataBagImpl to a DataBag. This should called every time a
   // DataBag is created from this DataBagImpl to make sure DataBagImpl is never
   // reused.
@@ -719,6 +821,76 @@ class DataBagImpl : public arolla::RefcountedBase {
   absl::Status MergeDictsInplace(const DataBagImpl& other,
                                  MergeOptions options);
 
+  // *** Content fingerprint helpers
+
+  // Independently hashed part of the DataBag content.
+  struct ContentPart {
+    enum Kind : uint8_t { kAttr, kSmallAllocAttr, kLists, kDicts };
+    Kind kind;
+    AllocationId alloc;  // Unused for kSmallAllocAttr.
+    std::string attr;    // Unused for kLists and kDicts.
+
+    friend bool operator==(const ContentPart&, const ContentPart&) = default;
+
+    template <typename H>
+    friend H AbslHashValue(H h, const ContentPart& p) {
+      return H::combine(std::move(h), p.kind, p.alloc, p.attr);
+    }
+  };
+  struct ContentFingerprintState {
+    // Sum of the hashes of all parts including the ones from parents.
+    absl::uint128 total = 0;
+    // Hashes of the parts present in this DataBagImpl (not in parents).
+    absl::flat_hash_map<ContentPart, absl::uint128> part_hashes;
+    // Parts modified since the last update.
+    absl::flat_hash_set<ContentPart> modified_parts;
+  };
+
+  struct ModificationTrackingState {
+    uint64_t databag_id;
+    int64_t modification_count = 0;
+    // Allocations modified up to this count are not known.
+    int64_t untracked_count = 0;
+    // The last modification count of each modified allocation.
+    absl::flat_hash_map<AllocationId, int64_t> alloc_modifications;
+    // The last modification count of attributes of small allocations.
+    int64_t small_alloc_modification = 0;
+    // The tracking is enabled while any of them is alive.
+    std::vector<std::weak_ptr<const ModificationTracker>> trackers;
+
+    // Removes the destroyed trackers and returns true if any is left.
+    bool HasLiveTrackers();
+  };
+
+  // Must be called before modifying the given part of this DataBagImpl.
+  void OnContentPartModified(ContentPart::Kind kind, AllocationId alloc,
+                             absl::string_view attr = "") {
+    if (ABSL_PREDICT_FALSE(
+            content_fingerprint_tracked_.load(std::memory_order_relaxed) ||
+            modification_tracked_.load(std::memory_order_relaxed))) {
+      OnContentPartModifiedSlow(kind, alloc, attr);
+    }
+  }
+  void OnContentPartModifiedSlow(ContentPart::Kind kind, AllocationId alloc,
+                                 absl::string_view attr);
+
+  // Rehashes all the parts modified since the previous call and returns the
+  // sum of the hashes of all parts.
+  absl::StatusOr<absl::uint128> UpdateContentFingerprint() const;
+
+  // Returns the hash of the given part as seen by this DataBagImpl (i.e.
+  // including data from parents).
+  absl::StatusOr<absl::uint128> ComputeContentPartHash(
+      const ContentPart& part) const;
+
+  // Returns the hash of the given part as seen by the parent. Zero if the part
+  // is not present in any of the parents.
+  absl::uint128 GetParentContentPartHash(const ContentPart& part) const;
+
+  // Returns true if `alloc` was modified in this DataBagImpl after it had
+  // `count` modifications, or if that is unknown.
+  bool IsAllocationModifiedAfter(AllocationId alloc, int64_t count) const;
+
   DataBagImplConstPtr parent_data_bag_ = nullptr;
   bool is_assigned_ = false;
 
@@ -882,6 +1054,19 @@ class DataBagImpl : public arolla::RefcountedBase {
 
   absl::flat_hash_map<AllocationId, std::shared_ptr<DataListVector>> lists_;
   absl::flat_hash_map<AllocationId, std::shared_ptr<DictVector>> dicts_;
+
+  // Lazily created on the first ContentFingerprint() call.
+  mutable absl::Mutex content_fingerprint_mutex_;
+  mutable std::unique_ptr<ContentFingerprintState> content_fingerprint_
+      ABSL_GUARDED_BY(content_fingerprint_mutex_);
+  mutable std::atomic<bool> content_fingerprint_tracked_ = false;
+
+  // Created on the first GetModificationSnapshot() call and released once all
+  // its trackers are destroyed.
+  mutable absl::Mutex modification_tracking_mutex_;
+  mutable std::unique_ptr<ModificationTrackingState> modification_tracking_
+      ABSL_GUARDED_BY(modification_tracking_mutex_);
+  mutable std::atomic<bool> modification_tracked_ = false;
 };
 
 }  // namespace koladata::internal
@@ -0,0 +1,121 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Benchmarks of the temporary DataBagImpls created by operators, reporting the
+// number of heap allocations per iteration.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "koladata/internal/data_bag.h"
+#include "koladata/internal/data_item.h"
+#include "koladata/internal/data_slice.h"
+#include "koladata/internal/object_id.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/util/text.h"
+
+namespace {
+
+std::atomic<int64_t> heap_allocation_count = 0;
+
+}  // namespace
+
+// Counts all the heap allocations of the benchmark binary.
+void* operator new(size_t size) {
+  heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+namespace koladata::internal {
+namespace {
+
+// Runs `fn(db)` on a new temporary DataBagImpl in each iteration.
+template <typename Fn>
+void RunWithTemporaryBag(benchmark::State& state, Fn fn) {
+  int64_t allocation_count = 0;
+  for (auto _ : state) {
+    int64_t start_count = heap_allocation_count.load();
+    {
+      DataBagImplPtr db = DataBagImpl::CreateEmptyDatabag();
+      fn(*db);
+      benchmark::DoNotOptimize(db);
+    }
+    allocation_count += heap_allocation_count.load() - start_count;
+  }
+  state.counters["allocations"] = benchmark::Counter(
+      allocation_count, benchmark::Counter::kAvgIterations);
+}
+
+// As in kd.with_attrs: a few attributes of a few objects.
+void BM_SetAttrs(benchmark::State& state) {
+  int64_t size = state.range(0);
+  auto objects = DataSliceImpl::AllocateEmptyObjects(size);
+  ObjectId small_object = AllocateSingleObject();
+  auto values = DataSliceImpl::Create(
+      arolla::CreateConstDenseArray<int32_t>(size, 57));
+  RunWithTemporaryBag(state, [&](DataBagImpl& db) {
+    CHECK_OK(db.SetAttr(objects, "a", values));
+    CHECK_OK(db.SetAttr(objects, "b", objects));
+    CHECK_OK(db.SetAttr(DataItem(small_object), "c",
+                        DataItem(arolla::Text("abc"))));
+  });
+}
+
+// As in kd.subslice and kd.expand_to_shape: lists of the items of a slice.
+void BM_CreateLists(benchmark::State& state) {
+  int64_t size = state.range(0);
+  auto lists = DataSliceImpl::ObjectsFromAllocation(AllocateLists(size), size);
+  auto values = DataSliceImpl::Create(
+      arolla::CreateConstDenseArray<int32_t>(size, 57));
+  RunWithTemporaryBag(state, [&](DataBagImpl& db) {
+    CHECK_OK(db.AppendToList(lists, values));
+    auto exploded = db.ExplodeLists(lists);
+    CHECK_OK(exploded);
+    benchmark::DoNotOptimize(exploded);
+  });
+}
+
+// As in the merges done for adoption: a small bag merged into a new one.
+void BM_Merge(benchmark::State& state) {
+  int64_t size = state.range(0);
+  auto objects = DataSliceImpl::AllocateEmptyObjects(size);
+  auto dicts = DataSliceImpl::ObjectsFromAllocation(AllocateDicts(size), size);
+  auto values = DataSliceImpl::Create(
+      arolla::CreateConstDenseArray<int32_t>(size, 57));
+  auto other_db = DataBagImpl::CreateEmptyDatabag();
+  CHECK_OK(other_db->SetAttr(objects, "a", values));
+  CHECK_OK(other_db->SetInDict(dicts, values, objects));
+  RunWithTemporaryBag(state, [&](DataBagImpl& db) {
+    CHECK_OK(db.MergeInplace(*other_db));
+  });
+}
+
+BENCHMARK(BM_SetAttrs)->Arg(1)->Arg(10)->Arg(1000);
+BENCHMARK(BM_CreateLists)->Arg(1)->Arg(10)->Arg(1000);
+BENCHMARK(BM_Merge)->Arg(1)->Arg(10)->Arg(1000);
+
+}  // namespace
+}  // namespace koladata::internal
@@ -822,6 +822,60 @@ void BM_SetInDicts(benchmark::State& state) {
 BENCHMARK(BM_SetInDict);
 BENCHMARK(BM_SetInDicts)->Arg(1)->Arg(10)->Arg(100)->Arg(1000);
 
+// Builds `num_dicts` dicts with `dict_size` keys each from columns, either
+// with SetInDict on expanded dicts or with SetInDicts on grouped keys.
+template <bool kGrouped>
+void BM_BuildDictsFromColumns(benchmark::State& state) {
+  int64_t num_dicts = state.range(0);
+  int64_t dict_size = state.range(1);
+  int64_t size = num_dicts * dict_size;
+
+  arolla::DenseArrayBuilder<int64_t> keys_bldr(size);
+  arolla::DenseArrayBuilder<float> values_bldr(size);
+  for (int64_t i = 0; i < size; ++i) {
+    keys_bldr.Set(i, i % dict_size);
+    values_bldr.Set(i, 1.0f);
+  }
+  auto keys = DataSliceImpl::Create(std::move(keys_bldr).Build());
+  auto values = DataSliceImpl::Create(std::move(values_bldr).Build());
+  auto edge = *arolla::DenseArrayEdge::FromUniformGroups(num_dicts, dict_size);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto db = DataBagImpl::CreateEmptyDatabag();
+    AllocationId alloc = AllocateDicts(num_dicts);
+    DataSliceImpl dicts =
+        DataSliceImpl::ObjectsFromAllocation(alloc, num_dicts);
+    arolla::DenseArrayBuilder<ObjectId> expanded_dicts_bldr(size);
+    if (!kGrouped) {
+      for (int64_t i = 0; i < size; ++i) {
+        expanded_dicts_bldr.Set(i, alloc.ObjectByOffset(i / dict_size));
+      }
+    }
+    auto expanded_dicts =
+        DataSliceImpl::Create(std::move(expanded_dicts_bldr).Build());
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(keys);
+    benchmark::DoNotOptimize(values);
+    if (kGrouped) {
+      CHECK_OK(db->SetInDicts(dicts, edge, keys, values));
+    } else {
+      CHECK_OK(db->SetInDict(expanded_dicts, keys, values));
+    }
+    benchmark::DoNotOptimize(db);
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+
+BENCHMARK(BM_BuildDictsFromColumns<false>)
+    ->ArgPair(1000, 10)
+    ->ArgPair(100000, 10)
+    ->ArgPair(10, 100000);
+BENCHMARK(BM_BuildDictsFromColumns<true>)
+    ->ArgPair(1000, 10)
+    ->ArgPair(100000, 10)
+    ->ArgPair(10, 100000);
+
 template <MergeOptions::ConflictHandlingOption kDataConflictPolicy>
 void BM_MergeIntoEmpty(benchmark::State& state) {
   int64_t alloc_size = state.range(0);
@@ -183,6 +183,96 @@ TEST(DataBagTest, Dicts) {
               IsOkAndHolds(DataItem()));
 }
 
+TEST(DataBagTest, SetInDicts) {
+  auto db = DataBagImpl::CreateEmptyDatabag();
+  AllocationId alloc_id = AllocateDicts(3);
+  DataSliceImpl dicts =
+      DataSliceImpl::Create(arolla::CreateDenseArray<ObjectId>(
+          {alloc_id.ObjectByOffset(0), std::nullopt,
+           alloc_id.ObjectByOffset(2)}));
+  ASSERT_OK_AND_ASSIGN(auto edge,
+                       DenseArrayEdge::FromSplitPoints(
+                           arolla::CreateDenseArray<int64_t>({0, 2, 3, 6})));
+
+  ASSERT_OK(db->SetInDicts(
+      dicts, edge,
+      DataSliceImpl::Create(
+          arolla::CreateDenseArray<int>({1, 2, 3, 1, std::nullopt, 2})),
+      DataSliceImpl::Create(
+          arolla::CreateDenseArray<int>({5, 6, 7, 8, 9, std::nullopt}))));
+  EXPECT_THAT(db->GetDictSize(dicts),
+              IsOkAndHolds(ElementsAre(int64_t{2}, std::nullopt, int64_t{1})));
+  EXPECT_THAT(
+      db->GetFromDict(dicts, DataSliceImpl::Create(
+                                 arolla::CreateDenseArray<int>({2, 2, 1}))),
+      IsOkAndHolds(ElementsAre(6, DataItem(), 8)));
+
+  // Repeated dicts and mixed values.
+  DataSliceImpl repeated_dicts = DataSliceImpl::Create(
+      arolla::CreateConstDenseArray<ObjectId>(2, alloc_id.ObjectByOffset(1)));
+  ASSERT_OK_AND_ASSIGN(auto repeated_edge,
+                       DenseArrayEdge::FromMapping(
+                           arolla::CreateDenseArray<int64_t>({0, 0, 1}), 2));
+  ASSERT_OK(db->SetInDicts(
+      repeated_dicts, repeated_edge,
+      DataSliceImpl::Create(arolla::CreateDenseArray<arolla::Bytes>(
+          {arolla::Bytes("a"), arolla::Bytes("b"), arolla::Bytes("a")})),
+      DataSliceImpl::Create(
+          arolla::CreateDenseArray<int>({1, std::nullopt, std::nullopt}),
+          arolla::CreateDenseArray<float>({std::nullopt, 2.0f, 3.0f}))));
+  EXPECT_THAT(db->GetFromDict(
+                  repeated_dicts,
+                  DataSliceImpl::Create(arolla::CreateDenseArray<arolla::Bytes>(
+                      {arolla::Bytes("a"), arolla::Bytes("b")}))),
+              IsOkAndHolds(ElementsAre(3.0f, 2.0f)));
+  AssertKVsAreAligned(*db, dicts);
+
+  EXPECT_THAT(
+      db->SetInDicts(dicts, edge,
+                     DataSliceImpl::Create(arolla::CreateDenseArray<int>({1})),
+                     DataSliceImpl::Create(arolla::CreateDenseArray<int>({5}))),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               "dicts and keys sizes don't match the edge: 3 and 1 vs 3 -> 6"));
+  EXPECT_THAT(db->SetInDicts(
+                  dicts, edge,
+                  DataSliceImpl::Create(arolla::CreateConstDenseArray<float>(
+                      6, 1.0f)),
+                  DataSliceImpl::CreateEmptyAndUnknownType(6)),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       "invalid key type: FLOAT32"));
+}
+
+TEST(DataBagTest, SetInManyDicts) {
+  // Big enough to split insertion between several threads.
+  constexpr int64_t kDictCount = 1 << 16;
+  constexpr int64_t kDictSize = 4;
+  auto db = DataBagImpl::CreateEmptyDatabag();
+  AllocationId alloc_id = AllocateDicts(kDictCount);
+  DataSliceImpl dicts =
+      DataSliceImpl::ObjectsFromAllocation(alloc_id, kDictCount);
+  ASSERT_OK_AND_ASSIGN(
+      auto edge, DenseArrayEdge::FromUniformGroups(kDictCount, kDictSize));
+  arolla::DenseArrayBuilder<int64_t> keys_bldr(kDictCount * kDictSize);
+  arolla::DenseArrayBuilder<int64_t> values_bldr(kDictCount * kDictSize);
+  for (int64_t i = 0; i < kDictCount * kDictSize; ++i) {
+    keys_bldr.Set(i, i % kDictSize);
+    values_bldr.Set(i, i);
+  }
+  ASSERT_OK(db->SetInDicts(
+      dicts, edge, DataSliceImpl::Create(std::move(keys_bldr).Build()),
+      DataSliceImpl::Create(std::move(values_bldr).Build())));
+
+  ASSERT_OK_AND_ASSIGN(
+      auto values,
+      db->GetFromDict(dicts, DataSliceImpl::Create(
+                                 arolla::CreateConstDenseArray<int64_t>(
+                                     kDictCount, kDictSize - 1))));
+  ASSERT_EQ(values.size(), kDictCount);
+  for (int64_t i = 0; i < kDictCount; ++i) {
+    ASSERT_EQ(values[i], DataItem((i + 1) * kDictSize - 1)) << i;
+  }
+}
+
 TEST(DataBagTest, EmptyAndUnknownDicts) {
   auto db = DataBagImpl::CreateEmptyDatabag();
   auto empty = DataSliceImpl::CreateEmptyAndUnknownType(3);
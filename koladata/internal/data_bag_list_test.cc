@@ -218,6 +218,100 @@ TEST(DataBagTest, ExplodeLists) {
   }
 }
 
+TEST(DataBagTest, ExplodeAndGetFromTypedLists) {
+  auto db = DataBagImpl::CreateEmptyDatabag();
+  AllocationId alloc_id = AllocateLists(3);
+  AllocationId obj_alloc_id = Allocate(3);
+  DataSliceImpl lists =
+      DataSliceImpl::Create(arolla::CreateDenseArray<ObjectId>(
+          {alloc_id.ObjectByOffset(0), alloc_id.ObjectByOffset(1),
+           std::nullopt, alloc_id.ObjectByOffset(2)}));
+
+  ASSERT_OK(db->ExtendList(
+      DataItem(alloc_id.ObjectByOffset(0)),
+      DataSliceImpl::ObjectsFromAllocation(obj_alloc_id, 2)));
+  ASSERT_OK(db->ExtendList(
+      DataItem(alloc_id.ObjectByOffset(2)),
+      DataSliceImpl::Create(arolla::CreateDenseArray<ObjectId>(
+          {std::nullopt, obj_alloc_id.ObjectByOffset(2),
+           obj_alloc_id.ObjectByOffset(0)}))));
+
+  {
+    ASSERT_OK_AND_ASSIGN((auto [values, edge]),
+                         db->ExplodeLists(lists, DataBagImpl::ListRange(1)));
+    EXPECT_EQ(values.dtype(), arolla::GetQType<ObjectId>());
+    EXPECT_THAT(values, ElementsAre(obj_alloc_id.ObjectByOffset(1),
+                                    obj_alloc_id.ObjectByOffset(2),
+                                    obj_alloc_id.ObjectByOffset(0)));
+    EXPECT_THAT(values.allocation_ids(), ElementsAre(obj_alloc_id));
+    EXPECT_THAT(edge.edge_values(), ElementsAre(0, 1, 1, 1, 3));
+  }
+  {
+    ASSERT_OK_AND_ASSIGN(
+        auto values,
+        db->GetFromLists(lists,
+                         arolla::CreateDenseArray<int64_t>({-2, 0, 0, 0})));
+    EXPECT_THAT(values, ElementsAre(obj_alloc_id.ObjectByOffset(0),
+                                    DataItem(), DataItem(), DataItem()));
+    EXPECT_THAT(values.allocation_ids(), ElementsAre(obj_alloc_id));
+  }
+}
+
+TEST(DataBagTest, ExplodeAndGetFromManyTypedLists) {
+  // Big enough to split copying of the values between several threads.
+  constexpr int64_t kListCount = 1 << 19;
+  constexpr int64_t kListSize = 3;
+  auto db = DataBagImpl::CreateEmptyDatabag();
+  AllocationId alloc_id = AllocateLists(kListCount);
+  DataSliceImpl lists =
+      DataSliceImpl::ObjectsFromAllocation(alloc_id, kListCount);
+
+  // Every 7th value is missing.
+  arolla::DenseArrayBuilder<int64_t> values_bldr(kListCount * kListSize);
+  for (int64_t i = 0; i < kListCount * kListSize; ++i) {
+    if (i % 7 != 0) {
+      values_bldr.Set(i, i);
+    }
+  }
+  ASSERT_OK_AND_ASSIGN(
+      auto values_edge,
+      arolla::DenseArrayEdge::FromUniformGroups(kListCount, kListSize));
+  ASSERT_OK(db->ExtendLists(
+      lists, DataSliceImpl::Create(std::move(values_bldr).Build()),
+      values_edge));
+
+  {  // Slices [1:] from each list grouped together.
+    ASSERT_OK_AND_ASSIGN((auto [values, edge]),
+                         db->ExplodeLists(lists, DataBagImpl::ListRange(1)));
+    EXPECT_EQ(edge.parent_size(), kListCount);
+    ASSERT_EQ(values.size(), kListCount * (kListSize - 1));
+    const arolla::DenseArray<int64_t>& array = values.values<int64_t>();
+    for (int64_t i = 0; i < values.size(); ++i) {
+      int64_t expected =
+          i / (kListSize - 1) * kListSize + i % (kListSize - 1) + 1;
+      ASSERT_EQ(array.present(i), expected % 7 != 0) << i;
+      if (array.present(i)) {
+        ASSERT_EQ(array.values[i], expected) << i;
+      }
+    }
+  }
+  {  // The last element of each list.
+    ASSERT_OK_AND_ASSIGN(
+        auto values,
+        db->GetFromLists(lists, arolla::CreateConstDenseArray<int64_t>(
+                                    kListCount, -1)));
+    ASSERT_EQ(values.size(), kListCount);
+    const arolla::DenseArray<int64_t>& array = values.values<int64_t>();
+    for (int64_t i = 0; i < kListCount; ++i) {
+      int64_t expected = (i + 1) * kListSize - 1;
+      ASSERT_EQ(array.present(i), expected % 7 != 0) << i;
+      if (array.present(i)) {
+        ASSERT_EQ(array.values[i], expected) << i;
+      }
+    }
+  }
+}
+
 TEST(DataBagTest, ExtendAndReplaceInLists) {
   auto db = DataBagImpl::CreateEmptyDatabag();
   AllocationId alloc_id = AllocateLists(3);
@@ -38,6 +38,7 @@
 #include "koladata/internal/object_id.h"
 #include "koladata/internal/schema_utils.h"
 #include "koladata/internal/uuid_object.h"
+#include "arolla/dense_array/dense_array.h"
 #include "arolla/dense_array/qtype/types.h"
 #include "arolla/qtype/base_types.h"
 #include "arolla/util/bytes.h"
@@ -49,6 +50,7 @@ namespace {
 using ::absl_testing::IsOkAndHolds;
 using ::absl_testing::StatusIs;
 using ::testing::_;
+using ::testing::ElementsAre;
 using ::testing::ElementsAreArray;
 using ::testing::HasSubstr;
 using ::testing::Pair;
@@ -1113,5 +1115,87 @@ TEST(DataBagTest, MergeImplicitSchemas) {
   }
 }
 
+TEST(DataBagTest, SpliceInplace) {
+  auto ds = DataSliceImpl::AllocateEmptyObjects(3);
+  auto new_ds = DataSliceImpl::AllocateEmptyObjects(3);
+  DataItem list(AllocateSingleList());
+  DataItem dict(AllocateSingleDict());
+  DataItem new_dict(AllocateSingleDict());
+
+  auto db = DataBagImpl::CreateEmptyDatabag();
+  ASSERT_OK(db->SetAttr(ds, "a", new_ds));
+  ASSERT_OK(db->SetInDict(dict, DataItem(1), DataItem(2)));
+  auto db_fork = db->PartiallyPersistentFork();
+
+  auto shard = DataBagImpl::CreateEmptyDatabag();
+  ASSERT_OK(shard->SetAttr(new_ds, "a", ds));
+  ASSERT_OK(shard->SetAttr(new_ds, "b",
+                           DataSliceImpl::Create(
+                               arolla::CreateDenseArray<int>({1, 2, 3}))));
+  ASSERT_OK(shard->SetAttr(ds, "a", new_ds));
+  ASSERT_OK(shard->AppendToList(list, DataItem(5)));
+  ASSERT_OK(shard->SetInDict(dict, DataItem(3), DataItem(4)));
+  ASSERT_OK(shard->SetInDict(new_dict, DataItem(5), DataItem(6)));
+
+  ASSERT_OK(db_fork->SpliceInplace(*shard));
+  EXPECT_THAT(db_fork->GetAttr(ds, "a"),
+              IsOkAndHolds(ElementsAreArray(new_ds)));
+  EXPECT_THAT(db_fork->GetAttr(new_ds, "a"),
+              IsOkAndHolds(ElementsAreArray(ds)));
+  EXPECT_THAT(db_fork->GetAttr(new_ds, "b"),
+              IsOkAndHolds(ElementsAreArray({1, 2, 3})));
+  EXPECT_THAT(db_fork->ExplodeList(list), IsOkAndHolds(ElementsAreArray({5})));
+  EXPECT_THAT(db_fork->GetFromDict(dict, DataItem(1)),
+              IsOkAndHolds(DataItem(2)));
+  EXPECT_THAT(db_fork->GetFromDict(dict, DataItem(3)),
+              IsOkAndHolds(DataItem(4)));
+  EXPECT_THAT(db_fork->GetFromDict(new_dict, DataItem(5)),
+              IsOkAndHolds(DataItem(6)));
+  // The parent is not modified.
+  EXPECT_THAT(db->GetAttr(new_ds, "b"),
+              IsOkAndHolds(ElementsAre(DataItem(), DataItem(), DataItem())));
+  EXPECT_THAT(db->GetFromDict(dict, DataItem(3)), IsOkAndHolds(DataItem()));
+
+  // Conflicts in the merged part are reported.
+  auto conflicting_shard = DataBagImpl::CreateEmptyDatabag();
+  ASSERT_OK(conflicting_shard->SetAttr(ds, "a", ds));
+  EXPECT_THAT(db->SpliceInplace(*conflicting_shard),
+              StatusIs(absl::StatusCode::kFailedPrecondition,
+                       HasSubstr("conflict")));
+}
+
+TEST(DataBagTest, SpliceInplaceIsAtomic) {
+  auto ds = DataSliceImpl::AllocateEmptyObjects(3);
+  auto new_ds = DataSliceImpl::AllocateEmptyObjects(3);
+  DataItem new_list(AllocateSingleList());
+
+  auto db = DataBagImpl::CreateEmptyDatabag();
+  ASSERT_OK(db->SetAttr(ds, "a", new_ds));
+
+  // The first shard can be spliced alone, the second one conflicts with `db`.
+  auto shard = DataBagImpl::CreateEmptyDatabag();
+  ASSERT_OK(shard->SetAttr(new_ds, "a", ds));
+  ASSERT_OK(shard->AppendToList(new_list, DataItem(5)));
+  auto conflicting_shard = DataBagImpl::CreateEmptyDatabag();
+  ASSERT_OK(conflicting_shard->SetAttr(ds, "a", ds));
+
+  DataBagImpl* shards[] = {shard.get(), conflicting_shard.get()};
+  EXPECT_THAT(db->SpliceInplace(shards),
+              StatusIs(absl::StatusCode::kFailedPrecondition,
+                       HasSubstr("conflict")));
+  // Neither `db` nor the shards are modified.
+  EXPECT_THAT(db->GetAttr(new_ds, "a"),
+              IsOkAndHolds(ElementsAre(DataItem(), DataItem(), DataItem())));
+  EXPECT_THAT(db->ExplodeList(new_list), IsOkAndHolds(ElementsAre()));
+  EXPECT_THAT(shard->GetAttr(new_ds, "a"),
+              IsOkAndHolds(ElementsAreArray(ds)));
+  EXPECT_THAT(shard->ExplodeList(new_list),
+              IsOkAndHolds(ElementsAreArray({5})));
+
+  ASSERT_OK(db->SpliceInplace(absl::MakeConstSpan(shards, 1)));
+  EXPECT_THAT(db->GetAttr(new_ds, "a"), IsOkAndHolds(ElementsAreArray(ds)));
+  EXPECT_THAT(db->ExplodeList(new_list), IsOkAndHolds(ElementsAreArray({5})));
+}
+
 }  // namespace
 }  // namespace koladata::internal
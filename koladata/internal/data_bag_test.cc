@@ -19,6 +19,7 @@
 #include <cstdint>
 #include <functional>
 #include <initializer_list>
+#include <memory>
 #include <optional>
 #include <string>
 #include <tuple>
@@ -30,6 +31,7 @@
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "koladata/internal/data_item.h"
 #include "koladata/internal/data_slice.h"
 #include "koladata/internal/dtype.h"
@@ -374,6 +376,65 @@ TEST(DataBagTest, GetAttrPrimitivesErrors) {
   }
 }
 
+TEST(DataBagTest, GetAttrs) {
+  for (size_t size : {1, 2, 4, 17, 126}) {
+    auto db = DataBagImpl::CreateEmptyDatabag();
+    auto db_f = DataBagImpl::CreateEmptyDatabag();
+
+    auto big = DataSliceImpl::AllocateEmptyObjects(size);
+    ObjectId small = AllocateSingleObject();
+    std::vector<DataItem> items;
+    for (size_t i = 0; i < size; ++i) {
+      items.push_back(i % 3 == 1 ? DataItem() : DataItem(big[i]));
+    }
+    items.push_back(DataItem(small));
+    auto ds = DataSliceImpl::Create(items);
+
+    std::vector<OptionalValue<int>> a_values(size + 1);
+    std::vector<OptionalValue<float>> b_values(size + 1);
+    for (size_t i = 0; i <= size; ++i) {
+      if (i % 2 == 0) a_values[i] = static_cast<int>(i);
+      if (i % 4 != 1) b_values[i] = 0.5f * i;
+    }
+    ASSERT_OK(db->SetAttr(
+        ds, "a",
+        DataSliceImpl::Create(arolla::CreateDenseArray<int>(a_values))));
+    ASSERT_OK(db_f->SetAttr(
+        ds, "b",
+        DataSliceImpl::Create(arolla::CreateDenseArray<float>(b_values))));
+    ASSERT_OK(db_f->SetAttr(ds, "a", ds));
+
+    std::vector<absl::string_view> attrs = {"a", "b", "c", "a"};
+    ASSERT_OK_AND_ASSIGN(std::vector<DataSliceImpl> res,
+                         db->GetAttrs(ds, attrs, {db_f.get()}));
+    ASSERT_EQ(res.size(), attrs.size());
+    for (size_t i = 0; i < attrs.size(); ++i) {
+      ASSERT_OK_AND_ASSIGN(DataSliceImpl expected,
+                           db->GetAttr(ds, attrs[i], {db_f.get()}));
+      EXPECT_THAT(res[i], IsEquivalentTo(expected)) << attrs[i];
+    }
+    EXPECT_TRUE(res[2].is_empty_and_unknown());
+  }
+}
+
+TEST(DataBagTest, GetAttrsEdgeCases) {
+  auto db = DataBagImpl::CreateEmptyDatabag();
+  auto ds = DataSliceImpl::AllocateEmptyObjects(3);
+  ASSERT_OK(db->SetAttr(ds, "a", ds));
+  EXPECT_THAT(db->GetAttrs(ds, {}), IsOkAndHolds(IsEmpty()));
+
+  ASSERT_OK_AND_ASSIGN(
+      auto res, db->GetAttrs(DataSliceImpl::CreateEmptyAndUnknownType(3),
+                             {"a", "b"}));
+  ASSERT_EQ(res.size(), 2);
+  EXPECT_TRUE(res[0].is_empty_and_unknown());
+  EXPECT_EQ(res[1].size(), 3);
+
+  EXPECT_THAT(db->GetAttrs(DataSliceImpl::Create({DataItem(1)}), {"a", "b"}),
+              StatusIs(absl::StatusCode::kFailedPrecondition,
+                       "getting attributes of primitives is not allowed"));
+}
+
 TEST(DataBagTest, SetGetWithFallbackObjectId) {
   for (size_t size : {1, 2, 4, 17, 126}) {
     auto db = DataBagImpl::CreateEmptyDatabag();
@@ -633,6 +694,39 @@ TEST(DataBagTest, SingleSparseSourceToDense) {
   }
 }
 
+TEST(DataBagTest, ReserveAttrForAllocation) {
+  constexpr size_t kAllocSize = 10000;
+  auto db = DataBagImpl::CreateEmptyDatabag();
+
+  AllocationId alloc = Allocate(kAllocSize);
+  ASSERT_OK(db->ReserveAttrForAllocation(alloc, "a",
+                                         arolla::GetQType<int32_t>()));
+  // Noop if already reserved.
+  ASSERT_OK(db->ReserveAttrForAllocation(alloc, "a"));
+
+  {  // Set 5 of 10000 -> goes to the reserved dense source
+    auto ds = DataSliceImpl::ObjectsFromAllocation(alloc, 5);
+    auto ds_a =
+        DataSliceImpl::Create(arolla::CreateConstDenseArray<int>(5, 57));
+    ASSERT_OK(db->SetAttr(ds, "a", ds_a));
+  }
+  {
+    DataBagImpl::ConstDenseSourceArray dense_sources;
+    DataBagImpl::ConstSparseSourceArray sparse_sources;
+    db->GetAttributeDataSources(alloc, "a", dense_sources, sparse_sources);
+    EXPECT_EQ(dense_sources.size(), 1);
+    EXPECT_EQ(sparse_sources.size(), 0);
+  }
+  EXPECT_THAT(db->GetAttr(DataItem(alloc.ObjectByOffset(3)), "a"),
+              IsOkAndHolds(DataItem(57)));
+  EXPECT_THAT(db->GetAttr(DataItem(alloc.ObjectByOffset(7)), "a"),
+              IsOkAndHolds(DataItem()));
+
+  EXPECT_THAT(db->ReserveAttrForAllocation(
+                  AllocationId(AllocateSingleObject()), "a"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 TEST(DataBagTest, SparseSource) {
   constexpr size_t kAllocSize = 10000;
   auto db = DataBagImpl::CreateEmptyDatabag();
@@ -1700,6 +1794,146 @@ TEST(DataBagTest, GetApproxTotalSize) {
   }
 }
 
+TEST(DataBagTest, ContentFingerprint) {
+  auto objs = DataSliceImpl::AllocateEmptyObjects(3);
+  auto small_obj = DataSliceImpl::AllocateEmptyObjects(1)[0];
+  auto values = DataSliceImpl::Create(
+      {DataItem(1), DataItem(), DataItem(arolla::Text("x"))});
+  DataSliceImpl lists =
+      DataSliceImpl::ObjectsFromAllocation(AllocateLists(2), 2);
+  DataSliceImpl dicts =
+      DataSliceImpl::ObjectsFromAllocation(AllocateDicts(2), 2);
+
+  auto empty_db = DataBagImpl::CreateEmptyDatabag();
+  ASSERT_OK_AND_ASSIGN(auto empty_fp, empty_db->ContentFingerprint());
+
+  auto db1 = DataBagImpl::CreateEmptyDatabag();
+  ASSERT_OK(db1->SetAttr(objs, "a", values));
+  ASSERT_OK(db1->SetAttr(small_obj, "b", DataItem(2.0f)));
+  ASSERT_OK(db1->ExtendList(
+      lists[0], DataSliceImpl::Create({DataItem(4), DataItem(5)})));
+  ASSERT_OK(db1->SetInDict(dicts[1], DataItem(1), DataItem(2)));
+  ASSERT_OK_AND_ASSIGN(auto fp1, db1->ContentFingerprint());
+  EXPECT_NE(fp1, empty_fp);
+  EXPECT_THAT(db1->ContentFingerprint(), IsOkAndHolds(fp1));
+
+  {
+    SCOPED_TRACE("same content, different order and storage");
+    auto db2 = DataBagImpl::CreateEmptyDatabag();
+    ASSERT_OK(db2->SetInDict(dicts[1], DataItem(1), DataItem(2)));
+    ASSERT_OK(db2->AppendToList(lists[0], DataItem(4)));
+    ASSERT_OK(db2->SetAttr(small_obj, "b", DataItem(2.0f)));
+    ASSERT_OK(db2->SetAttr(objs[2], "a", DataItem(arolla::Text("x"))));
+    ASSERT_OK(db2->SetAttr(objs[0], "a", DataItem(1)));
+    ASSERT_OK(db2->AppendToList(lists[0], DataItem(5)));
+    EXPECT_THAT(db2->ContentFingerprint(), IsOkAndHolds(fp1));
+  }
+  {
+    SCOPED_TRACE("incremental updates");
+    auto db2 = DataBagImpl::CreateEmptyDatabag();
+    EXPECT_THAT(db2->ContentFingerprint(), IsOkAndHolds(empty_fp));
+    ASSERT_OK(db2->SetAttr(objs, "a", values));
+    ASSERT_OK(db2->SetAttr(small_obj, "b", DataItem(3.0f)));
+    EXPECT_THAT(db2->ContentFingerprint(), IsOkAndHolds(Ne(fp1)));
+    ASSERT_OK(db2->SetAttr(small_obj, "b", DataItem(2.0f)));
+    ASSERT_OK(db2->ExtendList(
+        lists[0], DataSliceImpl::Create({DataItem(4), DataItem(5)})));
+    ASSERT_OK(db2->SetInDict(dicts[1], DataItem(1), DataItem(2)));
+    ASSERT_OK(db2->SetInDict(dicts[0], DataItem(7), DataItem(8)));
+    EXPECT_THAT(db2->ContentFingerprint(), IsOkAndHolds(Ne(fp1)));
+    ASSERT_OK(db2->ClearDict(dicts[0]));
+    EXPECT_THAT(db2->ContentFingerprint(), IsOkAndHolds(fp1));
+  }
+  {
+    SCOPED_TRACE("forks");
+    auto fork = db1->PartiallyPersistentFork();
+    EXPECT_THAT(fork->ContentFingerprint(), IsOkAndHolds(fp1));
+    ASSERT_OK(fork->SetAttr(objs[1], "a", DataItem(7)));
+    ASSERT_OK(fork->SetInList(lists[0], 0, DataItem(6)));
+    ASSERT_OK_AND_ASSIGN(auto fork_fp, fork->ContentFingerprint());
+    EXPECT_NE(fork_fp, fp1);
+    EXPECT_THAT(db1->ContentFingerprint(), IsOkAndHolds(fp1));
+
+    ASSERT_OK(fork->SetAttr(objs[1], "a", DataItem()));
+    ASSERT_OK(fork->SetInList(lists[0], 0, DataItem(4)));
+    EXPECT_THAT(fork->ContentFingerprint(), IsOkAndHolds(fp1));
+
+    auto fork2 = fork->PartiallyPersistentFork();
+    ASSERT_OK(fork2->SetAttr(objs[1], "a", DataItem(7)));
+    ASSERT_OK(fork2->SetInList(lists[0], 0, DataItem(6)));
+    EXPECT_THAT(fork2->ContentFingerprint(), IsOkAndHolds(fork_fp));
+  }
+}
+
+TEST(DataBagTest, ModificationSnapshot) {
+  auto objs = DataSliceImpl::AllocateEmptyObjects(3);
+  auto other_objs = DataSliceImpl::AllocateEmptyObjects(3);
+  auto small_obj = DataSliceImpl::AllocateEmptyObjects(1)[0];
+  AllocationId alloc(objs[0].value<ObjectId>());
+  AllocationId other_alloc(other_objs[0].value<ObjectId>());
+  AllocationId small_alloc(small_obj.value<ObjectId>());
+
+  auto tracker = std::make_shared<DataBagImpl::ModificationTracker>();
+  auto db = DataBagImpl::CreateEmptyDatabag();
+  auto snapshot = db->GetModificationSnapshot(tracker);
+  EXPECT_NE(snapshot.databag_id, 0);
+  EXPECT_EQ(db->GetModificationSnapshot(tracker), snapshot);
+  EXPECT_FALSE(db->IsAllocationModifiedSince(alloc, snapshot));
+
+  ASSERT_OK(db->SetAttr(objs[1], "a", DataItem(1)));
+  EXPECT_NE(db->GetModificationSnapshot(tracker), snapshot);
+  EXPECT_TRUE(db->IsAllocationModifiedSince(alloc, snapshot));
+  EXPECT_FALSE(db->IsAllocationModifiedSince(other_alloc, snapshot));
+  EXPECT_FALSE(db->IsAllocationModifiedSince(small_alloc, snapshot));
+
+  snapshot = db->GetModificationSnapshot(tracker);
+  ASSERT_OK(db->SetAttr(small_obj, "b", DataItem(2)));
+  EXPECT_FALSE(db->IsAllocationModifiedSince(alloc, snapshot));
+  EXPECT_TRUE(db->IsAllocationModifiedSince(small_alloc, snapshot));
+
+  {
+    SCOPED_TRACE("forks");
+    snapshot = db->GetModificationSnapshot(tracker);
+    auto fork = db->PartiallyPersistentFork();
+    EXPECT_FALSE(fork->IsAllocationModifiedSince(alloc, snapshot));
+    ASSERT_OK(fork->SetAttr(other_objs[0], "a", DataItem(1)));
+    EXPECT_FALSE(fork->IsAllocationModifiedSince(alloc, snapshot));
+    EXPECT_TRUE(fork->IsAllocationModifiedSince(other_alloc, snapshot));
+    EXPECT_FALSE(db->IsAllocationModifiedSince(other_alloc, snapshot));
+
+    auto fork_snapshot = fork->GetModificationSnapshot(tracker);
+    EXPECT_TRUE(db->IsAllocationModifiedSince(alloc, fork_snapshot));
+  }
+  {
+    SCOPED_TRACE("tracking starts after modifications");
+    auto db2 = DataBagImpl::CreateEmptyDatabag();
+    ASSERT_OK(db2->SetAttr(objs[0], "a", DataItem(1)));
+    auto snapshot2 = db2->GetModificationSnapshot(tracker);
+    EXPECT_FALSE(db2->IsAllocationModifiedSince(alloc, snapshot2));
+    EXPECT_TRUE(db2->IsAllocationModifiedSince(alloc, snapshot));
+    EXPECT_TRUE(db2->IsAllocationModifiedSince(
+        alloc, DataBagImpl::ModificationSnapshot()));
+  }
+  {
+    SCOPED_TRACE("tracking stops with the tracker");
+    auto db3 = DataBagImpl::CreateEmptyDatabag();
+    auto tracker3 = std::make_shared<DataBagImpl::ModificationTracker>();
+    auto snapshot3 = db3->GetModificationSnapshot(tracker3);
+    tracker3 = nullptr;
+    ASSERT_OK(db3->SetAttr(objs[0], "a", DataItem(1)));
+    // The modification is not tracked anymore, so any allocation could have
+    // been modified.
+    EXPECT_TRUE(db3->IsAllocationModifiedSince(other_alloc, snapshot3));
+    auto fork = db3->PartiallyPersistentFork();
+    ASSERT_OK(fork->SetAttr(objs[0], "a", DataItem(2)));
+    EXPECT_TRUE(fork->IsAllocationModifiedSince(other_alloc, snapshot3));
+
+    snapshot3 = db3->GetModificationSnapshot(tracker);
+    EXPECT_NE(snapshot3.databag_id, snapshot.databag_id);
+    EXPECT_FALSE(db3->IsAllocationModifiedSince(other_alloc, snapshot3));
+  }
+}
+
 // NOTE(b/343432263): msan regression test to ensure that the DataBagImpl
 // destructor does not cause use-of-uninitialized-value issues.
 using DataBagMsanTest = ::testing::TestWithParam<DataBagImplPtr>;
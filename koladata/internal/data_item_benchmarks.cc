@@ -13,6 +13,7 @@
 // limitations under the License.
 //
 #include <cstdint>
+#include <vector>
 
 #include "benchmark/benchmark.h"
 #include "koladata/internal/data_item.h"
@@ -57,5 +58,71 @@ void BM_AllocateLongText(benchmark::State& state) {
 
 BENCHMARK(BM_AllocateLongText);
 
+void BM_CopyLongText(benchmark::State& state) {
+  DataItem item(
+      arolla::Text("string that longer than short string optimization"));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(item);
+    DataItem copy = item;
+    benchmark::DoNotOptimize(copy);
+  }
+}
+
+BENCHMARK(BM_CopyLongText);
+
+// Short strings fit std::string's inline buffer and need no heap allocation.
+void BM_AllocateShortText(benchmark::State& state) {
+  arolla::Text value("short");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(value);
+    DataItem item(value);
+    benchmark::DoNotOptimize(item);
+  }
+}
+
+BENCHMARK(BM_AllocateShortText);
+
+void BM_CopyShortText(benchmark::State& state) {
+  DataItem item(arolla::Text("short"));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(item);
+    DataItem copy = item;
+    benchmark::DoNotOptimize(copy);
+  }
+}
+
+BENCHMARK(BM_CopyShortText);
+
+void BM_CopyMixedVector(benchmark::State& state) {
+  int64_t size = state.range(0);
+  std::vector<DataItem> items;
+  items.reserve(size);
+  for (int64_t i = 0; i < size; ++i) {
+    switch (i % 4) {
+      case 0:
+        items.emplace_back(static_cast<int32_t>(i));
+        break;
+      case 1:
+        items.emplace_back(AllocateSingleObject());
+        break;
+      case 2:
+        items.emplace_back(arolla::Text(
+            "string that longer than short string optimization"));
+        break;
+      default:
+        items.emplace_back();
+    }
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(items);
+    std::vector<DataItem> copy = items;
+    benchmark::DoNotOptimize(copy);
+  }
+  state.counters["bytes_per_item"] = sizeof(DataItem);
+  state.SetItemsProcessed(state.iterations() * size);
+}
+
+BENCHMARK(BM_CopyMixedVector)->Arg(10)->Arg(1000);
+
 }  // namespace
 }  // namespace koladata::internal
@@ -27,6 +27,9 @@
 #include "koladata/internal/data_slice.h"
 #include "koladata/internal/object_id.h"
 #include "koladata/internal/slice_builder.h"
+#include "arolla/qtype/base_types.h"
+#include "arolla/qtype/qtype.h"
+#include "arolla/qtype/qtype_traits.h"
 #include "arolla/util/meta.h"
 
 namespace koladata::internal {
@@ -94,6 +97,20 @@ void DataList::AddToDataSlice(SliceBuilder& bldr, int64_t offset,
       data_);
 }
 
+const arolla::QType* DataList::dtype() const {
+  return std::visit(
+      []<typename VecT>(const VecT& vec) -> const arolla::QType* {
+        if constexpr (std::is_same_v<VecT, AllMissing>) {
+          return arolla::GetNothingQType();
+        } else if constexpr (std::is_same_v<VecT, std::vector<DataItem>>) {
+          return nullptr;
+        } else {
+          return arolla::GetQType<typename VecT::value_type::value_type>();
+        }
+      },
+      data_);
+}
+
 DataItem DataList::Get(int64_t index) const {
   DCHECK(0 <= index && index < size_);
   DataItem res;
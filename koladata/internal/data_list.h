@@ -25,6 +25,7 @@
 #include <vector>
 
 #include "absl/log/check.h"
+#include "absl/types/span.h"
 #include "koladata/internal/data_item.h"
 #include "koladata/internal/data_slice.h"
 #include "koladata/internal/dtype.h"
@@ -34,6 +35,7 @@
 #include "arolla/dense_array/dense_array.h"
 #include "arolla/expr/quote.h"
 #include "arolla/memory/optional_value.h"
+#include "arolla/qtype/qtype.h"
 #include "arolla/util/bytes.h"
 #include "arolla/util/iterator.h"
 #include "arolla/util/meta.h"
@@ -80,6 +82,22 @@ class DataList {
   size_t size() const { return size_; }
   bool empty() const { return size() == 0; }
 
+  // Returns the type of the values if they are stored in a typed
+  // representation, `arolla::GetNothingQType()` if all values are missing and
+  // nullptr if values are stored as DataItems (i.e. types can be mixed).
+  const arolla::QType* dtype() const;
+
+  // Returns values stored in a typed representation, or an empty span if all
+  // values are missing. `T` must match `dtype()` unless all values are missing.
+  template <typename T>
+  absl::Span<const std::optional<T>> typed_values() const {
+    if (const auto* vec = std::get_if<std::vector<std::optional<T>>>(&data_)) {
+      return *vec;
+    }
+    DCHECK(std::holds_alternative<AllMissing>(data_));
+    return {};
+  }
+
   // Adds value from this list (sliced from `from` to `to`, full list
   // by default) to the data slice builder starting from `offset`.
   // I.e. the value `list[from + i]` will go to `bldr[offset + i]`.
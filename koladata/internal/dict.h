@@ -147,6 +147,9 @@ class Dict {
   std::vector<DataItem> GetValues(
       absl::Span<const Dict* const> fallbacks = {}) const;
 
+  // Reserves space for `count` more keys in this dict (not in parents).
+  void Reserve(size_t count) { data_.reserve(data_.size() + count); }
+
   size_t GetSizeNoFallbacks() const {
     auto* dict = FindFirstNonEmpty();
     if (dict == nullptr) {
@@ -26,6 +26,7 @@
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "koladata/internal/data_slice.h"
+#include "koladata/internal/op_utils/parallel_gather.h"
 #include "koladata/internal/slice_builder.h"
 #include "arolla/dense_array/dense_array.h"
 #include "arolla/dense_array/edge.h"
@@ -105,6 +106,9 @@ absl::StatusOr<DataSliceImpl> AtOp(
       ASSIGN_OR_RETURN(auto res, SelectWithOffsets(array, indices, ds_to_common,
                                                    *indices_to_common));
       builder.InsertIfNotSet<T>(res.bitmap, {}, res.values);
+    } else if (UseParallelGather<T>(indices.size())) {
+      auto res = ParallelAt(array, indices);
+      builder.InsertIfNotSet<T>(res.bitmap, {}, res.values);
     } else {
       // NOTE: out-of-bound errors are reported to the EvaluationContext and
       // ignored here.
@@ -18,15 +18,18 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "koladata/internal/data_bag.h"
 #include "koladata/internal/data_item.h"
 #include "koladata/internal/data_slice.h"
@@ -47,12 +50,28 @@ namespace {
 
 class DeepUuidVisitor : AbstractVisitor {
  public:
-  explicit DeepUuidVisitor(absl::string_view seed) : seed_(seed) {}
+  // If `cached_entries` is not null, they are reused and the newly computed
+  // values are collected in new_entries().
+  DeepUuidVisitor(absl::string_view seed,
+                  const DeepUuidCache::EntryMap* cached_entries)
+      : seed_(seed), cached_entries_(cached_entries) {}
 
   absl::Status Previsit(const DataItem& item, const DataItem& schema) override {
     return absl::OkStatus();
   }
 
+  bool SkipTraversal(const DataItem& item, const DataItem& schema) {
+    if (cached_entries_ == nullptr || !item.holds_value<ObjectId>()) {
+      return false;
+    }
+    auto it = cached_entries_->find(DeepUuidCache::Key(item, schema));
+    if (it == cached_entries_->end()) {
+      return false;
+    }
+    object_tracker_.emplace(item, it->second.uuid);
+    return true;
+  }
+
   absl::StatusOr<DataItem> GetValue(const DataItem& item,
                                     const DataItem& schema) override {
     if (!item.holds_value<ObjectId>()) {
@@ -61,7 +80,18 @@ class DeepUuidVisitor : AbstractVisitor {
     if (schema == schema::kItemId) {
       return item;
     }
+    if (cached_entries_ != nullptr) {
+      deps_.emplace_back(item, schema);
+    }
     auto item_it = object_tracker_.find(item);
+    if (item_it == object_tracker_.end() && cached_entries_ != nullptr) {
+      // Values of the items reachable only from skipped ones, e.g. attribute
+      // schemas of a skipped schema.
+      if (auto it = cached_entries_->find(DeepUuidCache::Key(item, schema));
+          it != cached_entries_->end()) {
+        item_it = object_tracker_.emplace(item, it->second.uuid).first;
+      }
+    }
     if (item_it == object_tracker_.end()) {
       return absl::InvalidArgumentError(
           absl::StrFormat("object %v is not found, cyclic attributes are not "
@@ -75,6 +105,7 @@ class DeepUuidVisitor : AbstractVisitor {
                          bool is_object_schema,
                          const DataSliceImpl& items) override {
     DCHECK(list.is_list());
+    AddSchemaDep(schema, is_object_schema);
     DataItem uuid;
     if (is_object_schema) {
       ASSIGN_OR_RETURN(auto schema_value,
@@ -84,7 +115,8 @@ class DeepUuidVisitor : AbstractVisitor {
     } else {
       uuid = CreateListUuidFromItemsAndFields(seed_, items, {}, {});
     }
-    object_tracker_.emplace(list, std::move(uuid));
+    AddValue(list, is_object_schema ? DataItem(schema::kObject) : schema,
+             std::move(uuid));
     return absl::OkStatus();
   }
 
@@ -93,6 +125,7 @@ class DeepUuidVisitor : AbstractVisitor {
                          const DataSliceImpl& values) override {
     DCHECK(dict.is_dict());
     DCHECK(keys.size() == values.size());
+    AddSchemaDep(schema, is_object_schema);
     DataItem uuid;
     if (is_object_schema) {
       ASSIGN_OR_RETURN(auto schema_value,
@@ -103,7 +136,8 @@ class DeepUuidVisitor : AbstractVisitor {
     } else {
       uuid = CreateDictUuidFromKeysValuesAndFields(seed_, keys, values, {}, {});
     }
-    object_tracker_.emplace(dict, std::move(uuid));
+    AddValue(dict, is_object_schema ? DataItem(schema::kObject) : schema,
+             std::move(uuid));
     return absl::OkStatus();
   }
 
@@ -112,6 +146,7 @@ class DeepUuidVisitor : AbstractVisitor {
       const arolla::DenseArray<arolla::Text>& attr_names,
       const arolla::DenseArray<DataItem>& attr_values) override {
     DCHECK(object.holds_value<ObjectId>());
+    AddSchemaDep(schema, is_object_schema);
     std::vector<std::string_view> attr_names_view;
     attr_names_view.reserve(attr_names.size());
     for (int64_t i = 0; i < attr_names.size(); ++i) {
@@ -131,7 +166,8 @@ class DeepUuidVisitor : AbstractVisitor {
     }
     DataItem uuid =
         CreateUuidFromFields(seed_, attr_names_view, attr_values_view);
-    object_tracker_.emplace(object, std::move(uuid));
+    AddValue(object, is_object_schema ? DataItem(schema::kObject) : schema,
+             std::move(uuid));
     return absl::OkStatus();
   }
 
@@ -151,7 +187,7 @@ class DeepUuidVisitor : AbstractVisitor {
     });
     DataItem uuid =
         CreateSchemaUuidFromFields(seed_, attr_names_view, attr_schemas_view);
-    object_tracker_.emplace(item, std::move(uuid));
+    AddValue(item, schema, std::move(uuid));
     return absl::OkStatus();
   }
 
@@ -160,13 +196,115 @@ class DeepUuidVisitor : AbstractVisitor {
     return absl::OkStatus();
   }
 
+  std::vector<std::pair<DeepUuidCache::Key, DeepUuidCache::Entry>>&
+  new_entries() {
+    return new_entries_;
+  }
+
  private:
+  // The uuid of an entity depends on the attributes of its schema.
+  void AddSchemaDep(const DataItem& schema, bool is_object_schema) {
+    // For objects, the schema value is requested with GetValue.
+    if (cached_entries_ != nullptr && !is_object_schema &&
+        schema.holds_value<ObjectId>()) {
+      deps_.emplace_back(schema, DataItem(schema::kSchema));
+    }
+  }
+
+  // Stores the uuid of `item` computed from the values requested since the
+  // previous call.
+  void AddValue(const DataItem& item, const DataItem& schema, DataItem uuid) {
+    if (cached_entries_ != nullptr) {
+      new_entries_.emplace_back(
+          DeepUuidCache::Key(item, schema),
+          DeepUuidCache::Entry{.uuid = uuid, .deps = std::move(deps_)});
+      deps_.clear();
+    }
+    object_tracker_.emplace(item, std::move(uuid));
+  }
+
   absl::string_view seed_;
   absl::flat_hash_map<DataItem, DataItem, DataItem::Hash> object_tracker_;
+  const DeepUuidCache::EntryMap* cached_entries_;
+  std::vector<DeepUuidCache::Key> deps_;
+  std::vector<std::pair<DeepUuidCache::Key, DeepUuidCache::Entry>>
+      new_entries_;
 };
 
 };  // namespace
 
+size_t DeepUuidCache::KeyHash::operator()(const Key& key) const {
+  return absl::HashOf(DataItem::Hash()(key.first),
+                      DataItem::Hash()(key.second));
+}
+
+void DeepUuidCache::Clear() {
+  tracker_ = std::make_shared<DataBagImpl::ModificationTracker>();
+  seed_.clear();
+  snapshots_.clear();
+  entries_.clear();
+}
+
+void DeepUuidCache::Update(absl::string_view seed,
+                           absl::Span<const DataBagImpl* const> databags) {
+  if (!track_modifications_) {
+    if (seed != seed_) {
+      entries_.clear();
+      seed_ = std::string(seed);
+    }
+    return;
+  }
+  std::vector<DataBagImpl::ModificationSnapshot> snapshots;
+  snapshots.reserve(databags.size());
+  for (const DataBagImpl* databag : databags) {
+    snapshots.push_back(databag->GetModificationSnapshot(tracker_));
+  }
+  if (seed == seed_ && snapshots == snapshots_) {
+    return;
+  }
+  if (seed != seed_ || snapshots.size() != snapshots_.size()) {
+    entries_.clear();
+  } else if (!entries_.empty()) {
+    std::vector<Key> removed;
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      AllocationId alloc(it->first.first.value<ObjectId>());
+      bool is_modified = false;
+      for (size_t i = 0; i < databags.size() && !is_modified; ++i) {
+        is_modified =
+            databags[i]->IsAllocationModifiedSince(alloc, snapshots_[i]);
+      }
+      if (is_modified) {
+        removed.push_back(it->first);
+        entries_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+    if (!removed.empty() && !entries_.empty()) {
+      absl::flat_hash_map<Key, std::vector<Key>, KeyHash> dependents;
+      for (const auto& [key, entry] : entries_) {
+        for (const Key& dep : entry.deps) {
+          dependents[dep].push_back(key);
+        }
+      }
+      // `removed` grows while we iterate.
+      for (size_t i = 0; i < removed.size(); ++i) {
+        auto it = dependents.find(removed[i]);
+        if (it == dependents.end()) {
+          continue;
+        }
+        for (const Key& dependent : it->second) {
+          if (entries_.erase(dependent) > 0) {
+            removed.push_back(dependent);
+          }
+        }
+      }
+    }
+  }
+  seed_ = std::string(seed);
+  snapshots_ = std::move(snapshots);
+}
+
 absl::StatusOr<DataSliceImpl> DeepUuidOp::operator()(
     const DataItem& seed, const DataSliceImpl& ds, const DataItem& schema,
     const DataBagImpl& databag, DataBagImpl::FallbackSpan fallbacks) const {
@@ -179,7 +317,15 @@ absl::StatusOr<DataSliceImpl> DeepUuidOp::operator()(
           absl::StrFormat("seed must be a string, got %v", seed));
     }
   }
-  auto visitor = std::make_shared<DeepUuidVisitor>(seed_str);
+  if (cache_ != nullptr) {
+    std::vector<const DataBagImpl*> databags;
+    databags.reserve(fallbacks.size() + 1);
+    databags.push_back(&databag);
+    databags.insert(databags.end(), fallbacks.begin(), fallbacks.end());
+    cache_->Update(seed_str, databags);
+  }
+  auto visitor = std::make_shared<DeepUuidVisitor>(
+      seed_str, cache_ != nullptr ? &cache_->entries_ : nullptr);
   auto traverse_op = Traverser<DeepUuidVisitor>(databag, fallbacks, visitor);
   RETURN_IF_ERROR(traverse_op.TraverseSlice(ds, schema));
   SliceBuilder result_items(ds.size());
@@ -197,6 +343,14 @@ absl::StatusOr<DataSliceImpl> DeepUuidOp::operator()(
     }
     result_items.InsertIfNotSetAndUpdateAllocIds(i, value);
   }
+  if (cache_ != nullptr) {
+    for (auto& [key, entry] : visitor->new_entries()) {
+      cache_->entries_.insert_or_assign(std::move(key), std::move(entry));
+    }
+    if (cache_->size() > cache_->max_size_) {
+      cache_->entries_.clear();
+    }
+  }
   return std::move(result_items).Build();
 }
 
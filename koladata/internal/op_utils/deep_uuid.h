@@ -15,19 +15,95 @@
 #ifndef KOLADATA_INTERNAL_OP_UTILS_DEEP_UUID_H_
 #define KOLADATA_INTERNAL_OP_UTILS_DEEP_UUID_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "koladata/internal/data_bag.h"
 #include "koladata/internal/data_item.h"
 #include "koladata/internal/data_slice.h"
 
 namespace koladata::internal {
 
+// Memoizes deep uuids of subtrees between DeepUuidOp calls, so that only the
+// subtrees affected by modifications are rehashed.
+//
+// An entry for an (item, schema) is reused while the data of its subtree is
+// unchanged:
+// - A write to a DataBagImpl invalidates the entries of the objects (and
+//   schemas) from the modified allocations, and all entries depending on them.
+// - A fork sees the entries computed on its parents, except for the
+//   allocations modified in the fork.
+// - A call with another seed, a different number of fallbacks, or DataBagImpls
+//   that are not the previously used ones or their forks, invalidates all
+//   entries.
+//
+// Modifications of the DataBagImpls the cache was used with, and of their
+// forks, are tracked until the cache is destroyed or cleared.
+//
+// If `track_modifications` is false, the cache must always be used with the
+// same DataBagImpls, which must never be modified, e.g. the ones of an
+// immutable DataBag. Then only a change of the seed invalidates the entries,
+// and no modification tracking is started.
+//
+// Not thread-safe.
+class DeepUuidCache {
+ public:
+  explicit DeepUuidCache(int64_t max_size = int64_t{1} << 20,
+                         bool track_modifications = true)
+      : max_size_(max_size), track_modifications_(track_modifications) {}
+
+  int64_t size() const { return entries_.size(); }
+
+  void Clear();
+
+  // (item, schema), where schema is kObject for objects.
+  using Key = std::pair<DataItem, DataItem>;
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+
+  struct Entry {
+    DataItem uuid;
+    // Keys of the values the uuid was computed from.
+    std::vector<Key> deps;
+  };
+
+  using EntryMap = absl::flat_hash_map<Key, Entry, KeyHash>;
+
+ private:
+  friend class DeepUuidOp;
+
+  // Removes the entries that are not valid for the given DataBagImpls anymore
+  // and makes them the current ones.
+  void Update(absl::string_view seed,
+              absl::Span<const DataBagImpl* const> databags);
+
+  int64_t max_size_;
+  bool track_modifications_;
+  DataBagImpl::ModificationTrackerPtr tracker_ =
+      std::make_shared<DataBagImpl::ModificationTracker>();
+  std::string seed_;
+  std::vector<DataBagImpl::ModificationSnapshot> snapshots_;
+  EntryMap entries_;
+};
+
 // Recursively computes uuid for the given slice.
 class DeepUuidOp {
  public:
   explicit DeepUuidOp() = default;
 
+  // Reuses and updates deep uuids memoized in `cache`.
+  explicit DeepUuidOp(DeepUuidCache* cache) : cache_(cache) {}
+
   absl::StatusOr<DataSliceImpl> operator()(
       const DataItem& seed, const DataSliceImpl& ds, const DataItem& schema,
       const DataBagImpl& databag,
@@ -37,6 +113,9 @@ class DeepUuidOp {
       const DataItem& seed, const DataItem& item, const DataItem& schema,
       const DataBagImpl& databag,
       DataBagImpl::FallbackSpan fallbacks = {}) const;
+
+ private:
+  DeepUuidCache* cache_ = nullptr;
 };
 
 }  // namespace koladata::internal
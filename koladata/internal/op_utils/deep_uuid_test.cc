@@ -505,5 +505,127 @@ TEST_P(DeepUuidTest, CyclicReferences) {
                            "cyclic attributes are not allowed in deep_uuid")));
 }
 
+TEST_P(DeepUuidTest, Cache) {
+  auto db = DataBagImpl::CreateEmptyDatabag();
+  auto obj_ids = DataSliceImpl::AllocateEmptyObjects(6);
+  auto a0 = obj_ids[0];
+  auto a1 = obj_ids[1];
+  auto a2 = obj_ids[2];
+  auto b0 = obj_ids[3];
+  auto b1 = obj_ids[4];
+  auto b2 = obj_ids[5];
+  auto ds =
+      DataSliceImpl::Create(arolla::CreateDenseArray<DataItem>({a0, a1, a2}));
+  auto schema_a = AllocateSchema();
+  auto schema_b = AllocateSchema();
+  TriplesT data_triples = {{a0, {{"x", DataItem("a")}, {"b", b0}}},
+                           {a1, {{"x", DataItem("b")}, {"b", b1}}},
+                           {a2, {{"x", DataItem("c")}, {"b", b2}}},
+                           {b0, {{"y", DataItem(4)}}},
+                           {b1, {{"y", DataItem(5)}}},
+                           {b2, {{"y", DataItem(5)}}}};
+  TriplesT schema_triples = {
+      {schema_a, {{"x", DataItem(schema::kBytes)}, {"b", schema_b}}},
+      {schema_b, {{"y", DataItem(schema::kInt32)}}}};
+  SetDataTriples(*db, data_triples);
+  SetSchemaTriples(*db, schema_triples);
+
+  DeepUuidCache cache;
+  auto main_db = GetMainDb(db);
+  auto fallback_db = GetFallbackDb(db);
+  auto expect_same_as_uncached = [&](const DataBagImplPtr& main_db,
+                                     const DataBagImplPtr& fallback_db) {
+    ASSERT_OK_AND_ASSIGN(
+        auto expected,
+        DeepUuidOp()(DataItem(arolla::Text("")), ds, schema_a, *main_db,
+                     {fallback_db.get()}));
+    ASSERT_OK_AND_ASSIGN(
+        auto result,
+        DeepUuidOp(&cache)(DataItem(arolla::Text("")), ds, schema_a, *main_db,
+                           {fallback_db.get()}));
+    ASSERT_EQ(result.size(), expected.size());
+    for (int64_t i = 0; i < expected.size(); ++i) {
+      EXPECT_EQ(result[i], expected[i]) << i;
+    }
+  };
+
+  expect_same_as_uncached(main_db, fallback_db);
+  EXPECT_GT(cache.size(), 0);
+  expect_same_as_uncached(main_db, fallback_db);
+
+  // Modification of a nested entity.
+  ASSERT_OK(db->SetAttr(b2, "y", DataItem(11)));
+  expect_same_as_uncached(main_db, fallback_db);
+
+  // Modification of a schema.
+  ASSERT_OK(db->SetSchemaAttr(schema_b, "z", DataItem(schema::kInt32)));
+  ASSERT_OK(db->SetAttr(b1, "z", DataItem(7)));
+  expect_same_as_uncached(main_db, fallback_db);
+
+  // Modification in a fork.
+  auto forked_db = db->PartiallyPersistentFork();
+  ASSERT_OK(forked_db->SetAttr(b0, "y", DataItem(12)));
+  expect_same_as_uncached(GetMainDb(forked_db), GetFallbackDb(forked_db));
+  expect_same_as_uncached(main_db, fallback_db);
+
+  // Different DataBag with the same ObjectIds.
+  auto other_db = DataBagImpl::CreateEmptyDatabag();
+  SetDataTriples(*other_db, data_triples);
+  SetSchemaTriples(*other_db, schema_triples);
+  expect_same_as_uncached(GetMainDb(other_db), GetFallbackDb(other_db));
+
+  // Different seed.
+  ASSERT_OK_AND_ASSIGN(
+      auto result,
+      DeepUuidOp(&cache)(DataItem(arolla::Text("a")), ds, schema_a, *db));
+  ASSERT_OK_AND_ASSIGN(
+      auto expected,
+      DeepUuidOp()(DataItem(arolla::Text("a")), ds, schema_a, *db));
+  EXPECT_EQ(result[0], expected[0]);
+
+  cache.Clear();
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST_P(DeepUuidTest, CacheWithoutModificationTracking) {
+  auto db = DataBagImpl::CreateEmptyDatabag();
+  auto obj_ids = DataSliceImpl::AllocateEmptyObjects(4);
+  auto a0 = obj_ids[0];
+  auto a1 = obj_ids[1];
+  auto b0 = obj_ids[2];
+  auto b1 = obj_ids[3];
+  auto ds = DataSliceImpl::Create(arolla::CreateDenseArray<DataItem>({a0, a1}));
+  auto schema_a = AllocateSchema();
+  auto schema_b = AllocateSchema();
+  TriplesT data_triples = {{a0, {{"x", DataItem(1)}, {"b", b0}}},
+                           {a1, {{"x", DataItem(2)}, {"b", b1}}},
+                           {b0, {{"y", DataItem(3)}}},
+                           {b1, {{"y", DataItem(3)}}}};
+  TriplesT schema_triples = {
+      {schema_a, {{"x", DataItem(schema::kInt32)}, {"b", schema_b}}},
+      {schema_b, {{"y", DataItem(schema::kInt32)}}}};
+  SetDataTriples(*db, data_triples);
+  SetSchemaTriples(*db, schema_triples);
+
+  DeepUuidCache cache(/*max_size=*/1 << 20, /*track_modifications=*/false);
+  auto main_db = GetMainDb(db);
+  auto fallback_db = GetFallbackDb(db);
+  for (std::string_view seed : {"", "", "a", "a", ""}) {
+    ASSERT_OK_AND_ASSIGN(
+        auto expected,
+        DeepUuidOp()(DataItem(arolla::Text(seed)), ds, schema_a, *main_db,
+                     {fallback_db.get()}));
+    ASSERT_OK_AND_ASSIGN(
+        auto result,
+        DeepUuidOp(&cache)(DataItem(arolla::Text(seed)), ds, schema_a,
+                           *main_db, {fallback_db.get()}));
+    ASSERT_EQ(result.size(), expected.size());
+    for (int64_t i = 0; i < expected.size(); ++i) {
+      EXPECT_EQ(result[i], expected[i]) << seed << " " << i;
+    }
+    EXPECT_GT(cache.size(), 0);
+  }
+}
+
 }  // namespace
 }  // namespace koladata::internal
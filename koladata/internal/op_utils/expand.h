@@ -42,6 +42,22 @@ struct ExpandOp {
                                            arolla::DenseArrayEdge& edge) const {
     DCHECK_EQ(ds.size(), edge.parent_size());  // Ensured by high-level caller.
     arolla::EvaluationContext ctx;
+    if (ds.is_empty_and_unknown()) {
+      return DataSliceImpl::CreateEmptyAndUnknownType(edge.child_size());
+    }
+    if (ds.is_single_dtype()) {
+      // The expanded array is used as is, without copying it into a
+      // SliceBuilder.
+      DataSliceImpl res;
+      RETURN_IF_ERROR(ds.VisitValues([&](const auto& array) -> absl::Status {
+        ASSIGN_OR_RETURN(auto expanded_array,
+                         arolla::DenseArrayExpandOp()(&ctx, array, edge));
+        res = DataSliceImpl::CreateWithAllocIds(ds.allocation_ids(),
+                                                std::move(expanded_array));
+        return absl::OkStatus();
+      }));
+      return res;
+    }
     SliceBuilder bldr(edge.child_size());
     bldr.GetMutableAllocationIds().Insert(ds.allocation_ids());
     RETURN_IF_ERROR(ds.VisitValues([&](const auto& array) -> absl::Status {
@@ -26,6 +26,7 @@
 #include "absl/strings/string_view.h"
 #include "koladata/internal/data_item.h"
 #include "koladata/internal/data_slice.h"
+#include "koladata/internal/op_utils/parallel_gather.h"
 #include "koladata/internal/op_utils/utils.h"
 #include "koladata/internal/slice_builder.h"
 #include "arolla/dense_array/dense_array.h"
@@ -92,15 +93,19 @@ struct InverseSelectOp {
     }
 
     arolla::DenseArray<int64_t> present_indices =
-        arolla::DenseArrayPresentIndicesOp()(&ctx, *presence_mask_array);
-
-    SliceBuilder builder(presence_mask_array->size(), ds_impl.allocation_ids());
-
-    RETURN_IF_ERROR(ds_impl.VisitValues([&](const auto& array) -> absl::Status {
-      auto res = arolla::DenseArrayFromIndicesAndValues()(
-          &ctx, present_indices, array, presence_mask_array->size());
-      builder.InsertIfNotSet<typename decltype(res)::base_type>(res.bitmap, {},
-                                                                res.values);
+        PresentIndices(*presence_mask_array);
+
+    int64_t size = presence_mask_array->size();
+    SliceBuilder builder(size, ds_impl.allocation_ids());
+
+    RETURN_IF_ERROR(ds_impl.VisitValues([&]<typename T>(
+                                            const arolla::DenseArray<T>& array)
+                                            -> absl::Status {
+      auto res = UseParallelGather<T>(size)
+                     ? ParallelScatter(present_indices, array, size)
+                     : arolla::DenseArrayFromIndicesAndValues()(
+                           &ctx, present_indices, array, size);
+      builder.InsertIfNotSet<T>(res.bitmap, {}, res.values);
       return absl::OkStatus();
     }));
 
@@ -0,0 +1,144 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "koladata/internal/op_utils/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "absl/base/no_destructor.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/functional/function_ref.h"
+#include "absl/synchronization/mutex.h"
+
+namespace koladata::internal {
+namespace {
+
+// Fixed-size pool of detached threads that lives until the end of the process.
+class SharedThreadPool {
+ public:
+  static SharedThreadPool& Get() {
+    static absl::NoDestructor<SharedThreadPool> pool(
+        std::max<int64_t>(std::thread::hardware_concurrency(), 1) - 1);
+    return *pool;
+  }
+
+  explicit SharedThreadPool(int64_t size) : size_(size) {
+    for (int64_t i = 0; i < size; ++i) {
+      std::thread([this] { WorkLoop(); }).detach();
+    }
+  }
+
+  int64_t size() const { return size_; }
+
+  void Schedule(absl::AnyInvocable<void() &&> callback) {
+    absl::MutexLock lock(&mutex_);
+    queue_.push_back(std::move(callback));
+  }
+
+ private:
+  void WorkLoop() {
+    while (true) {
+      absl::AnyInvocable<void() &&> callback;
+      {
+        absl::MutexLock lock(&mutex_);
+        mutex_.Await(absl::Condition(this, &SharedThreadPool::HasWork));
+        callback = std::move(queue_.front());
+        queue_.pop_front();
+      }
+      std::move(callback)();
+    }
+  }
+
+  bool HasWork() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return !queue_.empty();
+  }
+
+  const int64_t size_;
+  absl::Mutex mutex_;
+  std::deque<absl::AnyInvocable<void() &&>> queue_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Tasks of a single ParallelFor call. Pool threads can get to the batch after
+// the call has returned, so it is reference counted and `fn` is touched only
+// if there are tasks left.
+struct TaskBatch {
+  TaskBatch(int64_t task_count, absl::FunctionRef<void(int64_t)> fn)
+      : task_count(task_count), fn(fn) {}
+
+  // Executes tasks until none are left.
+  void Work() {
+    int64_t done = 0;
+    for (int64_t task_id = next_task.fetch_add(1); task_id < task_count;
+         task_id = next_task.fetch_add(1)) {
+      fn(task_id);
+      ++done;
+    }
+    if (done > 0) {
+      absl::MutexLock lock(&mutex);
+      finished_tasks += done;
+    }
+  }
+
+  void WaitAll() {
+    absl::MutexLock lock(&mutex);
+    mutex.Await(absl::Condition(this, &TaskBatch::AllFinished));
+  }
+
+  bool AllFinished() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+    return finished_tasks == task_count;
+  }
+
+  const int64_t task_count;
+  const absl::FunctionRef<void(int64_t)> fn;
+  std::atomic<int64_t> next_task = 0;
+  absl::Mutex mutex;
+  int64_t finished_tasks ABSL_GUARDED_BY(mutex) = 0;
+};
+
+}  // namespace
+
+int64_t MaxParallelism() { return SharedThreadPool::Get().size() + 1; }
+
+int64_t ParallelTaskCount(int64_t work_size, int64_t min_work_per_task) {
+  return std::max<int64_t>(
+      1, std::min<int64_t>(MaxParallelism(),
+                           work_size / std::max<int64_t>(min_work_per_task,
+                                                         1)));
+}
+
+void ParallelFor(int64_t task_count, absl::FunctionRef<void(int64_t)> fn) {
+  if (task_count <= 1) {
+    if (task_count == 1) {
+      fn(0);
+    }
+    return;
+  }
+  auto batch = std::make_shared<TaskBatch>(task_count, fn);
+  SharedThreadPool& pool = SharedThreadPool::Get();
+  int64_t helper_count = std::min<int64_t>(task_count - 1, pool.size());
+  for (int64_t i = 0; i < helper_count; ++i) {
+    pool.Schedule([batch] { batch->Work(); });
+  }
+  batch->Work();
+  batch->WaitAll();
+}
+
+}  // namespace koladata::internal
@@ -0,0 +1,97 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef KOLADATA_INTERNAL_OP_UTILS_PARALLEL_H_
+#define KOLADATA_INTERNAL_OP_UTILS_PARALLEL_H_
+
+#include <algorithm>
+#include <cstdint>
+
+#include "absl/functional/function_ref.h"
+#include "absl/types/span.h"
+#include "arolla/dense_array/bitmap.h"
+
+// Helpers to split work of Koda kernels between threads. All the work is done
+// by the calling thread and a process-wide pool of
+// `hardware_concurrency() - 1` threads, so no threads are created per call.
+
+namespace koladata::internal {
+
+// Returns the number of tasks to split `work_size` units of work into, so that
+// every task gets at least `min_work_per_task` units. The result is in
+// [1, MaxParallelism()].
+int64_t ParallelTaskCount(int64_t work_size, int64_t min_work_per_task);
+
+// Returns the maximal number of tasks that can be executed concurrently: the
+// size of the shared thread pool plus the calling thread.
+int64_t MaxParallelism();
+
+// Calls `fn(task_id)` for every task_id in [0, task_count) and returns when all
+// of them are finished. The tasks are executed by the calling thread and the
+// shared thread pool. The calling thread executes every task that is not
+// picked up by the pool, so the function can be safely called from the pool
+// threads (e.g. from a task of another ParallelFor).
+void ParallelFor(int64_t task_count, absl::FunctionRef<void(int64_t)> fn);
+
+// Splits [0, size) into at most `task_count` ranges and calls
+// `fn(task_id, begin, end)` for each of them concurrently. Range boundaries
+// are aligned to bitmap words, so `fn` can set presence bits within its range
+// without synchronization.
+template <typename Fn>
+void ForEachBitmapAlignedRange(int64_t size, int64_t task_count, Fn fn) {
+  constexpr int64_t kWordBits = arolla::bitmap::kWordBitCount;
+  task_count = std::max<int64_t>(task_count, 1);
+  int64_t step = (size + task_count - 1) / task_count;
+  step = std::max<int64_t>((step + kWordBits - 1) / kWordBits * kWordBits, 1);
+  int64_t range_count = std::max<int64_t>((size + step - 1) / step, 1);
+  ParallelFor(range_count, [&](int64_t task_id) {
+    int64_t begin = std::min(task_id * step, size);
+    fn(task_id, begin, std::min(begin + step, size));
+  });
+}
+
+// Splits groups defined by `split_points` into at most `task_count` ranges
+// with similar total sizes and calls `fn(begin, end)` for each range of groups
+// concurrently.
+template <typename Fn>
+void ForEachGroupRangeInParallel(absl::Span<const int64_t> split_points,
+                                 int64_t task_count, Fn fn) {
+  int64_t num_groups = split_points.size() - 1;
+  int64_t total_size = split_points.back();
+  task_count = std::max<int64_t>(task_count, 1);
+  ParallelFor(task_count, [&](int64_t task_id) {
+    auto group_at = [&](int64_t task_boundary) -> int64_t {
+      if (task_boundary == 0) {
+        return 0;
+      }
+      if (task_boundary == task_count) {
+        return num_groups;
+      }
+      return std::min<int64_t>(
+          std::lower_bound(split_points.begin(), split_points.end(),
+                           total_size * task_boundary / task_count) -
+              split_points.begin(),
+          num_groups);
+    };
+    int64_t begin = group_at(task_id);
+    int64_t end = group_at(task_id + 1);
+    if (end > begin) {
+      fn(begin, end);
+    }
+  });
+}
+
+}  // namespace koladata::internal
+
+#endif  // KOLADATA_INTERNAL_OP_UTILS_PARALLEL_H_
@@ -0,0 +1,94 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "koladata/internal/op_utils/parallel_gather.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "absl/numeric/bits.h"
+#include "absl/types/span.h"
+#include "koladata/internal/op_utils/parallel.h"
+#include "arolla/dense_array/bitmap.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/memory/buffer.h"
+#include "arolla/util/unit.h"
+
+namespace koladata::internal {
+namespace {
+
+// Returns the word `word_id` of the presence bitmap of `mask`, with the bits
+// after the end of the array cleared.
+arolla::bitmap::Word GetMaskWord(const arolla::DenseArray<arolla::Unit>& mask,
+                                 int64_t word_id) {
+  constexpr int64_t kWordBits = arolla::bitmap::kWordBitCount;
+  arolla::bitmap::Word word =
+      mask.bitmap.empty()
+          ? arolla::bitmap::kFullWord
+          : arolla::bitmap::GetWordWithOffset(mask.bitmap, word_id,
+                                              mask.bitmap_bit_offset);
+  if (int64_t tail = mask.size() - word_id * kWordBits; tail < kWordBits) {
+    word &= (arolla::bitmap::Word{1} << tail) - 1;
+  }
+  return word;
+}
+
+}  // namespace
+
+arolla::DenseArray<int64_t> PresentIndices(
+    const arolla::DenseArray<arolla::Unit>& mask) {
+  constexpr int64_t kWordBits = arolla::bitmap::kWordBitCount;
+  int64_t size = mask.size();
+  if (mask.bitmap.empty()) {
+    arolla::Buffer<int64_t>::Builder bldr(size);
+    absl::Span<int64_t> indices = bldr.GetMutableSpan();
+    std::iota(indices.begin(), indices.end(), int64_t{0});
+    return {std::move(bldr).Build()};
+  }
+
+  // Ranges are aligned to words, so each of them covers whole words.
+  int64_t range_count =
+      ParallelTaskCount(size, kMinParallelGatherItemsPerThread);
+  std::vector<int64_t> offsets(range_count + 1);
+  ForEachBitmapAlignedRange(
+      size, range_count, [&](int64_t range_id, int64_t begin, int64_t end) {
+        int64_t count = 0;
+        for (int64_t word_id = begin / kWordBits;
+             word_id < arolla::bitmap::BitmapSize(end); ++word_id) {
+          count += absl::popcount(GetMaskWord(mask, word_id));
+        }
+        offsets[range_id + 1] = count;
+      });
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  arolla::Buffer<int64_t>::Builder bldr(offsets.back());
+  absl::Span<int64_t> indices = bldr.GetMutableSpan();
+  ForEachBitmapAlignedRange(
+      size, range_count, [&](int64_t range_id, int64_t begin, int64_t end) {
+        int64_t offset = offsets[range_id];
+        for (int64_t word_id = begin / kWordBits;
+             word_id < arolla::bitmap::BitmapSize(end); ++word_id) {
+          arolla::bitmap::Word word = GetMaskWord(mask, word_id);
+          while (word != 0) {
+            indices[offset++] = word_id * kWordBits + absl::countr_zero(word);
+            word &= word - 1;
+          }
+        }
+      });
+  return {std::move(bldr).Build()};
+}
+
+}  // namespace koladata::internal
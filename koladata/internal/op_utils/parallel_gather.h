@@ -0,0 +1,179 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef KOLADATA_INTERNAL_OP_UTILS_PARALLEL_GATHER_H_
+#define KOLADATA_INTERNAL_OP_UTILS_PARALLEL_GATHER_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "koladata/internal/object_id.h"
+#include "koladata/internal/op_utils/parallel.h"
+#include "arolla/dense_array/bitmap.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/memory/buffer.h"
+#include "arolla/util/meta.h"
+#include "arolla/util/unit.h"
+
+// Multi-threaded versions of the DenseArray kernels used by kd.select,
+// kd.inverse_select and kd.take. Small arrays are processed by the calling
+// thread only, so the functions can be used unconditionally.
+
+namespace koladata::internal {
+
+// Minimal number of items processed by one thread.
+constexpr int64_t kMinParallelGatherItemsPerThread = int64_t{1} << 18;
+
+// Value types supported by ParallelAt and ParallelScatter. Values of other
+// types (e.g. strings) are not stored in a flat buffer.
+using ParallelGatherTypes =
+    arolla::meta::type_list<int32_t, int64_t, float, double, bool, ObjectId>;
+
+// Returns true if the parallel kernels should be used for `size` items of
+// type T.
+template <typename T>
+bool UseParallelGather(int64_t size) {
+  if constexpr (arolla::meta::contains_v<ParallelGatherTypes, T>) {
+    return size >= 2 * kMinParallelGatherItemsPerThread;
+  } else {
+    return false;
+  }
+}
+
+namespace parallel_gather_internal {
+
+// Builds a DenseArray from `values` and `presence`, dropping the bitmap if all
+// the `size` items are present.
+template <typename T>
+arolla::DenseArray<T> BuildDenseArray(
+    typename arolla::Buffer<T>::Builder values,
+    arolla::bitmap::Bitmap::Builder presence, int64_t present_count,
+    int64_t size) {
+  if (present_count == size) {
+    return {std::move(values).Build()};
+  }
+  return {std::move(values).Build(), std::move(presence).Build()};
+}
+
+}  // namespace parallel_gather_internal
+
+// Returns the (always present) positions of the present items of `mask`.
+// Equivalent to arolla::DenseArrayPresentIndicesOp. The positions are written
+// word by word of the presence bitmap, after computing the per-thread output
+// offsets with a prefix sum of the bit counts.
+arolla::DenseArray<int64_t> PresentIndices(
+    const arolla::DenseArray<arolla::Unit>& mask);
+
+// Returns values[indices[i]] for each i. Missing and out-of-bound indices
+// result in missing items. Equivalent to arolla::DenseArrayAtOp except that
+// out-of-bound indices are not reported.
+template <typename T>
+arolla::DenseArray<T> ParallelAt(const arolla::DenseArray<T>& values,
+                                 const arolla::DenseArray<int64_t>& indices) {
+  using parallel_gather_internal::BuildDenseArray;
+  int64_t size = indices.size();
+  int64_t values_size = values.size();
+  typename arolla::Buffer<T>::Builder values_bldr(size);
+  arolla::bitmap::Bitmap::Builder presence_bldr(
+      arolla::bitmap::BitmapSize(size));
+  absl::Span<T> result = values_bldr.GetMutableSpan();
+  absl::Span<arolla::bitmap::Word> presence = presence_bldr.GetMutableSpan();
+  int64_t range_count =
+      ParallelTaskCount(size, kMinParallelGatherItemsPerThread);
+  std::vector<int64_t> present_counts(range_count);
+  ForEachBitmapAlignedRange(
+      size, range_count, [&](int64_t range_id, int64_t begin, int64_t end) {
+        std::fill(presence.begin() + begin / arolla::bitmap::kWordBitCount,
+                  presence.begin() + arolla::bitmap::BitmapSize(end), 0);
+        int64_t present_count = 0;
+        for (int64_t i = begin; i < end; ++i) {
+          int64_t index = indices.values[i];
+          if (indices.present(i) && index >= 0 && index < values_size &&
+              values.present(index)) {
+            result[i] = values.values[index];
+            arolla::bitmap::SetBit(presence.data(), i);
+            ++present_count;
+          } else {
+            result[i] = T();
+          }
+        }
+        present_counts[range_id] = present_count;
+      });
+  int64_t present_count = 0;
+  for (int64_t count : present_counts) {
+    present_count += count;
+  }
+  return BuildDenseArray<T>(std::move(values_bldr), std::move(presence_bldr),
+                            present_count, size);
+}
+
+// Returns an array of `size` items with values[i] placed at position
+// positions[i]. `positions` must be full, strictly increasing and less than
+// `size`, and have the same size as `values`. Equivalent to
+// arolla::DenseArrayFromIndicesAndValues.
+template <typename T>
+arolla::DenseArray<T> ParallelScatter(
+    const arolla::DenseArray<int64_t>& positions,
+    const arolla::DenseArray<T>& values, int64_t size) {
+  using parallel_gather_internal::BuildDenseArray;
+  absl::Span<const int64_t> positions_span = positions.values.span();
+  typename arolla::Buffer<T>::Builder values_bldr(size);
+  arolla::bitmap::Bitmap::Builder presence_bldr(
+      arolla::bitmap::BitmapSize(size));
+  absl::Span<T> result = values_bldr.GetMutableSpan();
+  absl::Span<arolla::bitmap::Word> presence = presence_bldr.GetMutableSpan();
+  int64_t range_count =
+      ParallelTaskCount(size, kMinParallelGatherItemsPerThread);
+  std::vector<int64_t> present_counts(range_count);
+  ForEachBitmapAlignedRange(
+      size, range_count, [&](int64_t range_id, int64_t begin, int64_t end) {
+        std::fill(presence.begin() + begin / arolla::bitmap::kWordBitCount,
+                  presence.begin() + arolla::bitmap::BitmapSize(end), 0);
+        int64_t from = std::lower_bound(positions_span.begin(),
+                                        positions_span.end(), begin) -
+                       positions_span.begin();
+        int64_t to = std::lower_bound(positions_span.begin() + from,
+                                      positions_span.end(), end) -
+                     positions_span.begin();
+        int64_t present_count = 0;
+        int64_t next = begin;
+        for (int64_t j = from; j < to; ++j) {
+          int64_t position = positions_span[j];
+          std::fill(result.begin() + next, result.begin() + position, T());
+          if (values.present(j)) {
+            result[position] = values.values[j];
+            arolla::bitmap::SetBit(presence.data(), position);
+            ++present_count;
+          } else {
+            result[position] = T();
+          }
+          next = position + 1;
+        }
+        std::fill(result.begin() + next, result.begin() + end, T());
+        present_counts[range_id] = present_count;
+      });
+  int64_t present_count = 0;
+  for (int64_t count : present_counts) {
+    present_count += count;
+  }
+  return BuildDenseArray<T>(std::move(values_bldr), std::move(presence_bldr),
+                            present_count, size);
+}
+
+}  // namespace koladata::internal
+
+#endif  // KOLADATA_INTERNAL_OP_UTILS_PARALLEL_GATHER_H_
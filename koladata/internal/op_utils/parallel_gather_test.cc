@@ -0,0 +1,139 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "koladata/internal/op_utils/parallel_gather.h"
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/qexpr/eval_context.h"
+#include "arolla/qexpr/operators/dense_array/array_ops.h"
+#include "arolla/util/unit.h"
+
+namespace koladata::internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+using ::arolla::CreateDenseArray;
+using ::arolla::DenseArray;
+using ::arolla::kPresent;
+using ::arolla::Unit;
+
+// Large enough to be processed by several threads.
+constexpr int64_t kLargeSize = 4 * kMinParallelGatherItemsPerThread + 17;
+
+DenseArray<Unit> CreateLargeMask(int64_t size) {
+  arolla::DenseArrayBuilder<Unit> bldr(size);
+  for (int64_t i = 0; i < size; ++i) {
+    if (i % 3 == 0 || i % 7 == 0) {
+      bldr.Set(i, kPresent);
+    }
+  }
+  return std::move(bldr).Build();
+}
+
+DenseArray<int64_t> CreateLargeValues(int64_t size) {
+  arolla::DenseArrayBuilder<int64_t> bldr(size);
+  for (int64_t i = 0; i < size; ++i) {
+    if (i % 5 != 0) {
+      bldr.Set(i, i * 11);
+    }
+  }
+  return std::move(bldr).Build();
+}
+
+TEST(ParallelGatherTest, PresentIndices) {
+  EXPECT_THAT(
+      PresentIndices(CreateDenseArray<Unit>(
+          {kPresent, std::nullopt, std::nullopt, kPresent, kPresent})),
+      ElementsAre(0, 3, 4));
+  EXPECT_THAT(PresentIndices(arolla::CreateConstDenseArray<Unit>(3, Unit())),
+              ElementsAre(0, 1, 2));
+  EXPECT_THAT(PresentIndices(arolla::CreateEmptyDenseArray<Unit>(40)),
+              ElementsAre());
+  EXPECT_THAT(PresentIndices(DenseArray<Unit>()), ElementsAre());
+
+  arolla::EvaluationContext ctx;
+  DenseArray<Unit> mask = CreateLargeMask(kLargeSize);
+  EXPECT_THAT(
+      PresentIndices(mask),
+      ElementsAreArray(arolla::DenseArrayPresentIndicesOp()(&ctx, mask)));
+  // Bitmap with an offset.
+  DenseArray<Unit> sliced_mask = mask.Slice(5, kLargeSize - 10);
+  ASSERT_NE(sliced_mask.bitmap_bit_offset, 0);
+  EXPECT_THAT(PresentIndices(sliced_mask),
+              ElementsAreArray(
+                  arolla::DenseArrayPresentIndicesOp()(&ctx, sliced_mask)));
+}
+
+TEST(ParallelGatherTest, ParallelAt) {
+  auto values = CreateDenseArray<int32_t>({1, std::nullopt, 3});
+  auto indices =
+      CreateDenseArray<int64_t>({2, 0, std::nullopt, 1, 3, -1, 2});
+  EXPECT_THAT(ParallelAt(values, indices),
+              ElementsAre(3, 1, std::nullopt, std::nullopt, std::nullopt,
+                          std::nullopt, 3));
+
+  DenseArray<int64_t> large_values = CreateLargeValues(kLargeSize);
+  arolla::DenseArrayBuilder<int64_t> indices_bldr(kLargeSize);
+  for (int64_t i = 0; i < kLargeSize; ++i) {
+    if (i % 13 != 0) {
+      indices_bldr.Set(i, (i * 7919) % (kLargeSize + 100));
+    }
+  }
+  DenseArray<int64_t> large_indices = std::move(indices_bldr).Build();
+  DenseArray<int64_t> res = ParallelAt(large_values, large_indices);
+  ASSERT_EQ(res.size(), kLargeSize);
+  for (int64_t i = 0; i < kLargeSize; ++i) {
+    int64_t index = large_indices.values[i];
+    if (large_indices.present(i) && index < kLargeSize &&
+        large_values.present(index)) {
+      ASSERT_TRUE(res.present(i)) << i;
+      EXPECT_EQ(res.values[i], index * 11) << i;
+    } else {
+      EXPECT_FALSE(res.present(i)) << i;
+    }
+  }
+
+  // The bitmap is dropped if all the items are present.
+  res = ParallelAt(arolla::CreateConstDenseArray<int64_t>(kLargeSize, 5),
+                   PresentIndices(CreateLargeMask(kLargeSize)));
+  EXPECT_TRUE(res.bitmap.empty());
+}
+
+TEST(ParallelGatherTest, ParallelScatter) {
+  EXPECT_THAT(ParallelScatter(CreateDenseArray<int64_t>({1, 2, 4}),
+                              CreateDenseArray<float>({1.0f, std::nullopt,
+                                                       3.0f}),
+                              6),
+              ElementsAre(std::nullopt, 1.0f, std::nullopt, std::nullopt, 3.0f,
+                          std::nullopt));
+
+  arolla::EvaluationContext ctx;
+  DenseArray<int64_t> positions =
+      PresentIndices(CreateLargeMask(kLargeSize));
+  DenseArray<int64_t> values = CreateLargeValues(positions.size());
+  EXPECT_THAT(ParallelScatter(positions, values, kLargeSize),
+              ElementsAreArray(arolla::DenseArrayFromIndicesAndValues()(
+                  &ctx, positions, values, kLargeSize)));
+}
+
+}  // namespace
+}  // namespace koladata::internal
@@ -0,0 +1,92 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "koladata/internal/op_utils/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace koladata::internal {
+namespace {
+
+using ::testing::Each;
+using ::testing::ElementsAre;
+
+TEST(ParallelTest, ParallelTaskCount) {
+  EXPECT_EQ(ParallelTaskCount(0, 10), 1);
+  EXPECT_EQ(ParallelTaskCount(15, 10), 1);
+  EXPECT_EQ(ParallelTaskCount(20, 10), std::min<int64_t>(2, MaxParallelism()));
+  EXPECT_EQ(ParallelTaskCount(int64_t{1} << 40, 1), MaxParallelism());
+  EXPECT_GE(MaxParallelism(), 1);
+}
+
+TEST(ParallelTest, ParallelFor) {
+  std::vector<int> calls(100);
+  ParallelFor(calls.size(), [&](int64_t task_id) { ++calls[task_id]; });
+  EXPECT_THAT(calls, Each(1));
+
+  int single_calls = 0;
+  ParallelFor(1, [&](int64_t) { ++single_calls; });
+  EXPECT_EQ(single_calls, 1);
+  ParallelFor(0, [&](int64_t) { ++single_calls; });
+  EXPECT_EQ(single_calls, 1);
+}
+
+TEST(ParallelTest, NestedParallelFor) {
+  constexpr int64_t kTaskCount = 64;
+  std::atomic<int64_t> total = 0;
+  ParallelFor(kTaskCount, [&](int64_t) {
+    ParallelFor(kTaskCount, [&](int64_t) { ++total; });
+  });
+  EXPECT_EQ(total, kTaskCount * kTaskCount);
+}
+
+TEST(ParallelTest, ForEachBitmapAlignedRange) {
+  std::vector<std::pair<int64_t, int64_t>> ranges(4);
+  ForEachBitmapAlignedRange(
+      100, 4, [&](int64_t task_id, int64_t begin, int64_t end) {
+        ranges[task_id] = {begin, end};
+      });
+  using Range = std::pair<int64_t, int64_t>;
+  EXPECT_THAT(ranges, ElementsAre(Range{0, 32}, Range{32, 64}, Range{64, 96},
+                                  Range{96, 100}));
+
+  int calls = 0;
+  ForEachBitmapAlignedRange(0, 4, [&](int64_t, int64_t begin, int64_t end) {
+    EXPECT_EQ(begin, end);
+    ++calls;
+  });
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(ParallelTest, ForEachGroupRangeInParallel) {
+  std::vector<int64_t> split_points = {0, 10, 10, 20, 25, 40};
+  std::vector<int> group_calls(split_points.size() - 1);
+  ForEachGroupRangeInParallel(split_points, 3,
+                              [&](int64_t begin, int64_t end) {
+                                for (int64_t i = begin; i < end; ++i) {
+                                  ++group_calls[i];
+                                }
+                              });
+  EXPECT_THAT(group_calls, Each(1));
+}
+
+}  // namespace
+}  // namespace koladata::internal
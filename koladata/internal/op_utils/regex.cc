@@ -0,0 +1,280 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "koladata/internal/op_utils/regex.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/no_destructor.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/hash/hash.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "koladata/internal/data_item.h"
+#include "koladata/internal/data_slice.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/qtype/qtype_traits.h"
+#include "arolla/util/lru_cache.h"
+#include "arolla/util/text.h"
+#include "arolla/util/unit.h"
+#include "re2/re2.h"
+#include "re2/set.h"
+#include "arolla/util/status_macros_backport.h"
+
+namespace koladata::internal {
+namespace {
+
+constexpr size_t kRegexCacheSize = 1024;
+constexpr size_t kRegexSetCacheSize = 128;
+
+struct KeyHash {
+  using is_transparent = void;
+
+  size_t operator()(absl::string_view key) const { return absl::HashOf(key); }
+};
+
+struct KeyEq {
+  using is_transparent = void;
+
+  bool operator()(absl::string_view lhs, absl::string_view rhs) const {
+    return lhs == rhs;
+  }
+};
+
+// Thread-safe LRU cache of compiled regular expressions of type `T`.
+template <typename T>
+class CompiledRegexCache {
+ public:
+  explicit CompiledRegexCache(size_t capacity) : cache_(capacity) {}
+
+  template <typename CompileFn>
+  absl::StatusOr<std::shared_ptr<const T>> GetOrCompile(absl::string_view key,
+                                                        CompileFn compile) {
+    {
+      absl::MutexLock lock(&mutex_);
+      if (auto* hit = cache_.LookupOrNull(key); hit != nullptr) {
+        return *hit;
+      }
+    }
+    // Compile outside of the lock, so that a slow compilation doesn't block
+    // lookups of other patterns.
+    ASSIGN_OR_RETURN(std::shared_ptr<const T> compiled, compile());
+    absl::MutexLock lock(&mutex_);
+    return *cache_.Put(std::string(key), std::move(compiled));
+  }
+
+  void Clear() {
+    absl::MutexLock lock(&mutex_);
+    cache_.Clear();
+  }
+
+ private:
+  absl::Mutex mutex_;
+  arolla::LruCache<std::string, std::shared_ptr<const T>, KeyHash, KeyEq>
+      cache_ ABSL_GUARDED_BY(mutex_);
+};
+
+CompiledRegexCache<RE2>& RegexCache() {
+  static absl::NoDestructor<CompiledRegexCache<RE2>> cache(kRegexCacheSize);
+  return *cache;
+}
+
+CompiledRegexCache<RE2::Set>& RegexSetCache() {
+  static absl::NoDestructor<CompiledRegexCache<RE2::Set>> cache(
+      kRegexSetCacheSize);
+  return *cache;
+}
+
+absl::Status ExpectTexts(const DataSliceImpl& text) {
+  if (text.is_empty_and_unknown() ||
+      text.dtype() == arolla::GetQType<arolla::Text>()) {
+    return absl::OkStatus();
+  }
+  return absl::InvalidArgumentError("expected a slice of texts");
+}
+
+absl::Status ExpectText(const DataItem& text) {
+  if (!text.has_value() || text.holds_value<arolla::Text>()) {
+    return absl::OkStatus();
+  }
+  return absl::InvalidArgumentError("expected a text");
+}
+
+absl::Status ExpectSingleCapturingGroup(const RE2& regex) {
+  if (regex.NumberOfCapturingGroups() != 1) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "ExtractRegexOp expected regular expression with exactly one "
+        "capturing group; got `%s` which contains %d capturing groups",
+        regex.pattern(), regex.NumberOfCapturingGroups()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<std::shared_ptr<const RE2>> CompileRegex(
+    absl::string_view pattern) {
+  return RegexCache().GetOrCompile(
+      pattern, [&]() -> absl::StatusOr<std::shared_ptr<const RE2>> {
+        auto regex = std::make_shared<const RE2>(pattern, RE2::Quiet);
+        if (!regex->ok()) {
+          return absl::InvalidArgumentError(
+              absl::StrCat("Invalid regular expression: \"", pattern, "\"; ",
+                           regex->error()));
+        }
+        return regex;
+      });
+}
+
+absl::StatusOr<std::shared_ptr<const RE2::Set>> CompileRegexSet(
+    absl::Span<const std::string> patterns) {
+  // Length-prefixed, so that different pattern lists never share a key.
+  std::string key;
+  for (const auto& pattern : patterns) {
+    absl::StrAppend(&key, pattern.size(), ":", pattern);
+  }
+  return RegexSetCache().GetOrCompile(
+      key, [&]() -> absl::StatusOr<std::shared_ptr<const RE2::Set>> {
+        auto regex_set =
+            std::make_shared<RE2::Set>(RE2::Quiet, RE2::UNANCHORED);
+        for (const auto& pattern : patterns) {
+          std::string error;
+          if (regex_set->Add(pattern, &error) < 0) {
+            return absl::InvalidArgumentError(absl::StrCat(
+                "Invalid regular expression: \"", pattern, "\"; ", error));
+          }
+        }
+        if (!regex_set->Compile()) {
+          return absl::ResourceExhaustedError(
+              "failed to compile the set of regular expressions");
+        }
+        return regex_set;
+      });
+}
+
+void ClearRegexCache() {
+  RegexCache().Clear();
+  RegexSetCache().Clear();
+}
+
+absl::StatusOr<DataSliceImpl> RegexMatchOp::operator()(
+    const DataSliceImpl& text, const RE2& regex) const {
+  RETURN_IF_ERROR(ExpectTexts(text));
+  if (text.is_empty_and_unknown()) {
+    return DataSliceImpl::CreateEmptyAndUnknownType(text.size());
+  }
+  arolla::DenseArrayBuilder<arolla::Unit> builder(text.size());
+  text.values<arolla::Text>().ForEachPresent(
+      [&](int64_t id, absl::string_view value) {
+        if (RE2::PartialMatch(value, regex)) {
+          builder.Set(id, arolla::kUnit);
+        }
+      });
+  return DataSliceImpl::Create(std::move(builder).Build());
+}
+
+absl::StatusOr<DataItem> RegexMatchOp::operator()(const DataItem& text,
+                                                  const RE2& regex) const {
+  RETURN_IF_ERROR(ExpectText(text));
+  if (text.has_value() &&
+      RE2::PartialMatch(text.value<arolla::Text>().view(), regex)) {
+    return DataItem(arolla::kUnit);
+  }
+  return DataItem();
+}
+
+absl::StatusOr<DataSliceImpl> RegexExtractOp::operator()(
+    const DataSliceImpl& text, const RE2& regex) const {
+  RETURN_IF_ERROR(ExpectSingleCapturingGroup(regex));
+  RETURN_IF_ERROR(ExpectTexts(text));
+  if (text.is_empty_and_unknown()) {
+    return DataSliceImpl::CreateEmptyAndUnknownType(text.size());
+  }
+  arolla::DenseArrayBuilder<arolla::Text> builder(text.size());
+  text.values<arolla::Text>().ForEachPresent(
+      [&](int64_t id, absl::string_view value) {
+        absl::string_view match;
+        if (RE2::PartialMatch(value, regex, &match)) {
+          builder.Set(id, match);
+        }
+      });
+  return DataSliceImpl::Create(std::move(builder).Build());
+}
+
+absl::StatusOr<DataItem> RegexExtractOp::operator()(const DataItem& text,
+                                                    const RE2& regex) const {
+  RETURN_IF_ERROR(ExpectSingleCapturingGroup(regex));
+  RETURN_IF_ERROR(ExpectText(text));
+  absl::string_view match;
+  if (text.has_value() &&
+      RE2::PartialMatch(text.value<arolla::Text>().view(), regex, &match)) {
+    return DataItem(arolla::Text(match));
+  }
+  return DataItem();
+}
+
+absl::StatusOr<std::vector<DataSliceImpl>> RegexMatchManyOp::operator()(
+    const DataSliceImpl& text, const RE2::Set& regex_set,
+    size_t num_patterns) const {
+  RETURN_IF_ERROR(ExpectTexts(text));
+  std::vector<DataSliceImpl> result;
+  result.reserve(num_patterns);
+  if (text.is_empty_and_unknown()) {
+    for (size_t i = 0; i < num_patterns; ++i) {
+      result.push_back(DataSliceImpl::CreateEmptyAndUnknownType(text.size()));
+    }
+    return result;
+  }
+  std::vector<arolla::DenseArrayBuilder<arolla::Unit>> builders;
+  builders.reserve(num_patterns);
+  for (size_t i = 0; i < num_patterns; ++i) {
+    builders.emplace_back(text.size());
+  }
+  absl::Status status = absl::OkStatus();
+  std::vector<int> matched;
+  text.values<arolla::Text>().ForEachPresent(
+      [&](int64_t id, absl::string_view value) {
+        if (!status.ok()) {
+          return;
+        }
+        RE2::Set::ErrorInfo error_info;
+        if (!regex_set.Match(value, &matched, &error_info)) {
+          if (error_info.kind != RE2::Set::kNoError) {
+            status = absl::ResourceExhaustedError(
+                "failed to match the set of regular expressions");
+          }
+          return;
+        }
+        for (int pattern_index : matched) {
+          builders[pattern_index].Set(id, arolla::kUnit);
+        }
+      });
+  RETURN_IF_ERROR(status);
+  for (auto& builder : builders) {
+    result.push_back(DataSliceImpl::Create(std::move(builder).Build()));
+  }
+  return result;
+}
+
+}  // namespace koladata::internal
@@ -0,0 +1,86 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef KOLADATA_INTERNAL_OP_UTILS_REGEX_H_
+#define KOLADATA_INTERNAL_OP_UTILS_REGEX_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "koladata/internal/data_item.h"
+#include "koladata/internal/data_slice.h"
+#include "re2/re2.h"
+#include "re2/set.h"
+
+namespace koladata::internal {
+
+// Returns the compiled RE2 for `pattern`. Compiled patterns are kept in a
+// bounded, process-wide LRU cache, so repeated calls with the same pattern
+// don't recompile it. Flags are expected to be embedded into the pattern
+// (e.g. "(?i)foo"), so the pattern text is the full cache key.
+//
+// Thread-safe.
+absl::StatusOr<std::shared_ptr<const RE2>> CompileRegex(
+    absl::string_view pattern);
+
+// Returns the compiled unanchored RE2::Set for `patterns`, where the i-th
+// pattern has index i. Uses a cache similar to CompileRegex.
+//
+// Thread-safe.
+absl::StatusOr<std::shared_ptr<const RE2::Set>> CompileRegexSet(
+    absl::Span<const std::string> patterns);
+
+// Clears the regex caches.
+//
+// Exposed for testing purposes.
+void ClearRegexCache();
+
+// Returns `present` for each text that partially matches `regex`. `text` must
+// contain only Text values.
+struct RegexMatchOp {
+  absl::StatusOr<DataSliceImpl> operator()(const DataSliceImpl& text,
+                                           const RE2& regex) const;
+  absl::StatusOr<DataItem> operator()(const DataItem& text,
+                                      const RE2& regex) const;
+};
+
+// Returns the substring of each text that matches the capturing group of
+// the first partial match of `regex`, or missing if there is no match. `regex`
+// must contain exactly one capturing group. `text` must contain only Text
+// values.
+struct RegexExtractOp {
+  absl::StatusOr<DataSliceImpl> operator()(const DataSliceImpl& text,
+                                           const RE2& regex) const;
+  absl::StatusOr<DataItem> operator()(const DataItem& text,
+                                      const RE2& regex) const;
+};
+
+// Matches all the patterns of `regex_set` against each text in a single pass.
+// Returns one MASK slice per pattern (`num_patterns` in total), with `present`
+// where the corresponding pattern partially matches the text. `text` must
+// contain only Text values.
+struct RegexMatchManyOp {
+  absl::StatusOr<std::vector<DataSliceImpl>> operator()(
+      const DataSliceImpl& text, const RE2::Set& regex_set,
+      size_t num_patterns) const;
+};
+
+}  // namespace koladata::internal
+
+#endif  // KOLADATA_INTERNAL_OP_UTILS_REGEX_H_
@@ -0,0 +1,127 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "koladata/internal/data_slice.h"
+#include "koladata/internal/op_utils/regex.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/util/text.h"
+#include "re2/re2.h"
+
+namespace koladata::internal {
+namespace {
+
+constexpr auto kBenchmarkFn = [](auto* b) {
+  b->Arg(1)->Arg(10)->Arg(100)->Arg(10000);
+};
+
+constexpr absl::string_view kPattern =
+    R"regex(^\s*(\w+)@example\.com\s*$)regex";
+
+DataSliceImpl CreateTexts(int64_t size) {
+  arolla::DenseArrayBuilder<arolla::Text> builder(size);
+  for (int64_t i = 0; i < size; ++i) {
+    if (i % 3 == 0) {
+      builder.Set(i, absl::StrCat(" user", i, "@example.com"));
+    } else if (i % 3 == 1) {
+      builder.Set(i, absl::StrCat("user", i, "@example.org"));
+    }
+  }
+  return DataSliceImpl::Create(std::move(builder).Build());
+}
+
+// Compiles the pattern on every call, as done without the regex cache.
+void BM_RegexExtractUncached(benchmark::State& state) {
+  DataSliceImpl text = CreateTexts(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(text);
+    RE2 regex(kPattern);
+    auto result = RegexExtractOp()(text, regex);
+    CHECK_OK(result);
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+void BM_RegexExtractCached(benchmark::State& state) {
+  DataSliceImpl text = CreateTexts(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(text);
+    auto regex = CompileRegex(kPattern);
+    CHECK_OK(regex);
+    auto result = RegexExtractOp()(text, **regex);
+    CHECK_OK(result);
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+std::vector<std::string> CreatePatterns(int64_t count) {
+  std::vector<std::string> patterns;
+  patterns.reserve(count);
+  for (int64_t i = 0; i < count; ++i) {
+    patterns.push_back(absl::StrCat("user", i, "@example"));
+  }
+  return patterns;
+}
+
+void BM_RegexMatchEachPattern(benchmark::State& state) {
+  DataSliceImpl text = CreateTexts(state.range(0));
+  std::vector<std::string> patterns = CreatePatterns(state.range(1));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(text);
+    for (const auto& pattern : patterns) {
+      auto regex = CompileRegex(pattern);
+      CHECK_OK(regex);
+      auto result = RegexMatchOp()(text, **regex);
+      CHECK_OK(result);
+      benchmark::DoNotOptimize(result);
+    }
+  }
+}
+
+void BM_RegexMatchMany(benchmark::State& state) {
+  DataSliceImpl text = CreateTexts(state.range(0));
+  std::vector<std::string> patterns = CreatePatterns(state.range(1));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(text);
+    auto regex_set = CompileRegexSet(patterns);
+    CHECK_OK(regex_set);
+    auto result = RegexMatchManyOp()(text, **regex_set, patterns.size());
+    CHECK_OK(result);
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+BENCHMARK(BM_RegexExtractUncached)->Apply(kBenchmarkFn);
+BENCHMARK(BM_RegexExtractCached)->Apply(kBenchmarkFn);
+BENCHMARK(BM_RegexMatchEachPattern)
+    ->ArgPair(10, 5)
+    ->ArgPair(10, 50)
+    ->ArgPair(10000, 5)
+    ->ArgPair(10000, 50);
+BENCHMARK(BM_RegexMatchMany)
+    ->ArgPair(10, 5)
+    ->ArgPair(10, 50)
+    ->ArgPair(10000, 5)
+    ->ArgPair(10000, 50);
+
+}  // namespace
+}  // namespace koladata::internal
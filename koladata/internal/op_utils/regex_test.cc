@@ -0,0 +1,179 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "koladata/internal/op_utils/regex.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "koladata/internal/data_item.h"
+#include "koladata/internal/data_slice.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/util/text.h"
+#include "arolla/util/unit.h"
+#include "re2/re2.h"
+#include "re2/set.h"
+
+namespace koladata::internal {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+using ::arolla::CreateDenseArray;
+using ::arolla::kMissing;
+using ::arolla::kPresent;
+using ::arolla::Text;
+using ::arolla::Unit;
+
+TEST(RegexTest, CompileRegexIsCached) {
+  ClearRegexCache();
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<const RE2> regex1,
+                       CompileRegex("f(o+)"));
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<const RE2> regex2,
+                       CompileRegex("f(o+)"));
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<const RE2> regex3,
+                       CompileRegex("(?i)f(o+)"));
+  EXPECT_EQ(regex1.get(), regex2.get());
+  EXPECT_NE(regex1.get(), regex3.get());
+  EXPECT_EQ(regex3->pattern(), "(?i)f(o+)");
+
+  ClearRegexCache();
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<const RE2> regex4,
+                       CompileRegex("f(o+)"));
+  EXPECT_EQ(regex4->pattern(), "f(o+)");
+  // The evicted regex is still usable by its holders.
+  EXPECT_TRUE(RE2::PartialMatch("foo", *regex1));
+}
+
+TEST(RegexTest, CompileRegexError) {
+  EXPECT_THAT(CompileRegex("f(o"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Invalid regular expression: \"f(o\"")));
+  EXPECT_THAT(CompileRegexSet({"a", "f(o"}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Invalid regular expression: \"f(o\"")));
+}
+
+TEST(RegexTest, CompileRegexSetIsCached) {
+  ClearRegexCache();
+  ASSERT_OK_AND_ASSIGN(auto set1, CompileRegexSet({"ab", "c"}));
+  ASSERT_OK_AND_ASSIGN(auto set2, CompileRegexSet({"ab", "c"}));
+  ASSERT_OK_AND_ASSIGN(auto set3, CompileRegexSet({"a", "bc"}));
+  EXPECT_EQ(set1.get(), set2.get());
+  EXPECT_NE(set1.get(), set3.get());
+}
+
+TEST(RegexTest, CompileRegexFromManyThreads) {
+  ClearRegexCache();
+  std::vector<std::shared_ptr<const RE2>> regexes(8);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < regexes.size(); ++i) {
+    threads.emplace_back([&, i] {
+      for (int j = 0; j < 100; ++j) {
+        regexes[i] = *CompileRegex("a+(b)");
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto& regex : regexes) {
+    EXPECT_TRUE(RE2::PartialMatch("aab", *regex));
+  }
+}
+
+TEST(RegexTest, Match) {
+  ASSERT_OK_AND_ASSIGN(auto regex, CompileRegex("^a.c$"));
+  auto ds = DataSliceImpl::Create(CreateDenseArray<Text>(
+      {Text("abc"), std::nullopt, Text("abcd"), Text("a_c")}));
+  ASSERT_OK_AND_ASSIGN(auto res, RegexMatchOp()(ds, *regex));
+  EXPECT_THAT(res.values<Unit>(),
+              ElementsAre(kPresent, kMissing, kMissing, kPresent));
+
+  ASSERT_OK_AND_ASSIGN(auto item, RegexMatchOp()(DataItem(Text("axc")),
+                                                 *regex));
+  EXPECT_EQ(item, DataItem(arolla::kUnit));
+  ASSERT_OK_AND_ASSIGN(item, RegexMatchOp()(DataItem(Text("xc")), *regex));
+  EXPECT_EQ(item, DataItem());
+  ASSERT_OK_AND_ASSIGN(item, RegexMatchOp()(DataItem(), *regex));
+  EXPECT_EQ(item, DataItem());
+
+  ASSERT_OK_AND_ASSIGN(
+      res, RegexMatchOp()(DataSliceImpl::CreateEmptyAndUnknownType(3), *regex));
+  EXPECT_TRUE(res.is_empty_and_unknown());
+  EXPECT_EQ(res.size(), 3);
+
+  EXPECT_THAT(
+      RegexMatchOp()(DataSliceImpl::Create(CreateDenseArray<int>({1})), *regex),
+      StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(RegexTest, Extract) {
+  ASSERT_OK_AND_ASSIGN(auto regex, CompileRegex("b(.*)"));
+  auto ds = DataSliceImpl::Create(
+      CreateDenseArray<Text>({Text("abcd"), std::nullopt, Text("xyz")}));
+  ASSERT_OK_AND_ASSIGN(auto res, RegexExtractOp()(ds, *regex));
+  EXPECT_THAT(res.values<Text>(),
+              ElementsAre(Text("cd"), std::nullopt, std::nullopt));
+
+  ASSERT_OK_AND_ASSIGN(auto item, RegexExtractOp()(DataItem(Text("foobar")),
+                                                   *regex));
+  EXPECT_EQ(item, DataItem(Text("ar")));
+  ASSERT_OK_AND_ASSIGN(item, RegexExtractOp()(DataItem(Text("foo")), *regex));
+  EXPECT_EQ(item, DataItem());
+
+  ASSERT_OK_AND_ASSIGN(auto two_groups, CompileRegex("(.)(.)"));
+  EXPECT_THAT(
+      RegexExtractOp()(ds, *two_groups),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               "ExtractRegexOp expected regular expression with exactly one "
+               "capturing group; got `(.)(.)` which contains 2 capturing "
+               "groups"));
+}
+
+TEST(RegexTest, MatchMany) {
+  std::vector<std::string> patterns = {"^a", "b", "c$", "z"};
+  ASSERT_OK_AND_ASSIGN(auto regex_set, CompileRegexSet(patterns));
+  auto ds = DataSliceImpl::Create(CreateDenseArray<Text>(
+      {Text("abc"), std::nullopt, Text("bcd"), Text("")}));
+  ASSERT_OK_AND_ASSIGN(std::vector<DataSliceImpl> res,
+                       RegexMatchManyOp()(ds, *regex_set, patterns.size()));
+  ASSERT_EQ(res.size(), 4);
+  EXPECT_THAT(res[0].values<Unit>(),
+              ElementsAre(kPresent, kMissing, kMissing, kMissing));
+  EXPECT_THAT(res[1].values<Unit>(),
+              ElementsAre(kPresent, kMissing, kPresent, kMissing));
+  EXPECT_THAT(res[2].values<Unit>(),
+              ElementsAre(kPresent, kMissing, kMissing, kMissing));
+  EXPECT_TRUE(res[3].is_empty_and_unknown());
+  EXPECT_EQ(res[3].size(), 4);
+
+  ASSERT_OK_AND_ASSIGN(
+      res, RegexMatchManyOp()(DataSliceImpl::CreateEmptyAndUnknownType(2),
+                              *regex_set, patterns.size()));
+  ASSERT_EQ(res.size(), 4);
+  EXPECT_TRUE(res[0].is_empty_and_unknown());
+}
+
+}  // namespace
+}  // namespace koladata::internal
@@ -27,6 +27,7 @@
 #include "absl/types/span.h"
 #include "koladata/internal/data_item.h"
 #include "koladata/internal/data_slice.h"
+#include "koladata/internal/op_utils/parallel_gather.h"
 #include "koladata/internal/op_utils/utils.h"
 #include "koladata/internal/slice_builder.h"
 #include "arolla/dense_array/dense_array.h"
@@ -159,13 +160,14 @@ absl::StatusOr<SelectOp::Result<DataSliceImpl>> SelectOp::operator()(
   SliceBuilder builder(presence_mask_array.PresentCount(),
                        ds_impl.allocation_ids());
 
-  DenseArray<int64_t> present_indexes =
-      DenseArrayPresentIndicesOp()(&ctx, presence_mask_array);
+  DenseArray<int64_t> present_indexes = PresentIndices(presence_mask_array);
 
   RETURN_IF_ERROR(ds_impl.VisitValues([&](const auto& array) -> absl::Status {
     using T = typename std::decay_t<decltype(array)>::base_type;
     // Gets elements in `array` at the positions from `present_indexes`.
-    DenseArray<T> res = DenseArrayAtOp()(&ctx, array, present_indexes);
+    DenseArray<T> res = UseParallelGather<T>(present_indexes.size())
+                            ? ParallelAt(array, present_indexes)
+                            : DenseArrayAtOp()(&ctx, array, present_indexes);
     builder.InsertIfNotSet<T>(res.bitmap, {}, res.values);
     return absl::OkStatus();
   }));
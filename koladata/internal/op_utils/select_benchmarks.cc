@@ -0,0 +1,140 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/random/random.h"
+#include "koladata/internal/data_slice.h"
+#include "koladata/internal/op_utils/at.h"
+#include "koladata/internal/op_utils/inverse_select.h"
+#include "koladata/internal/op_utils/select.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/dense_array/edge.h"
+#include "arolla/jagged_shape/dense_array/jagged_shape.h"
+#include "arolla/util/unit.h"
+
+namespace koladata::internal {
+namespace {
+
+using ::arolla::JaggedDenseArrayShape;
+
+// Values 0, 1, 2, ... with every 10th missing.
+DataSliceImpl CreateValues(int64_t size) {
+  arolla::DenseArrayBuilder<int64_t> bldr(size);
+  for (int64_t i = 0; i < size; ++i) {
+    if (i % 10 != 0) {
+      bldr.Set(i, i);
+    }
+  }
+  return DataSliceImpl::Create(std::move(bldr).Build());
+}
+
+// Mask with about half of the items present.
+DataSliceImpl CreateFilter(int64_t size) {
+  absl::BitGen gen;
+  arolla::DenseArrayBuilder<arolla::Unit> bldr(size);
+  for (int64_t i = 0; i < size; ++i) {
+    if (absl::Bernoulli(gen, 0.5)) {
+      bldr.Set(i, arolla::kPresent);
+    }
+  }
+  return DataSliceImpl::Create(std::move(bldr).Build());
+}
+
+JaggedDenseArrayShape CreateShape(int64_t group_count, int64_t group_size) {
+  auto edge1 = arolla::DenseArrayEdge::FromUniformGroups(1, group_count);
+  CHECK_OK(edge1);
+  auto edge2 =
+      arolla::DenseArrayEdge::FromUniformGroups(group_count, group_size);
+  CHECK_OK(edge2);
+  auto shape =
+      JaggedDenseArrayShape::FromEdges({*std::move(edge1), *std::move(edge2)});
+  CHECK_OK(shape);
+  return *std::move(shape);
+}
+
+void BM_Select(benchmark::State& state) {
+  int64_t group_count = state.range(0);
+  int64_t group_size = state.range(1);
+  int64_t size = group_count * group_size;
+  DataSliceImpl ds = CreateValues(size);
+  DataSliceImpl filter = CreateFilter(size);
+  JaggedDenseArrayShape shape = CreateShape(group_count, group_size);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ds);
+    benchmark::DoNotOptimize(filter);
+    auto res = SelectOp()(ds, shape, filter, shape);
+    CHECK_OK(res);
+    benchmark::DoNotOptimize(res);
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+
+void BM_InverseSelect(benchmark::State& state) {
+  int64_t group_count = state.range(0);
+  int64_t group_size = state.range(1);
+  int64_t size = group_count * group_size;
+  DataSliceImpl filter = CreateFilter(size);
+  JaggedDenseArrayShape shape = CreateShape(group_count, group_size);
+  auto selected = SelectOp()(CreateValues(size), shape, filter, shape);
+  CHECK_OK(selected);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(selected);
+    auto res = InverseSelectOp()(selected->data_slice_impl, selected->shape,
+                                 filter, shape);
+    CHECK_OK(res);
+    benchmark::DoNotOptimize(res);
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+
+void BM_TakeScalarEdge(benchmark::State& state) {
+  int64_t size = state.range(0);
+  DataSliceImpl ds = CreateValues(size);
+  absl::BitGen gen;
+  arolla::DenseArrayBuilder<int64_t> indices_bldr(size);
+  for (int64_t i = 0; i < size; ++i) {
+    indices_bldr.Set(i, absl::Uniform<int64_t>(gen, 0, size));
+  }
+  arolla::DenseArray<int64_t> indices = std::move(indices_bldr).Build();
+  auto ds_to_common = arolla::DenseArrayEdge::FromUniformGroups(1, size);
+  CHECK_OK(ds_to_common);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ds);
+    benchmark::DoNotOptimize(indices);
+    auto res = AtOp(ds, indices, *ds_to_common, std::nullopt);
+    CHECK_OK(res);
+    benchmark::DoNotOptimize(res);
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+
+BENCHMARK(BM_Select)
+    ->ArgPair(1, 10)
+    ->ArgPair(1000, 1000)
+    ->ArgPair(100000, 100)
+    ->ArgPair(10, 10000000);
+BENCHMARK(BM_InverseSelect)
+    ->ArgPair(1, 10)
+    ->ArgPair(1000, 1000)
+    ->ArgPair(100000, 100)
+    ->ArgPair(10, 10000000);
+BENCHMARK(BM_TakeScalarEdge)->Arg(10)->Arg(1000000)->Arg(100000000);
+
+}  // namespace
+}  // namespace koladata::internal
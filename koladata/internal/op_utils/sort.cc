@@ -0,0 +1,260 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "koladata/internal/op_utils/sort.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/base/casts.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "koladata/internal/data_slice.h"
+#include "koladata/internal/op_utils/at.h"
+#include "koladata/internal/op_utils/parallel.h"
+#include "arolla/dense_array/bitmap.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/dense_array/edge.h"
+#include "arolla/memory/buffer.h"
+#include "arolla/qtype/qtype_traits.h"
+#include "arolla/util/bytes.h"
+#include "arolla/util/meta.h"
+#include "arolla/util/text.h"
+#include "arolla/util/status_macros_backport.h"
+
+namespace koladata::internal {
+namespace {
+
+// Groups of at least this size with fixed-width values are radix-sorted.
+constexpr int64_t kMinRadixSortSize = 256;
+
+// Minimal number of items sorted by one thread.
+constexpr int64_t kMinSortedItemsPerThread = int64_t{1} << 16;
+
+using FixedWidthSortableTypes =
+    arolla::meta::type_list<int32_t, int64_t, float, double, bool>;
+using SortableTypes =
+    arolla::meta::concat_t<FixedWidthSortableTypes,
+                           arolla::meta::type_list<arolla::Text,
+                                                   arolla::Bytes>>;
+
+// Number of significant bytes in OrderedKey(T).
+template <typename T>
+constexpr int kKeyBytes = std::is_same_v<T, bool> ? 1 : sizeof(T);
+
+// Maps fixed-width values to unsigned keys with the same order.
+uint64_t OrderedKey(bool value) { return value ? 1 : 0; }
+
+uint64_t OrderedKey(int32_t value) {
+  return static_cast<uint32_t>(value) ^ (uint32_t{1} << 31);
+}
+
+uint64_t OrderedKey(int64_t value) {
+  return static_cast<uint64_t>(value) ^ (uint64_t{1} << 63);
+}
+
+template <typename Bits, typename Float>
+uint64_t FloatOrderedKey(Float value) {
+  constexpr Bits kSignBit = Bits{1} << (sizeof(Bits) * 8 - 1);
+  // -0.0 and 0.0 are equal.
+  Bits bits = absl::bit_cast<Bits>(value == 0 ? Float{0} : value);
+  return (bits & kSignBit) ? static_cast<Bits>(~bits) : (bits | kSignBit);
+}
+
+uint64_t OrderedKey(float value) { return FloatOrderedKey<uint32_t>(value); }
+
+uint64_t OrderedKey(double value) { return FloatOrderedKey<uint64_t>(value); }
+
+struct KeyAndPosition {
+  uint64_t key;
+  int64_t position;
+};
+
+// Stable LSD radix sort of `items` by the lowest `key_bytes` bytes of their
+// keys. `buffer` is scratch space.
+void RadixSort(std::vector<KeyAndPosition>& items,
+               std::vector<KeyAndPosition>& buffer, int key_bytes) {
+  buffer.resize(items.size());
+  for (int shift = 0; shift < key_bytes * 8; shift += 8) {
+    std::array<int64_t, 256> offsets{};
+    for (const KeyAndPosition& item : items) {
+      ++offsets[(item.key >> shift) & 0xFF];
+    }
+    // All the keys have the same byte, so the pass would not change anything.
+    if (offsets[(items.front().key >> shift) & 0xFF] == items.size()) {
+      continue;
+    }
+    int64_t offset = 0;
+    for (int64_t& count : offsets) {
+      offset += std::exchange(count, offset);
+    }
+    for (const KeyAndPosition& item : items) {
+      buffer[offsets[(item.key >> shift) & 0xFF]++] = item;
+    }
+    items.swap(buffer);
+  }
+}
+
+// Writes the positions of the present `sort_by` items of each group in
+// [group_begin, group_end), in the sorted order, to the beginning of the
+// group's range of `positions`, and their number to `counts`.
+template <typename T>
+void SortGroupRange(const arolla::DenseArray<T>& sort_by,
+                    absl::Span<const int64_t> split_points,
+                    int64_t group_begin, int64_t group_end, bool descending,
+                    absl::Span<int64_t> positions,
+                    absl::Span<int64_t> counts) {
+  if constexpr (std::is_same_v<T, arolla::Text> ||
+                std::is_same_v<T, arolla::Bytes>) {
+    std::vector<std::pair<absl::string_view, int64_t>> items;
+    for (int64_t group = group_begin; group < group_end; ++group) {
+      items.clear();
+      for (int64_t i = split_points[group]; i < split_points[group + 1]; ++i) {
+        if (sort_by.present(i)) {
+          items.emplace_back(sort_by.values[i], i);
+        }
+      }
+      std::sort(items.begin(), items.end(), [&](const auto& a, const auto& b) {
+        if (a.first != b.first) {
+          return descending ? a.first > b.first : a.first < b.first;
+        }
+        return a.second < b.second;
+      });
+      for (int64_t j = 0; j < items.size(); ++j) {
+        positions[split_points[group] + j] = items[j].second;
+      }
+      counts[group] = items.size();
+    }
+  } else {
+    constexpr uint64_t kMaxKey =
+        kKeyBytes<T> == 8 ? ~uint64_t{0}
+                          : (uint64_t{1} << (kKeyBytes<T> * 8)) - 1;
+    std::vector<KeyAndPosition> items;
+    std::vector<KeyAndPosition> buffer;
+    for (int64_t group = group_begin; group < group_end; ++group) {
+      items.clear();
+      for (int64_t i = split_points[group]; i < split_points[group + 1]; ++i) {
+        if (!sort_by.present(i)) {
+          continue;
+        }
+        T value = sort_by.values[i];
+        if constexpr (std::is_floating_point_v<T>) {
+          if (std::isnan(value)) {
+            items.push_back({kMaxKey, i});
+            continue;
+          }
+        }
+        uint64_t key = OrderedKey(value);
+        items.push_back({descending ? ~key & kMaxKey : key, i});
+      }
+      if (items.size() < kMinRadixSortSize) {
+        std::sort(items.begin(), items.end(),
+                  [](const KeyAndPosition& a, const KeyAndPosition& b) {
+                    return a.key != b.key ? a.key < b.key
+                                          : a.position < b.position;
+                  });
+      } else {
+        RadixSort(items, buffer, kKeyBytes<T>);
+      }
+      for (int64_t j = 0; j < items.size(); ++j) {
+        positions[split_points[group] + j] = items[j].position;
+      }
+      counts[group] = items.size();
+    }
+  }
+}
+
+}  // namespace
+
+absl::StatusOr<DataSliceImpl> SortOp::operator()(
+    const DataSliceImpl& x, const DataSliceImpl& sort_by,
+    const arolla::DenseArrayEdge& edge, bool descending) const {
+  if (x.size() != sort_by.size() || x.size() != edge.child_size()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("x and sort_by sizes don't match the edge: %d and %d "
+                        "vs %d",
+                        x.size(), sort_by.size(), edge.child_size()));
+  }
+  int64_t size = x.size();
+  if (sort_by.is_empty_and_unknown()) {
+    return DataSliceImpl::CreateEmptyAndUnknownType(size);
+  }
+  if (sort_by.is_mixed_dtype()) {
+    return absl::InvalidArgumentError(
+        "sort_by must contain values of a single type");
+  }
+  ASSIGN_OR_RETURN(auto splits_edge, edge.ToSplitPointsEdge());
+  absl::Span<const int64_t> split_points =
+      splits_edge.edge_values().values.span();
+  int64_t num_groups = edge.parent_size();
+
+  arolla::Buffer<int64_t>::Builder positions_bldr(size);
+  absl::Span<int64_t> positions = positions_bldr.GetMutableSpan();
+  std::vector<int64_t> counts(num_groups);
+  bool is_sortable = false;
+  arolla::meta::foreach_type(SortableTypes(), [&](auto tpe) {
+    using T = typename decltype(tpe)::type;
+    if (sort_by.dtype() != arolla::GetQType<T>()) {
+      return;
+    }
+    is_sortable = true;
+    auto sort_groups = [&](int64_t group_begin, int64_t group_end) {
+      SortGroupRange<T>(sort_by.values<T>(), split_points, group_begin,
+                        group_end, descending, positions,
+                        absl::MakeSpan(counts));
+    };
+    if (int64_t num_threads = ParallelTaskCount(size, kMinSortedItemsPerThread);
+        num_threads > 1) {
+      ForEachGroupRangeInParallel(split_points, num_threads, sort_groups);
+    } else {
+      sort_groups(0, num_groups);
+    }
+  });
+  if (!is_sortable) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "sort_by must contain values of a sortable type, got ",
+        sort_by.dtype()->name()));
+  }
+
+  arolla::bitmap::Bitmap::Builder presence_bldr(
+      arolla::bitmap::BitmapSize(size));
+  absl::Span<arolla::bitmap::Word> presence = presence_bldr.GetMutableSpan();
+  std::fill(presence.begin(), presence.end(), 0);
+  for (int64_t group = 0; group < num_groups; ++group) {
+    int64_t begin = split_points[group];
+    for (int64_t i = begin; i < begin + counts[group]; ++i) {
+      arolla::bitmap::SetBit(presence.data(), i);
+    }
+    std::fill(positions.begin() + begin + counts[group],
+              positions.begin() + split_points[group + 1], 0);
+  }
+  arolla::DenseArray<int64_t> sorted_positions{
+      std::move(positions_bldr).Build(), std::move(presence_bldr).Build()};
+
+  ASSIGN_OR_RETURN(auto x_to_scalar,
+                   arolla::DenseArrayEdge::FromUniformGroups(1, size));
+  return AtOp(x, sorted_positions, x_to_scalar, std::nullopt);
+}
+
+}  // namespace koladata::internal
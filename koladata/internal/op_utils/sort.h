@@ -0,0 +1,41 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef KOLADATA_INTERNAL_OP_UTILS_SORT_H_
+#define KOLADATA_INTERNAL_OP_UTILS_SORT_H_
+
+#include "absl/status/statusor.h"
+#include "koladata/internal/data_slice.h"
+#include "arolla/dense_array/edge.h"
+
+namespace koladata::internal {
+
+// Sorts the items of `x` within each group of `edge` by the corresponding
+// items of `sort_by`. Items with missing `sort_by` are dropped, and the end of
+// each group is filled with missing values. Ties are resolved by position, and
+// NaNs are placed after all other values regardless of `descending`.
+//
+// `sort_by` must contain values of a single type among INT32, INT64, FLOAT32,
+// FLOAT64, BOOLEAN, STRING and BYTES. Large groups of fixed-width values are
+// radix-sorted, and many groups are sorted by several threads.
+struct SortOp {
+  absl::StatusOr<DataSliceImpl> operator()(const DataSliceImpl& x,
+                                           const DataSliceImpl& sort_by,
+                                           const arolla::DenseArrayEdge& edge,
+                                           bool descending) const;
+};
+
+}  // namespace koladata::internal
+
+#endif  // KOLADATA_INTERNAL_OP_UTILS_SORT_H_
@@ -0,0 +1,89 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <cstdint>
+#include <utility>
+
+#include "benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/random/random.h"
+#include "absl/strings/str_cat.h"
+#include "koladata/internal/data_slice.h"
+#include "koladata/internal/op_utils/sort.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/dense_array/edge.h"
+#include "arolla/util/text.h"
+
+namespace koladata::internal {
+namespace {
+
+DataSliceImpl CreateIntSortBy(int64_t size) {
+  absl::BitGen gen;
+  arolla::DenseArrayBuilder<int64_t> bldr(size);
+  for (int64_t i = 0; i < size; ++i) {
+    if (i % 10 != 0) {
+      bldr.Set(i, absl::Uniform<int64_t>(gen, -1000000, 1000000));
+    }
+  }
+  return DataSliceImpl::Create(std::move(bldr).Build());
+}
+
+DataSliceImpl CreateTextSortBy(int64_t size) {
+  absl::BitGen gen;
+  arolla::DenseArrayBuilder<arolla::Text> bldr(size);
+  for (int64_t i = 0; i < size; ++i) {
+    if (i % 10 != 0) {
+      bldr.Set(i, arolla::Text(absl::StrCat(
+                      "key", absl::Uniform<int64_t>(gen, 0, 1000000))));
+    }
+  }
+  return DataSliceImpl::Create(std::move(bldr).Build());
+}
+
+template <DataSliceImpl (*CreateSortBy)(int64_t)>
+void BM_Sort(benchmark::State& state) {
+  int64_t group_count = state.range(0);
+  int64_t group_size = state.range(1);
+  int64_t size = group_count * group_size;
+  auto x = DataSliceImpl::Create(
+      arolla::CreateConstDenseArray<int32_t>(size, 57));
+  DataSliceImpl sort_by = CreateSortBy(size);
+  auto edge =
+      arolla::DenseArrayEdge::FromUniformGroups(group_count, group_size);
+  CHECK_OK(edge);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(x);
+    benchmark::DoNotOptimize(sort_by);
+    auto res = SortOp()(x, sort_by, *edge, /*descending=*/false);
+    CHECK_OK(res);
+    benchmark::DoNotOptimize(res);
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+
+// Many small groups and a few huge groups.
+BENCHMARK(BM_Sort<CreateIntSortBy>)
+    ->ArgPair(1, 10)
+    ->ArgPair(100000, 10)
+    ->ArgPair(10000, 1000)
+    ->ArgPair(10, 1000000)
+    ->ArgPair(1, 10000000);
+BENCHMARK(BM_Sort<CreateTextSortBy>)
+    ->ArgPair(1, 10)
+    ->ArgPair(100000, 10)
+    ->ArgPair(10, 100000)
+    ->ArgPair(1, 1000000);
+
+}  // namespace
+}  // namespace koladata::internal
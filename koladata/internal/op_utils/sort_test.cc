@@ -0,0 +1,188 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "koladata/internal/op_utils/sort.h"
+
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/types/span.h"
+#include "koladata/internal/data_item.h"
+#include "koladata/internal/data_slice.h"
+#include "koladata/internal/object_id.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/dense_array/edge.h"
+#include "arolla/util/text.h"
+
+namespace koladata::internal {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+using ::arolla::CreateDenseArray;
+using ::arolla::DenseArrayEdge;
+
+DenseArrayEdge SplitPointsEdge(absl::Span<const int64_t> split_points) {
+  return *DenseArrayEdge::FromSplitPoints(
+      CreateDenseArray<int64_t>(split_points));
+}
+
+TEST(SortOpTest, Int) {
+  auto x =
+      DataSliceImpl::Create(CreateDenseArray<int32_t>({0, 1, 2, 3, 4, 5}));
+  auto sort_by = DataSliceImpl::Create(
+      CreateDenseArray<int64_t>({3, std::nullopt, -1, 2, 2, 1}));
+  auto edge = SplitPointsEdge({0, 3, 6});
+
+  ASSERT_OK_AND_ASSIGN(auto res, SortOp()(x, sort_by, edge, false));
+  EXPECT_THAT(res.values<int32_t>(), ElementsAre(2, 0, std::nullopt, 5, 3, 4));
+
+  ASSERT_OK_AND_ASSIGN(res, SortOp()(x, sort_by, edge, true));
+  EXPECT_THAT(res.values<int32_t>(), ElementsAre(0, 2, std::nullopt, 3, 4, 5));
+}
+
+TEST(SortOpTest, Float) {
+  auto x = DataSliceImpl::Create(CreateDenseArray<int32_t>({0, 1, 2, 3, 4}));
+  auto sort_by = DataSliceImpl::Create(
+      CreateDenseArray<float>({NAN, 1.0f, -0.0f, -INFINITY, 0.0f}));
+  auto edge = SplitPointsEdge({0, 5});
+
+  ASSERT_OK_AND_ASSIGN(auto res, SortOp()(x, sort_by, edge, false));
+  EXPECT_THAT(res.values<int32_t>(), ElementsAre(3, 2, 4, 1, 0));
+
+  ASSERT_OK_AND_ASSIGN(res, SortOp()(x, sort_by, edge, true));
+  EXPECT_THAT(res.values<int32_t>(), ElementsAre(1, 2, 4, 3, 0));
+}
+
+TEST(SortOpTest, Text) {
+  auto x = DataSliceImpl::Create(CreateDenseArray<int32_t>({0, 1, 2, 3}));
+  auto sort_by = DataSliceImpl::Create(CreateDenseArray<arolla::Text>(
+      {arolla::Text("b"), arolla::Text("a"), arolla::Text("ab"),
+       arolla::Text("a")}));
+  auto edge = SplitPointsEdge({0, 4});
+
+  ASSERT_OK_AND_ASSIGN(auto res, SortOp()(x, sort_by, edge, false));
+  EXPECT_THAT(res.values<int32_t>(), ElementsAre(1, 3, 2, 0));
+
+  ASSERT_OK_AND_ASSIGN(res, SortOp()(x, sort_by, edge, true));
+  EXPECT_THAT(res.values<int32_t>(), ElementsAre(0, 2, 1, 3));
+}
+
+TEST(SortOpTest, MixedX) {
+  auto x = DataSliceImpl::Create(
+      {DataItem(1), DataItem(arolla::Text("a")), DataItem(), DataItem(2.0f)});
+  auto sort_by =
+      DataSliceImpl::Create(CreateDenseArray<bool>({true, false, true, true}));
+
+  ASSERT_OK_AND_ASSIGN(
+      auto res, SortOp()(x, sort_by, SplitPointsEdge({0, 4}), false));
+  EXPECT_EQ(res[0], DataItem(arolla::Text("a")));
+  EXPECT_EQ(res[1], DataItem(1));
+  EXPECT_EQ(res[2], DataItem());
+  EXPECT_EQ(res[3], DataItem(2.0f));
+}
+
+TEST(SortOpTest, EmptyGroupsAndMissingSortBy) {
+  auto x = DataSliceImpl::Create(CreateDenseArray<int32_t>({0, 1, 2}));
+  auto edge = SplitPointsEdge({0, 0, 3, 3});
+
+  ASSERT_OK_AND_ASSIGN(
+      auto res,
+      SortOp()(x, DataSliceImpl::CreateEmptyAndUnknownType(3), edge, false));
+  EXPECT_EQ(res.present_count(), 0);
+  EXPECT_EQ(res.size(), 3);
+
+  ASSERT_OK_AND_ASSIGN(
+      res, SortOp()(x,
+                    DataSliceImpl::Create(CreateDenseArray<int64_t>(
+                        {std::nullopt, 5, 4})),
+                    edge, false));
+  EXPECT_THAT(res.values<int32_t>(), ElementsAre(2, 1, std::nullopt));
+}
+
+// Large groups are radix-sorted, and many items are sorted by several threads.
+TEST(SortOpTest, LargeGroups) {
+  constexpr int64_t kGroupCount = 40;
+  constexpr int64_t kGroupSize = 10000;
+  constexpr int64_t kSize = kGroupCount * kGroupSize;
+  arolla::DenseArrayBuilder<int64_t> x_bldr(kSize);
+  arolla::DenseArrayBuilder<int32_t> sort_by_bldr(kSize);
+  for (int64_t i = 0; i < kSize; ++i) {
+    x_bldr.Set(i, i);
+    if (i % 5 != 0) {
+      // Each value is repeated in a group, so ties must be kept in order.
+      sort_by_bldr.Set(i, (i * 7919) % 1000 - 500);
+    }
+  }
+  ASSERT_OK_AND_ASSIGN(auto edge, DenseArrayEdge::FromUniformGroups(
+                                      kGroupCount, kGroupSize));
+  auto x = DataSliceImpl::Create(std::move(x_bldr).Build());
+  auto sort_by = DataSliceImpl::Create(std::move(sort_by_bldr).Build());
+
+  for (bool descending : {false, true}) {
+    ASSERT_OK_AND_ASSIGN(auto res, SortOp()(x, sort_by, edge, descending));
+    const auto& values = res.values<int64_t>();
+    const auto& sort_by_values = sort_by.values<int32_t>();
+    for (int64_t group = 0; group < kGroupCount; ++group) {
+      int64_t begin = group * kGroupSize;
+      int64_t present_size = kGroupSize / 5 * 4;
+      for (int64_t i = begin; i < begin + kGroupSize; ++i) {
+        ASSERT_EQ(values.present(i), i < begin + present_size) << i;
+        if (i == begin || !values.present(i)) {
+          continue;
+        }
+        int64_t prev = values.values[i - 1];
+        int64_t cur = values.values[i];
+        ASSERT_EQ(cur / kGroupSize, group) << i;
+        int32_t prev_key = sort_by_values.values[prev];
+        int32_t cur_key = sort_by_values.values[cur];
+        if (prev_key == cur_key) {
+          ASSERT_LT(prev, cur) << i;
+        } else {
+          ASSERT_EQ(prev_key < cur_key, !descending) << i;
+        }
+      }
+    }
+  }
+}
+
+TEST(SortOpTest, Errors) {
+  auto x = DataSliceImpl::Create(CreateDenseArray<int32_t>({0, 1}));
+  auto edge = SplitPointsEdge({0, 2});
+  EXPECT_THAT(SortOp()(x, DataSliceImpl::Create(CreateDenseArray<int32_t>({1})),
+                       edge, false),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("don't match the edge")));
+  EXPECT_THAT(
+      SortOp()(x, DataSliceImpl::Create({DataItem(1), DataItem(int64_t{2})}),
+               edge, false),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               "sort_by must contain values of a single type"));
+  auto objects = DataSliceImpl::Create(2, DataItem(AllocateSingleObject()));
+  EXPECT_THAT(SortOp()(x, objects, edge, false),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       "sort_by must contain values of a sortable type, got "
+                       "OBJECT_ID"));
+}
+
+}  // namespace
+}  // namespace koladata::internal
@@ -0,0 +1,254 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "koladata/internal/op_utils/translate.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "koladata/internal/data_item.h"
+#include "koladata/internal/data_slice.h"
+#include "koladata/internal/dict.h"
+#include "koladata/internal/object_id.h"
+#include "koladata/internal/op_utils/parallel.h"
+#include "arolla/dense_array/bitmap.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/dense_array/edge.h"
+#include "arolla/memory/buffer.h"
+#include "arolla/qtype/qtype.h"
+#include "arolla/qtype/qtype_traits.h"
+#include "arolla/util/bytes.h"
+#include "arolla/util/meta.h"
+#include "arolla/util/text.h"
+#include "arolla/util/view_types.h"
+#include "arolla/util/status_macros_backport.h"
+
+namespace koladata::internal {
+namespace {
+
+constexpr int64_t kMinKeysPerProbeThread = int64_t{1} << 16;
+
+// Key types stored in a typed hash table. Other keys are stored as DataItems.
+using TypedKeyTypes =
+    arolla::meta::type_list<int32_t, int64_t, ObjectId, arolla::Text,
+                            arolla::Bytes, bool>;
+
+// Maps (group, key) to the key position. The key type is kept explicitly,
+// since different types can share the view type (e.g. Text and Bytes).
+template <typename T>
+struct TypedKeyMap {
+  using KeyT = T;
+
+  absl::flat_hash_map<std::pair<int64_t, arolla::view_type_t<T>>, int64_t>
+      positions;
+};
+
+struct GroupedItem {
+  int64_t group;
+  DataItem item;
+};
+
+struct GroupedItemHash {
+  size_t operator()(const GroupedItem& key) const {
+    return absl::HashOf(key.group, DataItem::Hash()(key.item));
+  }
+};
+
+struct GroupedItemEq {
+  bool operator()(const GroupedItem& lhs, const GroupedItem& rhs) const {
+    return lhs.group == rhs.group && DataItem::Eq()(lhs.item, rhs.item);
+  }
+};
+
+using GenericKeyMap =
+    absl::flat_hash_map<GroupedItem, int64_t, GroupedItemHash, GroupedItemEq>;
+
+using KeyMap =
+    std::variant<GenericKeyMap, TypedKeyMap<int32_t>, TypedKeyMap<int64_t>,
+                 TypedKeyMap<ObjectId>, TypedKeyMap<arolla::Text>,
+                 TypedKeyMap<arolla::Bytes>, TypedKeyMap<bool>>;
+
+absl::Status VerifyKeyTypes(const DataSliceImpl& keys) {
+  const arolla::QType* unsupported_key_type = nullptr;
+  keys.VisitValues([&]<typename T>(const arolla::DenseArray<T>&) {
+    if (Dict::IsUnsupportedKeyType<T>()) {
+      unsupported_key_type = arolla::GetQType<T>();
+    }
+  });
+  if (unsupported_key_type) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("invalid key type: ", unsupported_key_type->name()));
+  }
+  return absl::OkStatus();
+}
+
+// Returns the group that contains position `offset`.
+int64_t GroupOf(absl::Span<const int64_t> split_points, int64_t offset) {
+  return std::upper_bound(split_points.begin(), split_points.end(), offset) -
+         split_points.begin() - 1;
+}
+
+}  // namespace
+
+struct TranslateIndex::Impl {
+  // Owns the values referenced by the keys of `map`.
+  DataSliceImpl keys;
+  int64_t group_count;
+  KeyMap map;
+};
+
+absl::StatusOr<TranslateIndex> TranslateIndex::Create(
+    const DataSliceImpl& keys, const arolla::DenseArrayEdge& groups_to_keys) {
+  if (keys.size() != groups_to_keys.child_size()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("keys size doesn't match the edge: %d vs %d",
+                        keys.size(), groups_to_keys.child_size()));
+  }
+  RETURN_IF_ERROR(VerifyKeyTypes(keys));
+  ASSIGN_OR_RETURN(auto splits_edge, groups_to_keys.ToSplitPointsEdge());
+  absl::Span<const int64_t> split_points =
+      splits_edge.edge_values().values.span();
+
+  auto impl = std::make_shared<Impl>();
+  impl->keys = keys;
+  impl->group_count = groups_to_keys.parent_size();
+
+  bool has_duplicates = false;
+  bool is_typed = false;
+  arolla::meta::foreach_type(TypedKeyTypes(), [&](auto tpe) {
+    using T = typename decltype(tpe)::type;
+    if (keys.dtype() != arolla::GetQType<T>()) {
+      return;
+    }
+    is_typed = true;
+    auto& map = impl->map.emplace<TypedKeyMap<T>>().positions;
+    map.reserve(keys.present_count());
+    int64_t group = 0;
+    keys.values<T>().ForEachPresent(
+        [&](int64_t offset, arolla::view_type_t<T> key) {
+          while (split_points[group + 1] <= offset) {
+            ++group;
+          }
+          has_duplicates |= !map.try_emplace({group, key}, offset).second;
+        });
+  });
+  if (!is_typed) {
+    auto& map = impl->map.emplace<GenericKeyMap>();
+    map.reserve(keys.present_count());
+    for (int64_t group = 0; group < impl->group_count; ++group) {
+      for (int64_t offset = split_points[group];
+           offset < split_points[group + 1]; ++offset) {
+        DataItem key = keys[offset];
+        if (key.has_value()) {
+          has_duplicates |=
+              !map.try_emplace(GroupedItem{group, std::move(key)}, offset)
+                   .second;
+        }
+      }
+    }
+  }
+  if (has_duplicates) {
+    return absl::AlreadyExistsError("keys must be unique within each group");
+  }
+  return TranslateIndex(std::move(impl));
+}
+
+absl::StatusOr<arolla::DenseArray<int64_t>> TranslateIndex::Find(
+    const DataSliceImpl& keys,
+    const arolla::DenseArrayEdge& groups_to_keys) const {
+  if (keys.size() != groups_to_keys.child_size() ||
+      impl_->group_count != groups_to_keys.parent_size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "keys and the index sizes don't match the edge: %d and %d vs %d -> %d",
+        impl_->group_count, keys.size(), groups_to_keys.parent_size(),
+        groups_to_keys.child_size()));
+  }
+  ASSIGN_OR_RETURN(auto splits_edge, groups_to_keys.ToSplitPointsEdge());
+  absl::Span<const int64_t> split_points =
+      splits_edge.edge_values().values.span();
+
+  int64_t size = keys.size();
+  arolla::Buffer<int64_t>::Builder positions_bldr(size);
+  arolla::bitmap::Bitmap::Builder presence_bldr(
+      arolla::bitmap::BitmapSize(size));
+  absl::Span<int64_t> positions = positions_bldr.GetMutableSpan();
+  absl::Span<arolla::bitmap::Word> presence = presence_bldr.GetMutableSpan();
+
+  auto set_position = [&](int64_t offset, int64_t position) {
+    positions[offset] = position;
+    arolla::bitmap::SetBit(presence.data(), offset);
+  };
+
+  ForEachBitmapAlignedRange(
+      size, ParallelTaskCount(size, kMinKeysPerProbeThread),
+      [&](int64_t /*task_id*/, int64_t begin, int64_t end) {
+        std::fill(presence.begin() + begin / arolla::bitmap::kWordBitCount,
+                  presence.begin() + arolla::bitmap::BitmapSize(end), 0);
+        std::visit(
+            [&]<typename Map>(const Map& map) {
+              int64_t group = GroupOf(split_points, begin);
+              if constexpr (std::is_same_v<Map, GenericKeyMap>) {
+                for (int64_t offset = begin; offset < end; ++offset) {
+                  while (split_points[group + 1] <= offset) {
+                    ++group;
+                  }
+                  if (auto it = map.find(GroupedItem{group, keys[offset]});
+                      it != map.end()) {
+                    set_position(offset, it->second);
+                  }
+                }
+              } else {
+                // Only keys of exactly the same type can match.
+                keys.VisitValues([&]<typename U>(
+                                     const arolla::DenseArray<U>& array) {
+                  if constexpr (std::is_same_v<U, typename Map::KeyT>) {
+                    for (int64_t offset = begin; offset < end; ++offset) {
+                      while (split_points[group + 1] <= offset) {
+                        ++group;
+                      }
+                      if (!array.present(offset)) {
+                        continue;
+                      }
+                      if (auto it =
+                              map.positions.find({group, array.values[offset]});
+                          it != map.positions.end()) {
+                        set_position(offset, it->second);
+                      }
+                    }
+                  }
+                });
+              }
+            },
+            impl_->map);
+      });
+  return arolla::DenseArray<int64_t>{std::move(positions_bldr).Build(),
+                                     std::move(presence_bldr).Build()};
+}
+
+int64_t TranslateIndex::group_count() const { return impl_->group_count; }
+
+}  // namespace koladata::internal
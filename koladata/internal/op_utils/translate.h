@@ -0,0 +1,65 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef KOLADATA_INTERNAL_OP_UTILS_TRANSLATE_H_
+#define KOLADATA_INTERNAL_OP_UTILS_TRANSLATE_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "koladata/internal/data_slice.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/dense_array/edge.h"
+
+namespace koladata::internal {
+
+// Hash index from (group, key) to the position of the key in the slice it was
+// built from. Keys are compared in the same way as dict keys, i.e. the types
+// must match exactly. Keys of a single primitive type or ObjectId are stored
+// in a typed hash table.
+//
+// The index is immutable and cheap to copy. Lookups are thread-safe.
+class TranslateIndex {
+ public:
+  // Builds the index of `keys`, grouped by `groups_to_keys`. Missing keys are
+  // skipped. Returns an AlreadyExists error if a key occurs more than once
+  // within a group, and an InvalidArgument error if `keys` contain values that
+  // can't be dict keys.
+  static absl::StatusOr<TranslateIndex> Create(
+      const DataSliceImpl& keys, const arolla::DenseArrayEdge& groups_to_keys);
+
+  // Returns for each of `keys` the position of the equal key within the same
+  // group of the indexed keys, or missing if there is no such key.
+  // `groups_to_keys` must have the same parent size as the edge the index was
+  // built with. Large inputs are probed by several threads.
+  absl::StatusOr<arolla::DenseArray<int64_t>> Find(
+      const DataSliceImpl& keys,
+      const arolla::DenseArrayEdge& groups_to_keys) const;
+
+  int64_t group_count() const;
+
+ private:
+  struct Impl;
+
+  explicit TranslateIndex(std::shared_ptr<const Impl> impl)
+      : impl_(std::move(impl)) {}
+
+  std::shared_ptr<const Impl> impl_;
+};
+
+}  // namespace koladata::internal
+
+#endif  // KOLADATA_INTERNAL_OP_UTILS_TRANSLATE_H_
@@ -0,0 +1,109 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/random/random.h"
+#include "koladata/internal/data_slice.h"
+#include "koladata/internal/op_utils/translate.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/dense_array/edge.h"
+
+namespace koladata::internal {
+namespace {
+
+// Keys 0, 7, 14, ... in random order.
+DataSliceImpl CreateKeysFrom(int64_t size) {
+  std::vector<int64_t> keys(size);
+  for (int64_t i = 0; i < size; ++i) {
+    keys[i] = i * 7;
+  }
+  absl::BitGen gen;
+  for (int64_t i = size - 1; i > 0; --i) {
+    std::swap(keys[i], keys[absl::Uniform<int64_t>(gen, 0, i + 1)]);
+  }
+  return DataSliceImpl::Create(arolla::CreateFullDenseArray(std::move(keys)));
+}
+
+// Random keys, about half of which are present in CreateKeysFrom(table_size).
+DataSliceImpl CreateKeysTo(int64_t size, int64_t table_size) {
+  absl::BitGen gen;
+  arolla::DenseArrayBuilder<int64_t> bldr(size);
+  for (int64_t i = 0; i < size; ++i) {
+    int64_t key = absl::Uniform<int64_t>(gen, 0, table_size * 2);
+    bldr.Set(i, key % 2 == 0 ? key / 2 * 7 : key);
+  }
+  return DataSliceImpl::Create(std::move(bldr).Build());
+}
+
+arolla::DenseArrayEdge ScalarEdge(int64_t size) {
+  auto edge = arolla::DenseArrayEdge::FromUniformGroups(1, size);
+  CHECK_OK(edge);
+  return *std::move(edge);
+}
+
+// Builds the index and probes it once, as kd.translate does.
+void BM_TranslateBuildAndFind(benchmark::State& state) {
+  int64_t table_size = state.range(0);
+  int64_t keys_to_size = state.range(1);
+  DataSliceImpl keys_from = CreateKeysFrom(table_size);
+  DataSliceImpl keys_to = CreateKeysTo(keys_to_size, table_size);
+  arolla::DenseArrayEdge keys_from_edge = ScalarEdge(table_size);
+  arolla::DenseArrayEdge keys_to_edge = ScalarEdge(keys_to_size);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(keys_from);
+    benchmark::DoNotOptimize(keys_to);
+    auto index = TranslateIndex::Create(keys_from, keys_from_edge);
+    CHECK_OK(index);
+    auto positions = index->Find(keys_to, keys_to_edge);
+    CHECK_OK(positions);
+    benchmark::DoNotOptimize(positions);
+  }
+  state.SetItemsProcessed(state.iterations() * (table_size + keys_to_size));
+}
+
+// Probes a prepared index.
+void BM_TranslateFind(benchmark::State& state) {
+  int64_t table_size = state.range(0);
+  int64_t keys_to_size = state.range(1);
+  auto index = TranslateIndex::Create(CreateKeysFrom(table_size),
+                                      ScalarEdge(table_size));
+  CHECK_OK(index);
+  DataSliceImpl keys_to = CreateKeysTo(keys_to_size, table_size);
+  arolla::DenseArrayEdge keys_to_edge = ScalarEdge(keys_to_size);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(keys_to);
+    auto positions = index->Find(keys_to, keys_to_edge);
+    CHECK_OK(positions);
+    benchmark::DoNotOptimize(positions);
+  }
+  state.SetItemsProcessed(state.iterations() * keys_to_size);
+}
+
+BENCHMARK(BM_TranslateBuildAndFind)
+    ->ArgPair(10, 10)
+    ->ArgPair(1000, 1000)
+    ->ArgPair(1000000, 1000000);
+BENCHMARK(BM_TranslateFind)
+    ->ArgPair(10, 10)
+    ->ArgPair(1000, 1000)
+    ->ArgPair(1000000, 1000000)
+    ->ArgPair(1000000, 10000000);
+
+}  // namespace
+}  // namespace koladata::internal
@@ -0,0 +1,179 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "koladata/internal/op_utils/translate.h"
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/types/span.h"
+#include "koladata/internal/data_item.h"
+#include "koladata/internal/data_slice.h"
+#include "koladata/internal/object_id.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/dense_array/edge.h"
+#include "arolla/util/bytes.h"
+#include "arolla/util/text.h"
+
+namespace koladata::internal {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+using ::arolla::CreateDenseArray;
+using ::arolla::DenseArrayEdge;
+
+DenseArrayEdge SplitPointsEdge(absl::Span<const int64_t> split_points) {
+  return *DenseArrayEdge::FromSplitPoints(
+      CreateDenseArray<int64_t>(split_points));
+}
+
+TEST(TranslateIndexTest, TypedKeys) {
+  auto keys = DataSliceImpl::Create(
+      CreateDenseArray<int64_t>({1, 2, std::nullopt, 1, 3}));
+  ASSERT_OK_AND_ASSIGN(
+      auto index, TranslateIndex::Create(keys, SplitPointsEdge({0, 3, 5})));
+  EXPECT_EQ(index.group_count(), 2);
+
+  auto keys_to = DataSliceImpl::Create(
+      CreateDenseArray<int64_t>({2, 1, 3, 1, 3, std::nullopt, 2}));
+  ASSERT_OK_AND_ASSIGN(auto positions,
+                       index.Find(keys_to, SplitPointsEdge({0, 3, 7})));
+  EXPECT_THAT(positions, ElementsAre(1, 0, std::nullopt, 3, 4, std::nullopt,
+                                     std::nullopt));
+}
+
+TEST(TranslateIndexTest, TypesMustMatchExactly) {
+  auto keys = DataSliceImpl::Create(
+      CreateDenseArray<arolla::Text>({arolla::Text("a"), arolla::Text("b")}));
+  ASSERT_OK_AND_ASSIGN(auto index,
+                       TranslateIndex::Create(keys, SplitPointsEdge({0, 2})));
+
+  auto keys_to = DataSliceImpl::Create(
+      CreateDenseArray<arolla::Bytes>({arolla::Bytes("a"), std::nullopt}),
+      CreateDenseArray<arolla::Text>({std::nullopt, arolla::Text("b")}));
+  ASSERT_OK_AND_ASSIGN(auto positions,
+                       index.Find(keys_to, SplitPointsEdge({0, 2})));
+  EXPECT_THAT(positions, ElementsAre(std::nullopt, 1));
+
+  keys_to = DataSliceImpl::Create(CreateDenseArray<int32_t>({1, 2}));
+  ASSERT_OK_AND_ASSIGN(positions,
+                       index.Find(keys_to, SplitPointsEdge({0, 2})));
+  EXPECT_THAT(positions, ElementsAre(std::nullopt, std::nullopt));
+}
+
+TEST(TranslateIndexTest, MixedKeys) {
+  ObjectId obj = AllocateSingleObject();
+  auto keys = DataSliceImpl::Create(
+      CreateDenseArray<int32_t>({1, std::nullopt, std::nullopt, 1}),
+      CreateDenseArray<int64_t>({std::nullopt, 1, std::nullopt, std::nullopt}),
+      CreateDenseArray<ObjectId>({std::nullopt, std::nullopt, obj,
+                                  std::nullopt}));
+  ASSERT_OK_AND_ASSIGN(
+      auto index, TranslateIndex::Create(keys, SplitPointsEdge({0, 3, 4})));
+
+  auto keys_to = DataSliceImpl::Create(
+      {DataItem(obj), DataItem(int64_t{1}), DataItem(1), DataItem(),
+       DataItem(1), DataItem(obj)});
+  ASSERT_OK_AND_ASSIGN(auto positions,
+                       index.Find(keys_to, SplitPointsEdge({0, 4, 6})));
+  EXPECT_THAT(positions,
+              ElementsAre(2, 1, 0, std::nullopt, 3, std::nullopt));
+}
+
+TEST(TranslateIndexTest, MappingEdge) {
+  auto keys = DataSliceImpl::Create(
+      CreateDenseArray<arolla::Text>({arolla::Text("a"), arolla::Text("b"),
+                                      arolla::Text("a")}));
+  ASSERT_OK_AND_ASSIGN(
+      auto index, TranslateIndex::Create(keys, SplitPointsEdge({0, 2, 3})));
+
+  auto keys_to = DataSliceImpl::Create(CreateDenseArray<arolla::Text>(
+      {arolla::Text("a"), arolla::Text("b"), arolla::Text("a"),
+       arolla::Text("b")}));
+  ASSERT_OK_AND_ASSIGN(auto edge,
+                       DenseArrayEdge::FromMapping(
+                           CreateDenseArray<int64_t>({0, 0, 1, 1}), 2));
+  ASSERT_OK_AND_ASSIGN(auto positions, index.Find(keys_to, edge));
+  EXPECT_THAT(positions, ElementsAre(0, 1, 2, std::nullopt));
+}
+
+TEST(TranslateIndexTest, ManyKeys) {
+  constexpr int64_t kGroupCount = 1000;
+  constexpr int64_t kGroupSize = 300;
+  arolla::DenseArrayBuilder<int64_t> keys_bldr(kGroupCount * kGroupSize);
+  for (int64_t i = 0; i < kGroupCount * kGroupSize; ++i) {
+    if (i % 7 != 0) {
+      keys_bldr.Set(i, (i % kGroupSize) * 11);
+    }
+  }
+  ASSERT_OK_AND_ASSIGN(auto edge, DenseArrayEdge::FromUniformGroups(
+                                      kGroupCount, kGroupSize));
+  auto keys = DataSliceImpl::Create(std::move(keys_bldr).Build());
+  ASSERT_OK_AND_ASSIGN(auto index, TranslateIndex::Create(keys, edge));
+
+  arolla::DenseArrayBuilder<int64_t> keys_to_bldr(kGroupCount * kGroupSize);
+  for (int64_t i = 0; i < kGroupCount * kGroupSize; ++i) {
+    keys_to_bldr.Set(i, (kGroupSize - 1 - i % kGroupSize) * 11);
+  }
+  ASSERT_OK_AND_ASSIGN(
+      auto positions,
+      index.Find(DataSliceImpl::Create(std::move(keys_to_bldr).Build()),
+                 edge));
+  for (int64_t i = 0; i < kGroupCount * kGroupSize; ++i) {
+    int64_t expected = i - i % kGroupSize + (kGroupSize - 1 - i % kGroupSize);
+    if (expected % 7 == 0) {
+      EXPECT_FALSE(positions.present(i)) << i;
+    } else {
+      ASSERT_TRUE(positions.present(i)) << i;
+      EXPECT_EQ(positions.values[i], expected) << i;
+    }
+  }
+}
+
+TEST(TranslateIndexTest, Errors) {
+  auto keys = DataSliceImpl::Create(CreateDenseArray<int32_t>({1, 2, 1}));
+  EXPECT_THAT(TranslateIndex::Create(keys, SplitPointsEdge({0, 3})),
+              StatusIs(absl::StatusCode::kAlreadyExists));
+  EXPECT_OK(TranslateIndex::Create(keys, SplitPointsEdge({0, 2, 3})));
+  EXPECT_THAT(TranslateIndex::Create(keys, SplitPointsEdge({0, 2})),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("doesn't match the edge")));
+
+  auto mixed_keys = DataSliceImpl::Create(
+      {DataItem(1), DataItem(arolla::Text("a")), DataItem(1)});
+  EXPECT_THAT(TranslateIndex::Create(mixed_keys, SplitPointsEdge({0, 3})),
+              StatusIs(absl::StatusCode::kAlreadyExists));
+
+  auto float_keys = DataSliceImpl::Create(CreateDenseArray<float>({1.0f}));
+  EXPECT_THAT(TranslateIndex::Create(float_keys, SplitPointsEdge({0, 1})),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       "invalid key type: FLOAT32"));
+
+  ASSERT_OK_AND_ASSIGN(
+      auto index, TranslateIndex::Create(keys, SplitPointsEdge({0, 2, 3})));
+  EXPECT_THAT(index.Find(keys, SplitPointsEdge({0, 3})),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("don't match the edge")));
+}
+
+}  // namespace
+}  // namespace koladata::internal
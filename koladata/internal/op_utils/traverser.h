@@ -143,6 +143,12 @@ class Traverser {
   //    - calls visitor.GetValue on attributes, list items, dict keys and values
   //    and use the results for arguments in visitor.Visit* calls. Except for
   //    the currently visited item and it's schema.
+  //
+  // The visitor can optionally define
+  //   bool SkipTraversal(const DataItem& item, const DataItem& schema);
+  // returning true if the items reachable from (item, schema) should not be
+  // traversed, e.g. because the visitor already knows the value for it.
+  // Visit* methods are not called for such items, but GetValue can be.
  public:
   Traverser(const DataBagImpl& databag, DataBagImpl::FallbackSpan fallbacks,
             std::shared_ptr<VisitorT> visitor)
@@ -345,6 +351,15 @@ class Traverser {
     return status;
   }
 
+  bool SkipTraversal(const ItemWithSchema& item) {
+    if constexpr (requires(VisitorT& visitor, const DataItem& x) {
+                    visitor.SkipTraversal(x, x);
+                  }) {
+      return visitor_->SkipTraversal(item.item, item.schema);
+    }
+    return false;
+  }
+
   absl::Status DepthFirstPrevisitItemsAndSchemas() {
     // We do a depth-first traversal, with unrolled recursion. For that we keep
     // track of the stack size when we started visiting the current item. If the
@@ -357,7 +372,7 @@ class Traverser {
     while (!previsit_stack_.empty()) {
       ItemWithSchema item = std::move(previsit_stack_.top());
       previsit_stack_.pop();
-      if (!used_items.contains(item.item)) {
+      if (!used_items.contains(item.item) && !SkipTraversal(item)) {
         objects_on_stack.emplace(previsit_stack_.size(), item);
         used_items.insert(item.item);
         if (item.item != DataItem(schema::kSchema) ||
@@ -529,6 +529,32 @@ absl::StatusOr<DataSlice> CreateObjectsImpl(
   return res;
 }
 
+// Returns `values` with the given `shape` and `schema`. The values are stored
+// as they are if their type matches `schema`, and casted otherwise.
+absl::StatusOr<DataSlice> ColumnWithSchema(const DataSliceImpl& values,
+                                           DataSlice::JaggedShape shape,
+                                           const DataItem& schema,
+                                           const DataBagPtr& db) {
+  bool matches_schema = values.is_empty_and_unknown();
+  if (values.is_single_dtype()) {
+    bool has_objects = values.dtype() == arolla::GetQType<ObjectId>();
+    if (schema.is_primitive_schema()) {
+      matches_schema = values.dtype() == schema.value<schema::DType>().qtype();
+    } else if (schema == schema::kObject) {
+      matches_schema = !has_objects;
+    } else {
+      matches_schema = has_objects;
+    }
+  }
+  if (matches_schema) {
+    return DataSlice::Create(values, std::move(shape), schema, db);
+  }
+  ASSIGN_OR_RETURN(
+      DataSlice slice,
+      DataSlice::CreateWithSchemaFromData(values, std::move(shape), db));
+  return CastToExplicit(slice, schema);
+}
+
 }  // namespace
 
 // TODO: When DataSlice::SetAttrs is fast enough keep only -Shaped
@@ -619,6 +645,74 @@ absl::StatusOr<DataSlice> EntityCreator::FromAttrs(
   return *std::move(res);
 }
 
+absl::StatusOr<DataSlice> EntityCreator::FromColumns(
+    const DataBagPtr& db, const DataSlice& schema, int64_t row_count,
+    absl::Span<const EntityColumn> columns) {
+  RETURN_IF_ERROR(schema.VerifyIsSchema());
+  if (!schema.item().is_entity_schema()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "processing Entity attributes requires Entity schema, got %v",
+        schema.item()));
+  }
+  AdoptionQueue schema_adoption_queue;
+  schema_adoption_queue.Add(schema);
+  RETURN_IF_ERROR(schema_adoption_queue.AdoptInto(*db));
+  DataSlice db_schema = schema.WithBag(db);
+  auto shape = DataSlice::JaggedShape::FlatFromSize(row_count);
+
+  std::vector<absl::string_view> attr_names;
+  std::vector<DataSlice> values;
+  attr_names.reserve(columns.size());
+  values.reserve(columns.size());
+  for (const EntityColumn& column : columns) {
+    ASSIGN_OR_RETURN(DataSlice attr_schema,
+                     db_schema.GetAttr(column.attr_name));
+    attr_names.push_back(column.attr_name);
+    if (!column.list_offsets.has_value()) {
+      if (column.values.size() != row_count) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "column '%s' has %d values, expected %d", column.attr_name,
+            column.values.size(), row_count));
+      }
+      ASSIGN_OR_RETURN(values.emplace_back(),
+                       ColumnWithSchema(column.values, shape,
+                                        attr_schema.item(), db));
+      continue;
+    }
+    if (!attr_schema.IsListSchema()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "column '%s' has list offsets, but its schema is %v",
+          column.attr_name, attr_schema.item()));
+    }
+    ASSIGN_OR_RETURN(auto edge, DataSlice::JaggedShape::Edge::FromSplitPoints(
+                                    *column.list_offsets));
+    if (edge.parent_size() != row_count ||
+        edge.child_size() != column.values.size()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "list offsets of column '%s' describe %d lists of %d items in "
+          "total, expected %d lists of %d items",
+          column.attr_name, edge.parent_size(), edge.child_size(), row_count,
+          column.values.size()));
+    }
+    ASSIGN_OR_RETURN(auto items_shape, shape.AddDims({std::move(edge)}));
+    ASSIGN_OR_RETURN(DataSlice item_schema,
+                     attr_schema.GetAttr(schema::kListItemsSchemaAttr));
+    ASSIGN_OR_RETURN(DataSlice items,
+                     ColumnWithSchema(column.values, std::move(items_shape),
+                                      item_schema.item(), db));
+    ASSIGN_OR_RETURN(values.emplace_back(),
+                     CreateListsFromLastDimension(db, items, attr_schema));
+  }
+  if (values.empty()) {
+    return DataSlice::Create(DataSliceImpl::AllocateEmptyObjects(row_count),
+                             std::move(shape), schema.item(), db);
+  }
+  ASSIGN_OR_RETURN(internal::DataBagImpl & db_mutable_impl,
+                   db->GetMutableImpl());
+  return CreateEntitiesFromFields<DataSliceImpl>(
+      db, attr_names, values, schema.item(), db_mutable_impl);
+}
+
 absl::StatusOr<DataSlice> EntityCreator::Shaped(
     const DataBagPtr& db, DataSlice::JaggedShape shape,
     absl::Span<const absl::string_view> attr_names,
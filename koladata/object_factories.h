@@ -15,6 +15,7 @@
 #ifndef KOLADATA_OBJECT_FACTORIES_H_
 #define KOLADATA_OBJECT_FACTORIES_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -25,7 +26,9 @@
 #include "absl/types/span.h"
 #include "koladata/data_bag.h"
 #include "koladata/data_slice.h"
+#include "koladata/internal/data_slice.h"
 #include "koladata/internal/uuid_object.h"
+#include "arolla/dense_array/dense_array.h"
 
 namespace koladata {
 
@@ -37,6 +40,19 @@ absl::StatusOr<DataSlice> CreateEntitySchema(
     absl::Span<const absl::string_view> attr_names,
     absl::Span<const DataSlice> schemas);
 
+// A column of attribute values for EntityCreator::FromColumns.
+struct EntityColumn {
+  // Name of the attribute, which must be present in the schema.
+  absl::string_view attr_name;
+  // Values of the attribute, one per row, or for list attributes the items of
+  // all the lists. DenseArrays can wrap existing value buffers and validity
+  // bitmaps (e.g. of an Arrow record batch) without copying.
+  internal::DataSliceImpl values;
+  // For list attributes, the offsets of the lists in `values` (row count + 1
+  // split points starting at 0), as in Arrow list arrays.
+  std::optional<arolla::DenseArray<int64_t>> list_offsets;
+};
+
 // Functor that provides different factories for Entities. When created,
 // Entities have DataSlice-level explicit schema (which is also stored in the
 // referenced DataBag).
@@ -121,6 +137,19 @@ struct EntityCreator {
       bool update_schema = false,
       const std::optional<DataSlice>& itemid = std::nullopt);
 
+  // Bulk creation of Entities from columnar data, e.g. from record batches
+  // with a fixed schema.
+  //
+  // Returns a 1-dimensional DataSlice of `row_count` new Entities with Entity
+  // schema `schema`, whose attributes are set to `columns`. Values whose type
+  // matches the schema attribute are stored in `db` as they are, without
+  // casting or copying; other values are cast using explicit casting rules.
+  //
+  // Adopts `schema` into `db`.
+  static absl::StatusOr<DataSlice> FromColumns(
+      const DataBagPtr& db, const DataSlice& schema, int64_t row_count,
+      absl::Span<const EntityColumn> columns);
+
   // This method, together with ObjectCreator::Convert provides a uniform method
   // for adapting DataSlices for usage in converting complex Python structures
   // to Koda structure.
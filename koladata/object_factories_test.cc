@@ -604,6 +604,87 @@ TEST(EntityCreatorTest, EntityToEntity) {
   EXPECT_EQ(entity.GetSchemaImpl(), entity_val.GetSchemaImpl());
 }
 
+TEST(EntityCreatorTest, FromColumns) {
+  auto db = DataBag::Empty();
+  auto schema_db = DataBag::Empty();
+  ASSERT_OK_AND_ASSIGN(
+      auto list_schema,
+      CreateListSchema(schema_db, test::Schema(schema::kFloat32)));
+  ASSERT_OK_AND_ASSIGN(
+      auto schema,
+      CreateEntitySchema(schema_db, {"a", "b", "c"},
+                         {test::Schema(schema::kInt32),
+                          test::Schema(schema::kInt64), list_schema}));
+  auto a = internal::DataSliceImpl::Create(
+      CreateDenseArray<int>({1, std::nullopt, 3}));
+  auto b = internal::DataSliceImpl::Create(CreateDenseArray<int>({4, 5, 6}));
+  auto c = internal::DataSliceImpl::Create(
+      CreateDenseArray<float>({1.5, 2.5, 3.5}));
+  auto c_offsets = CreateDenseArray<int64_t>({0, 2, 2, 3});
+
+  ASSERT_OK_AND_ASSIGN(
+      auto ds, EntityCreator::FromColumns(db, schema, 3,
+                                          {{.attr_name = "a", .values = a},
+                                           {.attr_name = "b", .values = b},
+                                           {.attr_name = "c",
+                                            .values = c,
+                                            .list_offsets = c_offsets}}));
+  EXPECT_EQ(ds.GetBag(), db);
+  EXPECT_EQ(ds.size(), 3);
+  EXPECT_EQ(ds.GetSchemaImpl(), schema.item());
+  // The schema is adopted.
+  EXPECT_THAT(ds.GetSchema().GetAttr("a"),
+              IsOkAndHolds(Property(&DataSlice::item, Eq(schema::kInt32))));
+
+  ASSERT_OK_AND_ASSIGN(auto ds_a, ds.GetAttr("a"));
+  EXPECT_EQ(ds_a.GetSchemaImpl(), schema::kInt32);
+  EXPECT_THAT(ds_a.slice(), ElementsAre(1, std::nullopt, 3));
+  ASSERT_OK_AND_ASSIGN(auto ds_b, ds.GetAttr("b"));
+  EXPECT_EQ(ds_b.GetSchemaImpl(), schema::kInt64);
+  EXPECT_THAT(ds_b.slice(), ElementsAre(int64_t{4}, int64_t{5}, int64_t{6}));
+  ASSERT_OK_AND_ASSIGN(auto ds_c, ds.GetAttr("c"));
+  EXPECT_EQ(ds_c.GetSchemaImpl(), list_schema.item());
+  ASSERT_OK_AND_ASSIGN(auto ds_c_items, ds_c.ExplodeList(0, std::nullopt));
+  EXPECT_THAT(ds_c_items.slice(), ElementsAre(1.5f, 2.5f, 3.5f));
+  EXPECT_THAT(ds_c_items.GetShape().edges().back(),
+              IsEquivalentTo(*DenseArrayEdge::FromSplitPoints(c_offsets)));
+
+  ASSERT_OK_AND_ASSIGN(ds, EntityCreator::FromColumns(db, schema, 2, {}));
+  EXPECT_EQ(ds.size(), 2);
+  EXPECT_EQ(ds.GetSchemaImpl(), schema.item());
+}
+
+TEST(EntityCreatorTest, FromColumns_Errors) {
+  auto db = DataBag::Empty();
+  ASSERT_OK_AND_ASSIGN(
+      auto schema,
+      CreateEntitySchema(db, {"a"}, {test::Schema(schema::kInt32)}));
+  auto a = internal::DataSliceImpl::Create(CreateDenseArray<int>({1, 2}));
+
+  EXPECT_THAT(
+      EntityCreator::FromColumns(db, test::Schema(schema::kInt32), 2,
+                                 {{.attr_name = "a", .values = a}}),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("requires Entity schema, got INT32")));
+  EXPECT_THAT(EntityCreator::FromColumns(db, schema, 3,
+                                         {{.attr_name = "a", .values = a}}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("column 'a' has 2 values, expected 3")));
+  EXPECT_THAT(EntityCreator::FromColumns(db, schema, 2,
+                                         {{.attr_name = "b", .values = a}}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("attribute 'b' is missing")));
+  EXPECT_THAT(
+      EntityCreator::FromColumns(
+          db, schema, 1,
+          {{.attr_name = "a",
+            .values = a,
+            .list_offsets = CreateDenseArray<int64_t>({0, 2})}}),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("column 'a' has list offsets, but its schema is "
+                         "INT32")));
+}
+
 TEST(CreateUuTest, DataSlice) {
   constexpr int64_t kSize = 3;
   auto db = DataBag::Empty();
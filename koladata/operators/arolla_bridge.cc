@@ -14,7 +14,9 @@
 //
 #include "koladata/operators/arolla_bridge.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -39,13 +41,18 @@
 #include "koladata/data_slice_qtype.h"
 #include "koladata/internal/data_item.h"
 #include "koladata/internal/dtype.h"
+#include "koladata/internal/op_utils/parallel.h"
 #include "koladata/internal/op_utils/utils.h"
 #include "koladata/internal/schema_utils.h"
 #include "koladata/schema_utils.h"
 #include "koladata/shape_utils.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/dense_array/edge.h"
 #include "arolla/dense_array/qtype/types.h"
+#include "arolla/expr/expr_attributes.h"
 #include "arolla/expr/registered_expr_operator.h"
 #include "arolla/jagged_shape/dense_array/qtype/qtype.h"
+#include "arolla/memory/buffer.h"
 #include "arolla/qtype/optional_qtype.h"
 #include "arolla/qtype/qtype.h"
 #include "arolla/qtype/standard_type_properties/properties.h"
@@ -53,6 +60,7 @@
 #include "arolla/qtype/typed_value.h"
 #include "arolla/serving/expr_compiler.h"
 #include "arolla/util/lru_cache.h"
+#include "arolla/util/meta.h"
 #include "arolla/util/repr.h"
 #include "arolla/util/status_macros_backport.h"
 
@@ -183,10 +191,206 @@ absl::StatusOr<internal::DataItem> GetResultSchema(
   return internal::DataItem(result_dtype);
 }
 
+// Returns the boundaries of group ranges with similar numbers of rows, so that
+// [res[i], res[i + 1]) are the groups of `edge` aggregated by the i-th thread.
+// Returns an empty vector if the evaluation should not be split.
+std::vector<int64_t> GetParallelAggGroupRanges(
+    const arolla::DenseArrayEdge& edge, const ParallelAggOptions& options) {
+  int64_t num_rows = edge.child_size();
+  int64_t num_threads = std::min<int64_t>(
+      {options.max_parallelism, edge.parent_size(),
+       num_rows / std::max<int64_t>(options.min_rows_per_thread, 1)});
+  if (num_threads <= 1 ||
+      edge.edge_type() != arolla::DenseArrayEdge::SPLIT_POINTS) {
+    return {};
+  }
+  absl::Span<const int64_t> split_points = edge.edge_values().values.span();
+  std::vector<int64_t> res = {0};
+  for (int64_t thread_id = 1; thread_id < num_threads; ++thread_id) {
+    int64_t group = std::lower_bound(split_points.begin(), split_points.end(),
+                                     num_rows * thread_id / num_threads) -
+                    split_points.begin();
+    if (group > res.back() && group < edge.parent_size()) {
+      res.push_back(group);
+    }
+  }
+  res.push_back(edge.parent_size());
+  if (res.size() <= 2) {
+    return {};
+  }
+  return res;
+}
+
+// Returns rows [begin, begin + size) of the DenseArray `value` without copying
+// the values. Returns nullopt if `value` is not a DenseArray of a primitive
+// type.
+std::optional<arolla::TypedValue> SliceDenseArray(arolla::TypedRef value,
+                                                  int64_t begin, int64_t size) {
+  std::optional<arolla::TypedValue> res;
+  arolla::meta::foreach_type(
+      schema::supported_primitive_dtypes(), [&](auto tpe) {
+        using T = typename decltype(tpe)::type;
+        if (value.GetType() == arolla::GetDenseArrayQType<T>()) {
+          res = arolla::TypedValue::FromValue(
+              value.UnsafeAs<arolla::DenseArray<T>>().Slice(begin, size));
+        }
+      });
+  return res;
+}
+
+// Returns true if `op_name` evaluated on `inputs` returns a DenseArray of a
+// primitive type, i.e. if its results can be concatenated by
+// ConcatDenseArrays. Only the output type is inferred, nothing is evaluated.
+bool HasDenseArrayOfPrimitivesOutput(
+    absl::string_view op_name, absl::Span<const arolla::TypedRef> inputs) {
+  std::vector<arolla::expr::ExprAttributes> input_attrs;
+  input_attrs.reserve(inputs.size());
+  for (const arolla::TypedRef& input : inputs) {
+    input_attrs.emplace_back(input.GetType());
+  }
+  auto output_attr =
+      arolla::expr::RegisteredOperator(op_name).InferAttributes(input_attrs);
+  if (!output_attr.ok() || output_attr->qtype() == nullptr) {
+    return false;
+  }
+  bool res = false;
+  arolla::meta::foreach_type(
+      schema::supported_primitive_dtypes(), [&](auto tpe) {
+        using T = typename decltype(tpe)::type;
+        res |= output_attr->qtype() == arolla::GetDenseArrayQType<T>();
+      });
+  return res;
+}
+
+// Concatenates DenseArrays of the same primitive type. Returns nullopt for
+// other types.
+std::optional<arolla::TypedValue> ConcatDenseArrays(
+    absl::Span<const arolla::TypedValue> arrays) {
+  std::optional<arolla::TypedValue> res;
+  arolla::meta::foreach_type(
+      schema::supported_primitive_dtypes(), [&](auto tpe) {
+        using T = typename decltype(tpe)::type;
+        if (arrays[0].GetType() != arolla::GetDenseArrayQType<T>()) {
+          return;
+        }
+        int64_t size = 0;
+        for (const arolla::TypedValue& array : arrays) {
+          size += array.UnsafeAs<arolla::DenseArray<T>>().size();
+        }
+        arolla::DenseArrayBuilder<T> bldr(size);
+        int64_t offset = 0;
+        for (const arolla::TypedValue& array : arrays) {
+          const auto& typed_array = array.UnsafeAs<arolla::DenseArray<T>>();
+          typed_array.ForEachPresent(
+              [&](int64_t id, auto value) { bldr.Set(offset + id, value); });
+          offset += typed_array.size();
+        }
+        res = arolla::TypedValue::FromValue(std::move(bldr).Build());
+      });
+  return res;
+}
+
+// Evaluates the aggregational `fn` (compiled `op_name`) on ranges of groups of
+// `edge` in parallel according to `options` and concatenates the results.
+// Returns nullopt if the evaluation is not split, e.g. because the inputs or
+// the output are not DenseArrays of primitives. The decision is made before
+// anything is evaluated.
+std::optional<absl::StatusOr<arolla::TypedValue>> ParallelAggEval(
+    absl::string_view op_name, const compiler_internal::CompiledOp& fn,
+    absl::Span<const arolla::TypedRef> inputs, int edge_arg_index,
+    const arolla::DenseArrayEdge& edge, const ParallelAggOptions& options) {
+  std::vector<int64_t> group_ranges = GetParallelAggGroupRanges(edge, options);
+  if (group_ranges.empty() ||
+      !HasDenseArrayOfPrimitivesOutput(op_name, inputs)) {
+    return std::nullopt;
+  }
+  absl::Span<const int64_t> split_points = edge.edge_values().values.span();
+  int64_t num_chunks = group_ranges.size() - 1;
+  std::vector<std::vector<arolla::TypedValue>> chunk_inputs(num_chunks);
+  for (int64_t chunk = 0; chunk < num_chunks; ++chunk) {
+    int64_t first_group = group_ranges[chunk];
+    int64_t end_group = group_ranges[chunk + 1];
+    int64_t first_row = split_points[first_group];
+    int64_t num_rows = split_points[end_group] - first_row;
+    std::vector<arolla::TypedValue>& values = chunk_inputs[chunk];
+    values.reserve(inputs.size());
+    for (int i = 0; i < inputs.size(); ++i) {
+      if (i == edge_arg_index) {
+        arolla::Buffer<int64_t>::Builder chunk_split_points(
+            end_group - first_group + 1);
+        for (int64_t group = first_group; group <= end_group; ++group) {
+          chunk_split_points.Set(group - first_group,
+                                 split_points[group] - first_row);
+        }
+        auto chunk_edge = arolla::DenseArrayEdge::FromSplitPoints(
+            {std::move(chunk_split_points).Build()});
+        if (!chunk_edge.ok()) {
+          return std::move(chunk_edge).status();
+        }
+        values.push_back(arolla::TypedValue::FromValue(*std::move(chunk_edge)));
+      } else if (arolla::IsDenseArrayQType(inputs[i].GetType())) {
+        std::optional<arolla::TypedValue> sliced =
+            SliceDenseArray(inputs[i], first_row, num_rows);
+        if (!sliced.has_value()) {
+          return std::nullopt;
+        }
+        values.push_back(*std::move(sliced));
+      } else {
+        values.push_back(arolla::TypedValue(inputs[i]));
+      }
+    }
+  }
+
+  std::vector<absl::StatusOr<arolla::TypedValue>> chunk_results(
+      num_chunks, absl::UnknownError("not evaluated"));
+  auto eval_chunk = [&](int64_t chunk) {
+    std::vector<arolla::TypedRef> refs;
+    refs.reserve(inputs.size());
+    for (const arolla::TypedValue& value : chunk_inputs[chunk]) {
+      refs.push_back(value.AsRef());
+    }
+    chunk_results[chunk] = fn(refs);
+  };
+  internal::ParallelFor(num_chunks, eval_chunk);
+
+  std::vector<arolla::TypedValue> results;
+  results.reserve(num_chunks);
+  for (absl::StatusOr<arolla::TypedValue>& result : chunk_results) {
+    if (!result.ok()) {
+      return std::move(result).status();
+    }
+    results.push_back(*std::move(result));
+  }
+  std::optional<arolla::TypedValue> res = ConcatDenseArrays(results);
+  if (!res.has_value()) {
+    return absl::InternalError(absl::StrCat(
+        "unexpected output type of ", op_name, ": ",
+        results[0].GetType()->name()));
+  }
+  return *std::move(res);
+}
+
+// Evaluates the aggregational operator `op_name` with the edge of the last
+// dimension as the `edge_arg_index` input, in parallel if enabled by
+// `parallel_options`.
+absl::StatusOr<arolla::TypedValue> EvalAggExpr(
+    absl::string_view op_name, absl::Span<const arolla::TypedRef> inputs,
+    int edge_arg_index, const arolla::DenseArrayEdge& edge,
+    const ParallelAggOptions& parallel_options) {
+  ASSIGN_OR_RETURN(auto fn, EvalCompiler::Compile(op_name, inputs));
+  if (auto result = ParallelAggEval(op_name, fn, inputs, edge_arg_index, edge,
+                                    parallel_options);
+      result.has_value()) {
+    return *std::move(result);
+  }
+  return fn(inputs);
+}
+
 absl::StatusOr<DataSlice> SimpleAggEval(
     absl::string_view op_name, std::vector<DataSlice> inputs,
     internal::DataItem output_schema, int edge_arg_index, bool is_agg_into,
-    const std::optional<absl::Span<const int>>& primary_operand_indices) {
+    const std::optional<absl::Span<const int>>& primary_operand_indices,
+    const ParallelAggOptions& parallel_options) {
   DCHECK_GE(inputs.size(), 1);
   DCHECK_GE(edge_arg_index, 0);
   DCHECK_LE(edge_arg_index, inputs.size());
@@ -231,10 +435,12 @@ absl::StatusOr<DataSlice> SimpleAggEval(
                          aligned_ds[i], typed_value_holder,
                          primary_operand_schema_info.first_primitive_schema));
   }
-  auto edge_tv = arolla::TypedValue::FromValue(aligned_shape.edges().back());
+  const arolla::DenseArrayEdge& edge = aligned_shape.edges().back();
+  auto edge_tv = arolla::TypedValue::FromValue(edge);
   typed_refs[edge_arg_index] = edge_tv.AsRef();
   ASSIGN_OR_RETURN(
-      auto result, EvalExpr(op_name, typed_refs),
+      auto result,
+      EvalAggExpr(op_name, typed_refs, edge_arg_index, edge, parallel_options),
       internal::OperatorEvalError(
           std::move(_), op_name,
           "successfully converted input DataSlice(s) to DenseArray(s) but "
@@ -363,19 +569,23 @@ absl::StatusOr<DataSlice> SimplePointwiseEval(
 absl::StatusOr<DataSlice> SimpleAggIntoEval(
     absl::string_view op_name, std::vector<DataSlice> inputs,
     internal::DataItem output_schema, int edge_arg_index,
-    const std::optional<absl::Span<const int>>& primary_operand_indices) {
+    const std::optional<absl::Span<const int>>& primary_operand_indices,
+    const ParallelAggOptions& parallel_options) {
   return SimpleAggEval(op_name, std::move(inputs), std::move(output_schema),
                        edge_arg_index,
-                       /*is_agg_into=*/true, primary_operand_indices);
+                       /*is_agg_into=*/true, primary_operand_indices,
+                       parallel_options);
 }
 
 absl::StatusOr<DataSlice> SimpleAggOverEval(
     absl::string_view op_name, std::vector<DataSlice> inputs,
     internal::DataItem output_schema, int edge_arg_index,
-    const std::optional<absl::Span<const int>>& primary_operand_indices) {
+    const std::optional<absl::Span<const int>>& primary_operand_indices,
+    const ParallelAggOptions& parallel_options) {
   return SimpleAggEval(op_name, std::move(inputs), std::move(output_schema),
                        edge_arg_index,
-                       /*is_agg_into=*/false, primary_operand_indices);
+                       /*is_agg_into=*/false, primary_operand_indices,
+                       parallel_options);
 }
 
 }  // namespace koladata::ops
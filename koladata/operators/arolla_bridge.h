@@ -17,6 +17,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <optional>
 #include <string>
@@ -180,6 +181,19 @@ absl::StatusOr<DataSlice> SimplePointwiseEval(
     const std::optional<absl::Span<const int>>& primary_operand_indices =
         std::nullopt);
 
+// Options of chunked parallel evaluation in SimpleAggIntoEval and
+// SimpleAggOverEval, passed per call. The groups of the last dimension are
+// split into ranges with similar numbers of rows, each range is aggregated on
+// its own thread and the results are concatenated. The results are identical
+// to the sequential evaluation.
+struct ParallelAggOptions {
+  // The maximal number of threads, including the calling one. 1 disables
+  // parallel evaluation.
+  int max_parallelism = 1;
+  // The minimal number of rows aggregated by one thread.
+  int64_t min_rows_per_thread = int64_t{1} << 20;
+};
+
 // Evaluates the registered operator of the given name on the given input and
 // returns the result. The expr_op is expected to be an agg-into operator that
 // should be evaluated on the given inputs extracted as Arolla values and the
@@ -197,12 +211,14 @@ absl::StatusOr<DataSlice> SimplePointwiseEval(
 // primitive schema of the primary inputs is used to construct all primary
 // inputs, and the non-primary inputs are treated individually (i.e. the
 // primitive schema of each non-primary input is used to construct it).
+// `parallel_options` enable parallel evaluation, see ParallelAggOptions.
 absl::StatusOr<DataSlice> SimpleAggIntoEval(
     absl::string_view op_name, std::vector<DataSlice> inputs,
     internal::DataItem output_schema = internal::DataItem(),
     int edge_arg_index = 1,
     const std::optional<absl::Span<const int>>& primary_operand_indices =
-        std::nullopt);
+        std::nullopt,
+    const ParallelAggOptions& parallel_options = {});
 
 // Evaluates the registered operator of the given name on the given input and
 // returns the result. The expr_op is expected to be an agg-over operator that
@@ -220,13 +236,15 @@ absl::StatusOr<DataSlice> SimpleAggIntoEval(
 // evaluated. In other cases, the first primitive schema of the primary inputs
 // is used to construct all primary inputs, and the non-primary inputs are
 // treated individually (i.e. the primitive schema of each non-primary input is
-// used to construct it).
+// used to construct it). `parallel_options` enable parallel evaluation, see
+// ParallelAggOptions.
 absl::StatusOr<DataSlice> SimpleAggOverEval(
     absl::string_view op_name, std::vector<DataSlice> inputs,
     internal::DataItem output_schema = internal::DataItem(),
     int edge_arg_index = 1,
     const std::optional<absl::Span<const int>>& primary_operand_indices =
-        std::nullopt);
+        std::nullopt,
+    const ParallelAggOptions& parallel_options = {});
 
 // koda_internal._to_data_slice operator.
 //
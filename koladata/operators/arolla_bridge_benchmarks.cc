@@ -0,0 +1,161 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "koladata/data_slice.h"
+#include "koladata/internal/data_item.h"
+#include "koladata/internal/data_slice.h"
+#include "koladata/internal/dtype.h"
+#include "koladata/operators/arolla_bridge.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/util/init_arolla.h"
+
+namespace koladata::ops {
+namespace {
+
+DataSlice CreateFloatSlice(int64_t size, float offset) {
+  std::vector<float> values(size);
+  for (int64_t i = 0; i < size; ++i) {
+    values[i] = offset + i % 100 - 50.f;
+  }
+  auto ds = DataSlice::Create(
+      internal::DataSliceImpl::Create(arolla::CreateFullDenseArray(values)),
+      DataSlice::JaggedShape::FlatFromSize(size),
+      internal::DataItem(schema::kFloat32));
+  CHECK_OK(ds);
+  return *std::move(ds);
+}
+
+DataSlice CreateScalar(float value) {
+  auto ds = DataSlice::Create(internal::DataItem(value),
+                              internal::DataItem(schema::kFloat32));
+  CHECK_OK(ds);
+  return *std::move(ds);
+}
+
+// Computes `log(abs(x * 2 + y))` with a chain of eager operators.
+void BM_ChainedPointwiseEval(benchmark::State& state) {
+  arolla::InitArolla();
+  int64_t size = state.range(0);
+  DataSlice x = CreateFloatSlice(size, 0.5f);
+  DataSlice y = CreateFloatSlice(size, 0.25f);
+  DataSlice c = CreateScalar(2.f);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(x);
+    benchmark::DoNotOptimize(y);
+    auto res = SimplePointwiseEval("math.multiply", {x, c});
+    res = SimplePointwiseEval("math.add", {*std::move(res), y});
+    res = SimplePointwiseEval("math.abs", {*std::move(res)});
+    res = SimplePointwiseEval("math.log", {*std::move(res)});
+    CHECK_OK(res);
+    benchmark::DoNotOptimize(res);
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+
+// Returns a rank-2 jagged shape with `parent_size` rows of 1 to 19 elements.
+DataSlice::JaggedShape CreateJaggedShape(int64_t parent_size) {
+  std::vector<int64_t> split_points;
+  split_points.reserve(parent_size + 1);
+  split_points.push_back(0);
+  for (int64_t i = 0; i < parent_size; ++i) {
+    split_points.push_back(split_points.back() + 1 + i % 19);
+  }
+  auto edge = DataSlice::JaggedShape::Edge::FromSplitPoints(
+      arolla::CreateFullDenseArray(std::move(split_points)));
+  CHECK_OK(edge);
+  auto shape = DataSlice::JaggedShape::FlatFromSize(parent_size)
+                   .AddDims({*std::move(edge)});
+  CHECK_OK(shape);
+  return *std::move(shape);
+}
+
+// Computes `x + c` for a large jagged `x` and a scalar `c`.
+void BM_ScalarBroadcastPointwiseEval(benchmark::State& state) {
+  arolla::InitArolla();
+  auto shape = CreateJaggedShape(state.range(0));
+  auto x = CreateFloatSlice(shape.size(), 0.5f).Reshape(shape);
+  CHECK_OK(x);
+  DataSlice c = CreateScalar(2.f);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(x);
+    auto res = SimplePointwiseEval("math.add", {*x, c});
+    CHECK_OK(res);
+    benchmark::DoNotOptimize(res);
+  }
+  state.SetItemsProcessed(state.iterations() * shape.size());
+}
+
+// Computes `x + p` for a large jagged `x` and `p` of one rank lower.
+void BM_ParentBroadcastPointwiseEval(benchmark::State& state) {
+  arolla::InitArolla();
+  auto shape = CreateJaggedShape(state.range(0));
+  auto x = CreateFloatSlice(shape.size(), 0.5f).Reshape(shape);
+  CHECK_OK(x);
+  DataSlice p = CreateFloatSlice(state.range(0), 0.25f);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(x);
+    benchmark::DoNotOptimize(p);
+    auto res = SimplePointwiseEval("math.add", {*x, p});
+    CHECK_OK(res);
+    benchmark::DoNotOptimize(res);
+  }
+  state.SetItemsProcessed(state.iterations() * shape.size());
+}
+
+// Computes `agg_sum(x)` and `cum_sum(x)` for a large jagged `x` with the
+// given maximal parallelism.
+void BM_ParallelAggEval(benchmark::State& state) {
+  arolla::InitArolla();
+  auto shape = CreateJaggedShape(state.range(0));
+  auto x = CreateFloatSlice(shape.size(), 0.5f).Reshape(shape);
+  CHECK_OK(x);
+  ParallelAggOptions options = {
+      .max_parallelism = static_cast<int>(state.range(1)),
+      .min_rows_per_thread = 1 << 16};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(x);
+    auto sum = SimpleAggIntoEval("math.sum", {*x}, internal::DataItem(),
+                                 /*edge_arg_index=*/1,
+                                 /*primary_operand_indices=*/std::nullopt,
+                                 options);
+    CHECK_OK(sum);
+    auto cum_sum = SimpleAggOverEval("math.cum_sum", {*x}, internal::DataItem(),
+                                     /*edge_arg_index=*/1,
+                                     /*primary_operand_indices=*/std::nullopt,
+                                     options);
+    CHECK_OK(cum_sum);
+    benchmark::DoNotOptimize(sum);
+    benchmark::DoNotOptimize(cum_sum);
+  }
+  state.SetItemsProcessed(state.iterations() * shape.size());
+}
+
+BENCHMARK(BM_ChainedPointwiseEval)->Range(1, 1000000);
+BENCHMARK(BM_ScalarBroadcastPointwiseEval)->Range(1, 100000);
+BENCHMARK(BM_ParentBroadcastPointwiseEval)->Range(1, 100000);
+BENCHMARK(BM_ParallelAggEval)
+    ->ArgPair(1000, 1)
+    ->ArgPair(1000000, 1)
+    ->ArgPair(1000000, 4)
+    ->ArgPair(1000000, 16);
+
+}  // namespace
+}  // namespace koladata::ops
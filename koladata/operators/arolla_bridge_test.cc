@@ -29,12 +29,14 @@
 #include "koladata/data_bag.h"
 #include "koladata/data_slice.h"
 #include "koladata/internal/data_item.h"
+#include "koladata/internal/data_slice.h"
 #include "koladata/internal/dtype.h"
 #include "koladata/internal/error.pb.h"
 #include "koladata/internal/error_utils.h"
 #include "koladata/internal/object_id.h"
 #include "koladata/internal/testing/matchers.h"
 #include "koladata/object_factories.h"
+#include "koladata/operators/math.h"
 #include "koladata/test_utils.h"
 #include "koladata/testing/matchers.h"
 #include "arolla/dense_array/dense_array.h"
@@ -90,6 +92,23 @@ TEST(ArollaEval, SimplePointwiseEval) {
                     {int64_t{4}, int64_t{-2}, std::nullopt, std::nullopt},
                     y_shape, schema::kAny)));
   }
+  {
+    // Lower-rank and scalar inputs are broadcasted to the common shape.
+    DataSlice x = test::DataSlice<int>({1, std::nullopt, 3}, schema::kInt32);
+    DataSlice::JaggedShape y_shape = *DataSlice::JaggedShape::FromEdges(
+        {EdgeFromSizes({3}), EdgeFromSizes({2, 1, 2})});
+    DataSlice y = test::DataSlice<int>({10, 20, 30, 40, std::nullopt},
+                                       y_shape, schema::kInt32);
+    DataSlice z = test::DataItem(100, schema::kInt32);
+    ASSERT_OK_AND_ASSIGN(auto result, SimplePointwiseEval("math.add", {x, y}));
+    EXPECT_THAT(result, IsEquivalentTo(test::DataSlice<int>(
+                            {11, 21, std::nullopt, 43, std::nullopt}, y_shape,
+                            schema::kInt32)));
+    ASSERT_OK_AND_ASSIGN(result, SimplePointwiseEval("math.subtract", {z, y}));
+    EXPECT_THAT(result, IsEquivalentTo(test::DataSlice<int>(
+                            {90, 80, 70, 60, std::nullopt}, y_shape,
+                            schema::kInt32)));
+  }
   {
     // One empty and unknown slice.
     DataSlice x = test::EmptyDataSlice(3, schema::kObject);
@@ -547,6 +566,82 @@ TEST(ArollaEval, SimpleAggIntoEvalWithPrimaryOperands) {
   }
 }
 
+TEST(ArollaEval, SimpleAggEvalParallel) {
+  DataSlice::JaggedShape shape = *DataSlice::JaggedShape::FromEdges(
+      {EdgeFromSizes({6}), EdgeFromSizes({3, 0, 2, 4, 1, 2})});
+  DataSlice x = test::DataSlice<float>(
+      {1.0f, 2.0f, std::nullopt, 4.0f, 5.0f, 6.0f, std::nullopt, 8.0f, 9.0f,
+       10.0f, 11.0f, 12.0f},
+      shape);
+  DataSlice texts = test::DataSlice<arolla::Text>(
+      {"a", "b", std::nullopt, "d", "e", "f", std::nullopt, "h", "i", "j", "k",
+       "l"},
+      shape);
+  DataSlice sep = test::DataItem(arolla::Text(","));
+  DataSlice unbiased = test::DataItem(true);
+
+  auto eval_all = [&](const ParallelAggOptions& options)
+      -> std::vector<absl::StatusOr<DataSlice>> {
+    return {
+        SimpleAggIntoEval("math.sum", {x}, internal::DataItem(),
+                          /*edge_arg_index=*/1,
+                          /*primary_operand_indices=*/std::nullopt, options),
+        SimpleAggIntoEval("math.std", {x, unbiased},
+                          /*output_schema=*/internal::DataItem(),
+                          /*edge_arg_index=*/1,
+                          /*primary_operand_indices=*/{{0}}, options),
+        SimpleAggIntoEval("strings.agg_join", {texts, sep},
+                          internal::DataItem(), /*edge_arg_index=*/1,
+                          /*primary_operand_indices=*/std::nullopt, options),
+        SimpleAggOverEval("math.cum_sum", {x}, internal::DataItem(),
+                          /*edge_arg_index=*/1,
+                          /*primary_operand_indices=*/std::nullopt, options),
+        SimpleAggOverEval("math.cum_max", {x}, internal::DataItem(),
+                          /*edge_arg_index=*/1,
+                          /*primary_operand_indices=*/std::nullopt, options),
+    };
+  };
+
+  std::vector<absl::StatusOr<DataSlice>> expected =
+      eval_all(ParallelAggOptions());
+  std::vector<absl::StatusOr<DataSlice>> actual =
+      eval_all({.max_parallelism = 4, .min_rows_per_thread = 1});
+  ASSERT_EQ(actual.size(), expected.size());
+  for (int i = 0; i < expected.size(); ++i) {
+    ASSERT_OK(expected[i]);
+    ASSERT_OK(actual[i]);
+    EXPECT_THAT(*actual[i], IsEquivalentTo(*expected[i])) << i;
+  }
+}
+
+TEST(ArollaEval, MathAggOperatorsParallel) {
+  // Large enough to be split between threads by the math operators.
+  constexpr int64_t kGroupCount = 1000;
+  constexpr int64_t kGroupSize = 3000;
+  std::vector<float> values(kGroupCount * kGroupSize);
+  for (int64_t i = 0; i < values.size(); ++i) {
+    values[i] = i % 7;
+  }
+  ASSERT_OK_AND_ASSIGN(
+      auto shape,
+      DataSlice::JaggedShape::FromEdges(
+          {*DataSliceEdge::FromUniformGroups(1, kGroupCount),
+           *DataSliceEdge::FromUniformGroups(kGroupCount, kGroupSize)}));
+  ASSERT_OK_AND_ASSIGN(
+      DataSlice x,
+      DataSlice::Create(internal::DataSliceImpl::Create(
+                            arolla::CreateFullDenseArray<float>(values)),
+                        shape, internal::DataItem(schema::kFloat32)));
+
+  ASSERT_OK_AND_ASSIGN(auto expected_sum, SimpleAggIntoEval("math.sum", {x}));
+  EXPECT_THAT(AggSum(x), IsOkAndHolds(IsEquivalentTo(expected_sum)));
+  ASSERT_OK_AND_ASSIGN(auto expected_max, SimpleAggIntoEval("math.max", {x}));
+  EXPECT_THAT(AggMax(x), IsOkAndHolds(IsEquivalentTo(expected_max)));
+  ASSERT_OK_AND_ASSIGN(auto expected_cum_sum,
+                       SimpleAggOverEval("math.cum_sum", {x}));
+  EXPECT_THAT(CumSum(x), IsOkAndHolds(IsEquivalentTo(expected_cum_sum)));
+}
+
 TEST(ArollaEval, SimpleAggOverEval) {
   {
     // Eval through operator.
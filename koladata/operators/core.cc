@@ -62,6 +62,7 @@
 #include "koladata/internal/op_utils/itemid.h"
 #include "koladata/internal/op_utils/reverse.h"
 #include "koladata/internal/op_utils/select.h"
+#include "koladata/internal/op_utils/sort.h"
 #include "koladata/internal/op_utils/utils.h"
 #include "koladata/internal/schema_utils.h"
 #include "koladata/internal/slice_builder.h"
@@ -99,6 +100,7 @@ namespace {
 
 constexpr absl::string_view kSubsliceOperatorName = "kd.subslice";
 constexpr absl::string_view kTakeOperatorName = "kd.take";
+constexpr absl::string_view kTranslateOperatorName = "kd.translate";
 constexpr auto OpError = ::koladata::internal::ToOperatorEvalError;
 
 class AlignOperator : public arolla::QExprOperator {
@@ -1066,6 +1068,28 @@ absl::StatusOr<DataSlice> OrdinalRank(const DataSlice& x,
       /*output_schema=*/internal::DataItem(schema::kInt64), /*edge_index=*/2);
 }
 
+absl::StatusOr<DataSlice> Sort(const DataSlice& x, const DataSlice& sort_by,
+                               const DataSlice& descending) {
+  constexpr absl::string_view kOperatorName = "kd.core.sort";
+  RETURN_IF_ERROR(ExpectPresentScalar("descending", descending, schema::kBool))
+      .With(OpError(kOperatorName));
+  const auto& shape = x.GetShape();
+  if (shape.rank() == 0) {
+    return internal::OperatorEvalError(kOperatorName, "expected rank(x) > 0");
+  }
+  if (!shape.IsEquivalentTo(sort_by.GetShape())) {
+    return internal::OperatorEvalError(
+        kOperatorName, "arguments `x` and `sort_by` must have the same shape");
+  }
+  ASSIGN_OR_RETURN(
+      auto result,
+      internal::SortOp()(x.slice(), sort_by.slice(), shape.edges().back(),
+                         descending.item().value<bool>()),
+      internal::OperatorEvalError(std::move(_), kOperatorName));
+  return DataSlice::Create(std::move(result), shape, x.GetSchemaImpl(),
+                           x.GetBag());
+}
+
 absl::StatusOr<DataSlice> DenseRank(const DataSlice& x,
                                     const DataSlice& descending) {
   constexpr absl::string_view kOperatorName = "kd.core.dense_rank";
@@ -1619,60 +1643,93 @@ absl::StatusOr<DataSlice> Take(const DataSlice& x, const DataSlice& indices) {
 absl::StatusOr<DataSlice> Translate(const DataSlice& keys_to,
                                     const DataSlice& keys_from,
                                     const DataSlice& values_from) {
-  constexpr absl::string_view kOperatorName = "kd.translate";
+  ASSIGN_OR_RETURN(auto table,
+                   TranslationTable::Create(keys_from, values_from));
+  return table.Translate(keys_to);
+}
 
+absl::StatusOr<TranslationTable> TranslationTable::Create(
+    const DataSlice& keys_from, const DataSlice& values_from) {
   const auto& from_shape = keys_from.GetShape();
   ASSIGN_OR_RETURN(auto expanded_values_from,
                    BroadcastToShape(values_from, from_shape),
                    internal::OperatorEvalError(
-                       std::move(_), kOperatorName,
+                       std::move(_), kTranslateOperatorName,
                        "values_from must be broadcastable to keys_from"));
 
   if (from_shape.rank() == 0) {
     return internal::OperatorEvalError(
-        kOperatorName,
+        kTranslateOperatorName,
         "keys_from and values_from must have at least one dimension");
   }
 
-  auto shape_without_last_dim = from_shape.RemoveDims(from_shape.rank() - 1);
-  if (!shape_without_last_dim.IsBroadcastableTo(keys_to.GetShape())) {
+  absl::StatusOr<internal::TranslateIndex> index =
+      internal::TranslateIndex::Create(keys_from.slice(),
+                                       from_shape.edges().back());
+  if (absl::IsAlreadyExists(index.status())) {
+    // Deduplicate the keys only to report the error.
+    ASSIGN_OR_RETURN(auto false_item,
+                     DataSlice::Create(internal::DataItem(false),
+                                       DataSlice::JaggedShape::Empty(),
+                                       internal::DataItem(schema::kBool)));
+    ASSIGN_OR_RETURN(auto unique_keys, Unique(keys_from, false_item));
+    return internal::OperatorEvalError(
+        kTranslateOperatorName,
+        absl::StrFormat(
+            "keys_from must be unique within each group of the last dimension: "
+            "original DataSlice %s vs DataSlice after dedup %s. Consider using "
+            "translate_group instead",
+            arolla::Repr(keys_from), arolla::Repr(unique_keys)));
+  }
+  if (!index.ok()) {
+    return internal::OperatorEvalError(std::move(index).status(),
+                                       kTranslateOperatorName);
+  }
+  return TranslationTable(keys_from.GetSchemaImpl(),
+                          from_shape.RemoveDims(from_shape.rank() - 1),
+                          std::move(expanded_values_from), *std::move(index));
+}
+
+absl::StatusOr<DataSlice> TranslationTable::Translate(
+    const DataSlice& keys_to) const {
+  if (!shape_without_last_dim_.IsBroadcastableTo(keys_to.GetShape())) {
     return internal::OperatorEvalError(
-        kOperatorName,
+        kTranslateOperatorName,
         absl::StrFormat(
             "keys_from.get_shape()[:-1] must be broadcastable to keys_to, but "
             "got %s vs %s",
-            arolla::Repr(shape_without_last_dim),
+            arolla::Repr(shape_without_last_dim_),
             arolla::Repr(keys_to.GetShape())));
   }
 
   ASSIGN_OR_RETURN(auto casted_keys_to,
-                   CastToNarrow(keys_to, keys_from.GetSchemaImpl()),
+                   CastToNarrow(keys_to, keys_from_schema_),
                    internal::OperatorEvalError(
-                       std::move(_), kOperatorName,
+                       std::move(_), kTranslateOperatorName,
                        "keys_to schema must be castable to keys_from schema"));
 
-  ASSIGN_OR_RETURN(auto false_item,
-                   DataSlice::Create(internal::DataItem(false),
-                                     DataSlice::JaggedShape::Empty(),
-                                     internal::DataItem(schema::kBool)));
-  ASSIGN_OR_RETURN(auto unique_keys, Unique(keys_from, false_item));
-  if (keys_from.present_count() != unique_keys.present_count()) {
-    return internal::OperatorEvalError(
-        kOperatorName,
-        absl::StrFormat(
-            "keys_from must be unique within each group of the last dimension: "
-            "original DataSlice %s vs DataSlice after dedup %s. Consider using "
-            "translate_group instead",
-            arolla::Repr(keys_from), arolla::Repr(unique_keys)));
-  }
-
-  auto temp_db = DataBag::Empty();
-  ASSIGN_OR_RETURN(auto lookup,
-                   CreateDictShaped(temp_db, std::move(shape_without_last_dim),
-                                    keys_from.WithBag(nullptr),
-                                    expanded_values_from.WithBag(nullptr)));
-  ASSIGN_OR_RETURN(auto res, lookup.GetFromDict(casted_keys_to));
-  return res.WithBag(expanded_values_from.GetBag());
+  internal::DataSliceImpl keys_to_impl =
+      casted_keys_to.is_item()
+          ? internal::DataSliceImpl::Create(1, casted_keys_to.item())
+          : casted_keys_to.slice();
+  ASSIGN_OR_RETURN(
+      arolla::DenseArray<int64_t> positions,
+      index_.Find(keys_to_impl,
+                  shape_without_last_dim_.GetBroadcastEdge(keys_to.GetShape())),
+      internal::OperatorEvalError(std::move(_), kTranslateOperatorName));
+  const internal::DataSliceImpl& values_from_impl = values_from_.slice();
+  ASSIGN_OR_RETURN(
+      auto values_from_to_scalar,
+      arolla::DenseArrayEdge::FromUniformGroups(1, values_from_impl.size()));
+  ASSIGN_OR_RETURN(internal::DataSliceImpl values,
+                   internal::AtOp(values_from_impl, positions,
+                                  values_from_to_scalar, std::nullopt));
+  if (keys_to.is_item()) {
+    return DataSlice::Create(values[0], values_from_.GetSchemaImpl(),
+                             values_from_.GetBag());
+  }
+  return DataSlice::Create(std::move(values), keys_to.GetShape(),
+                           values_from_.GetSchemaImpl(), values_from_.GetBag());
 }
 
 }  // namespace koladata::ops
@@ -16,12 +16,15 @@
 #define KOLADATA_OPERATORS_CORE_H_
 
 #include <cstdint>
+#include <utility>
 
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "koladata/data_bag.h"
 #include "koladata/data_slice.h"
+#include "koladata/internal/data_item.h"
 #include "koladata/internal/non_deterministic_token.h"
+#include "koladata/internal/op_utils/translate.h"
 #include "arolla/qexpr/operators.h"
 #include "arolla/qtype/qtype.h"
 
@@ -95,6 +98,10 @@ absl::StatusOr<DataSlice> OrdinalRank(const DataSlice& x,
                                       const DataSlice& tie_breaker,
                                       const DataSlice& descending);
 
+// kde.core._sort.
+absl::StatusOr<DataSlice> Sort(const DataSlice& x, const DataSlice& sort_by,
+                               const DataSlice& descending);
+
 // kde.core._dense_rank.
 absl::StatusOr<DataSlice> DenseRank(const DataSlice& x,
                                     const DataSlice& descending);
@@ -242,6 +249,36 @@ absl::StatusOr<DataSlice> Translate(const DataSlice& keys_to,
                                     const DataSlice& keys_from,
                                     const DataSlice& values_from);
 
+// Lookup table of kd.translate. Building the table is the most expensive part
+// of kd.translate, so the table can be built once and used to translate many
+// `keys_to`. The table is immutable and can be used from multiple threads.
+class TranslationTable {
+ public:
+  // Returns an error if `keys_from` and `values_from` are not valid arguments
+  // of kd.translate, e.g. if `keys_from` are not unique within the groups of
+  // the last dimension.
+  static absl::StatusOr<TranslationTable> Create(const DataSlice& keys_from,
+                                                 const DataSlice& values_from);
+
+  // Equivalent to kd.translate(keys_to, keys_from, values_from).
+  absl::StatusOr<DataSlice> Translate(const DataSlice& keys_to) const;
+
+ private:
+  TranslationTable(internal::DataItem keys_from_schema,
+                   DataSlice::JaggedShape shape_without_last_dim,
+                   DataSlice values_from, internal::TranslateIndex index)
+      : keys_from_schema_(std::move(keys_from_schema)),
+        shape_without_last_dim_(std::move(shape_without_last_dim)),
+        values_from_(std::move(values_from)),
+        index_(std::move(index)) {}
+
+  internal::DataItem keys_from_schema_;
+  DataSlice::JaggedShape shape_without_last_dim_;
+  // Broadcasted to the shape of `keys_from`.
+  DataSlice values_from_;
+  internal::TranslateIndex index_;
+};
+
 }  // namespace koladata::ops
 
 #endif  // KOLADATA_OPERATORS_CORE_H_
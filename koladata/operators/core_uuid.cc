@@ -141,11 +141,9 @@ class UuidForDictOperator : public arolla::QExprOperator {
   }
 };
 
-}  // namespace
-
-absl::StatusOr<DataSlice> DeepUuid(const DataSlice& ds,
-                                   const DataSlice& schema,
-                                   const DataSlice& seed) {
+absl::StatusOr<DataSlice> DeepUuidImpl(
+    const DataSlice& ds, const DataSlice& schema, const DataSlice& seed,
+    absl::Nullable<internal::DeepUuidCache*> cache) {
   absl::Nullable<DataBagPtr> db = ds.GetBag();
   if (db == nullptr) {
     if (schema.IsEntitySchema()) {
@@ -157,7 +155,8 @@ absl::StatusOr<DataSlice> DeepUuid(const DataSlice& ds,
   const auto& schema_db = schema.GetBag();
   if (schema_db != nullptr && schema_db != db) {
     ASSIGN_OR_RETURN(auto extracted_ds, Extract(ds, schema));
-    return DeepUuid(extracted_ds, schema.WithBag(extracted_ds.GetBag()), seed);
+    return DeepUuidImpl(extracted_ds, schema.WithBag(extracted_ds.GetBag()),
+                        seed, cache);
   }
   if (seed.GetShape().rank() != 0) {
     return absl::InvalidArgumentError(
@@ -170,7 +169,7 @@ absl::StatusOr<DataSlice> DeepUuid(const DataSlice& ds,
   FlattenFallbackFinder fb_finder(*db);
   auto fallbacks_span = fb_finder.GetFlattenFallbacks();
   return ds.VisitImpl([&](const auto& impl) -> absl::StatusOr<DataSlice> {
-    internal::DeepUuidOp deep_uuid_op;
+    internal::DeepUuidOp deep_uuid_op(cache);
     ASSIGN_OR_RETURN(auto result_slice_impl,
                      deep_uuid_op(seed_item, impl, schema_item, db->GetImpl(),
                                   fallbacks_span));
@@ -179,6 +178,33 @@ absl::StatusOr<DataSlice> DeepUuid(const DataSlice& ds,
   });
 }
 
+}  // namespace
+
+absl::StatusOr<DataSlice> DeepUuid(const DataSlice& ds,
+                                   const DataSlice& schema,
+                                   const DataSlice& seed) {
+  // The deep uuids of frozen data are memoized in its DataBag. Concurrent
+  // calls that find the memo busy compute without it.
+  const DataBagPtr& db = ds.GetBag();
+  DataBag::DeepUuidMemo* memo = nullptr;
+  if (db != nullptr && (schema.GetBag() == nullptr || schema.GetBag() == db)) {
+    memo = db->GetDeepUuidMemo();
+  }
+  if (memo == nullptr || !memo->mutex.TryLock()) {
+    return DeepUuidImpl(ds, schema, seed, /*cache=*/nullptr);
+  }
+  auto result = DeepUuidImpl(ds, schema, seed, &memo->cache);
+  memo->mutex.Unlock();
+  return result;
+}
+
+absl::StatusOr<DataSlice> DeepUuidWithCache(const DataSlice& ds,
+                                            const DataSlice& schema,
+                                            const DataSlice& seed,
+                                            internal::DeepUuidCache& cache) {
+  return DeepUuidImpl(ds, schema, seed, &cache);
+}
+
 absl::StatusOr<DataSlice> AggUuid(const DataSlice& x) {
   auto rank = x.GetShape().rank();
   if (rank == 0) {
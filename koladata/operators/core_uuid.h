@@ -18,16 +18,29 @@
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "koladata/data_slice.h"
+#include "koladata/internal/op_utils/deep_uuid.h"
 #include "arolla/qexpr/operators.h"
 #include "arolla/qtype/qtype.h"
 
 namespace koladata::ops {
 
 // kde.core._deep_uuid
+//
+// If the DataBag of `ds` is immutable and has no mutable fallbacks, the deep
+// uuids of subtrees are memoized in it and reused by later calls.
 absl::StatusOr<DataSlice> DeepUuid(const DataSlice& ds,
                                    const DataSlice& schema,
                                    const DataSlice& seed);
 
+// Same as DeepUuid, but reuses the deep uuids of subtrees memoized in `cache`
+// by the previous calls, and memoizes the new ones. Modifications of the
+// DataBags used with `cache` are tracked while it is alive, so it should be
+// kept only while the same DataBags are repeatedly processed.
+absl::StatusOr<DataSlice> DeepUuidWithCache(const DataSlice& ds,
+                                            const DataSlice& schema,
+                                            const DataSlice& seed,
+                                            internal::DeepUuidCache& cache);
+
 // kde.core.agg_uuid operator.
 absl::StatusOr<DataSlice> AggUuid(const DataSlice& x);
 
@@ -14,6 +14,7 @@
 //
 #include "koladata/operators/math.h"
 
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -24,6 +25,7 @@
 #include "koladata/data_slice.h"
 #include "koladata/internal/data_item.h"
 #include "koladata/internal/dtype.h"
+#include "koladata/internal/op_utils/parallel.h"
 #include "koladata/internal/op_utils/utils.h"
 #include "koladata/operators/arolla_bridge.h"
 #include "koladata/schema_utils.h"
@@ -34,6 +36,16 @@ namespace koladata::ops {
 
 constexpr auto OpError = ::koladata::internal::ToOperatorEvalError;
 
+namespace {
+
+// Options of the aggregational operators: large slices are aggregated by all
+// the threads of the shared pool.
+ParallelAggOptions AggOptions() {
+  return {.max_parallelism = static_cast<int>(internal::MaxParallelism())};
+}
+
+}  // namespace
+
 absl::StatusOr<DataSlice> Subtract(const DataSlice& x, const DataSlice& y) {
   RETURN_IF_ERROR(ExpectNumeric("x", x)).With(OpError("kde.math.subtract"));
   RETURN_IF_ERROR(ExpectNumeric("y", y)).With(OpError("kde.math.subtract"));
@@ -146,17 +158,26 @@ absl::StatusOr<DataSlice> Minimum(const DataSlice& x, const DataSlice& y) {
 
 absl::StatusOr<DataSlice> CumMax(const DataSlice& x) {
   RETURN_IF_ERROR(ExpectNumeric("x", x)).With(OpError("kde.math.cum_max"));
-  return SimpleAggOverEval("math.cum_max", {x});
+  return SimpleAggOverEval("math.cum_max", {x}, internal::DataItem(),
+                           /*edge_arg_index=*/1,
+                           /*primary_operand_indices=*/std::nullopt,
+                           AggOptions());
 }
 
 absl::StatusOr<DataSlice> CumMin(const DataSlice& x) {
   RETURN_IF_ERROR(ExpectNumeric("x", x)).With(OpError("kde.math.cum_min"));
-  return SimpleAggOverEval("math.cum_min", {x});
+  return SimpleAggOverEval("math.cum_min", {x}, internal::DataItem(),
+                           /*edge_arg_index=*/1,
+                           /*primary_operand_indices=*/std::nullopt,
+                           AggOptions());
 }
 
 absl::StatusOr<DataSlice> CumSum(const DataSlice& x) {
   RETURN_IF_ERROR(ExpectNumeric("x", x)).With(OpError("kde.math.cum_sum"));
-  return SimpleAggOverEval("math.cum_sum", {x});
+  return SimpleAggOverEval("math.cum_sum", {x}, internal::DataItem(),
+                           /*edge_arg_index=*/1,
+                           /*primary_operand_indices=*/std::nullopt,
+                           AggOptions());
 }
 
 absl::StatusOr<DataSlice> Softmax(const DataSlice& x, const DataSlice& beta) {
@@ -165,7 +186,9 @@ absl::StatusOr<DataSlice> Softmax(const DataSlice& x, const DataSlice& beta) {
       .With(OpError("kde.math.softmax"));
   return SimpleAggOverEval("math.softmax", {x, beta},
                            /*output_schema=*/internal::DataItem(),
-                           /*edge_arg_index=*/2);
+                           /*edge_arg_index=*/2,
+                           /*primary_operand_indices=*/std::nullopt,
+                           AggOptions());
 }
 
 absl::StatusOr<DataSlice> Cdf(const DataSlice& x, const DataSlice& weights) {
@@ -174,7 +197,9 @@ absl::StatusOr<DataSlice> Cdf(const DataSlice& x, const DataSlice& weights) {
       .With(OpError("kde.math.cdf"));
   return SimpleAggOverEval("math.cdf", {x, weights},
                            /*output_schema=*/internal::DataItem(),
-                           /*edge_arg_index=*/2);
+                           /*edge_arg_index=*/2,
+                           /*primary_operand_indices=*/std::nullopt,
+                           AggOptions());
 }
 
 absl::StatusOr<DataSlice> AggInverseCdf(const DataSlice& x,
@@ -192,7 +217,8 @@ absl::StatusOr<DataSlice> AggInverseCdf(const DataSlice& x,
   return SimpleAggIntoEval("math.inverse_cdf", {x, cdf_arg},
                            /*output_schema=*/internal::DataItem(),
                            /*edge_arg_index=*/2,
-                           /*primary_operand_indices=*/{{0}});
+                           /*primary_operand_indices=*/{{0}},
+                           AggOptions());
 }
 
 absl::StatusOr<DataSlice> AggSum(const DataSlice& x) {
@@ -203,7 +229,10 @@ absl::StatusOr<DataSlice> AggSum(const DataSlice& x) {
   // The input has primitive schema or OBJECT/ANY schema with a single primitive
   // dtype.
   if (primitive_schema.has_value()) {
-    return SimpleAggIntoEval("math.sum", {x});
+    return SimpleAggIntoEval("math.sum", {x}, internal::DataItem(),
+                             /*edge_arg_index=*/1,
+                             /*primary_operand_indices=*/std::nullopt,
+                             AggOptions());
   }
   // If the input is fully empty and unknown, we fix the schema to INT32. We
   // cannot skip evaluation even if the input is empty-and-unknown because the
@@ -216,17 +245,26 @@ absl::StatusOr<DataSlice> AggSum(const DataSlice& x) {
                            ? internal::DataItem(schema::kInt32)
                            : x.GetSchemaImpl();
   return SimpleAggIntoEval("math.sum", {std::move(x_int32)},
-                           /*output_schema=*/output_schema);
+                           /*output_schema=*/output_schema,
+                           /*edge_arg_index=*/1,
+                           /*primary_operand_indices=*/std::nullopt,
+                           AggOptions());
 }
 
 absl::StatusOr<DataSlice> AggMean(const DataSlice& x) {
   RETURN_IF_ERROR(ExpectNumeric("x", x)).With(OpError("kde.math.agg_mean"));
-  return SimpleAggIntoEval("math.mean", {x});
+  return SimpleAggIntoEval("math.mean", {x}, internal::DataItem(),
+                           /*edge_arg_index=*/1,
+                           /*primary_operand_indices=*/std::nullopt,
+                           AggOptions());
 }
 
 absl::StatusOr<DataSlice> AggMedian(const DataSlice& x) {
   RETURN_IF_ERROR(ExpectNumeric("x", x)).With(OpError("kde.math.agg_median"));
-  return SimpleAggIntoEval("math.median", {x});
+  return SimpleAggIntoEval("math.median", {x}, internal::DataItem(),
+                           /*edge_arg_index=*/1,
+                           /*primary_operand_indices=*/std::nullopt,
+                           AggOptions());
 }
 
 absl::StatusOr<DataSlice> AggStd(const DataSlice& x,
@@ -237,7 +275,8 @@ absl::StatusOr<DataSlice> AggStd(const DataSlice& x,
   return SimpleAggIntoEval("math.std", {x, unbiased},
                            /*output_schema=*/internal::DataItem(),
                            /*edge_arg_index=*/1,
-                           /*primary_operand_indices=*/{{0}});
+                           /*primary_operand_indices=*/{{0}},
+                           AggOptions());
 }
 
 absl::StatusOr<DataSlice> AggVar(const DataSlice& x,
@@ -248,17 +287,24 @@ absl::StatusOr<DataSlice> AggVar(const DataSlice& x,
   return SimpleAggIntoEval("math.var", {x, unbiased},
                            /*output_schema=*/internal::DataItem(),
                            /*edge_arg_index=*/1,
-                           /*primary_operand_indices=*/{{0}});
+                           /*primary_operand_indices=*/{{0}},
+                           AggOptions());
 }
 
 absl::StatusOr<DataSlice> AggMax(const DataSlice& x) {
   RETURN_IF_ERROR(ExpectNumeric("x", x)).With(OpError("kde.math.agg_max"));
-  return SimpleAggIntoEval("math.max", {x});
+  return SimpleAggIntoEval("math.max", {x}, internal::DataItem(),
+                           /*edge_arg_index=*/1,
+                           /*primary_operand_indices=*/std::nullopt,
+                           AggOptions());
 }
 
 absl::StatusOr<DataSlice> AggMin(const DataSlice& x) {
   RETURN_IF_ERROR(ExpectNumeric("x", x)).With(OpError("kde.math.agg_min"));
-  return SimpleAggIntoEval("math.min", {x});
+  return SimpleAggIntoEval("math.min", {x}, internal::DataItem(),
+                           /*edge_arg_index=*/1,
+                           /*primary_operand_indices=*/std::nullopt,
+                           AggOptions());
 }
 
 }  // namespace koladata::ops
@@ -100,6 +100,7 @@ OPERATOR_FAMILY("kde.core._new_shaped",
 OPERATOR("kde.core._ordinal_rank", OrdinalRank);
 OPERATOR("kde.core._select", Select);
 OPERATOR("kde.core._shallow_clone", ShallowClone);
+OPERATOR("kde.core._sort", Sort);
 OPERATOR_FAMILY("kde.core._uu", std::make_unique<UuOperatorFamily>());
 OPERATOR("kde.core.add", Add);
 OPERATOR_FAMILY("kde.core.align", std::make_unique<AlignOperatorFamily>());
@@ -36,6 +36,7 @@
 #include "koladata/data_slice.h"
 #include "koladata/internal/data_item.h"
 #include "koladata/internal/dtype.h"
+#include "koladata/internal/op_utils/regex.h"
 #include "koladata/internal/op_utils/utils.h"
 #include "koladata/internal/schema_utils.h"
 #include "koladata/operators/arolla_bridge.h"
@@ -60,6 +61,8 @@
 #include "arolla/util/repr.h"
 #include "arolla/util/string.h"
 #include "arolla/util/text.h"
+#include "re2/re2.h"
+#include "re2/set.h"
 #include "arolla/util/status_macros_backport.h"
 
 namespace koladata::ops {
@@ -311,18 +314,12 @@ absl::StatusOr<DataSlice> RegexExtract(const DataSlice& text,
     return BroadcastToShape(std::move(ds), text.GetShape());
   }
 
-  std::vector<arolla::TypedValue> typed_value_holder;
-  ASSIGN_OR_RETURN(
-      arolla::TypedRef text_ref,
-      DataSliceToOwnedArollaRef(text, typed_value_holder,
-                                internal::DataItem(schema::kString)));
-  arolla::TypedValue typed_regex = arolla::TypedValue::FromValue(
-      arolla::Text(regex_view));
-  ASSIGN_OR_RETURN(arolla::TypedValue result,
-                   EvalExpr("strings.extract_regex",
-                            {std::move(text_ref), typed_regex.AsRef()}));
-  return DataSliceFromArollaValue(result.AsRef(), text.GetShape(),
-                                  text.GetSchemaImpl());
+  ASSIGN_OR_RETURN(std::shared_ptr<const RE2> compiled_regex,
+                   internal::CompileRegex(regex_view));
+  return text.VisitImpl([&](const auto& impl) {
+    return DataSlice::Create(internal::RegexExtractOp()(impl, *compiled_regex),
+                             text.GetShape(), text.GetSchemaImpl());
+  });
 }
 
 absl::StatusOr<DataSlice> RegexMatch(const DataSlice& text,
@@ -340,18 +337,42 @@ absl::StatusOr<DataSlice> RegexMatch(const DataSlice& text,
     return BroadcastToShape(std::move(ds), text.GetShape());
   }
 
-  std::vector<arolla::TypedValue> typed_value_holder;
-  ASSIGN_OR_RETURN(
-      arolla::TypedRef text_ref,
-      DataSliceToOwnedArollaRef(text, typed_value_holder,
-                                internal::DataItem(schema::kString)));
-  arolla::TypedValue typed_regex = arolla::TypedValue::FromValue(
-      arolla::Text(regex_view));
-  ASSIGN_OR_RETURN(arolla::TypedValue result,
-                   EvalExpr("strings.contains_regex",
-                            {std::move(text_ref), typed_regex.AsRef()}));
-  return DataSliceFromArollaValue(result.AsRef(), text.GetShape(),
-                                  internal::DataItem(schema::kMask));
+  ASSIGN_OR_RETURN(std::shared_ptr<const RE2> compiled_regex,
+                   internal::CompileRegex(regex_view));
+  return text.VisitImpl([&](const auto& impl) {
+    return DataSlice::Create(internal::RegexMatchOp()(impl, *compiled_regex),
+                             text.GetShape(),
+                             internal::DataItem(schema::kMask));
+  });
+}
+
+absl::StatusOr<std::vector<DataSlice>> RegexMatchMany(
+    const DataSlice& text, absl::Span<const std::string> regexes) {
+  RETURN_IF_ERROR(ExpectString("text", text))
+      .With(OpError("kd.strings.regex_match"));
+  ASSIGN_OR_RETURN(std::shared_ptr<const RE2::Set> compiled_regexes,
+                   internal::CompileRegexSet(regexes));
+  // Match a single item as a slice of size 1, so that all the regexes are
+  // still matched in a single pass.
+  internal::DataSliceImpl text_impl =
+      text.is_item() ? internal::DataSliceImpl::Create(1, text.item())
+                     : text.slice();
+  ASSIGN_OR_RETURN(std::vector<internal::DataSliceImpl> matches,
+                   internal::RegexMatchManyOp()(text_impl, *compiled_regexes,
+                                                regexes.size()));
+  std::vector<DataSlice> result;
+  result.reserve(matches.size());
+  for (internal::DataSliceImpl& match : matches) {
+    ASSIGN_OR_RETURN(
+        DataSlice ds,
+        text.is_item()
+            ? DataSlice::Create(match[0], text.GetShape(),
+                                internal::DataItem(schema::kMask))
+            : DataSlice::Create(std::move(match), text.GetShape(),
+                                internal::DataItem(schema::kMask)));
+    result.push_back(std::move(ds));
+  }
+  return result;
 }
 
 absl::StatusOr<DataSlice> Replace(const DataSlice& s,
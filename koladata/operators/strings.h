@@ -15,6 +15,7 @@
 #ifndef KOLADATA_OPERATORS_STRINGS_H_
 #define KOLADATA_OPERATORS_STRINGS_H_
 
+#include <string>
 #include <vector>
 
 #include "absl/status/statusor.h"
@@ -115,6 +116,13 @@ absl::StatusOr<DataSlice> Substr(const DataSlice& x, const DataSlice& start,
 absl::StatusOr<DataSlice> Upper(const DataSlice& x);
 // go/keep-sorted end
 
+// Matches all the `regexes` against `text` in a single pass over the data.
+// Returns one MASK DataSlice per regex, shaped as `text`, with `present` where
+// the regex partially matches the text. The compiled regexes are cached, so
+// repeated calls with the same `regexes` don't recompile them.
+absl::StatusOr<std::vector<DataSlice>> RegexMatchMany(
+    const DataSlice& text, absl::Span<const std::string> regexes);
+
 }  // namespace koladata::ops
 
 #endif  // KOLADATA_OPERATORS_STRINGS_H_
@@ -14,8 +14,10 @@
 //
 #include "koladata/proto/to_proto.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <optional>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -482,38 +484,44 @@ absl::Status FillProtoMessage(
 
   // ANY schema doesn't give us a way to list attrs on the slice, so iterate
   // over the descriptor fields instead.
+  std::vector<absl::string_view> attr_names;
+  std::vector<const FieldDescriptor*> fields;
+  std::optional<DataSlice::AttrNamesSet> slice_attr_names;
   if (slice.GetSchemaImpl() == schema::kAny) {
     for (int64_t i_field = 0; i_field < message_descriptor.field_count();
          ++i_field) {
-      const auto& field = *message_descriptor.field(i_field);
-      ASSIGN_OR_RETURN(const auto& attr_slice,
-                       slice.GetAttrOrMissing(field.name()));
-      if (!attr_slice.IsEmpty()) {
-        RETURN_IF_ERROR(FillProtoField(attr_slice, field, messages, executor));
+      const auto* field = message_descriptor.field(i_field);
+      attr_names.push_back(field->name());
+      fields.push_back(field);
+    }
+  } else {
+    ASSIGN_OR_RETURN(slice_attr_names,
+                     slice.GetAttrNames(/*union_object_attrs=*/true));
+    for (const auto& attr_name : *slice_attr_names) {
+      const FieldDescriptor* field = nullptr;
+      if (attr_name.starts_with('(') && attr_name.ends_with(')')) {
+        // Interpret attrs with parentheses as fully-qualified extension paths.
+        const auto ext_full_path =
+            absl::string_view(attr_name).substr(1, attr_name.size() - 2);
+        field = message_descriptor.file()->pool()->FindExtensionByName(
+            ext_full_path);
+      } else {
+        field = message_descriptor.FindFieldByName(attr_name);
+      }
+      if (field != nullptr) {
+        attr_names.push_back(attr_name);
+        fields.push_back(field);
       }
     }
-    return absl::OkStatus();
   }
 
-  ASSIGN_OR_RETURN(const auto& attr_names,
-                   slice.GetAttrNames(/*union_object_attrs=*/true));
-  for (const auto& attr_name : attr_names) {
-    const FieldDescriptor* field = nullptr;
-    if (attr_name.starts_with('(') && attr_name.ends_with(')')) {
-      // Interpret attrs with parentheses as fully-qualified extension paths.
-      const auto ext_full_path =
-          absl::string_view(attr_name).substr(1, attr_name.size() - 2);
-      field =
-          message_descriptor.file()->pool()->FindExtensionByName(ext_full_path);
-    } else {
-      field = message_descriptor.FindFieldByName(attr_name);
-    }
-    if (field != nullptr) {
-      ASSIGN_OR_RETURN(const auto& attr_slice,
-                       slice.GetAttrOrMissing(attr_name));
-      if (!attr_slice.IsEmpty()) {
-        RETURN_IF_ERROR(FillProtoField(attr_slice, *field, messages, executor));
-      }
+  // Attributes are fetched together, which is faster for wide messages.
+  ASSIGN_OR_RETURN(auto attr_slices,
+                   slice.GetAttrs(attr_names, /*allow_missing=*/true));
+  for (size_t i = 0; i < attr_slices.size(); ++i) {
+    if (!attr_slices[i].IsEmpty()) {
+      RETURN_IF_ERROR(
+          FillProtoField(attr_slices[i], *fields[i], messages, executor));
     }
   }
   return absl::OkStatus();
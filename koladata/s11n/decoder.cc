@@ -15,8 +15,10 @@
 #include "arolla/serialization_base/decoder.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <numeric>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -26,6 +28,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "koladata/data_bag.h"
 #include "koladata/data_slice.h"
@@ -41,19 +44,54 @@
 #include "koladata/internal/slice_builder.h"
 #include "koladata/s11n/codec.pb.h"
 #include "koladata/s11n/codec_names.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/dense_array/edge.h"
 #include "arolla/expr/expr_node.h"
 #include "arolla/expr/expr_operator.h"
 #include "arolla/expr/quote.h"
+#include "arolla/memory/buffer.h"
 #include "arolla/qtype/qtype_traits.h"
+#include "arolla/qtype/simple_qtype.h"
 #include "arolla/qtype/typed_value.h"
 #include "arolla/serialization_base/base.pb.h"
 #include "arolla/serialization_codecs/registry.h"
 #include "arolla/util/bytes.h"
+#include "arolla/util/fingerprint.h"
 #include "arolla/util/init_arolla.h"
+#include "arolla/util/repr.h"
 #include "arolla/util/text.h"
 #include "arolla/util/unit.h"
 #include "arolla/util/status_macros_backport.h"
 
+namespace koladata::s11n {
+
+// DataBag that is being decoded from a chain of DataBagChunkProtos. It can be
+// taken over only once, by the next chunk of the chain, so the DataBag is
+// mutated only while no other decoded value can reference it.
+struct PartiallyDecodedDataBag {
+  std::shared_ptr<DataBagPtr> db;
+  // Every instance is unique.
+  arolla::Fingerprint fingerprint = arolla::RandomFingerprint();
+
+  void ArollaFingerprint(arolla::FingerprintHasher* hasher) const {
+    hasher->Combine(fingerprint);
+  }
+  arolla::ReprToken ArollaReprToken() const {
+    return {"PartiallyDecodedDataBag"};
+  }
+};
+
+}  // namespace koladata::s11n
+
+namespace arolla {
+
+AROLLA_DECLARE_SIMPLE_QTYPE(KODA_S11N_PARTIALLY_DECODED_DATA_BAG,
+                            ::koladata::s11n::PartiallyDecodedDataBag);
+AROLLA_DEFINE_SIMPLE_QTYPE(KODA_S11N_PARTIALLY_DECODED_DATA_BAG,
+                           ::koladata::s11n::PartiallyDecodedDataBag);
+
+}  // namespace arolla
+
 namespace koladata::s11n {
 namespace {
 
@@ -134,24 +172,33 @@ absl::StatusOr<ValueDecoderResult> DecodeDataItemValue(
   return TypedValue::FromValue(std::move(res));
 }
 
+// Note: it removes used values from input_values (i.e. applies subspan to the
+// span).
+absl::StatusOr<internal::DataSliceImpl> DecodeDataItemVectorProto(
+    const KodaV1Proto::DataItemVectorProto& vec_proto,
+    absl::Span<const TypedValue>& input_values) {
+  internal::SliceBuilder bldr(vec_proto.values_size());
+  for (size_t i = 0; i < vec_proto.values_size(); ++i) {
+    ASSIGN_OR_RETURN(internal::DataItem item,
+                     DecodeDataItemProto(vec_proto.values(i), input_values));
+    bldr.InsertIfNotSetAndUpdateAllocIds(i, item);
+  }
+  return std::move(bldr).Build();
+}
+
 absl::StatusOr<ValueDecoderResult> DecodeDataSliceImplValue(
     const KodaV1Proto::DataSliceImplProto& slice_proto,
     absl::Span<const TypedValue> input_values) {
   switch (slice_proto.value_case()) {
     case KodaV1Proto::DataSliceImplProto::kDataItemVector: {
-      const auto& vec_proto = slice_proto.data_item_vector();
-      internal::SliceBuilder bldr(vec_proto.values_size());
-      for (size_t i = 0; i < vec_proto.values_size(); ++i) {
-        ASSIGN_OR_RETURN(
-            internal::DataItem item,
-            DecodeDataItemProto(vec_proto.values(i), input_values));
-        bldr.InsertIfNotSetAndUpdateAllocIds(i, item);
-      }
+      ASSIGN_OR_RETURN(internal::DataSliceImpl res,
+                       DecodeDataItemVectorProto(
+                           slice_proto.data_item_vector(), input_values));
       if (!input_values.empty()) {
         return absl::InvalidArgumentError(
             "got more input_values than expected");
       }
-      return TypedValue::FromValue(std::move(bldr).Build());
+      return TypedValue::FromValue(std::move(res));
     }
     case KodaV1Proto::DataSliceImplProto::VALUE_NOT_SET:
       return absl::InvalidArgumentError("value not set");
@@ -309,6 +356,339 @@ absl::StatusOr<ValueDecoderResult> DecodeDataBagValue(
   return TypedValue::FromValue(std::move(db));
 }
 
+// Note: it removes used values from input_values (i.e. applies subspan to the
+// span).
+absl::StatusOr<internal::DataSliceImpl> DecodeCompactColumnProto(
+    const KodaV1Proto::CompactColumnProto& column_proto,
+    absl::Span<const TypedValue>& input_values) {
+  const int64_t size = column_proto.size();
+  if (size < 0) {
+    return absl::InvalidArgumentError("negative CompactColumnProto.size");
+  }
+  std::vector<int64_t> present_ids;
+  if (column_proto.presence_runs().empty()) {
+    present_ids.resize(size);
+    std::iota(present_ids.begin(), present_ids.end(), 0);
+  } else {
+    int64_t offset = 0;
+    bool present = true;
+    for (int64_t run : column_proto.presence_runs()) {
+      if (run < 0 || offset + run > size) {
+        return absl::InvalidArgumentError(
+            "invalid CompactColumnProto.presence_runs");
+      }
+      if (present) {
+        for (int64_t i = offset; i < offset + run; ++i) {
+          present_ids.push_back(i);
+        }
+      }
+      offset += run;
+      present = !present;
+    }
+    if (offset != size) {
+      return absl::InvalidArgumentError(
+          "CompactColumnProto.presence_runs don't match the size");
+    }
+  }
+  auto check_values_count = [&](int64_t count) -> absl::Status {
+    if (count != present_ids.size()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "CompactColumnProto has %d present items, but %d values",
+          present_ids.size(), count));
+    }
+    return absl::OkStatus();
+  };
+  if (present_ids.empty() && column_proto.values_case() !=
+                                 KodaV1Proto::CompactColumnProto::kItems) {
+    return internal::DataSliceImpl::CreateEmptyAndUnknownType(size);
+  }
+  switch (column_proto.values_case()) {
+    case KodaV1Proto::CompactColumnProto::kObjectOffsets: {
+      const auto& offsets_proto = column_proto.object_offsets();
+      RETURN_IF_ERROR(check_values_count(offsets_proto.offset_deltas_size()));
+      internal::AllocationId alloc(
+          DecodeObjectId(offsets_proto.alloc_first_id()));
+      if (alloc.IsSmall()) {
+        return absl::InvalidArgumentError(
+            "ObjectIdOffsetsProto can not refer to a small allocation");
+      }
+      arolla::DenseArrayBuilder<internal::ObjectId> bldr(size);
+      int64_t offset = 0;
+      for (int64_t i = 0; i < present_ids.size(); ++i) {
+        offset += offsets_proto.offset_deltas(i);
+        if (offset < 0 || offset >= alloc.Capacity()) {
+          return absl::InvalidArgumentError(
+              "ObjectIdOffsetsProto offset is out of the allocation");
+        }
+        bldr.Set(present_ids[i], alloc.ObjectByOffset(offset));
+      }
+      return internal::DataSliceImpl::CreateWithAllocIds(
+          internal::AllocationIdSet(alloc), std::move(bldr).Build());
+    }
+    case KodaV1Proto::CompactColumnProto::kDictStrings: {
+      const auto& strings_proto = column_proto.dict_strings();
+      RETURN_IF_ERROR(check_values_count(strings_proto.indices_size()));
+      auto decode = [&]<typename T>(std::type_identity<T>)
+          -> absl::StatusOr<internal::DataSliceImpl> {
+        arolla::DenseArrayBuilder<T> bldr(size);
+        for (int64_t i = 0; i < present_ids.size(); ++i) {
+          int32_t index = strings_proto.indices(i);
+          if (index < 0 || index >= strings_proto.dictionary_size()) {
+            return absl::InvalidArgumentError(
+                "DictStringsProto index is out of range");
+          }
+          bldr.Add(present_ids[i],
+                   absl::string_view(strings_proto.dictionary(index)));
+        }
+        return internal::DataSliceImpl::Create(std::move(bldr).Build());
+      };
+      if (strings_proto.is_text()) {
+        return decode(std::type_identity<arolla::Text>());
+      } else {
+        return decode(std::type_identity<arolla::Bytes>());
+      }
+    }
+    case KodaV1Proto::CompactColumnProto::kItems: {
+      const auto& items_proto = column_proto.items();
+      RETURN_IF_ERROR(check_values_count(items_proto.values_size()));
+      internal::SliceBuilder bldr(size);
+      for (int64_t i = 0; i < present_ids.size(); ++i) {
+        ASSIGN_OR_RETURN(
+            internal::DataItem item,
+            DecodeDataItemProto(items_proto.values(i), input_values));
+        bldr.InsertIfNotSetAndUpdateAllocIds(present_ids[i], item);
+      }
+      return std::move(bldr).Build();
+    }
+    case KodaV1Proto::CompactColumnProto::VALUES_NOT_SET:
+      return absl::InvalidArgumentError("CompactColumnProto values not set");
+  }
+  ABSL_UNREACHABLE();
+}
+
+// Decodes `compact_values` if present and `values` otherwise.
+// Note: it removes used values from input_values (i.e. applies subspan to the
+// span).
+absl::StatusOr<internal::DataSliceImpl> DecodeColumn(
+    bool has_compact_values,
+    const KodaV1Proto::CompactColumnProto& compact_values,
+    const KodaV1Proto::DataItemVectorProto& values,
+    absl::Span<const TypedValue>& input_values) {
+  if (has_compact_values) {
+    return DecodeCompactColumnProto(compact_values, input_values);
+  }
+  return DecodeDataItemVectorProto(values, input_values);
+}
+
+// Returns `size` sequential objects starting from `first`.
+absl::StatusOr<internal::DataSliceImpl> ObjectsRange(internal::ObjectId first,
+                                                     int64_t size) {
+  internal::AllocationId alloc(first);
+  if (alloc.IsSmall() || first.Offset() + size > alloc.Capacity()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "range of %d objects starting at offset %d doesn't fit into "
+        "the allocation",
+        size, first.Offset()));
+  }
+  arolla::Buffer<internal::ObjectId>::Builder bldr(size);
+  for (int64_t i = 0; i < size; ++i) {
+    bldr.Set(i, alloc.ObjectByOffset(first.Offset() + i));
+  }
+  return internal::DataSliceImpl::CreateObjectsDataSlice(
+      internal::ObjectIdArray{std::move(bldr).Build()},
+      internal::AllocationIdSet(alloc));
+}
+
+absl::Status DecodeAttrRangeChunk(
+    const KodaV1Proto::DataBagChunkProto::AttrRangeProto& range_proto,
+    absl::Span<const TypedValue>& input_values, internal::DataBagImpl& db) {
+  ASSIGN_OR_RETURN(
+      internal::DataSliceImpl values,
+      DecodeColumn(range_proto.has_compact_values(),
+                   range_proto.compact_values(), range_proto.values(),
+                   input_values));
+  internal::ObjectId first = DecodeObjectId(range_proto.first_object_id());
+  ASSIGN_OR_RETURN(internal::DataSliceImpl objects,
+                   ObjectsRange(first, values.size()));
+  if (range_proto.alloc_values_size() > values.size()) {
+    // The attribute is split into several chunks. Reserve dense storage to
+    // avoid creating a sparse source for the first chunks.
+    RETURN_IF_ERROR(db.ReserveAttrForAllocation(
+        internal::AllocationId(first), range_proto.name(),
+        values.dtype() == arolla::GetNothingQType() ? nullptr
+                                                    : values.dtype()));
+  }
+  return db.SetAttr(objects, range_proto.name(), values);
+}
+
+absl::Status DecodeAttrItemsChunk(
+    const KodaV1Proto::DataBagChunkProto::AttrItemsProto& items_proto,
+    absl::Span<const TypedValue>& input_values, internal::DataBagImpl& db) {
+  ASSIGN_OR_RETURN(
+      internal::DataSliceImpl values,
+      DecodeDataItemVectorProto(items_proto.values(), input_values));
+  if (values.size() != items_proto.object_ids_size()) {
+    return absl::InvalidArgumentError(
+        "AttrItemsProto.object_ids and AttrItemsProto.values have different "
+        "sizes");
+  }
+  for (int64_t i = 0; i < values.size(); ++i) {
+    RETURN_IF_ERROR(db.SetAttr(
+        internal::DataItem(DecodeObjectId(items_proto.object_ids(i))),
+        items_proto.name(), values[i]));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status DecodeListsChunk(
+    const KodaV1Proto::DataBagChunkProto::ListsProto& lists_proto,
+    absl::Span<const TypedValue>& input_values, internal::DataBagImpl& db) {
+  ASSIGN_OR_RETURN(
+      internal::DataSliceImpl values,
+      DecodeColumn(lists_proto.has_compact_values(),
+                   lists_proto.compact_values(), lists_proto.values(),
+                   input_values));
+  ASSIGN_OR_RETURN(internal::DataSliceImpl lists,
+                   ObjectsRange(DecodeObjectId(lists_proto.first_list_id()),
+                                lists_proto.sizes_size()));
+  arolla::Buffer<int64_t>::Builder splits_bldr(lists_proto.sizes_size() + 1);
+  int64_t total_size = 0;
+  splits_bldr.Set(0, 0);
+  for (int64_t i = 0; i < lists_proto.sizes_size(); ++i) {
+    if (lists_proto.sizes(i) < 0) {
+      return absl::InvalidArgumentError("negative list size");
+    }
+    total_size += lists_proto.sizes(i);
+    splits_bldr.Set(i + 1, total_size);
+  }
+  if (total_size != values.size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "sum of list sizes (%d) doesn't match the number of values (%d)",
+        total_size, values.size()));
+  }
+  ASSIGN_OR_RETURN(auto edge,
+                   arolla::DenseArrayEdge::FromSplitPoints(
+                       arolla::DenseArray<int64_t>{
+                           std::move(splits_bldr).Build()}));
+  return db.ExtendLists(lists, values, edge);
+}
+
+absl::Status DecodeDictsChunk(
+    const KodaV1Proto::DataBagChunkProto::DictsProto& dicts_proto,
+    absl::Span<const TypedValue>& input_values, internal::DataBagImpl& db) {
+  ASSIGN_OR_RETURN(
+      internal::DataSliceImpl keys,
+      DecodeColumn(dicts_proto.has_compact_keys(), dicts_proto.compact_keys(),
+                   dicts_proto.keys(), input_values));
+  ASSIGN_OR_RETURN(
+      internal::DataSliceImpl values,
+      DecodeColumn(dicts_proto.has_compact_values(),
+                   dicts_proto.compact_values(), dicts_proto.values(),
+                   input_values));
+  if (keys.size() != values.size() ||
+      dicts_proto.dict_ids_size() != dicts_proto.sizes_size()) {
+    return absl::InvalidArgumentError("inconsistent sizes in DictsProto");
+  }
+  internal::SliceBuilder dicts_bldr(keys.size());
+  int64_t offset = 0;
+  for (int64_t i = 0; i < dicts_proto.dict_ids_size(); ++i) {
+    internal::ObjectId dict_id = DecodeObjectId(dicts_proto.dict_ids(i));
+    int64_t size = dicts_proto.sizes(i);
+    if (size < 0 || offset + size > keys.size()) {
+      return absl::InvalidArgumentError("invalid dict size in DictsProto");
+    }
+    if (dict_id.IsSchema()) {
+      internal::DataItem schema(dict_id);
+      for (int64_t j = offset; j < offset + size; ++j) {
+        if (!keys[j].holds_value<arolla::Text>()) {
+          return absl::InvalidArgumentError("schema key must be arolla::Text");
+        }
+        RETURN_IF_ERROR(db.SetSchemaAttr(
+            schema, keys[j].value<arolla::Text>(), values[j]));
+      }
+    } else {
+      for (int64_t j = offset; j < offset + size; ++j) {
+        dicts_bldr.InsertIfNotSetAndUpdateAllocIds(j,
+                                                   internal::DataItem(dict_id));
+      }
+    }
+    offset += size;
+  }
+  if (offset != keys.size()) {
+    return absl::InvalidArgumentError(
+        "sum of dict sizes doesn't match the number of keys in DictsProto");
+  }
+  // Keys of schemas are left unset in `dicts`, so SetInDict skips them.
+  return db.SetInDict(std::move(dicts_bldr).Build(), keys, values);
+}
+
+// Returns the DataBag to apply the next chunk to. `input_value` is either the
+// empty DataBag that starts the chain, or the previous chunk.
+absl::StatusOr<DataBagPtr> TakeOverChunkedDataBag(
+    const TypedValue& input_value) {
+  if (input_value.GetType() == arolla::GetQType<DataBagPtr>()) {
+    ASSIGN_OR_RETURN(DataBagPtr first_db, input_value.As<DataBagPtr>());
+    if (!first_db->GetFallbacks().empty() ||
+        !first_db->GetImpl().IsPristine()) {
+      return absl::InvalidArgumentError(
+          "the first DataBagChunkProto must reference an empty DataBag");
+    }
+    // The empty DataBag can already be referenced by other decoded values, so
+    // the content is decoded into a new one.
+    return DataBag::Empty();
+  }
+  ASSIGN_OR_RETURN(PartiallyDecodedDataBag partial,
+                   input_value.As<PartiallyDecodedDataBag>());
+  DataBagPtr db = std::exchange(*partial.db, nullptr);
+  if (db == nullptr) {
+    return absl::InvalidArgumentError(
+        "DataBagChunkProto is referenced by more than one chunk");
+  }
+  return db;
+}
+
+// ValueProto.input_value_indices[0]: empty DataBag or the previous chunk
+// ValueProto.input_value_indices[1:]: ExprQuotes used in the chunk
+absl::StatusOr<ValueDecoderResult> DecodeDataBagChunkValue(
+    const KodaV1Proto::DataBagChunkProto& chunk_proto,
+    absl::Span<const TypedValue> input_values) {
+  if (input_values.empty()) {
+    return absl::InvalidArgumentError(
+        "required input_value_index pointing to DataBag");
+  }
+  ASSIGN_OR_RETURN(DataBagPtr db, TakeOverChunkedDataBag(input_values[0]));
+  input_values = input_values.subspan(1);
+  ASSIGN_OR_RETURN(internal::DataBagImpl & impl, db->GetMutableImpl());
+  switch (chunk_proto.value_case()) {
+    case KodaV1Proto::DataBagChunkProto::kAttrRange:
+      RETURN_IF_ERROR(
+          DecodeAttrRangeChunk(chunk_proto.attr_range(), input_values, impl));
+      break;
+    case KodaV1Proto::DataBagChunkProto::kAttrItems:
+      RETURN_IF_ERROR(
+          DecodeAttrItemsChunk(chunk_proto.attr_items(), input_values, impl));
+      break;
+    case KodaV1Proto::DataBagChunkProto::kLists:
+      RETURN_IF_ERROR(
+          DecodeListsChunk(chunk_proto.lists(), input_values, impl));
+      break;
+    case KodaV1Proto::DataBagChunkProto::kDicts:
+      RETURN_IF_ERROR(
+          DecodeDictsChunk(chunk_proto.dicts(), input_values, impl));
+      break;
+    case KodaV1Proto::DataBagChunkProto::VALUE_NOT_SET:
+      return absl::InvalidArgumentError("value not set");
+  }
+  if (!input_values.empty()) {
+    return absl::InvalidArgumentError("got more input_values than expected");
+  }
+  if (chunk_proto.is_last()) {
+    return TypedValue::FromValue(std::move(db));
+  }
+  return TypedValue::FromValue(PartiallyDecodedDataBag{
+      .db = std::make_shared<DataBagPtr>(std::move(db))});
+}
+
 absl::StatusOr<ValueDecoderResult> DecodeKodaValue(
     const ValueProto& value_proto, absl::Span<const TypedValue> input_values,
     absl::Span<const arolla::expr::ExprNodePtr> /* input_exprs*/) {
@@ -337,6 +717,9 @@ absl::StatusOr<ValueDecoderResult> DecodeKodaValue(
       return DecodeDataSliceValue(input_values);
     case KodaV1Proto::kDataBagValue:
       return DecodeDataBagValue(koda_proto.data_bag_value(), input_values);
+    case KodaV1Proto::kDataBagChunkValue:
+      return DecodeDataBagChunkValue(koda_proto.data_bag_chunk_value(),
+                                     input_values);
     case KodaV1Proto::kNonDeterministicTokenQtype:
       return TypedValue::FromValue(
           arolla::GetQType<internal::NonDeterministicToken>());
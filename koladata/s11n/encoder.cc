@@ -14,14 +14,22 @@
 //
 #include "arolla/serialization_base/encoder.h"
 
+#include <algorithm>
 #include <cstdint>
-#include <string>
+#include <memory>
+#include <optional>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
+#include "absl/base/optimization.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "koladata/data_bag.h"
 #include "koladata/data_slice.h"
@@ -35,7 +43,6 @@
 #include "koladata/internal/missing_value.h"
 #include "koladata/internal/non_deterministic_token.h"
 #include "koladata/internal/object_id.h"
-#include "koladata/internal/slice_builder.h"
 #include "koladata/s11n/codec.pb.h"
 #include "koladata/s11n/codec_names.h"
 #include "arolla/dense_array/dense_array.h"
@@ -45,17 +52,46 @@
 #include "arolla/jagged_shape/dense_array/qtype/qtype.h"
 #include "arolla/qtype/qtype.h"
 #include "arolla/qtype/qtype_traits.h"
+#include "arolla/qtype/simple_qtype.h"
 #include "arolla/qtype/typed_ref.h"
 #include "arolla/qtype/typed_value.h"
 #include "arolla/serialization_base/base.pb.h"
 #include "arolla/serialization_codecs/registry.h"
 #include "arolla/util/bytes.h"
 #include "arolla/util/fast_dynamic_downcast_final.h"
+#include "arolla/util/fingerprint.h"
 #include "arolla/util/init_arolla.h"
+#include "arolla/util/repr.h"
 #include "arolla/util/text.h"
 #include "arolla/util/unit.h"
 #include "arolla/util/status_macros_backport.h"
 
+namespace koladata::s11n {
+
+// ValueProto that is already built and only needs to be emitted. Allows a value
+// encoder to emit several decoding steps for a single value.
+struct PrebuiltValueProto {
+  std::shared_ptr<arolla::serialization_base::ValueProto> proto;
+  // Every instance is unique, so it must not be deduplicated by the encoder.
+  arolla::Fingerprint fingerprint = arolla::RandomFingerprint();
+
+  void ArollaFingerprint(arolla::FingerprintHasher* hasher) const {
+    hasher->Combine(fingerprint);
+  }
+  arolla::ReprToken ArollaReprToken() const { return {"PrebuiltValueProto"}; }
+};
+
+}  // namespace koladata::s11n
+
+namespace arolla {
+
+AROLLA_DECLARE_SIMPLE_QTYPE(KODA_S11N_PREBUILT_VALUE_PROTO,
+                            ::koladata::s11n::PrebuiltValueProto);
+AROLLA_DEFINE_SIMPLE_QTYPE(KODA_S11N_PREBUILT_VALUE_PROTO,
+                           ::koladata::s11n::PrebuiltValueProto);
+
+}  // namespace arolla
+
 namespace koladata::s11n {
 namespace {
 
@@ -65,6 +101,10 @@ using ::arolla::serialization_codecs::RegisterValueEncoderByQType;
 using ::arolla::serialization_codecs::
     RegisterValueEncoderByQValueSpecialisationKey;
 
+// Maximal number of values in a single DataBagChunkProto. A chunk can be
+// bigger only if a single list contains more values.
+constexpr int64_t kMaxDataBagChunkSize = 1 << 16;
+
 absl::StatusOr<ValueProto> GenValueProto(Encoder& encoder) {
   ASSIGN_OR_RETURN(auto codec_index, encoder.EncodeCodec(kKodaV1Codec));
   ValueProto value_proto;
@@ -180,78 +220,410 @@ absl::StatusOr<ValueProto> EncodeNonDeterministic(arolla::TypedRef value,
   return value_proto;
 }
 
+absl::Status FillItemProto(Encoder& encoder, ValueProto& value_proto,
+                           KodaV1Proto::DataItemProto& item_proto,
+                           const internal::DataItem& item) {
+  return item.VisitValue([&]<typename T>(const T& v) -> absl::Status {
+    if constexpr (std::is_same_v<T, internal::MissingValue>) {
+      item_proto.set_missing(true);
+    } else if constexpr (std::is_same_v<T, internal::ObjectId>) {
+      auto* id_proto = item_proto.mutable_object_id();
+      id_proto->set_hi(v.InternalHigh64());
+      id_proto->set_lo(v.InternalLow64());
+    } else if constexpr (std::is_same_v<T, int32_t>) {
+      item_proto.set_i32(v);
+    } else if constexpr (std::is_same_v<T, int64_t>) {
+      item_proto.set_i64(v);
+    } else if constexpr (std::is_same_v<T, float>) {
+      item_proto.set_f32(v);
+    } else if constexpr (std::is_same_v<T, double>) {
+      item_proto.set_f64(v);
+    } else if constexpr (std::is_same_v<T, bool>) {
+      item_proto.set_boolean(v);
+    } else if constexpr (std::is_same_v<T, arolla::Unit>) {
+      item_proto.set_unit(true);
+    } else if constexpr (std::is_same_v<T, arolla::Text>) {
+      item_proto.set_text(v.view());
+    } else if constexpr (std::is_same_v<T, arolla::Bytes>) {
+      item_proto.set_bytes_(v);
+    } else if constexpr (std::is_same_v<T, schema::DType>) {
+      item_proto.set_dtype(v.type_id());
+    } else if constexpr (std::is_same_v<T, arolla::expr::ExprQuote>) {
+      item_proto.set_expr_quote(true);
+      ASSIGN_OR_RETURN(auto index,
+                       encoder.EncodeValue(arolla::TypedValue::FromValue(v)));
+      value_proto.add_input_value_indices(index);
+    } else {
+      static_assert(false);
+    }
+    return absl::OkStatus();
+  });
+}
+
+absl::Status FillItemVectorProto(
+    Encoder& encoder, ValueProto& value_proto,
+    KodaV1Proto::DataItemVectorProto& vector_proto,
+    const internal::DataSliceImpl& slice, int64_t begin, int64_t end) {
+  for (int64_t i = begin; i < end; ++i) {
+    RETURN_IF_ERROR(FillItemProto(encoder, value_proto,
+                                  *vector_proto.add_values(), slice[i]));
+  }
+  return absl::OkStatus();
+}
+
 void EncodeObjectId(internal::ObjectId id, KodaV1Proto::ObjectIdProto* proto) {
   proto->set_hi(id.InternalHigh64());
   proto->set_lo(id.InternalLow64());
 }
 
-absl::Status EncodeAttribute(const std::string& attr_name,
-                             const internal::DataBagContent::AttrContent& data,
-                             KodaV1Proto::AttrProto& attr_proto,
-                             ValueProto& value_proto, Encoder& encoder) {
-  attr_proto.set_name(attr_name);
-  for (const internal::DataBagContent::AttrItemContent& ic : data.items) {
-    KodaV1Proto::AttrChunkProto* chunk_proto = attr_proto.add_chunks();
-    EncodeObjectId(ic.object_id, chunk_proto->mutable_first_object_id());
+// Number of bytes of `v` encoded as varint.
+int64_t VarintSize(uint64_t v) {
+  int64_t size = 1;
+  for (; v >= 128; v >>= 7) {
+    ++size;
+  }
+  return size;
+}
+
+uint64_t ZigZag(int64_t v) {
+  return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+// Approximate size of a DataItemProto in DataItemVectorProto excluding
+// the payload: tag and length of the DataItemProto and the tag of the value.
+constexpr int64_t kItemProtoOverhead = 3;
+// Approximate size of an ObjectIdProto payload (two 64-bit varints with tags).
+constexpr int64_t kObjectIdProtoSize = 2 + 2 * 10;
+
+// Representation of a column of values chosen by EncodeColumn.
+enum class ColumnEncoding {
+  kPlain,
+  kObjectOffsets,
+  kDictStrings,
+  kCompactItems,
+};
+
+// Chooses the encoding for values [begin, end) of `slice` by estimating
+// the encoded size of each applicable representation.
+// `presence_runs` is filled with the run-length encoded presence
+// (see CompactColumnProto.presence_runs) if the column has missing values.
+ColumnEncoding ChooseColumnEncoding(const internal::DataSliceImpl& slice,
+                                    int64_t begin, int64_t end,
+                                    std::vector<int64_t>& presence_runs) {
+  if (begin == end || slice.is_empty_and_unknown()) {
+    return ColumnEncoding::kPlain;
+  }
+  int64_t missing_count = 0;
+  bool cur_present = true;
+  int64_t run = 0;
+  for (int64_t i = begin; i < end; ++i) {
+    bool present = slice.present(i);
+    if (present != cur_present) {
+      presence_runs.push_back(run);
+      cur_present = present;
+      run = 0;
+    }
+    ++run;
+    missing_count += !present;
+  }
+  presence_runs.push_back(run);
+  if (missing_count == 0) {
+    presence_runs.clear();
+  }
+  int64_t presence_cost = 0;
+  for (int64_t r : presence_runs) {
+    presence_cost += VarintSize(r);
+  }
+  const int64_t present_count = end - begin - missing_count;
+
+  // Plain representation stores `missing: true` for every missing value.
+  const int64_t plain_missing_cost = missing_count * (kItemProtoOverhead + 1);
+
+  if (slice.dtype() == arolla::GetQType<internal::ObjectId>()) {
+    const auto& ids = slice.values<internal::ObjectId>();
+    std::optional<internal::AllocationId> alloc;
+    int64_t offsets_cost = kObjectIdProtoSize;
+    int64_t prev_offset = 0;
+    bool single_alloc = true;
+    for (int64_t i = begin; i < end && single_alloc; ++i) {
+      if (!ids.present(i)) {
+        continue;
+      }
+      internal::ObjectId id = ids.values[i];
+      if (!alloc.has_value()) {
+        alloc = internal::AllocationId(id);
+        single_alloc = !alloc->IsSmall();
+      } else {
+        single_alloc = alloc->Contains(id);
+      }
+      offsets_cost += VarintSize(ZigZag(id.Offset() - prev_offset));
+      prev_offset = id.Offset();
+    }
+    const int64_t plain_values_cost =
+        present_count * (kItemProtoOverhead + kObjectIdProtoSize);
+    if (single_alloc && presence_cost + offsets_cost <
+                            plain_missing_cost + plain_values_cost) {
+      return ColumnEncoding::kObjectOffsets;
+    }
+  } else if (slice.dtype() == arolla::GetQType<arolla::Text>() ||
+             slice.dtype() == arolla::GetQType<arolla::Bytes>()) {
+    int64_t plain_values_cost = 0;
+    int64_t dict_cost = 0;
+    auto estimate = [&]<typename T>(const arolla::DenseArray<T>& strings) {
+      absl::flat_hash_set<absl::string_view> dictionary;
+      for (int64_t i = begin; i < end; ++i) {
+        if (!strings.present(i)) {
+          continue;
+        }
+        absl::string_view str = strings.values[i];
+        int64_t str_cost = VarintSize(str.size()) + str.size();
+        plain_values_cost += kItemProtoOverhead + str_cost;
+        if (dictionary.insert(str).second) {
+          dict_cost += 1 + str_cost;
+        }
+        dict_cost += VarintSize(dictionary.size());
+      }
+    };
+    if (slice.dtype() == arolla::GetQType<arolla::Text>()) {
+      estimate(slice.values<arolla::Text>());
+    } else {
+      estimate(slice.values<arolla::Bytes>());
+    }
+    if (presence_cost + dict_cost < plain_missing_cost + plain_values_cost) {
+      return ColumnEncoding::kDictStrings;
+    }
+  }
+  // Only the presence can be compacted.
+  if (missing_count > 0 && presence_cost < plain_missing_cost) {
+    return ColumnEncoding::kCompactItems;
+  }
+  return ColumnEncoding::kPlain;
+}
+
+// Encodes values [begin, end) of `slice` either as DataItemVectorProto
+// (returned by `mutable_plain()`) or as CompactColumnProto (returned by
+// `mutable_compact()`), whichever is estimated to be smaller.
+template <class MutablePlainFn, class MutableCompactFn>
+absl::Status EncodeColumn(Encoder& encoder, ValueProto& value_proto,
+                          const internal::DataSliceImpl& slice, int64_t begin,
+                          int64_t end, MutablePlainFn mutable_plain,
+                          MutableCompactFn mutable_compact) {
+  std::vector<int64_t> presence_runs;
+  ColumnEncoding encoding =
+      ChooseColumnEncoding(slice, begin, end, presence_runs);
+  if (encoding == ColumnEncoding::kPlain) {
+    return FillItemVectorProto(encoder, value_proto, *mutable_plain(), slice,
+                               begin, end);
+  }
+  KodaV1Proto::CompactColumnProto& compact = *mutable_compact();
+  compact.set_size(end - begin);
+  compact.mutable_presence_runs()->Assign(presence_runs.begin(),
+                                          presence_runs.end());
+  switch (encoding) {
+    case ColumnEncoding::kObjectOffsets: {
+      auto* offsets_proto = compact.mutable_object_offsets();
+      const auto& ids = slice.values<internal::ObjectId>();
+      int64_t prev_offset = 0;
+      for (int64_t i = begin; i < end; ++i) {
+        if (!ids.present(i)) {
+          continue;
+        }
+        internal::ObjectId id = ids.values[i];
+        if (!offsets_proto->has_alloc_first_id()) {
+          EncodeObjectId(internal::AllocationId(id).ObjectByOffset(0),
+                         offsets_proto->mutable_alloc_first_id());
+        }
+        offsets_proto->add_offset_deltas(id.Offset() - prev_offset);
+        prev_offset = id.Offset();
+      }
+      return absl::OkStatus();
+    }
+    case ColumnEncoding::kDictStrings: {
+      auto* strings_proto = compact.mutable_dict_strings();
+      auto encode = [&]<typename T>(const arolla::DenseArray<T>& strings) {
+        strings_proto->set_is_text(std::is_same_v<T, arolla::Text>);
+        absl::flat_hash_map<absl::string_view, int32_t> dictionary;
+        for (int64_t i = begin; i < end; ++i) {
+          if (!strings.present(i)) {
+            continue;
+          }
+          absl::string_view str = strings.values[i];
+          auto [it, inserted] = dictionary.emplace(str, dictionary.size());
+          if (inserted) {
+            strings_proto->add_dictionary(str);
+          }
+          strings_proto->add_indices(it->second);
+        }
+      };
+      if (slice.dtype() == arolla::GetQType<arolla::Text>()) {
+        encode(slice.values<arolla::Text>());
+      } else {
+        encode(slice.values<arolla::Bytes>());
+      }
+      return absl::OkStatus();
+    }
+    case ColumnEncoding::kCompactItems: {
+      auto* items_proto = compact.mutable_items();
+      for (int64_t i = begin; i < end; ++i) {
+        if (slice.present(i)) {
+          RETURN_IF_ERROR(FillItemProto(encoder, value_proto,
+                                        *items_proto->add_values(), slice[i]));
+        }
+      }
+      return absl::OkStatus();
+    }
+    case ColumnEncoding::kPlain:
+      break;
+  }
+  ABSL_UNREACHABLE();
+}
+
+// Emits a DataBag as a chain of decoding steps: an empty DataBag followed by
+// DataBagChunkProtos, each of them referencing the previous step. Only the
+// last step is returned from the DataBag encoder; the others are emitted via
+// `Encoder::EncodeValue` wrapped into PrebuiltValueProto.
+class DataBagChunkEmitter {
+ public:
+  explicit DataBagChunkEmitter(Encoder& encoder) : encoder_(encoder) {}
+
+  absl::Status Init() {
+    ASSIGN_OR_RETURN(ValueProto value_proto, GenValueProto(encoder_));
+    value_proto.MutableExtension(KodaV1Proto::extension)
+        ->mutable_data_bag_value();
+    pending_ = std::move(value_proto);
+    return absl::OkStatus();
+  }
+
+  // Emits the pending step and starts a new chunk. The returned references are
+  // valid until the next call.
+  absl::StatusOr<std::pair<ValueProto*, KodaV1Proto::DataBagChunkProto*>>
+  NewChunk() {
     ASSIGN_OR_RETURN(
-        auto value_index,
-        encoder.EncodeValue(arolla::TypedValue::FromValue(ic.value)));
-    chunk_proto->set_values_subindex(value_proto.input_value_indices_size());
-    value_proto.add_input_value_indices(value_index);
+        uint64_t prev_index,
+        encoder_.EncodeValue(arolla::TypedValue::FromValue(PrebuiltValueProto{
+            std::make_shared<ValueProto>(std::move(pending_))})));
+    ASSIGN_OR_RETURN(pending_, GenValueProto(encoder_));
+    pending_.add_input_value_indices(prev_index);
+    return std::make_pair(&pending_,
+                          pending_.MutableExtension(KodaV1Proto::extension)
+                              ->mutable_data_bag_chunk_value());
+  }
+
+  ValueProto Finish() && {
+    auto* koda_proto = pending_.MutableExtension(KodaV1Proto::extension);
+    if (koda_proto->has_data_bag_chunk_value()) {
+      koda_proto->mutable_data_bag_chunk_value()->set_is_last(true);
+    }
+    return std::move(pending_);
+  }
+
+ private:
+  Encoder& encoder_;
+  ValueProto pending_;
+};
+
+absl::Status EncodeAttrChunks(absl::string_view attr_name,
+                              const internal::DataBagContent::AttrContent& data,
+                              DataBagChunkEmitter& emitter, Encoder& encoder) {
+  for (int64_t begin = 0; begin < data.items.size();
+       begin += kMaxDataBagChunkSize) {
+    int64_t end = std::min<int64_t>(begin + kMaxDataBagChunkSize,
+                                    data.items.size());
+    ASSIGN_OR_RETURN((auto [value_proto, chunk_proto]), emitter.NewChunk());
+    auto* items_proto = chunk_proto->mutable_attr_items();
+    items_proto->set_name(attr_name);
+    auto* values_proto = items_proto->mutable_values();
+    for (int64_t i = begin; i < end; ++i) {
+      EncodeObjectId(data.items[i].object_id, items_proto->add_object_ids());
+      RETURN_IF_ERROR(FillItemProto(encoder, *value_proto,
+                                    *values_proto->add_values(),
+                                    data.items[i].value));
+    }
   }
   for (const internal::DataBagContent::AttrAllocContent& ac : data.allocs) {
-    KodaV1Proto::AttrChunkProto* chunk_proto = attr_proto.add_chunks();
-    EncodeObjectId(ac.alloc_id.ObjectByOffset(0),
-                   chunk_proto->mutable_first_object_id());
-    ASSIGN_OR_RETURN(
-        auto values_index,
-        encoder.EncodeValue(arolla::TypedValue::FromValue(ac.values)));
-    chunk_proto->set_values_subindex(value_proto.input_value_indices_size());
-    value_proto.add_input_value_indices(values_index);
+    const int64_t size = ac.values.size();
+    for (int64_t begin = 0; begin < size; begin += kMaxDataBagChunkSize) {
+      int64_t end = std::min<int64_t>(begin + kMaxDataBagChunkSize, size);
+      ASSIGN_OR_RETURN((auto [value_proto, chunk_proto]), emitter.NewChunk());
+      auto* range_proto = chunk_proto->mutable_attr_range();
+      range_proto->set_name(attr_name);
+      EncodeObjectId(ac.alloc_id.ObjectByOffset(begin),
+                     range_proto->mutable_first_object_id());
+      range_proto->set_alloc_values_size(size);
+      RETURN_IF_ERROR(EncodeColumn(
+          encoder, *value_proto, ac.values, begin, end,
+          [&] { return range_proto->mutable_values(); },
+          [&] { return range_proto->mutable_compact_values(); }));
+    }
   }
   return absl::OkStatus();
 }
 
-absl::Status EncodeDict(const internal::DataBagContent::DictContent& data,
-                        KodaV1Proto::DictProto& dict_proto,
-                        ValueProto& value_proto, Encoder& encoder) {
-  EncodeObjectId(data.dict_id, dict_proto.mutable_dict_id());
-  ASSIGN_OR_RETURN(auto keys_index,
-                   encoder.EncodeValue(arolla::TypedValue::FromValue(
-                       internal::DataSliceImpl::Create(data.keys))));
-  ASSIGN_OR_RETURN(auto values_index,
-                   encoder.EncodeValue(arolla::TypedValue::FromValue(
-                       internal::DataSliceImpl::Create(data.values))));
-  dict_proto.set_keys_subindex(value_proto.input_value_indices_size());
-  dict_proto.set_values_subindex(value_proto.input_value_indices_size() + 1);
-  value_proto.add_input_value_indices(keys_index);
-  value_proto.add_input_value_indices(values_index);
+// Groups dicts into chunks with up to kMaxDataBagChunkSize keys (but at least
+// one dict per chunk).
+absl::Status EncodeDictChunks(
+    absl::Span<const internal::DataBagContent::DictContent> dicts,
+    DataBagChunkEmitter& emitter, Encoder& encoder) {
+  int64_t begin = 0;
+  while (begin < dicts.size()) {
+    int64_t end = begin;
+    std::vector<internal::DataItem> keys;
+    std::vector<internal::DataItem> values;
+    ASSIGN_OR_RETURN((auto [value_proto, chunk_proto]), emitter.NewChunk());
+    auto* dicts_proto = chunk_proto->mutable_dicts();
+    do {
+      const internal::DataBagContent::DictContent& d = dicts[end++];
+      EncodeObjectId(d.dict_id, dicts_proto->add_dict_ids());
+      dicts_proto->add_sizes(d.keys.size());
+      keys.insert(keys.end(), d.keys.begin(), d.keys.end());
+      values.insert(values.end(), d.values.begin(), d.values.end());
+    } while (end < dicts.size() &&
+             keys.size() + dicts[end].keys.size() <= kMaxDataBagChunkSize);
+    auto keys_slice = internal::DataSliceImpl::Create(keys);
+    auto values_slice = internal::DataSliceImpl::Create(values);
+    RETURN_IF_ERROR(EncodeColumn(
+        encoder, *value_proto, keys_slice, 0, keys_slice.size(),
+        [&] { return dicts_proto->mutable_keys(); },
+        [&] { return dicts_proto->mutable_compact_keys(); }));
+    RETURN_IF_ERROR(EncodeColumn(
+        encoder, *value_proto, values_slice, 0, values_slice.size(),
+        [&] { return dicts_proto->mutable_values(); },
+        [&] { return dicts_proto->mutable_compact_values(); }));
+    begin = end;
+  }
   return absl::OkStatus();
 }
 
-absl::Status EncodeLists(const internal::DataBagContent::ListsContent& lists,
-                         KodaV1Proto::DataBagProto& db_proto,
-                         ValueProto& value_proto, Encoder& encoder) {
+// Groups lists into chunks with up to kMaxDataBagChunkSize values (but at least
+// one list per chunk).
+absl::Status EncodeListChunks(
+    const internal::DataBagContent::ListsContent& lists,
+    DataBagChunkEmitter& emitter, Encoder& encoder) {
   DCHECK_EQ(lists.lists_to_values_edge.edge_type(),
             arolla::DenseArrayEdge::SPLIT_POINTS);
   absl::Span<const int64_t> splits =
       lists.lists_to_values_edge.edge_values().values.span();
   DCHECK_GT(splits.size(), 0);
   int64_t size = splits.size() - 1;
-  for (int64_t i = 0; i < size; ++i) {
-    KodaV1Proto::ListProto* list_proto = db_proto.add_lists();
-    EncodeObjectId(lists.alloc_id.ObjectByOffset(i),
-                   list_proto->mutable_list_id());
-    // TODO(b/328742873) Find a way to do it without copying data.
-    internal::SliceBuilder bldr(splits[i + 1] - splits[i]);
-    for (int64_t j = 0; j < splits[i + 1] - splits[i]; ++j) {
-      bldr.InsertIfNotSetAndUpdateAllocIds(j, lists.values[j + splits[i]]);
+  int64_t begin = 0;
+  while (begin < size) {
+    int64_t end = begin + 1;
+    while (end < size &&
+           splits[end + 1] - splits[begin] <= kMaxDataBagChunkSize) {
+      ++end;
+    }
+    ASSIGN_OR_RETURN((auto [value_proto, chunk_proto]), emitter.NewChunk());
+    auto* lists_proto = chunk_proto->mutable_lists();
+    EncodeObjectId(lists.alloc_id.ObjectByOffset(begin),
+                   lists_proto->mutable_first_list_id());
+    for (int64_t i = begin; i < end; ++i) {
+      lists_proto->add_sizes(splits[i + 1] - splits[i]);
     }
-    ASSIGN_OR_RETURN(auto values_index,
-                     encoder.EncodeValue(arolla::TypedValue::FromValue(
-                         std::move(bldr).Build())));
-    list_proto->set_values_subindex(value_proto.input_value_indices_size());
-    value_proto.add_input_value_indices(values_index);
+    RETURN_IF_ERROR(EncodeColumn(
+        encoder, *value_proto, lists.values, splits[begin], splits[end],
+        [&] { return lists_proto->mutable_values(); },
+        [&] { return lists_proto->mutable_compact_values(); }));
+    begin = end;
   }
   return absl::OkStatus();
 }
@@ -267,71 +639,75 @@ absl::StatusOr<ValueProto> EncodeDataBag(arolla::TypedRef value,
   }
   const DataBagPtr& db = value.UnsafeAs<DataBagPtr>();
 
-  ASSIGN_OR_RETURN(ValueProto value_proto, GenValueProto(encoder));
-  auto* koda_proto = value_proto.MutableExtension(KodaV1Proto::extension);
-  KodaV1Proto::DataBagProto* db_proto = koda_proto->mutable_data_bag_value();
-
-  db_proto->set_fallback_count(db->GetFallbacks().size());
-  for (const auto& fb : db->GetFallbacks()) {
-    ASSIGN_OR_RETURN(auto fb_index,
-                     encoder.EncodeValue(arolla::TypedValue::FromValue(fb)));
-    value_proto.add_input_value_indices(fb_index);
+  if (db->HasDeferredMerge()) {
+    // Only the result of the deferred merge is serialized, so that conflicts
+    // are reported and the fallbacks are not serialized as a whole.
+    ASSIGN_OR_RETURN(DataBagPtr merged_db, db->GetDeferredMergeResult());
+    return EncodeDataBag(arolla::TypedRef::FromValue(merged_db), encoder);
+  }
+  if (!db->GetFallbacks().empty()) {
+    // DataBags with fallbacks are always empty and immutable, so only the
+    // fallbacks are serialized.
+    ASSIGN_OR_RETURN(ValueProto value_proto, GenValueProto(encoder));
+    auto* koda_proto = value_proto.MutableExtension(KodaV1Proto::extension);
+    KodaV1Proto::DataBagProto* db_proto = koda_proto->mutable_data_bag_value();
+    db_proto->set_fallback_count(db->GetFallbacks().size());
+    for (const auto& fb : db->GetFallbacks()) {
+      ASSIGN_OR_RETURN(auto fb_index,
+                       encoder.EncodeValue(arolla::TypedValue::FromValue(fb)));
+      value_proto.add_input_value_indices(fb_index);
+    }
+    return value_proto;
   }
 
-  ASSIGN_OR_RETURN(internal::DataBagContent content,
-                   db->GetImpl().ExtractContent());
-  for (const auto& [attr_name, data] : content.attrs) {
-    RETURN_IF_ERROR(EncodeAttribute(attr_name, data, *db_proto->add_attrs(),
-                                    value_proto, encoder));
+  // The content is extracted one allocation at a time, so the peak memory
+  // usage doesn't exceed the size of the largest allocation.
+  const internal::DataBagImpl& impl = db->GetImpl();
+  internal::DataBagIndex index = impl.CreateIndex();
+  DataBagChunkEmitter emitter(encoder);
+  RETURN_IF_ERROR(emitter.Init());
+  for (const auto& [attr_name, attr_index] : index.attrs) {
+    auto encode_part =
+        [&](internal::DataBagIndex::AttrIndex part) -> absl::Status {
+      internal::DataBagIndex part_index;
+      part_index.attrs.emplace(attr_name, std::move(part));
+      ASSIGN_OR_RETURN(internal::DataBagContent content,
+                       impl.ExtractContent(part_index));
+      for (const auto& [name, data] : content.attrs) {
+        RETURN_IF_ERROR(EncodeAttrChunks(name, data, emitter, encoder));
+      }
+      return absl::OkStatus();
+    };
+    if (attr_index.with_small_allocs) {
+      RETURN_IF_ERROR(encode_part({.with_small_allocs = true}));
+    }
+    for (internal::AllocationId alloc : attr_index.allocations) {
+      RETURN_IF_ERROR(encode_part({.allocations = {alloc}}));
+    }
   }
-  for (const internal::DataBagContent::DictContent& d : content.dicts) {
-    RETURN_IF_ERROR(
-        EncodeDict(d, *db_proto->add_dicts(), value_proto, encoder));
+  for (internal::AllocationId alloc : index.dicts) {
+    internal::DataBagIndex part_index;
+    part_index.dicts.push_back(alloc);
+    ASSIGN_OR_RETURN(internal::DataBagContent content,
+                     impl.ExtractContent(part_index));
+    RETURN_IF_ERROR(EncodeDictChunks(content.dicts, emitter, encoder));
   }
-  for (const internal::DataBagContent::ListsContent& lists : content.lists) {
-    RETURN_IF_ERROR(EncodeLists(lists, *db_proto, value_proto, encoder));
+  for (internal::AllocationId alloc : index.lists) {
+    internal::DataBagIndex part_index;
+    part_index.lists.push_back(alloc);
+    ASSIGN_OR_RETURN(internal::DataBagContent content,
+                     impl.ExtractContent(part_index));
+    for (const internal::DataBagContent::ListsContent& lists : content.lists) {
+      RETURN_IF_ERROR(EncodeListChunks(lists, emitter, encoder));
+    }
   }
-  return value_proto;
+  return std::move(emitter).Finish();
 }
 
-absl::Status FillItemProto(Encoder& encoder, ValueProto& value_proto,
-                           KodaV1Proto::DataItemProto& item_proto,
-                           const internal::DataItem& item) {
-  return item.VisitValue([&]<typename T>(const T& v) -> absl::Status {
-    if constexpr (std::is_same_v<T, internal::MissingValue>) {
-      item_proto.set_missing(true);
-    } else if constexpr (std::is_same_v<T, internal::ObjectId>) {
-      auto* id_proto = item_proto.mutable_object_id();
-      id_proto->set_hi(v.InternalHigh64());
-      id_proto->set_lo(v.InternalLow64());
-    } else if constexpr (std::is_same_v<T, int32_t>) {
-      item_proto.set_i32(v);
-    } else if constexpr (std::is_same_v<T, int64_t>) {
-      item_proto.set_i64(v);
-    } else if constexpr (std::is_same_v<T, float>) {
-      item_proto.set_f32(v);
-    } else if constexpr (std::is_same_v<T, double>) {
-      item_proto.set_f64(v);
-    } else if constexpr (std::is_same_v<T, bool>) {
-      item_proto.set_boolean(v);
-    } else if constexpr (std::is_same_v<T, arolla::Unit>) {
-      item_proto.set_unit(true);
-    } else if constexpr (std::is_same_v<T, arolla::Text>) {
-      item_proto.set_text(v.view());
-    } else if constexpr (std::is_same_v<T, arolla::Bytes>) {
-      item_proto.set_bytes_(v);
-    } else if constexpr (std::is_same_v<T, schema::DType>) {
-      item_proto.set_dtype(v.type_id());
-    } else if constexpr (std::is_same_v<T, arolla::expr::ExprQuote>) {
-      item_proto.set_expr_quote(true);
-      ASSIGN_OR_RETURN(auto index,
-                       encoder.EncodeValue(arolla::TypedValue::FromValue(v)));
-      value_proto.add_input_value_indices(index);
-    } else {
-      static_assert(false);
-    }
-    return absl::OkStatus();
-  });
+absl::StatusOr<ValueProto> EncodePrebuiltValueProto(arolla::TypedRef value,
+                                                    Encoder& encoder) {
+  // NOTE: PrebuiltValueProto is used only once, so we can steal the proto.
+  return std::move(*value.UnsafeAs<PrebuiltValueProto>().proto);
 }
 
 absl::StatusOr<ValueProto> EncodeDataItem(arolla::TypedRef value,
@@ -356,10 +732,8 @@ absl::StatusOr<ValueProto> EncodeDataSliceImpl(arolla::TypedRef value,
       koda_proto->mutable_data_slice_impl_value();
   KodaV1Proto::DataItemVectorProto* vector_proto =
       slice_proto->mutable_data_item_vector();
-  for (int64_t i = 0; i < slice.size(); ++i) {
-    RETURN_IF_ERROR(FillItemProto(encoder, value_proto,
-                                  *vector_proto->add_values(), slice[i]));
-  }
+  RETURN_IF_ERROR(FillItemVectorProto(encoder, value_proto, *vector_proto,
+                                      slice, 0, slice.size()));
   return value_proto;
 }
 
@@ -377,6 +751,9 @@ AROLLA_INITIALIZER(
               EncodeNonDeterministic));
           RETURN_IF_ERROR(RegisterValueEncoderByQType(
               arolla::GetQType<DataBagPtr>(), EncodeDataBag));
+          RETURN_IF_ERROR(RegisterValueEncoderByQType(
+              arolla::GetQType<PrebuiltValueProto>(),
+              EncodePrebuiltValueProto));
           RETURN_IF_ERROR(RegisterValueEncoderByQType(
               arolla::GetQType<internal::DataItem>(), EncodeDataItem));
           RETURN_IF_ERROR(RegisterValueEncoderByQType(
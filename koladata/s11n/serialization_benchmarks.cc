@@ -0,0 +1,124 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include <cstdint>
+#include <utility>
+
+#include "benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/strings/str_cat.h"
+#include "koladata/data_bag.h"
+#include "koladata/internal/data_bag.h"
+#include "koladata/internal/data_slice.h"
+#include "koladata/internal/object_id.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/qtype/typed_value.h"
+#include "arolla/serialization/decode.h"
+#include "arolla/serialization/encode.h"
+#include "arolla/util/text.h"
+
+namespace koladata {
+namespace {
+
+using ::arolla::TypedValue;
+using ::koladata::internal::DataSliceImpl;
+
+enum ColumnKind { kRepetitiveText = 0, kObjectIds = 1, kSparseInt = 2 };
+
+DataSliceImpl CreateColumn(ColumnKind kind, int64_t size) {
+  switch (kind) {
+    case kRepetitiveText: {
+      arolla::DenseArrayBuilder<arolla::Text> bldr(size);
+      for (int64_t i = 0; i < size; ++i) {
+        bldr.Add(i, absl::StrCat("value_", i % 16));
+      }
+      return DataSliceImpl::Create(std::move(bldr).Build());
+    }
+    case kObjectIds:
+      return DataSliceImpl::AllocateEmptyObjects(size);
+    case kSparseInt: {
+      arolla::DenseArrayBuilder<int64_t> bldr(size);
+      for (int64_t i = 0; i < size; i += 37) {
+        bldr.Set(i, i);
+      }
+      return DataSliceImpl::Create(std::move(bldr).Build());
+    }
+  }
+  LOG(FATAL) << "unknown column kind";
+}
+
+// Returns a DataBag with a single attribute filled with the given column and
+// the column itself.
+std::pair<DataBagPtr, DataSliceImpl> CreateDataBag(ColumnKind kind,
+                                                   int64_t size) {
+  auto db = DataBag::Empty();
+  auto& impl = db->GetMutableImpl()->get();
+  auto objects = DataSliceImpl::AllocateEmptyObjects(size);
+  auto values = CreateColumn(kind, size);
+  CHECK_OK(impl.SetAttr(objects, "a", values));
+  return {std::move(db), std::move(values)};
+}
+
+void SetBytesCounters(benchmark::State& state, const DataSliceImpl& values,
+                      int64_t data_bag_bytes) {
+  // DataSliceImpl is always encoded in the plain representation.
+  auto plain_proto =
+      arolla::serialization::Encode({TypedValue::FromValue(values)}, {});
+  CHECK_OK(plain_proto);
+  state.counters["bytes_per_value"] =
+      static_cast<double>(data_bag_bytes) / values.size();
+  state.counters["compression_ratio"] =
+      static_cast<double>(plain_proto->ByteSizeLong()) / data_bag_bytes;
+}
+
+void BM_EncodeDataBag(benchmark::State& state) {
+  auto kind = static_cast<ColumnKind>(state.range(0));
+  int64_t size = state.range(1);
+  auto [db, values] = CreateDataBag(kind, size);
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(db);
+    auto proto = arolla::serialization::Encode({TypedValue::FromValue(db)}, {});
+    CHECK_OK(proto);
+    bytes = proto->ByteSizeLong();
+    benchmark::DoNotOptimize(proto);
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+  SetBytesCounters(state, values, bytes);
+}
+
+void BM_DecodeDataBag(benchmark::State& state) {
+  auto kind = static_cast<ColumnKind>(state.range(0));
+  int64_t size = state.range(1);
+  auto [db, values] = CreateDataBag(kind, size);
+  auto proto = arolla::serialization::Encode({TypedValue::FromValue(db)}, {});
+  CHECK_OK(proto);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(proto);
+    auto result = arolla::serialization::Decode(*proto);
+    CHECK_OK(result);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+  SetBytesCounters(state, values, proto->ByteSizeLong());
+}
+
+BENCHMARK(BM_EncodeDataBag)
+    ->ArgsProduct({{kRepetitiveText, kObjectIds, kSparseInt}, {1000, 100000}});
+BENCHMARK(BM_DecodeDataBag)
+    ->ArgsProduct({{kRepetitiveText, kObjectIds, kSparseInt}, {1000, 100000}});
+
+}  // namespace
+}  // namespace koladata
@@ -12,14 +12,24 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 //
+#include <cstdint>
+#include <numeric>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "koladata/data_bag.h"
+#include "koladata/internal/data_bag.h"
 #include "koladata/internal/data_item.h"
 #include "koladata/internal/data_slice.h"
 #include "koladata/internal/dtype.h"
 #include "koladata/internal/object_id.h"
+#include "koladata/internal/testing/matchers.h"
+#include "koladata/s11n/codec.pb.h"
+#include "arolla/dense_array/dense_array.h"
+#include "arolla/dense_array/edge.h"
 #include "arolla/expr/expr.h"
 #include "arolla/expr/quote.h"
 #include "arolla/qtype/typed_value.h"
@@ -35,6 +45,7 @@ namespace {
 using arolla::TypedValue;
 using internal::DataItem;
 using internal::DataSliceImpl;
+using internal::testing::IsEquivalentTo;
 
 TEST(SerializationTest, DataItem) {
   std::vector<DataItem> items{
@@ -85,5 +96,197 @@ TEST(SerializationTest, DataSliceImpl) {
   EXPECT_THAT(res, ::testing::ElementsAreArray(slice));
 }
 
+TEST(SerializationTest, ChunkedDataBag) {
+  // More values than fit into a single chunk.
+  constexpr int64_t kSize = 100000;
+  auto db = DataBag::Empty();
+  ASSERT_OK_AND_ASSIGN(internal::DataBagImpl & impl, db->GetMutableImpl());
+
+  auto objects = DataSliceImpl::AllocateEmptyObjects(kSize);
+  std::vector<int64_t> values_vec(kSize);
+  std::iota(values_vec.begin(), values_vec.end(), 0);
+  auto values =
+      DataSliceImpl::Create(arolla::CreateFullDenseArray(values_vec));
+  ASSERT_OK(impl.SetAttr(objects, "a", values));
+  DataItem small_obj(internal::AllocateSingleObject());
+  ASSERT_OK(impl.SetAttr(small_obj, "b", DataItem(arolla::Text("abc"))));
+
+  auto lists = DataSliceImpl::ObjectsFromAllocation(
+      internal::AllocateLists(3), 3);
+  ASSERT_OK_AND_ASSIGN(
+      auto lists_edge,
+      arolla::DenseArrayEdge::FromSplitPoints(
+          arolla::CreateFullDenseArray<int64_t>({0, 1, 1, 4})));
+  auto list_values = DataSliceImpl::Create(
+      {DataItem(1), DataItem(arolla::Text("x")), DataItem(),
+       DataItem(arolla::expr::ExprQuote(arolla::expr::Leaf("x")))});
+  ASSERT_OK(impl.ExtendLists(lists, list_values, lists_edge));
+
+  DataItem dict(internal::AllocateSingleDict());
+  ASSERT_OK(impl.SetInDict(dict, DataItem(arolla::Text("k")), DataItem(5)));
+  DataItem schema(internal::AllocateExplicitSchema());
+  ASSERT_OK(impl.SetSchemaAttr(schema, "a", DataItem(schema::kInt64)));
+
+  ASSERT_OK_AND_ASSIGN(auto proto, arolla::serialization::Encode(
+                                       {TypedValue::FromValue(db)}, {}));
+  int chunk_count = 0;
+  for (const auto& step : proto.decoding_steps()) {
+    if (step.has_value() &&
+        step.value().HasExtension(s11n::KodaV1Proto::extension) &&
+        step.value()
+            .GetExtension(s11n::KodaV1Proto::extension)
+            .has_data_bag_chunk_value()) {
+      ++chunk_count;
+    }
+  }
+  // 2 chunks for "a", 1 for "b", 1 for lists, 1 for dicts and 1 for schemas.
+  EXPECT_EQ(chunk_count, 6);
+
+  ASSERT_OK_AND_ASSIGN(auto decode_result,
+                       arolla::serialization::Decode(proto));
+  ASSERT_EQ(decode_result.values.size(), 1);
+  ASSERT_OK_AND_ASSIGN(DataBagPtr res_db,
+                       decode_result.values[0].As<DataBagPtr>());
+  const internal::DataBagImpl& res = res_db->GetImpl();
+  EXPECT_THAT(res.GetAttr(objects, "a"),
+              ::absl_testing::IsOkAndHolds(IsEquivalentTo(values)));
+  EXPECT_THAT(res.GetAttr(small_obj, "b"),
+              ::absl_testing::IsOkAndHolds(DataItem(arolla::Text("abc"))));
+  ASSERT_OK_AND_ASSIGN((auto [res_list_values, res_lists_edge]),
+                       res.ExplodeLists(lists));
+  EXPECT_THAT(res_list_values, IsEquivalentTo(list_values));
+  EXPECT_THAT(res_lists_edge.edge_values().values.span(),
+              ::testing::ElementsAre(0, 1, 1, 4));
+  EXPECT_THAT(res.GetFromDict(dict, DataItem(arolla::Text("k"))),
+              ::absl_testing::IsOkAndHolds(DataItem(5)));
+  EXPECT_THAT(res.GetSchemaAttr(schema, "a"),
+              ::absl_testing::IsOkAndHolds(DataItem(schema::kInt64)));
+}
+
+TEST(SerializationTest, ChunkedDataBagIsBuiltBeforeItIsReferenced) {
+  auto db = DataBag::Empty();
+  ASSERT_OK_AND_ASSIGN(internal::DataBagImpl & impl, db->GetMutableImpl());
+  DataItem obj(internal::AllocateSingleObject());
+  ASSERT_OK(impl.SetAttr(obj, "a", DataItem(1)));
+  ASSERT_OK(impl.SetAttr(obj, "b", DataItem(arolla::Text("x"))));
+  ASSERT_OK_AND_ASSIGN(auto proto, arolla::serialization::Encode(
+                                       {TypedValue::FromValue(db)}, {}));
+
+  std::vector<int> chunk_steps;
+  for (int i = 0; i < proto.decoding_steps_size(); ++i) {
+    const auto& step = proto.decoding_steps(i);
+    if (step.has_value() &&
+        step.value().HasExtension(s11n::KodaV1Proto::extension) &&
+        step.value()
+            .GetExtension(s11n::KodaV1Proto::extension)
+            .has_data_bag_chunk_value()) {
+      chunk_steps.push_back(i);
+    }
+  }
+  ASSERT_EQ(chunk_steps.size(), 2);
+  auto is_last = [&](int step) {
+    return proto.decoding_steps(step)
+        .value()
+        .GetExtension(s11n::KodaV1Proto::extension)
+        .data_bag_chunk_value()
+        .is_last();
+  };
+  EXPECT_FALSE(is_last(chunk_steps[0]));
+  EXPECT_TRUE(is_last(chunk_steps[1]));
+
+  // A chain of chunks must not branch: otherwise a DataBag could be mutated
+  // after it has been returned by a decoding step.
+  auto branched_proto = proto;
+  *branched_proto.add_decoding_steps() =
+      branched_proto.decoding_steps(chunk_steps[1]);
+  EXPECT_THAT(
+      arolla::serialization::Decode(branched_proto),
+      ::absl_testing::StatusIs(
+          absl::StatusCode::kInvalidArgument,
+          ::testing::HasSubstr(
+              "DataBagChunkProto is referenced by more than one chunk")));
+}
+
+TEST(SerializationTest, CompactDataBagColumns) {
+  constexpr int64_t kSize = 1000;
+  auto db = DataBag::Empty();
+  ASSERT_OK_AND_ASSIGN(internal::DataBagImpl & impl, db->GetMutableImpl());
+  auto objects = DataSliceImpl::AllocateEmptyObjects(kSize);
+
+  // Repetitive text.
+  arolla::DenseArrayBuilder<arolla::Text> text_bldr(kSize);
+  for (int64_t i = 0; i < kSize; ++i) {
+    text_bldr.Add(i, i % 3 == 0 ? "foo" : "bar");
+  }
+  auto text_values = DataSliceImpl::Create(std::move(text_bldr).Build());
+  ASSERT_OK(impl.SetAttr(objects, "text", text_values));
+
+  // References into a single allocation, with missing values.
+  internal::AllocationId ref_alloc = internal::Allocate(kSize);
+  arolla::DenseArrayBuilder<internal::ObjectId> ref_bldr(kSize);
+  for (int64_t i = 0; i < kSize; ++i) {
+    if (i % 10 != 0) {
+      ref_bldr.Set(i, ref_alloc.ObjectByOffset(kSize - 1 - i));
+    }
+  }
+  auto ref_values = DataSliceImpl::CreateWithAllocIds(
+      internal::AllocationIdSet(ref_alloc), std::move(ref_bldr).Build());
+  ASSERT_OK(impl.SetAttr(objects, "ref", ref_values));
+
+  // Sparse mixed column with long runs of missing values.
+  std::vector<DataItem> sparse_items(kSize);
+  for (int64_t i = 0; i < kSize; i += 100) {
+    sparse_items[i] = i % 200 == 0 ? DataItem(i) : DataItem(1.5f);
+  }
+  auto sparse_values = DataSliceImpl::Create(sparse_items);
+  ASSERT_OK(impl.SetAttr(objects, "sparse", sparse_values));
+
+  // Dict with repeated string values.
+  DataItem dict(internal::AllocateSingleDict());
+  for (int64_t i = 0; i < kSize; ++i) {
+    ASSERT_OK(impl.SetInDict(dict, DataItem(i),
+                             DataItem(arolla::Text(i % 2 ? "odd" : "even"))));
+  }
+
+  ASSERT_OK_AND_ASSIGN(auto proto, arolla::serialization::Encode(
+                                       {TypedValue::FromValue(db)}, {}));
+  int compact_attr_count = 0;
+  int compact_dict_values_count = 0;
+  for (const auto& step : proto.decoding_steps()) {
+    if (!step.has_value() ||
+        !step.value().HasExtension(s11n::KodaV1Proto::extension)) {
+      continue;
+    }
+    const auto& koda_proto =
+        step.value().GetExtension(s11n::KodaV1Proto::extension);
+    if (!koda_proto.has_data_bag_chunk_value()) {
+      continue;
+    }
+    const auto& chunk = koda_proto.data_bag_chunk_value();
+    compact_attr_count += chunk.attr_range().has_compact_values();
+    compact_dict_values_count += chunk.dicts().has_compact_values();
+  }
+  EXPECT_EQ(compact_attr_count, 3);
+  EXPECT_EQ(compact_dict_values_count, 1);
+
+  ASSERT_OK_AND_ASSIGN(auto decode_result,
+                       arolla::serialization::Decode(proto));
+  ASSERT_EQ(decode_result.values.size(), 1);
+  ASSERT_OK_AND_ASSIGN(DataBagPtr res_db,
+                       decode_result.values[0].As<DataBagPtr>());
+  const internal::DataBagImpl& res = res_db->GetImpl();
+  EXPECT_THAT(res.GetAttr(objects, "text"),
+              ::absl_testing::IsOkAndHolds(IsEquivalentTo(text_values)));
+  EXPECT_THAT(res.GetAttr(objects, "ref"),
+              ::absl_testing::IsOkAndHolds(IsEquivalentTo(ref_values)));
+  EXPECT_THAT(res.GetAttr(objects, "sparse"),
+              ::absl_testing::IsOkAndHolds(IsEquivalentTo(sparse_values)));
+  for (int64_t i = 0; i < kSize; ++i) {
+    EXPECT_THAT(res.GetFromDict(dict, DataItem(i)),
+                ::absl_testing::IsOkAndHolds(
+                    DataItem(arolla::Text(i % 2 ? "odd" : "even"))));
+  }
+}
+
 }  // namespace
 }  // namespace koladata
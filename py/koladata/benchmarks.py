@@ -14,6 +14,7 @@
 
 """Benchmarks for Kola Data library."""
 
+import concurrent.futures
 import copy
 
 from arolla import arolla
@@ -1282,5 +1283,71 @@ def databag_repr_fallbacks(state):
     _ = repr(e.db)
 
 
+@google_benchmark.register
+@google_benchmark.option.arg_names(['num_threads'])
+@google_benchmark.option.arg(1)
+@google_benchmark.option.arg(4)
+@google_benchmark.option.arg(8)
+def merge_fallbacks_multithreaded(state):
+  """Benchmark merging immutable fallbacks in parallel Python threads."""
+  num_threads = state.range(0)
+  x = kd.freeze(kd.new(a=kd.slice(list(range(10**5)))))
+  y = kd.freeze(kd.new(b=kd.slice(list(range(10**5)))))
+  db = x.enriched(y.get_bag()).get_bag()
+
+  def merge(_):
+    return db.merge_fallbacks()
+
+  with concurrent.futures.ThreadPoolExecutor(num_threads) as executor:
+    while state:
+      _ = list(executor.map(merge, range(num_threads)))
+
+
+@google_benchmark.register
+@google_benchmark.option.arg_names(['num_threads'])
+@google_benchmark.option.arg(1)
+@google_benchmark.option.arg(4)
+@google_benchmark.option.arg(8)
+def extract_multithreaded(state):
+  """Benchmark extracting frozen data in parallel Python threads."""
+  num_threads = state.range(0)
+  ds = kd.freeze(
+      kd.new(
+          a=kd.slice(list(range(10**5))),
+          b=kd.new(c=kd.slice(list(range(10**5)))),
+      )
+  )
+
+  def extract(_):
+    return kd.extract(ds)
+
+  with concurrent.futures.ThreadPoolExecutor(num_threads) as executor:
+    while state:
+      _ = list(executor.map(extract, range(num_threads)))
+
+
+@google_benchmark.register
+@google_benchmark.option.arg_names(['num_threads'])
+@google_benchmark.option.arg(1)
+@google_benchmark.option.arg(4)
+@google_benchmark.option.arg(8)
+def deep_clone_multithreaded(state):
+  """Benchmark deep cloning frozen data in parallel Python threads."""
+  num_threads = state.range(0)
+  ds = kd.freeze(
+      kd.new(
+          a=kd.slice(list(range(10**5))),
+          b=kd.new(c=kd.slice(list(range(10**5)))),
+      )
+  )
+
+  def deep_clone(_):
+    return kd.deep_clone(ds)
+
+  with concurrent.futures.ThreadPoolExecutor(num_threads) as executor:
+    while state:
+      _ = list(executor.map(deep_clone, range(num_threads)))
+
+
 if __name__ == '__main__':
   google_benchmark.main()
@@ -28,6 +28,8 @@
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "koladata/data_bag.h"
 #include "koladata/data_slice.h"
 #include "koladata/data_slice_qtype.h"
 #include "koladata/expr/constants.h"
@@ -68,6 +70,39 @@ using ::arolla::python::UnwrapPyExpr;
 using ::arolla::python::UnwrapPyQValue;
 using ::arolla::python::WrapAsPyQValue;
 
+namespace {
+
+// Returns true if the DataBag is null or neither it nor its fallbacks can be
+// modified.
+bool IsImmutableBag(const DataBagPtr& db) {
+  return db == nullptr || (!db->IsMutable() && !db->HasMutableFallbacks());
+}
+
+// Returns true if none of the values (including tuple fields) refers to a
+// DataBag that can be modified by other Python threads.
+bool AllImmutable(absl::Span<const TypedRef> values) {
+  for (const TypedRef& value : values) {
+    if (value.GetType() == arolla::GetQType<DataSlice>()) {
+      if (!IsImmutableBag(value.UnsafeAs<DataSlice>().GetBag())) {
+        return false;
+      }
+    } else if (value.GetType() == arolla::GetQType<DataBagPtr>()) {
+      if (!IsImmutableBag(value.UnsafeAs<DataBagPtr>())) {
+        return false;
+      }
+    } else {
+      for (int64_t i = 0; i < value.GetFieldCount(); ++i) {
+        if (!AllImmutable({value.GetField(i)})) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
 absl::Nullable<PyObject*> PyEvalExpr(PyObject* /*self*/, PyObject** py_args,
                                      Py_ssize_t nargs, PyObject* py_kwnames) {
   DCheckPyGIL();
@@ -191,8 +226,21 @@ absl::Nullable<PyObject*> PyEvalOp(PyObject* /*self*/, PyObject** py_args,
   }
 
   // Call the implementation.
-  ASSIGN_OR_RETURN(auto result,
-                   InvokeOpWithCompilationCache(std::move(op), input_qvalues),
+  absl::StatusOr<TypedValue> result_or_error;
+  if (AllImmutable(input_qvalues)) {
+    // No Python thread can modify the inputs, so the GIL is not needed, like
+    // in kd.eval. This lets e.g. extract and deep_clone of frozen data run in
+    // parallel.
+    ReleasePyGIL guard;
+    result_or_error =
+        InvokeOpWithCompilationCache(std::move(op), input_qvalues);
+  } else {
+    // Other Python threads can modify the inputs' DataBags while the operator
+    // reads them, so the GIL is kept.
+    result_or_error =
+        InvokeOpWithCompilationCache(std::move(op), input_qvalues);
+  }
+  ASSIGN_OR_RETURN(auto result, std::move(result_or_error),
                    SetPyErrFromStatus(_));
   return WrapAsPyQValue(std::move(result));
 }
@@ -17,6 +17,7 @@
 import google_benchmark
 from koladata import kd
 from koladata.ext import nested_data
+from koladata.ext import npkd
 
 kdi = kd.kdi
 
@@ -111,5 +112,29 @@ def nested_data_selected_path_update_objects(state):
     )
 
 
+@google_benchmark.register
+@google_benchmark.option.arg_names(['size'])
+@google_benchmark.option.args([1000])
+@google_benchmark.option.args([100000])
+def map_py(state):
+  x = kd.range(state.range(0))
+  while state:
+    _ = kd.map_py(lambda x: x * 2 + 1, x)
+
+
+@google_benchmark.register
+@google_benchmark.option.arg_names(['size', 'max_threads'])
+@google_benchmark.option.args([1000, 1])
+@google_benchmark.option.args([100000, 1])
+@google_benchmark.option.args([10000000, 1])
+@google_benchmark.option.args([10000000, 4])
+def npkd_map_py_batched(state):
+  x = kd.range(state.range(0))
+  while state:
+    _ = npkd.map_py_batched(
+        lambda x: x * 2 + 1, x, max_threads=state.range(1)
+    )
+
+
 if __name__ == '__main__':
   google_benchmark.main()
@@ -224,6 +224,62 @@ class NpkdTest(parameterized.TestCase):
     converted_back = npkd.reshape_based_on_indices(ds.flatten(), indices)
     testing.assert_equal(converted_back, ds)
 
+  @parameterized.parameters(
+      (1, [2, 1, 4]),
+      (2, [2, 5]),
+      (3, [3, 4]),
+      (100, [7]),
+  )
+  def test_map_py_batched(self, chunk_size, expected_chunks):
+    x = kd.slice([[1, 2, None], [], [4], [5, 6, 7, 8]])
+    y = kd.slice([10, 20, 30, 40])
+    chunks = []
+
+    def fn(x, y):
+      chunks.append(len(x))
+      return x * y + 1
+
+    res = npkd.map_py_batched(fn, x, y=y, chunk_size=chunk_size)
+    testing.assert_equal(
+        res, kd.slice([[11, 21, None], [], [121], [201, 241, 281, 321]])
+    )
+    # Chunks consist of whole groups of the last dimension.
+    self.assertEqual(chunks, expected_chunks)
+
+  def test_map_py_batched_threads(self):
+    x = kd.range(100000)
+    res = npkd.map_py_batched(
+        lambda x: x % 7, x, chunk_size=1000, max_threads=4
+    )
+    testing.assert_equal(res, x % 7)
+
+  def test_map_py_batched_special_cases(self):
+    with self.subTest('data item'):
+      testing.assert_equal(
+          npkd.map_py_batched(lambda x: x * 2.0, kd.item(3.0)), kd.item(6.0)
+      )
+
+    with self.subTest('all missing'):
+      res = npkd.map_py_batched(
+          lambda x: x, kd.slice([None, None], schema=kd.INT32),
+          schema=kd.INT64,
+      )
+      testing.assert_equal(res, kd.slice([None, None], schema=kd.INT64))
+
+    with self.subTest('schema'):
+      testing.assert_equal(
+          npkd.map_py_batched(lambda x: x, kd.slice([1, 2]), schema=kd.INT64),
+          kd.int64([1, 2]),
+      )
+
+    with self.subTest('wrong result size'):
+      with self.assertRaisesRegex(ValueError, 'expected fn to return'):
+        npkd.map_py_batched(lambda x: x[:1], kd.slice([1, 2]))
+
+    with self.subTest('no inputs'):
+      with self.assertRaisesRegex(TypeError, 'expected at least one input'):
+        npkd.map_py_batched(lambda: np.array([]))
+
   # TODO: Remove this.
   def test_deprecated_names(self):
     with mock.patch.object(warnings, 'warn') as mock_warn:
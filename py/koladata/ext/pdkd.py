@@ -135,7 +135,7 @@ def to_dataframe(
   if ds.get_ndim() == 0:
     ds = ds.repeat(1)
 
-  get_attr_fn = kdi.get_attr
+  allow_missing = False
   if ds.get_bag() is None:
     if cols is not None:
       raise ValueError(
@@ -145,7 +145,20 @@ def to_dataframe(
   elif cols is None:
     cols = ['self_']
     cols.extend(ds.get_attr_names(intersection=False))
-    get_attr_fn = kdi.maybe
+    allow_missing = True
+
+  # Attributes are fetched together, which is much faster for wide DataSlices.
+  attr_names = [
+      col
+      for col in cols
+      if isinstance(col, str)
+      and col not in _SPECIAL_COLUMN_NAMES
+      and col != 'self_'
+  ]
+  attr_dss = {}
+  if attr_names:
+    attr_values = ds._internal_get_attrs(allow_missing, *attr_names)  # pylint: disable=protected-access
+    attr_dss = dict(zip(attr_names, attr_values))
 
   col_dss = []
   col_names = []
@@ -156,7 +169,7 @@ def to_dataframe(
       if col == 'self_':
         col_dss.append(ds)
       else:
-        col_dss.append(get_attr_fn(ds, col))
+        col_dss.append(attr_dss[col])
       col_names.append(col)
     elif isinstance(col, arolla.Expr):
       try:
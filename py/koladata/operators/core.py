@@ -3574,6 +3574,20 @@ def inverse_mapping(x, ndim=arolla.unspecified()):
   return jagged_shape_ops.reshape(res, jagged_shape_ops.get_shape(x))
 
 
+@optools.add_to_registry()
+@optools.as_backend_operator(
+    'kde.core._sort',
+    qtype_constraints=[
+        qtype_utils.expect_data_slice(P.x),
+        qtype_utils.expect_data_slice(P.sort_by),
+        qtype_utils.expect_data_slice(P.descending),
+    ],
+    qtype_inference_expr=qtypes.DATA_SLICE,
+)
+def _sort(x, sort_by, descending):  # pylint: disable=unused-argument
+  raise NotImplementedError('implemented in the backend')
+
+
 @optools.add_to_registry(aliases=['kde.sort'])
 @optools.as_lambda_operator(
     'kde.core.sort',
@@ -3645,7 +3659,7 @@ def sort(x, sort_by=arolla.unspecified(), descending=False):
           assert_same_shape(P.x, P.sort_by), P.sort_by
       ),
   )(x, sort_by)
-  return take(x, inverse_mapping(ordinal_rank(sort_by, descending=descending)))
+  return _sort(x, sort_by, descending)
 
 
 @optools.add_to_registry(aliases=['kde.val_shaped'])
@@ -60,6 +60,16 @@ class CoreDeepUuidTest(parameterized.TestCase):
     self.assertNotEqual(res_no_seed, res_with_seed)
     self.assertNotEqual(res_with_seed2, res_with_seed)
 
+  def test_frozen_bag(self):
+    # Deep uuids of frozen data are memoized in its DataBag.
+    x = bag().obj(y=bag().obj(a=ds([1, 2])), z=ds(['a', 'b']))
+    frozen_x = expr_eval.eval(kde.freeze(x))
+    for seed in ['', '', 'seed', 'seed', '']:
+      testing.assert_equal(
+          expr_eval.eval(kde.core.deep_uuid(frozen_x, seed=seed)),
+          expr_eval.eval(kde.core.deep_uuid(x, seed=seed)),
+      )
+
   def test_no_bag_object(self):
     x = bag().obj(x=1, y=2).no_bag()
     with self.assertRaisesRegex(
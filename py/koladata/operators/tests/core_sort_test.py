@@ -145,8 +145,7 @@ class CoreSortTest(parameterized.TestCase):
   def test_data_item(self):
     with self.assertRaisesRegex(
         exceptions.KodaError,
-        # TODO: b/375621456 - Must start with 'kde.core.sort: '.
-        re.escape('array.ordinal_rank: expected rank(x) > 0'),
+        re.escape('kd.core.sort: expected rank(x) > 0'),
     ):
       expr_eval.eval(kde.core.sort(ds(0)))
 
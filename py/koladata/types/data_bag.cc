@@ -28,6 +28,7 @@
 #include "absl/base/nullability.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
@@ -1161,8 +1162,11 @@ absl::Nullable<PyObject*> PyDataBag_exactly_equal(PyObject* self,
                  Py_TYPE(other)->tp_name);
     return nullptr;
   }
-  return PyBool_FromLong(DataBagComparison::ExactlyEqual(
-      UnsafeDataBagPtr(self), (UnsafeDataBagPtr(other))));
+  ASSIGN_OR_RETURN(bool exactly_equal,
+                   DataBagComparison::ExactlyEqual(UnsafeDataBagPtr(self),
+                                                   UnsafeDataBagPtr(other)),
+                   arolla::python::SetPyErrFromStatus(_));
+  return PyBool_FromLong(exactly_equal);
 }
 
 absl::Nullable<PyObject*> PyDataBag_merge_inplace(PyObject* self,
@@ -1225,7 +1229,17 @@ absl::Nullable<PyObject*> PyDataBag_adopt(PyObject* self,
 absl::Nullable<PyObject*> PyDataBag_merge_fallbacks(PyObject* self, PyObject*) {
   arolla::python::DCheckPyGIL();
   const auto& db = UnsafeDataBagPtr(self);
-  ASSIGN_OR_RETURN(auto res, db->MergeFallbacks(),
+  absl::StatusOr<DataBagPtr> res_or_error;
+  if (db->IsMutable() || db->HasMutableFallbacks()) {
+    // Other Python threads can modify the DataBags, so the GIL is kept.
+    res_or_error = db->MergeFallbacks();
+  } else {
+    // Only immutable DataBags are read, and the result is not visible to
+    // Python yet.
+    arolla::python::ReleasePyGIL guard;
+    res_or_error = db->MergeFallbacks();
+  }
+  ASSIGN_OR_RETURN(auto res, std::move(res_or_error),
                    arolla::python::SetPyErrFromStatus(_));
   return WrapDataBagPtr(std::move(res));
 }
@@ -29,11 +29,13 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "koladata/adoption_utils.h"
 #include "koladata/arolla_utils.h"
 #include "koladata/data_bag.h"
 #include "koladata/data_slice.h"
+#include "koladata/data_slice_chunks.h"
 #include "koladata/data_slice_qtype.h"
 #include "koladata/data_slice_repr.h"
 #include "koladata/internal/data_item.h"
@@ -257,18 +259,31 @@ absl::Nullable<PyObject*> PyDataSlice_to_proto(PyObject* self,
     message_ptrs.push_back(messages.back().get());
   }
 
-  ASSIGN_OR_RETURN(auto flat_slice,
-                   slice.Reshape(slice.GetShape().FlatFromSize(slice.size())),
-                   arolla::python::SetPyErrFromStatus(_));
-  ASSIGN_OR_RETURN(auto mask, ops::Has(flat_slice),
-                   arolla::python::SetPyErrFromStatus(_));
-  ASSIGN_OR_RETURN(auto dense_flat_slice,
-                   ops::Select(std::move(flat_slice), mask, false),
+  // Fills `messages` and returns the presence mask of the flattened `slice`.
+  auto to_proto = [&]() -> absl::StatusOr<DataSlice> {
+    ASSIGN_OR_RETURN(
+        auto flat_slice,
+        slice.Reshape(slice.GetShape().FlatFromSize(slice.size())));
+    ASSIGN_OR_RETURN(auto mask, ops::Has(flat_slice));
+    ASSIGN_OR_RETURN(auto dense_flat_slice,
+                     ops::Select(std::move(flat_slice), mask, false));
+    RETURN_IF_ERROR(ToProto(std::move(dense_flat_slice), message_ptrs));
+    return mask;
+  };
+  absl::StatusOr<DataSlice> mask_or_error;
+  const DataBagPtr& db = slice.GetBag();
+  if (db != nullptr && (db->IsMutable() || db->HasMutableFallbacks())) {
+    // Other Python threads can modify the DataBag, so the GIL is kept.
+    mask_or_error = to_proto();
+  } else {
+    // The DataBag is immutable, and the messages are not visible to Python
+    // until they are wrapped below.
+    arolla::python::ReleasePyGIL guard;
+    mask_or_error = to_proto();
+  }
+  ASSIGN_OR_RETURN(auto mask, std::move(mask_or_error),
                    arolla::python::SetPyErrFromStatus(_));
 
-  RETURN_IF_ERROR(ToProto(std::move(dense_flat_slice), message_ptrs))
-      .With(arolla::python::SetPyErrFromStatus);
-
   // If the input was a DataItem, return a single message (or None).
   if (slice.is_item()) {
     if (num_messages == 0) {
@@ -742,6 +757,67 @@ absl::Nullable<PyObject*> PyDataSlice_pop(PyObject* self, PyObject* const* args,
   return WrapPyDataSlice(std::move(res));
 }
 
+// Returns a list with the values of several attributes, fetched together.
+// Arguments are `allow_missing` followed by the attribute names.
+absl::Nullable<PyObject*> PyDataSlice_get_attrs(PyObject* self,
+                                                PyObject* const* args,
+                                                Py_ssize_t nargs) {
+  arolla::python::DCheckPyGIL();
+  if (nargs < 1 || !PyBool_Check(args[0])) {
+    PyErr_SetString(PyExc_TypeError,
+                    "expected `allow_missing` bool and attribute names");
+    return nullptr;
+  }
+  bool allow_missing = args[0] == Py_True;
+  std::vector<absl::string_view> attr_names;
+  attr_names.reserve(nargs - 1);
+  for (Py_ssize_t i = 1; i < nargs; ++i) {
+    Py_ssize_t size;
+    const char* attr_name_ptr = PyUnicode_AsUTF8AndSize(args[i], &size);
+    if (attr_name_ptr == nullptr) {
+      return nullptr;
+    }
+    attr_names.emplace_back(attr_name_ptr, size);
+  }
+  ASSIGN_OR_RETURN(
+      auto attrs,
+      UnsafeDataSliceRef(self).GetAttrs(attr_names, allow_missing),
+      arolla::python::SetPyErrFromStatus(_));
+  auto py_attrs = arolla::python::PyObjectPtr::Own(PyList_New(attrs.size()));
+  if (py_attrs == nullptr) {
+    return nullptr;
+  }
+  for (size_t i = 0; i < attrs.size(); ++i) {
+    PyObject* py_attr = WrapPyDataSlice(std::move(attrs[i]));
+    if (py_attr == nullptr) {
+      return nullptr;
+    }
+    PyList_SET_ITEM(py_attrs.get(), i, py_attr);
+  }
+  return py_attrs.release();
+}
+
+// Returns the items [begin, end) of the first dimension, see GetRows.
+absl::Nullable<PyObject*> PyDataSlice_get_rows(PyObject* self,
+                                               PyObject* const* args,
+                                               Py_ssize_t nargs) {
+  arolla::python::DCheckPyGIL();
+  if (nargs != 2 || !PyLong_Check(args[0]) || !PyLong_Check(args[1])) {
+    PyErr_SetString(PyExc_TypeError,
+                    "expected `begin` and `end` row indices as ints");
+    return nullptr;
+  }
+  int64_t begin = PyLong_AsLongLong(args[0]);
+  int64_t end = PyLong_AsLongLong(args[1]);
+  if (PyErr_Occurred()) {
+    return nullptr;
+  }
+  const DataSlice& self_ds = UnsafeDataSliceRef(self);
+  ASSIGN_OR_RETURN(auto res, GetRows(self_ds, begin, end),
+                   arolla::python::SetPyErrFromStatus(_));
+  return WrapPyDataSlice(std::move(res));
+}
+
 absl::Nullable<PyObject*> PyDataSlice_clear(PyObject* self, PyObject*) {
   arolla::python::DCheckPyGIL();
   RETURN_IF_ERROR(UnsafeDataSliceRef(self).ClearDictOrList())
@@ -1159,6 +1235,11 @@ Args:
      "Append a value to each list in this DataSlice"},
     {"_internal_pop", (PyCFunction)PyDataSlice_pop, METH_FASTCALL,
      "Pop a value from each list in this DataSlice"},
+    {"_internal_get_attrs", (PyCFunction)PyDataSlice_get_attrs, METH_FASTCALL,
+     "Returns a list of the values of several attributes, fetched together."},
+    {"_internal_get_rows", (PyCFunction)PyDataSlice_get_rows, METH_FASTCALL,
+     "Returns the items [begin, end) of the first dimension, without copying "
+     "the values."},
     {"clear", PyDataSlice_clear, METH_NOARGS,
      "clear()\n"
      "--\n\n"
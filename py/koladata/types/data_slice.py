@@ -16,7 +16,7 @@
 
 import dataclasses
 import functools
-from typing import Any
+from typing import Any, Iterator
 import warnings
 
 from arolla import arolla
@@ -444,6 +444,24 @@ def _take(self, indices: Any) -> DataSlice:
   return _eval_op('kde.take', self, indices)
 
 
+@DataSlice._add_method('iter_chunks')  # pylint: disable=protected-access
+def _iter_chunks(self, chunk_size: int = 1024) -> Iterator[DataSlice]:
+  """Yields chunks of at most `chunk_size` items of the first dimension.
+
+  The chunks are created lazily and share the values, schema and DataBag of
+  this DataSlice, so huge DataSlices can be processed (e.g. converted with
+  `to_py` or used to fetch attributes) with memory bounded by `chunk_size`.
+
+  Args:
+    chunk_size: Maximum number of items of the first dimension in a chunk.
+  """
+  if chunk_size <= 0:
+    raise ValueError(f'chunk_size must be positive, got {chunk_size}')
+  row_count = len(ListSlicingHelper(self))
+  for begin in range(0, row_count, chunk_size):
+    yield self._internal_get_rows(begin, min(begin + chunk_size, row_count))
+
+
 @DataSlice._add_method('to_py')  # pylint: disable=protected-access
 def to_py(
     ds: DataSlice,
@@ -858,7 +876,11 @@ class ListSlicingHelper:
     ).internal_as_py()[0]
 
   def __iter__(self):
-    return (self[i] for i in range(len(self)))
+    # Only one chunk of the DataSlice is imploded at a time.
+    for chunk in self._ds.iter_chunks():
+      chunk_helper = ListSlicingHelper(chunk)
+      for i in range(len(chunk_helper)):
+        yield chunk_helper[i]
 
 
 # NOTE: we can create a decorator for adding property similar to add_method, if
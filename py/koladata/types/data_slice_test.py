@@ -3276,6 +3276,32 @@ class DataSliceListSlicingTest(parameterized.TestCase):
     for idx, el in enumerate(d.L):
       self.assertEqual(el, d.L[idx])
 
+  def test_iter_multiple_chunks(self):
+    d = ds([[1, 2], [3], [], [4, 5, 6]] * 500)
+    items = list(d.L)
+    self.assertLen(items, 2000)
+    for idx in [0, 1, 1023, 1024, 1999]:
+      testing.assert_equal(items[idx], d.L[idx])
+
+  def test_iter_chunks(self):
+    db = bag()
+    x = db.new(a=ds([1, 2, 3, 4, 5]))
+    chunks = list(x.iter_chunks(chunk_size=2))
+    self.assertLen(chunks, 3)
+    testing.assert_equal(chunks[1].a, ds([3, 4]).with_bag(db))
+    testing.assert_equal(chunks[2], x.S[4:])
+    self.assertEqual(chunks[0].a.to_py(), [1, 2])
+
+    y = ds([[1, 2], [3], [4, 5, 6]])
+    testing.assert_equal(
+        list(y.iter_chunks(chunk_size=2))[0], ds([[1, 2], [3]])
+    )
+
+    with self.assertRaisesRegex(ValueError, 'chunk_size must be positive'):
+      next(x.iter_chunks(chunk_size=0))
+    with self.assertRaisesRegex(ValueError, 'at least one dimension'):
+      next(ds(1).iter_chunks())
+
   def test_is_mutable(self):
     x = ds(None)
     self.assertFalse(x.is_mutable())